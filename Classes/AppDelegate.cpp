@@ -1,9 +1,17 @@
 #include "AppDelegate.h"
 #include "DemoScene.h"
+#include "LoadingScene.h"
 
 //Wrapper Classes
 #include "InputHandler.h"
 #include "DisplayHandler.h"
+#include "BirdPool.h"
+#include "AssetPreloader.h"
+#include "SpriteAtlas.h"
+#include "GlyphCache.h"
+#include "FramePacer.h"
+#include "JobSystem.h"
+#include "Profiler.h"
 
 USING_NS_CC;
 
@@ -14,6 +22,8 @@ AppDelegate::AppDelegate()
 
 AppDelegate::~AppDelegate()
 {
+	//Stop the job system's worker threads. Any jobs still waiting are run first
+	JOBS->shutdown();
 }
 
 //--- Virtual Methods ---//
@@ -26,12 +36,62 @@ bool AppDelegate::applicationDidFinishLaunching()
 	//The 2.0x zoom factor simply scales up our window so it is easier to see and work with. The window itself is 2x the size as well as everything being drawn inside it
 	DISPLAY->init(640, 480, "Demo Scene for Cocos2D", false, 2.0f);
 
-	//Create our main scene and tell the director to use it
+	//Tell the director how often to draw a frame, and start timing how long each frame takes against that
+	//If the frames start going over budget, the frame pacer lowers the quality of the demo scene until they fit again. See FramePacer.h
+	//*** Try FrameTarget::FPS30 or FrameTarget::Uncapped here. Press F in the demo scene to switch between them while it is running! ***//
+	PACER->init(FrameTarget::FPS60);
+
+	//Start the job system's worker threads, one per CPU core (counting this one). Everything in the game hands its work to these threads instead of starting its own
+	//This has to happen before the scene is made, since the particle updater asks how many threads there are when it is created. See JobSystem.h
+	//*** Try JOBS->init(1) to run every job on the main thread, and compare the frame times in the profiler overlay (press P)! ***//
+	JOBS->init(0);
+
+	//Show the loading screen while all of the images, sounds and fonts are loaded
 	//The director is Cocos2D's game management system. It controls the scene switching, creating, etc. It is a singleton so there is only one instance of the class and it can be used everywhere
-	//We are creating a new version of our demo scene and then telling the director to start using it
+	//Without this, the images and fonts get loaded the first time something uses them, which means a stutter the first time you spawn a bird or press P
 	Director* director = Director::getInstance();
-	Scene* scene = DemoScene::createScene();
-	director->runWithScene(scene);
+	director->runWithScene(LoadingScene::create());
+
+	//Tell the preloader about everything in the Resources/Demo folder that the demo scene uses
+	//The paths HAVE to match the ones used in the scene exactly, otherwise Cocos2D won't realize they are the same file and will load them again
+	//*** Try adding a new image to the scene. Does the first spawn stutter if you forget to add it here? ***//
+	PRELOADER->addImage("Demo/Background\\spr_Background.jpg");
+
+	//The birds and particles are packed into a sprite atlas when the game is built (see SpriteAtlas.h), so only the atlas texture has to be loaded
+	//If the atlas wasn't built, the images are loaded on their own instead
+	if (SPRITE_ATLAS->load("Demo/Atlas/atlas_Demo.frames"))
+		PRELOADER->addImage(SPRITE_ATLAS->getTexturePath());
+	else
+	{
+		PRELOADER->addImage("Demo/Birds/spr_BirdYellow.png");
+		PRELOADER->addImage("Demo/Birds/spr_BirdRed.png");
+		PRELOADER->addImage("Demo/Birds/spr_BirdBlue.png");
+		PRELOADER->addImage("Demo/Particles/spr_SnowParticle.png");
+	}
+	PRELOADER->addSound("Demo/Sounds/sound_SpawnObject.mp3");
+
+	//The letters of the font are baked into a glyph cache when the game is built (see GlyphCache.h). One cache covers every size, and nothing has to be drawn by FreeType
+	//If the cache wasn't built, each size of the font is opened by the preloader instead
+	if (!GLYPHS->load("Fonts/arial.ttf"))
+	{
+		PRELOADER->addFont("Fonts/arial.ttf", 100.0f);
+		PRELOADER->addFont("Fonts/arial.ttf", 20.0f);
+		PRELOADER->addFont("Fonts/arial.ttf", 12.0f);
+	}
+
+	//Start loading. Once everything is in, the function below is called and we switch over to the actual game
+	PRELOADER->start([director]()
+	{
+		//Build some birds ahead of time so the first spawns don't have to create any sprites or physics bodies
+		//This has to happen after the images are loaded since the birds need their frames from the atlas
+		//*** Try changing the numbers and watch the 'Misses' count that is printed when you restart the scene! ***//
+		BIRD_POOL->prewarm(BirdType::Yellow, 64);
+		BIRD_POOL->prewarm(BirdType::Red, 32);
+
+		//Create our main scene and tell the director to use it
+		//We are creating a new version of our demo scene and then telling the director to switch to it from the loading screen
+		director->replaceScene(DemoScene::createScene());
+	});
 	
 	//Set up the input handler
 	//This is another singleton so you can't make more than one instance of this class
@@ -39,6 +99,10 @@ bool AppDelegate::applicationDidFinishLaunching()
 	//This is a simple input handler to prevent having to handle the Cocos2D events yourself
 	INPUTS->init();
 
+	//Let the profiler listen to the director so it can time the rendering and knows when each frame ends
+	//This does nothing in release builds since the profiler is compiled out
+	PROFILER->attachToDirector();
+
 	//Indicate everything succeeded with the launch
 	return true;
 }
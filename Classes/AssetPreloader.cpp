@@ -0,0 +1,335 @@
+#include "AssetPreloader.h"
+#include "CookedTexture.h"
+#include "DisplayHandler.h"
+#include "SoundCache.h"
+
+//Core Libraries
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+
+//--- Static Variables ---//
+AssetPreloader* AssetPreloader::inst = nullptr;
+
+//The key the update function is scheduled with so it can be unscheduled again
+static const char* PRELOADER_SCHEDULE_KEY = "AssetPreloader";
+
+
+
+//--- Constructor and Destructor ---//
+AssetPreloader::AssetPreloader()
+{
+	//Init the private data
+	nextImageToDecode = 0;
+	imagesUploaded = 0;
+	soundsLoaded = 0;
+	fontsLoaded = 0;
+	failed = 0;
+	useCookedTextures = true;
+	uploadMs = 0.0;
+	running = false;
+	finished = false;
+}
+
+AssetPreloader::~AssetPreloader()
+{
+	//Make sure none of the workers are still running. Skip any images they haven't picked up yet so they stop quickly
+	nextImageToDecode = images.size();
+	for (unsigned int i = 0; i < workers.size(); i++)
+	{
+		if (workers[i].joinable())
+			workers[i].join();
+	}
+
+	//Let go of any images that were decoded but never uploaded
+	for (unsigned int i = 0; i < images.size(); i++)
+	{
+		if (images[i].image)
+			images[i].image->release();
+	}
+
+	//Clean up the singleton pointer so a new preloader is built if it is used again
+	inst = nullptr;
+}
+
+
+
+//--- Getters ---//
+float AssetPreloader::getProgress() const
+{
+	//If there is nothing to load, it is already done
+	unsigned int total = getTotalCount();
+	if (total == 0)
+		return 1.0f;
+
+	return (float)getLoadedCount() / (float)total;
+}
+
+unsigned int AssetPreloader::getLoadedCount() const
+{
+	return imagesUploaded + soundsLoaded + fontsLoaded;
+}
+
+unsigned int AssetPreloader::getTotalCount() const
+{
+	return images.size() + sounds.size() + fonts.size();
+}
+
+unsigned int AssetPreloader::getFailedCount() const
+{
+	return failed;
+}
+
+bool AssetPreloader::isRunning() const
+{
+	return running;
+}
+
+bool AssetPreloader::isFinished() const
+{
+	return finished;
+}
+
+bool AssetPreloader::getCookedTexturesEnabled() const
+{
+	return useCookedTextures;
+}
+
+
+
+//--- Setters ---//
+void AssetPreloader::setCookedTexturesEnabled(bool enabled)
+{
+	useCookedTextures = enabled;
+}
+
+
+
+//--- Methods ---//
+void AssetPreloader::addImage(const std::string& path)
+{
+	//Work out the full path now, on the main thread. FileUtils caches its lookups so it isn't safe to use from the workers
+	//The texture cache uses the full path as the key too, so this is what makes Sprite::create(path) find the texture later
+	ImageJob job = { path, FileUtils::getInstance()->fullPathForFilename(path), "", nullptr, 0.0, false };
+
+	//Look for a cooked version too. Checking if it exists first keeps FileUtils from printing a warning when there isn't one
+	std::string cookedPath = CookedTexture::getCookedPath(path);
+	if (useCookedTextures && FileUtils::getInstance()->isFileExist(cookedPath))
+		job.cookedFullPath = FileUtils::getInstance()->fullPathForFilename(cookedPath);
+
+	images.push_back(job);
+}
+
+void AssetPreloader::addSound(const std::string& path)
+{
+	sounds.push_back(path);
+}
+
+void AssetPreloader::addFont(const std::string& path, float size)
+{
+	FontJob job = { path, size };
+	fonts.push_back(job);
+}
+
+void AssetPreloader::start(const std::function<void()>& _onFinished)
+{
+	//Don't start twice
+	if (running || finished)
+		return;
+
+	onFinished = _onFinished;
+	running = true;
+	startTime = std::chrono::steady_clock::now();
+
+	//If there is no GPU, none of this can be loaded. Count it all as done
+	if (DISPLAY->isHeadless())
+	{
+		imagesUploaded = images.size();
+		soundsLoaded = sounds.size();
+		fontsLoaded = fonts.size();
+		finish();
+		return;
+	}
+
+	//Start decoding the images. One thread per image up to the max, leaving a core for the main thread so the loading screen keeps drawing
+	unsigned int numThreads = std::thread::hardware_concurrency();
+	numThreads = (numThreads > 1) ? numThreads - 1 : 1;
+	numThreads = std::min(numThreads, (unsigned int)ASSET_MAX_DECODE_THREADS);
+	numThreads = std::min(numThreads, (unsigned int)images.size());
+	decodedImages.reserve(images.size());
+	for (unsigned int i = 0; i < numThreads; i++)
+		workers.push_back(std::thread(&AssetPreloader::decodeImages, this));
+
+	//Hand the sounds to the sound cache. The audio engine decodes them on its own threads and the cache lets us know when each one is done
+	//Long sounds are set to stream instead, and count as done right away
+	for (unsigned int i = 0; i < sounds.size(); i++)
+	{
+		SOUNDS->load(SOUNDS->getId(sounds[i]), [this](bool isSuccess)
+		{
+			if (!isSuccess)
+				failed++;
+			soundsLoaded++;
+		});
+	}
+
+	//Check on everything once a frame until it is all done
+	Director::getInstance()->getScheduler()->schedule(CC_CALLBACK_1(AssetPreloader::update, this), this, 0.0f, false, PRELOADER_SCHEDULE_KEY);
+}
+
+
+
+//--- Singleton Instance ---//
+AssetPreloader* AssetPreloader::getInstance()
+{
+	//Generate the singleton if it hasn't been created yet
+	if (!inst)
+		inst = new AssetPreloader();
+
+	//Return the singleton
+	return inst;
+}
+
+
+
+//--- Utility Functions ---//
+void AssetPreloader::decodeImages()
+{
+	//Keep grabbing the next image until they have all been taken. The atomic counter makes sure no two workers grab the same one
+	unsigned int index;
+	while ((index = nextImageToDecode++) < images.size())
+	{
+		//Use the cooked version if there is one. It is already raw pixels so there is nothing to decode
+		//If it is broken, fall back to the original image
+		ImageJob& job = images[index];
+		std::chrono::steady_clock::time_point loadStart = std::chrono::steady_clock::now();
+		Image* image = nullptr;
+		if (!job.cookedFullPath.empty())
+			image = CookedTexture::load(job.cookedFullPath);
+		job.wasCooked = image != nullptr;
+
+		//Otherwise read the file and decode it into raw pixels. This is the slow part, and it doesn't need the GPU so it can happen here
+		//The image isn't autoreleased since the autorelease pool only belongs to the main thread
+		if (!image)
+		{
+			image = new (std::nothrow) Image();
+			if (image && !image->initWithImageFile(job.fullPath))
+			{
+				image->release();
+				image = nullptr;
+			}
+		}
+		job.image = image;
+		job.loadMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - loadStart).count();
+
+		//Let the main thread know it is ready to upload. Failed images are passed along too so the main thread can count them
+		std::lock_guard<std::mutex> lock(decodedMutex);
+		decodedImages.push_back(index);
+	}
+}
+
+void AssetPreloader::update(float deltaTime)
+{
+	//Upload the decoded images until we run out of time for this frame. Whatever is left waits for the next frame
+	std::chrono::steady_clock::time_point uploadStart = std::chrono::steady_clock::now();
+	std::vector<unsigned int> readyImages;
+	{
+		std::lock_guard<std::mutex> lock(decodedMutex);
+		readyImages.swap(decodedImages);
+	}
+
+	unsigned int uploaded = 0;
+	for (; uploaded < readyImages.size(); uploaded++)
+	{
+		std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - uploadStart;
+		if (uploaded > 0 && elapsed.count() > ASSET_UPLOAD_BUDGET_MS)
+			break;
+
+		ImageJob& job = images[readyImages[uploaded]];
+		if (job.image)
+		{
+			//Create the texture from the decoded pixels and store it in the cache under the full path
+			//Cooked textures can have mips, which have to be switched on once the texture exists
+			Texture2D* texture = Director::getInstance()->getTextureCache()->addImage(job.image, job.fullPath);
+			CookedTexture::applyTexParameters(texture);
+			job.image->release();
+			job.image = nullptr;
+		}
+		else
+		{
+			std::cout << "ERROR: Could not load the image '" << job.path << "'" << std::endl;
+			failed++;
+		}
+		imagesUploaded++;
+	}
+
+	uploadMs += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - uploadStart).count();
+
+	//Put back anything that didn't fit in this frame, ahead of anything the workers have finished since
+	if (uploaded < readyImages.size())
+	{
+		std::lock_guard<std::mutex> lock(decodedMutex);
+		decodedImages.insert(decodedImages.begin(), readyImages.begin() + uploaded, readyImages.end());
+	}
+
+	//Open one font per frame once the images are done. Opening a font reads the whole '.ttf' file, which has to happen on the main thread
+	//The font cache keeps the font open for as long as something is using it. We never give this one back, so the labels always find it already open
+	if (imagesUploaded == images.size() && fontsLoaded < fonts.size())
+	{
+		const FontJob& job = fonts[fontsLoaded];
+		TTFConfig config(job.path.c_str(), job.size);
+		if (!FontAtlasCache::getFontAtlasTTF(&config))
+		{
+			std::cout << "ERROR: Could not load the font '" << job.path << "'" << std::endl;
+			failed++;
+		}
+		fontsLoaded++;
+	}
+
+	//Once everything is in, we are done
+	if (getLoadedCount() == getTotalCount())
+		finish();
+}
+
+void AssetPreloader::finish()
+{
+	//Every image has been decoded by now so the workers have already stopped. Just clean up the threads
+	for (unsigned int i = 0; i < workers.size(); i++)
+	{
+		if (workers[i].joinable())
+			workers[i].join();
+	}
+	workers.clear();
+
+	//Stop checking every frame
+	Director::getInstance()->getScheduler()->unschedule(PRELOADER_SCHEDULE_KEY, this);
+
+	//Print how long it all took. The image load times add up the time each worker spent, so they can be more than the total when the workers overlap
+	//*** Try calling PRELOADER->setCookedTexturesEnabled(false) in AppDelegate and compare the numbers. How much of the startup was decoding? ***//
+	unsigned int cookedCount = 0, decodedCount = 0;
+	double cookedMs = 0.0, decodedMs = 0.0;
+	for (unsigned int i = 0; i < images.size(); i++)
+	{
+		if (images[i].wasCooked)
+		{
+			cookedCount++;
+			cookedMs += images[i].loadMs;
+		}
+		else
+		{
+			decodedCount++;
+			decodedMs += images[i].loadMs;
+		}
+	}
+
+	double totalMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+	std::cout << "Preloaded " << getLoadedCount() << " assets (" << failed << " failed) in " << totalMs << " ms" << std::endl;
+	std::cout << "    Images: " << cookedCount << " cooked (" << cookedMs << " ms to load), " << decodedCount << " decoded (" << decodedMs << " ms to decode), " << uploadMs << " ms to upload" << std::endl;
+	running = false;
+	finished = true;
+
+	//Call the finished function. It is copied out first in case it starts loading something else
+	std::function<void()> callback = onFinished;
+	onFinished = nullptr;
+	if (callback)
+		callback();
+}
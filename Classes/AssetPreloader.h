@@ -0,0 +1,185 @@
+/*
+============================================================
+	Asset Preloader:
+		- Loads every image, sound and font the game needs before the first interactive frame, so nothing has to be read from disk in the middle of playing
+		- Images are decoded (png / jpg -> raw pixels) on worker threads, several at once. Only the upload to the GPU happens on the main thread, since OpenGL can only be used there
+			> If an image has a cooked version next to it (see CookedTexture.h), that is loaded instead. It skips the decode completely
+			> The uploads are spread over several frames (see ASSET_UPLOAD_BUDGET_MS) so the loading screen keeps drawing while they happen
+		- Sounds are handed to the sound cache (SoundCache.h), which has the audio engine decode them on its own threads
+		- Fonts are opened on the main thread once the images are done. Cocos2D doesn't let us open a font anywhere else
+		- getProgress() tells you how much is done so a loading screen can show it
+		- Once everything is loaded, how long it took is printed to the console, with the images split into cooked and decoded ones
+
+	Usage:
+		- Add every asset with addImage(), addSound() and addFont(), then call start() with a function to run once everything is loaded
+		- Use EXACTLY the same path you use when creating the sprite / label / sound, otherwise Cocos2D won't find the preloaded version and will load it again
+		- You are free to use this class for the case studies and for GDW
+		- You are free to edit / overwrite any or all of this class
+			> It is simply here to make your life easier
+
+	Note:
+		- The images end up in the director's texture cache, so Sprite::create() with the same path just finds them there
+		- Nothing is loaded when the display is headless since there is no GPU to upload to. The finished function is still called
+		- This class uses the Singleton design pattern
+			> There is a macro "PRELOADER->" that provides a shortcut for getting the singleton instance
+============================================================
+*/
+
+#ifndef ASSETPRELOADER_H
+#define ASSETPRELOADER_H
+
+//Core Libraries
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+//3rd Party Libraries
+#include "cocos2d.h"
+
+//Namespaces
+using namespace cocos2d;
+
+#define ASSET_MAX_DECODE_THREADS 4 //The most worker threads used to decode images. More than this just fight over the disk
+#define ASSET_UPLOAD_BUDGET_MS 8.0 //How long the uploads are allowed to take each frame before the rest wait for the next frame. Half a frame at 60fps
+
+
+
+/*
+	Asset Preloader Class:
+	> Getters
+		- Get the progress and the counts
+		- Get if it is running / finished
+	> Setters
+		- Set if cooked textures are used
+	> Methods
+		- Add images, sounds and fonts to load
+		- Start loading
+*/
+class AssetPreloader
+{
+protected:
+	//--- Constructor ---//
+	AssetPreloader(); //The constructor is protected so only one instance of this class can ever exist. This is called the singleton pattern.
+
+public:
+	//--- Destructor ---//
+	~AssetPreloader();
+
+
+
+	//--- Getters ---//
+	/*
+		Get how much of the loading is done
+
+		@return Returns -> 0.0 before anything has loaded, up to 1.0 once everything has loaded. Every asset counts the same no matter how big it is
+	*/
+	float getProgress() const;
+
+	unsigned int getLoadedCount() const; //Get how many assets have finished loading, including ones that failed
+	unsigned int getTotalCount() const; //Get how many assets have been added
+	unsigned int getFailedCount() const; //Get how many assets couldn't be loaded. The errors are printed to the console
+	bool isRunning() const; //Get if start() has been called and the loading isn't done yet
+	bool isFinished() const; //Get if everything has been loaded and the finished function has been called
+	bool getCookedTexturesEnabled() const; //Get if the cooked version of an image is used when there is one
+
+
+
+	//--- Setters ---//
+	void setCookedTexturesEnabled(bool enabled); //Set if the cooked version of an image is used when there is one. On by default. Turn it off to compare the load times. Set this before adding any images
+
+
+
+	//--- Methods ---//
+	/*
+		Add an image to load. It ends up in the director's texture cache
+
+		@param Path -> The path of the image, starting in the Resources folder. Ex: "Demo/Birds/spr_BirdYellow.png"
+	*/
+	void addImage(const std::string& path);
+
+	/*
+		Add a sound to load into the sound cache
+
+		@param Path -> The path of the sound, starting in the Resources folder. Ex: "Demo/Sounds/sound_SpawnObject.mp3"
+	*/
+	void addSound(const std::string& path);
+
+	/*
+		Add a font to open. Each size of the same font has to be added separately since Cocos2D keeps a separate set of letters for each size
+
+		@param Path -> The path of the '.ttf' file, starting in the Resources folder. Ex: "Fonts/arial.ttf"
+		@param Size -> The font size the labels are going to use
+	*/
+	void addFont(const std::string& path, float size);
+
+	/*
+		Start loading everything that was added. Call this on the main thread, once the window has been created. This returns straight away, the loading happens over the next few frames
+
+		@param OnFinished -> A function that is called on the main thread once everything has loaded. This is where you switch to the first real scene
+	*/
+	void start(const std::function<void()>& onFinished);
+
+
+
+	//--- Singleton Instance ---//
+	/*
+		Get the instance of the singleton. You shouldn't ever need to call this directly since the macro (PRELOADER->) automatically calls it
+
+		@return Returns -> The singleton instance of this class
+	*/
+	static AssetPreloader* getInstance();
+
+private:
+	//--- Private Data ---//
+	//An image waiting to be decoded, then uploaded
+	struct ImageJob
+	{
+		std::string path; //The path that was added. Used for error messages
+		std::string fullPath; //The full path on disk. This is also the key the texture cache uses, so Sprite::create() finds the texture
+		std::string cookedFullPath; //The full path of the cooked version of the image. Empty if there isn't one
+		Image* image; //The decoded pixels. nullptr until a worker has decoded it, or if it couldn't be decoded
+		double loadMs; //How long the worker took to read and decode it
+		bool wasCooked; //If the image came from the cooked version
+	};
+
+	//A font size waiting to be opened
+	struct FontJob
+	{
+		std::string path;
+		float size;
+	};
+
+	std::vector<ImageJob> images; //Every image that was added
+	std::vector<std::string> sounds; //Every sound that was added
+	std::vector<FontJob> fonts; //Every font that was added
+	std::vector<std::thread> workers; //The threads decoding the images
+	std::atomic<unsigned int> nextImageToDecode; //The index of the next image a worker should pick up
+	std::vector<unsigned int> decodedImages; //The images the workers have finished decoding, in the order they finished. Protected by the mutex
+	std::mutex decodedMutex; //Keeps the workers and the main thread from using decodedImages at the same time
+	unsigned int imagesUploaded; //How many images have been uploaded (or failed)
+	std::atomic<unsigned int> soundsLoaded; //How many sounds the audio engine has finished with. Atomic since some platforms let us know from the audio engine's threads
+	unsigned int fontsLoaded; //How many fonts have been opened
+	std::atomic<unsigned int> failed; //How many assets couldn't be loaded
+	bool useCookedTextures; //If the cooked version of an image is used when there is one
+	std::chrono::steady_clock::time_point startTime; //When start() was called. Used to print how long the whole thing took
+	double uploadMs; //How long the uploads have taken in total
+	std::function<void()> onFinished; //What to call once everything has loaded
+	bool running; //True between start() and the finished function being called
+	bool finished; //True once the finished function has been called
+
+	//--- Utility Functions ---//
+	void decodeImages(); //What each worker thread runs. Decodes images until there are none left
+	void update(float deltaTime); //Called every frame on the main thread while loading. Uploads the decoded images, opens the fonts and checks if everything is done
+	void finish(); //Stop the workers and call the finished function
+
+	//--- Singleton Instance ---//
+	static AssetPreloader* inst; //The singleton instance. Ie: The only instance of this class that can ever exist
+};
+
+#define PRELOADER AssetPreloader::getInstance() //Macro to make using the preloader easier. Automatically gets the singleton instance
+
+#endif
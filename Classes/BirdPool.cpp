@@ -0,0 +1,325 @@
+#include "BirdPool.h"
+#include "DisplayHandler.h"
+#include "CollisionFilter.h"
+
+//--- Static Variables ---//
+BirdPool* BirdPool::inst = nullptr;
+
+//The size of each bird's image. Used to size the birds when the display is headless and there are no images to get the size from
+static const Size BIRD_IMAGE_SIZES[NumBirdTypes] = { Size(198.0f, 186.0f), Size(256.0f, 256.0f) };
+
+//The image for each bird type
+static const char* BIRD_IMAGE_PATHS[NumBirdTypes] = { "Demo/Birds/spr_BirdYellow.png", "Demo/Birds/spr_BirdRed.png" };
+
+
+
+//--- Constructor and Destructor ---//
+BirdPool::BirdPool()
+{
+	//Init the private data
+	maxFreeBirds = 512;
+
+	//Zero out all of the counters. The frames and radii are looked up the first time they are needed
+	for (unsigned int i = 0; i < NumBirdTypes; i++)
+	{
+		stats[i] = BirdPoolStats{ 0, 0, 0, 0, 0 };
+		frameIds[i] = INVALID_FRAME_ID;
+		radii[i] = -1.0f;
+	}
+	childFrameId = INVALID_FRAME_ID;
+}
+
+BirdPool::~BirdPool()
+{
+	//Let go of every bird the pool is still holding on to. Cocos2D deletes them once nothing else is using them
+	for (unsigned int i = 0; i < birds.size(); i++)
+	{
+		if (birds[i].node)
+			birds[i].node->release();
+	}
+
+	//Clean up the lists
+	birds.clear();
+	emptySlots.clear();
+	for (unsigned int i = 0; i < NumBirdTypes; i++)
+		freeBirds[i].clear();
+}
+
+
+
+//--- Setters ---//
+void BirdPool::setMaxFreeBirds(unsigned int _maxFreeBirds)
+{
+	//Set the max number of unused birds that are kept per type
+	maxFreeBirds = _maxFreeBirds;
+}
+
+
+
+//--- Getters ---//
+BirdPoolStats BirdPool::getStats(BirdType type) const
+{
+	//Copy the counters for the type and fill in how many are currently waiting in the pool
+	BirdPoolStats result = stats[type];
+	result.free = freeBirds[type].size();
+	return result;
+}
+
+AtlasFrameId BirdPool::getFrameId(BirdType type)
+{
+	//Look the frame up by name the first time only
+	if (frameIds[type] == INVALID_FRAME_ID)
+		frameIds[type] = SPRITE_ATLAS->getFrameId(BIRD_IMAGE_PATHS[type]);
+
+	return frameIds[type];
+}
+
+Texture2D* BirdPool::getTexture(BirdType type)
+{
+	//The atlas holds on to the frame (and so the texture) once it has been made. There are no textures without a GPU, so this is nullptr when the display is headless
+	return SPRITE_ATLAS->getTexture(getFrameId(type));
+}
+
+float BirdPool::getRadius(BirdType type)
+{
+	//Work the radius out the first time only. The collider is a circle half as wide as the image
+	//The frame's size is known as soon as the texture is loaded, or right away if it is in the atlas. Otherwise (ex: headless with no atlas), the size is filled in from the list
+	if (radii[type] < 0.0f)
+	{
+		getTexture(type);
+		Size imageSize = SPRITE_ATLAS->getSize(getFrameId(type));
+		if (imageSize.width <= 0.0f)
+			imageSize = BIRD_IMAGE_SIZES[type];
+		radii[type] = imageSize.width / 2.0f;
+	}
+
+	return radii[type];
+}
+
+
+
+//--- Methods ---//
+void BirdPool::prewarm(BirdType type, unsigned int count)
+{
+	//Build birds until there are enough of them waiting in the pool. Prewarming doesn't count as a hit or a miss
+	freeBirds[type].reserve(count);
+	while (freeBirds[type].size() < count)
+		freeBirds[type].push_back(createBird(type));
+}
+
+Node* BirdPool::acquire(BirdType type)
+{
+	//Grab a bird from the pool and hand it over
+	return birds[takeFreeBird(type)].node;
+}
+
+void BirdPool::acquireBatch(BirdType type, unsigned int count, std::vector<Node*>& birdsOut)
+{
+	//Make sure the frame and radius are ready before any birds are built, so they are only looked up once for the whole batch
+	getTexture(type);
+	getRadius(type);
+
+	//Make room for the whole batch at once so the lists don't grow one bird at a time
+	birdsOut.reserve(birdsOut.size() + count);
+	if (freeBirds[type].size() < count)
+		birds.reserve(birds.size() + (count - freeBirds[type].size()));
+
+	//Grab the birds
+	for (unsigned int i = 0; i < count; i++)
+		birdsOut.push_back(birds[takeFreeBird(type)].node);
+}
+
+void BirdPool::release(Node* bird)
+{
+	//Find the bird using the index stored in its tag. Ignore anything that isn't an active bird from this pool so releasing twice doesn't break anything
+	int index = bird->getTag();
+	if (index < 0 || index >= (int)birds.size() || birds[index].node != bird || !birds[index].active)
+		return;
+
+	//Take the bird out of the scene. Cleanup stops all of the actions on the bird and its children. The pool still has a reference so the bird is NOT deleted
+	PooledBird& pooledBird = birds[index];
+	pooledBird.node->removeFromParentAndCleanup(true);
+	pooledBird.active = false;
+	stats[pooledBird.type].inUse--;
+
+	//If the pool is already holding enough of this type, actually delete the bird instead of keeping it around
+	if (freeBirds[pooledBird.type].size() >= maxFreeBirds)
+	{
+		pooledBird.node->release();
+		pooledBird.node = nullptr;
+		emptySlots.push_back(index);
+		return;
+	}
+
+	//Put the bird back into its freshly-spawned state and make it available again
+	resetBird(pooledBird);
+	freeBirds[pooledBird.type].push_back(index);
+}
+
+void BirdPool::reclaimAll()
+{
+	//Release every bird that is still out in the scene
+	for (unsigned int i = 0; i < birds.size(); i++)
+	{
+		if (birds[i].node && birds[i].active)
+			release(birds[i].node);
+	}
+}
+
+void BirdPool::printStats() const
+{
+	//Output the counters for each type to the console
+	const char* typeNames[NumBirdTypes] = { "Yellow", "Red" };
+	for (unsigned int i = 0; i < NumBirdTypes; i++)
+	{
+		BirdPoolStats typeStats = getStats((BirdType)i);
+		std::cout << "Bird Pool [" << typeNames[i] << "] -> Hits: " << typeStats.hits << ", Misses: " << typeStats.misses
+			<< ", In Use: " << typeStats.inUse << ", High Water: " << typeStats.highWater << ", Free: " << typeStats.free << std::endl;
+	}
+}
+
+
+
+//--- Singleton Instance ---//
+BirdPool* BirdPool::getInstance()
+{
+	//Generate the singleton if it hasn't been created yet
+	if (!inst)
+		inst = new BirdPool();
+
+	//Return the singleton
+	return inst;
+}
+
+
+
+//--- Utility Functions ---//
+int BirdPool::takeFreeBird(BirdType type)
+{
+	//Grab a bird from the pool if there is one. Otherwise, we have no choice but to build a new one
+	int index;
+	if (!freeBirds[type].empty())
+	{
+		index = freeBirds[type].back();
+		freeBirds[type].pop_back();
+		stats[type].hits++;
+	}
+	else
+	{
+		index = createBird(type);
+		stats[type].misses++;
+	}
+
+	//Put the bird in the bird category with the current masks. The masks can change while a bird sits in the pool (ex: bird-vs-bird collisions turned off, or a scene adding contact handlers), so this is done every time it is handed out. See CollisionFilter.h
+	PhysicsBody* body = birds[index].node->getPhysicsBody();
+	if (body)
+		COLLISION_FILTER->apply(body, PhysicsCategory::Bird);
+
+	//Mark the bird as out in the scene and update the in-use counters
+	birds[index].active = true;
+	stats[type].inUse++;
+	if (stats[type].inUse > stats[type].highWater)
+		stats[type].highWater = stats[type].inUse;
+
+	return index;
+}
+
+int BirdPool::createBird(BirdType type)
+{
+	//Build the bird. This is the same setup that used to be done in DemoScene every time a bird was spawned
+	//The frame and collider radius are shared by every bird of the same type, so they come from the cached values instead of being looked up again
+	Node* bird = nullptr;
+	if (DISPLAY->isHeadless())
+	{
+		//With no GPU, we can't load any images. Build a plain node the same size as the bird image so the physics body matches
+		//The children are skipped since they are only there to be looked at
+		bird = Node::create();
+		bird->setContentSize(BIRD_IMAGE_SIZES[type]);
+	}
+	else
+	{
+		//Use the frame id directly so there is no search through the texture cache by file name
+		bird = SPRITE_ATLAS->createSprite(getFrameId(type));
+	}
+	bird->setScale(0.25f);
+	bird->setAnchorPoint(Vec2(0.5f, 0.5f));
+
+	//A circle collider the width of the image
+	PhysicsBody* body_Bird = PhysicsBody::createCircle(getRadius(type));
+	body_Bird->setDynamic(true);
+	bird->setPhysicsBody(body_Bird);
+
+	//The red bird has two children as well. They are only there to be looked at so headless birds don't get them
+	if (type == BirdType::Red && !DISPLAY->isHeadless())
+	{
+		//The blue child bird uses the same frame every time too. With the atlas loaded, it is even the same texture as its parent
+		if (childFrameId == INVALID_FRAME_ID)
+			childFrameId = SPRITE_ATLAS->getFrameId("Demo/Birds/spr_BirdBlue.png");
+
+		//The blue dot. The dot is only drawn once here instead of every time the bird is spawned
+		DrawNode* child_A = DrawNode::create();
+		child_A->drawDot(Vec2(0.0f, 0.0f), 64.0f, Color4F(0.0f, 0.0f, 1.0f, 0.5f));
+		child_A->setName(RED_BIRD_DOT_NAME);
+		bird->addChild(child_A);
+
+		//The small blue bird in the top right corner
+		Sprite* child_B = SPRITE_ATLAS->createSprite(childFrameId);
+		child_B->setPosition(Vec2(256.0f, 256.0f));
+		child_B->setName(RED_BIRD_CHILD_NAME);
+		bird->addChild(child_B);
+	}
+
+	//Hold on to the bird so it isn't deleted when it is taken out of the scene
+	bird->retain();
+
+	//Store the bird in an empty slot if there is one, otherwise add it to the end of the list
+	int index;
+	if (!emptySlots.empty())
+	{
+		index = emptySlots.back();
+		emptySlots.pop_back();
+	}
+	else
+	{
+		index = birds.size();
+		birds.push_back(PooledBird());
+	}
+
+	//Fill in the slot and remember the index in the tag so release() can find the bird quickly
+	birds[index].node = bird;
+	birds[index].type = type;
+	birds[index].active = false;
+	bird->setTag(index);
+
+	return index;
+}
+
+void BirdPool::resetBird(PooledBird& pooledBird)
+{
+	//Reset the transform of the bird itself
+	Node* bird = pooledBird.node;
+	bird->setRotation(0.0f);
+
+	//Stop the physics body from carrying over any motion from its last life, and wake it up if it was put to sleep (see PhysicsTuning.h)
+	PhysicsBody* body = bird->getPhysicsBody();
+	if (body)
+	{
+		body->setDynamic(true);
+		body->setVelocity(Vec2::ZERO);
+		body->setAngularVelocity(0.0f);
+		body->resetForces();
+	}
+
+	//Undo whatever the spawn actions did to the red bird's children. Headless birds don't have any children
+	if (pooledBird.type == BirdType::Red && bird->getChildrenCount() > 0)
+	{
+		Node* child_A = bird->getChildByName(RED_BIRD_DOT_NAME);
+		child_A->setRotation3D(Vec3::ZERO);
+		child_A->setOpacity(255);
+
+		Node* child_B = bird->getChildByName(RED_BIRD_CHILD_NAME);
+		child_B->setRotation3D(Vec3::ZERO);
+		child_B->setScale(1.0f);
+		child_B->setColor(Color3B::WHITE);
+	}
+}
@@ -0,0 +1,240 @@
+/*
+============================================================
+	Bird Pool:
+		- Keeps a pool of ready-to-use birds so spawning doesn't have to build a brand new sprite, physics body, draw node, etc every single click
+		- Birds are 'acquired' from the pool when they are spawned and 'released' back to the pool when they expire
+			> Released birds are removed from the scene but NOT deleted. They sit in the pool until the next spawn asks for one
+			> If the pool is empty, a new bird is built on the spot (this is counted as a 'miss')
+		- Call prewarm() at startup to build a bunch of birds ahead of time so the first few spawns don't have to build anything
+		- When the display is headless, the birds are plain Nodes with the same size and physics body but no image or children, so they can be simulated without a GPU
+		- The frame and collision radius of each type are looked up once and reused for every bird after that
+			> Sprite::create() with a file path has to search the texture cache by name every time. The pool skips that by holding on to the frame id from the sprite atlas (see SpriteAtlas.h)
+			> Every bird's image is in the same atlas texture, so the yellow, red and blue birds can all be drawn together
+
+	Usage:
+		- You are free to use this class for the case studies and for GDW
+		- You are free to edit / overwrite any or all of this class
+			> It is simply here to make your life easier
+
+	Note:
+		- This class uses the Singleton design pattern
+			> Do not ever make more than one instance of this class in its current form
+			> You don't ever have to call the constructor for this class. Simply start using it and it will build itself
+			> There is a macro "BIRD_POOL->" that provides a shortcut for getting the singleton instance
+		- The pool uses the tag of each bird node to find it again when it is released. Don't change the tag of a pooled bird!
+============================================================
+*/
+
+#ifndef BIRDPOOL_H
+#define BIRDPOOL_H
+
+//Core Libraries
+#include <vector>
+#include <iostream>
+
+//3rd Party Libraries
+#include "cocos2d.h"
+
+//Wrapper Classes
+#include "SpriteAtlas.h"
+
+//Namespaces
+using namespace cocos2d;
+
+/*
+	Bird Type Enum
+	- Used to pick which kind of bird bundle the pool should hand out
+
+	> Yellow
+		- A single yellow bird with a circle physics body. Spawned with the left mouse button
+	> Red
+		- A red bird with a circle physics body and two children (a blue draw node dot and a small blue bird). Spawned with the right mouse button
+*/
+enum BirdType
+{
+	Yellow,
+	Red,
+	NumBirdTypes
+};
+
+//Useful shorthands
+#define RED_BIRD_DOT_NAME "ChildDot" //The name of the red bird's blue dot child. Use with getChildByName() to find it
+#define RED_BIRD_CHILD_NAME "ChildBird" //The name of the red bird's small blue bird child. Use with getChildByName() to find it
+
+/*
+	Bird Pool Stats
+	- Counters reported by the pool for a single bird type
+
+	> Hits -> Number of times acquire() was able to hand out a bird that was already built
+	> Misses -> Number of times acquire() had to build a brand new bird because the pool was empty
+	> InUse -> Number of birds that are currently out in the scene
+	> HighWater -> The largest number of birds that have been in use at the same time
+	> Free -> Number of birds sitting in the pool waiting to be used
+*/
+struct BirdPoolStats
+{
+	unsigned int hits;
+	unsigned int misses;
+	unsigned int inUse;
+	unsigned int highWater;
+	unsigned int free;
+};
+
+
+
+/*
+	Bird Pool Class:
+	> Setters
+		- Set the max number of free birds kept per type
+	> Getters
+		- Get the stats for a bird type
+		- Get the frame, texture and collision radius for a bird type
+	> Methods
+		- Prewarm
+		- Acquire / release birds
+		- Acquire a whole batch of birds at once
+		- Reclaim every bird currently in use
+		- Print the stats
+*/
+class BirdPool
+{
+protected:
+	//--- Constructor ---//
+	BirdPool(); //The constructor is protected so only one instance of this class can ever exist. This is called the singleton pattern.
+
+public:
+	//--- Destructor ---//
+	~BirdPool();
+
+
+
+	//--- Setters ---//
+	/*
+		Set the largest number of unused birds the pool will hold on to for each type. Birds released past this number are deleted instead of being kept
+
+		@param MaxFreeBirds -> The max number of unused birds to keep per type. Defaulted to 512
+	*/
+	void setMaxFreeBirds(unsigned int maxFreeBirds);
+
+
+
+	//--- Getters ---//
+	/*
+		Get the hit / miss / high-water counters for one of the bird types
+
+		@param Type -> The type of bird to get the stats for. Ex: getStats(BirdType::Yellow)
+		@return Returns -> A BirdPoolStats struct filled with the counters for that type
+	*/
+	BirdPoolStats getStats(BirdType type) const;
+
+	/*
+		Get the sprite atlas frame used by a bird type
+
+		@param Type -> The type of bird
+		@return Returns -> The id of the frame in the sprite atlas. Valid even when the display is headless
+	*/
+	AtlasFrameId getFrameId(BirdType type);
+
+	/*
+		Get the texture used by a bird type. Every bird of the same type shares this texture, so it can be used to make a SpriteBatchNode for them
+		When the sprite atlas is loaded, every type shares the same texture
+
+		@param Type -> The type of bird
+		@return Returns -> The texture. nullptr if the display is headless since there are no textures without a GPU
+	*/
+	Texture2D* getTexture(BirdType type);
+
+	/*
+		Get the radius of the circle collider used by a bird type, before the bird is scaled
+
+		@param Type -> The type of bird
+		@return Returns -> The radius in pixels. Half the width of the bird's image
+	*/
+	float getRadius(BirdType type);
+
+
+
+	//--- Methods ---//
+	/*
+		Build a number of birds ahead of time and put them straight into the pool. Call this once the window has been created so the textures can load
+
+		@param Type -> The type of bird to build
+		@param Count -> How many birds of that type should be waiting in the pool when this returns
+	*/
+	void prewarm(BirdType type, unsigned int count);
+
+	/*
+		Get a bird out of the pool. The bird is reset and ready to go, all you have to do is position it and add it to the scene. If the pool is empty, a new bird is built
+
+		@param Type -> The type of bird you want
+		@return Returns -> The bird, with its physics body (and children for red birds) already attached. This is a Sprite unless the display is headless, in which case it is a plain Node with no image or children
+	*/
+	Node* acquire(BirdType type);
+
+	/*
+		Get a whole batch of birds out of the pool at once. Same as calling acquire() in a loop, but the texture and collider size are only looked up once for the whole batch and the list only grows once
+
+		@param Type -> The type of bird you want
+		@param Count -> How many birds you want
+		@param BirdsOut -> The list the birds are added to. The birds are added to the end, anything already in the list is left alone
+	*/
+	void acquireBatch(BirdType type, unsigned int count, std::vector<Node*>& birdsOut);
+
+	/*
+		Give a bird back to the pool. This removes it from the scene, stops its actions and puts it back in the pool so it can be used again
+
+		@param Bird -> The bird to release. This MUST be a bird that came from acquire()
+	*/
+	void release(Node* bird);
+
+	/*
+		Give every bird that is currently in use back to the pool. Call this before the scene the birds are in goes away (ex: when restarting)
+	*/
+	void reclaimAll();
+
+	/*
+		Print the stats for every bird type to the console
+	*/
+	void printStats() const;
+
+
+
+	//--- Singleton Instance ---//
+	/*
+		Get the instance of the singleton. You shouldn't ever need to call this directly since the macro (BIRD_POOL->) automatically calls it
+
+		@return Returns -> The singleton instance of this class. This is the ONLY instance of this class so intrefacing HAS to be done through this instance.
+	*/
+	static BirdPool* getInstance();
+
+private:
+	//--- Private Data ---//
+	//A single bird the pool has built. The index of a bird in the 'birds' list is stored as the tag of its node so it can be found again quickly
+	struct PooledBird
+	{
+		Node* node; //The bird itself. The pool holds a reference (retain) on it for as long as it is in the list
+		BirdType type; //What type of bird this is
+		bool active; //True while the bird is out in the scene, false while it is sitting in the pool
+	};
+
+	std::vector<PooledBird> birds; //Every bird the pool has built. Deleted birds leave an empty slot which gets reused by the next new bird
+	std::vector<int> freeBirds[NumBirdTypes]; //The indices of the birds that are ready to be handed out, for each type
+	std::vector<int> emptySlots; //The indices in 'birds' that don't have a bird in them anymore
+	BirdPoolStats stats[NumBirdTypes]; //The counters for each type
+	unsigned int maxFreeBirds; //The max number of unused birds to keep per type
+	AtlasFrameId frameIds[NumBirdTypes]; //The sprite atlas frame for each type. Looked up once so every bird can use it directly
+	AtlasFrameId childFrameId; //The sprite atlas frame for the red bird's small blue bird child
+	float radii[NumBirdTypes]; //The collider radius for each type. Less than 0 until it has been worked out
+
+	//--- Utility Functions ---//
+	int createBird(BirdType type); //Build a brand new bird, store it in the list and return its index
+	int takeFreeBird(BirdType type); //Get the index of a free bird, building a new one if there aren't any. Updates the counters
+	void resetBird(PooledBird& bird); //Put a bird back into its freshly-spawned state (velocity, rotation, children, etc)
+
+	//--- Singleton Instance ---//
+	static BirdPool* inst; //The singleton instance. Ie: The only instance of this class that can ever exist
+};
+
+#define BIRD_POOL BirdPool::getInstance() //Macro to make using the bird pool easier. Automatically gets the singleton instance
+
+#endif
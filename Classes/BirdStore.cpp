@@ -0,0 +1,321 @@
+#include "BirdStore.h"
+#include "Profiler.h"
+#include "JobSystem.h"
+
+//Core Libraries
+#include <algorithm>
+#include <cmath>
+
+//How much of the bird's speed is kept when it bounces off of the ground, and how much of its sideways speed and spin is kept every bounce
+static const float GROUND_BOUNCE = 0.4f;
+static const float GROUND_FRICTION = 0.8f;
+
+//Simple birds are drawn at the same size as the pooled ones
+static const float SIMPLE_BIRD_SCALE = 0.25f;
+
+//The renderer can only take 65536 vertices in one go, and a command can't be split between two goes. 16383 birds is the most that fit with 4 corners each
+static const unsigned int MAX_BIRDS_PER_COMMAND = 16383;
+
+//How many birds each thread moves at a time. Moving a bird is only a handful of adds, so it takes a few thousand of them to be worth handing to another thread
+static const unsigned int BIRDS_PER_JOB = 4096;
+
+
+
+//--- Constructors and Destructors ---//
+BirdStore::BirdStore()
+{
+	//Init the private data. The textures and sizes are looked up in init()
+	gravity = Vec2(0.0f, -98.1f);
+	groundHeight = 0.0f;
+	for (unsigned int i = 0; i < NumBirdTypes; i++)
+	{
+		halfSizes[i] = 0.0f;
+		textures[i] = nullptr;
+		programStates[i] = nullptr;
+		blendFuncs[i] = BlendFunc::ALPHA_PREMULTIPLIED;
+		texCoordsMin[i] = Tex2F{ 0.0f, 0.0f };
+		texCoordsMax[i] = Tex2F{ 1.0f, 1.0f };
+	}
+}
+
+BirdStore::~BirdStore()
+{
+	//Let go of the shaders and textures
+	for (unsigned int i = 0; i < NumBirdTypes; i++)
+	{
+		CC_SAFE_RELEASE_NULL(programStates[i]);
+		CC_SAFE_RELEASE_NULL(textures[i]);
+	}
+}
+
+
+
+//--- Engine Functions ---//
+bool BirdStore::init()
+{
+	if (!Node::init())
+		return false;
+
+	//Look everything up once. The pool has already worked out the textures and sizes for its own birds, so just use those
+	for (unsigned int i = 0; i < NumBirdTypes; i++)
+	{
+		halfSizes[i] = BIRD_POOL->getRadius((BirdType)i) * SIMPLE_BIRD_SCALE;
+
+		//There are no textures or shaders when the display is headless
+		textures[i] = BIRD_POOL->getTexture((BirdType)i);
+		if (!textures[i])
+			continue;
+		textures[i]->retain();
+
+		//The renderer moves the vertices into place itself when it batches the commands, so the shader doesn't need the model view matrix
+		programStates[i] = GLProgramState::getOrCreateWithGLProgramName(GLProgram::SHADER_NAME_POSITION_TEXTURE_COLOR_NO_MVP, textures[i]);
+		CC_SAFE_RETAIN(programStates[i]);
+		blendFuncs[i] = (textures[i]->hasPremultipliedAlpha()) ? BlendFunc::ALPHA_PREMULTIPLIED : BlendFunc::ALPHA_NON_PREMULTIPLIED;
+
+		//Every type is in the same sprite atlas texture, so they only use their own part of it. Same as a sprite made from the frame. See SpriteAtlas.h
+		Rect rect = SPRITE_ATLAS->getRect(BIRD_POOL->getFrameId((BirdType)i));
+		float textureWidth = (float)textures[i]->getPixelsWide();
+		float textureHeight = (float)textures[i]->getPixelsHigh();
+		texCoordsMin[i] = Tex2F{ rect.getMinX() / textureWidth, rect.getMinY() / textureHeight };
+		texCoordsMax[i] = Tex2F{ rect.getMaxX() / textureWidth, rect.getMaxY() / textureHeight };
+	}
+
+	//Build the indices for the biggest command. Every bird is two triangles: (top left, bottom left, top right) and (bottom right, top right, bottom left)
+	//This is the same order Cocos2D uses for sprites. Every command starts counting its corners from 0, so they can all share this one list
+	indices.resize(MAX_BIRDS_PER_COMMAND * 6);
+	for (unsigned int i = 0; i < MAX_BIRDS_PER_COMMAND; i++)
+	{
+		unsigned short corner = (unsigned short)(i * 4);
+		indices[i * 6 + 0] = corner + 0;
+		indices[i * 6 + 1] = corner + 1;
+		indices[i * 6 + 2] = corner + 2;
+		indices[i * 6 + 3] = corner + 3;
+		indices[i * 6 + 4] = corner + 2;
+		indices[i * 6 + 5] = corner + 1;
+	}
+
+	return true;
+}
+
+void BirdStore::draw(Renderer* renderer, const Mat4& transform, uint32_t flags)
+{
+	unsigned int count = getCount();
+
+	//Nothing can be drawn without the textures (ex: when the display is headless)
+	if (count == 0 || !programStates[BirdType::Yellow] || !programStates[BirdType::Red])
+		return;
+
+	PROFILE_SCOPE("BirdStore::draw");
+
+	//Count the birds of each type so every list is sized once, then write the four corners of every bird into the list for its type
+	unsigned int typeCounts[NumBirdTypes] = {};
+	for (unsigned int i = 0; i < count; i++)
+		typeCounts[types[i]]++;
+
+	V3F_C4B_T2F* writePositions[NumBirdTypes];
+	for (unsigned int type = 0; type < NumBirdTypes; type++)
+	{
+		vertices[type].resize(typeCounts[type] * 4);
+		writePositions[type] = vertices[type].data();
+	}
+
+	Color4B white(255, 255, 255, 255);
+	for (unsigned int i = 0; i < count; i++)
+	{
+		//Spin the corners of the square around the bird's center
+		float halfSize = halfSizes[types[i]];
+		float cosine = cosf(rotations[i]) * halfSize;
+		float sine = sinf(rotations[i]) * halfSize;
+		float x = positionsX[i];
+		float y = positionsY[i];
+
+		V3F_C4B_T2F* corners = writePositions[types[i]];
+		writePositions[types[i]] += 4;
+		corners[0].vertices = Vec3(x - cosine - sine, y - sine + cosine, 0.0f); //Top left
+		corners[1].vertices = Vec3(x - cosine + sine, y - sine - cosine, 0.0f); //Bottom left
+		corners[2].vertices = Vec3(x + cosine - sine, y + sine + cosine, 0.0f); //Top right
+		corners[3].vertices = Vec3(x + cosine + sine, y + sine - cosine, 0.0f); //Bottom right
+		const Tex2F& texMin = texCoordsMin[types[i]];
+		const Tex2F& texMax = texCoordsMax[types[i]];
+		corners[0].texCoords = Tex2F{ texMin.u, texMin.v };
+		corners[1].texCoords = Tex2F{ texMin.u, texMax.v };
+		corners[2].texCoords = Tex2F{ texMax.u, texMin.v };
+		corners[3].texCoords = Tex2F{ texMax.u, texMax.v };
+		corners[0].colors = white;
+		corners[1].colors = white;
+		corners[2].colors = white;
+		corners[3].colors = white;
+	}
+
+	//Hand every type to the renderer in as few commands as will fit. Commands with the same texture next to each other are drawn together, so with the sprite atlas loaded both types go in one draw call
+	unsigned int numCommands = 0;
+	for (unsigned int type = 0; type < NumBirdTypes; type++)
+		numCommands += (typeCounts[type] + MAX_BIRDS_PER_COMMAND - 1) / MAX_BIRDS_PER_COMMAND;
+	if (commands.size() < numCommands)
+		commands.resize(numCommands);
+
+	unsigned int nextCommand = 0;
+	for (unsigned int type = 0; type < NumBirdTypes; type++)
+	{
+		for (unsigned int first = 0; first < typeCounts[type]; first += MAX_BIRDS_PER_COMMAND)
+		{
+			unsigned int birdsInCommand = std::min(MAX_BIRDS_PER_COMMAND, typeCounts[type] - first);
+			TrianglesCommand::Triangles triangles;
+			triangles.verts = vertices[type].data() + first * 4;
+			triangles.indices = indices.data();
+			triangles.vertCount = (int)(birdsInCommand * 4);
+			triangles.indexCount = (int)(birdsInCommand * 6);
+
+			TrianglesCommand& command = commands[nextCommand++];
+			command.init(_globalZOrder, textures[type]->getName(), programStates[type], blendFuncs[type], triangles, transform, flags);
+			renderer->addCommand(&command);
+		}
+	}
+}
+
+
+
+//--- Setters ---//
+void BirdStore::setGravity(Vec2 newGravity)
+{
+	gravity = newGravity;
+}
+
+void BirdStore::setGroundHeight(float height)
+{
+	groundHeight = height;
+}
+
+
+
+//--- Getters ---//
+unsigned int BirdStore::getCount() const
+{
+	return (unsigned int)positionsX.size();
+}
+
+
+
+//--- Methods ---//
+void BirdStore::reserve(unsigned int count)
+{
+	positionsX.reserve(count);
+	positionsY.reserve(count);
+	velocitiesX.reserve(count);
+	velocitiesY.reserve(count);
+	rotations.reserve(count);
+	spins.reserve(count);
+	lifetimes.reserve(count);
+	types.reserve(count);
+}
+
+void BirdStore::spawn(BirdType type, Vec2 position, Vec2 velocity, float lifetime)
+{
+	//Start the bird spinning as if it was rolling along with its sideways speed
+	positionsX.push_back(position.x);
+	positionsY.push_back(position.y);
+	velocitiesX.push_back(velocity.x);
+	velocitiesY.push_back(velocity.y);
+	rotations.push_back(0.0f);
+	spins.push_back(-velocity.x / halfSizes[type]);
+	lifetimes.push_back(lifetime);
+	types.push_back((unsigned char)type);
+}
+
+void BirdStore::step(float deltaTime)
+{
+	unsigned int count = getCount();
+	if (count == 0)
+		return;
+
+	PROFILE_SCOPE("BirdStore::step");
+
+	//Grab the raw lists so the loops below are just pointer math. The compiler can't always tell that the vectors don't change size inside the loop
+	float* posX = positionsX.data();
+	float* posY = positionsY.data();
+	float* velX = velocitiesX.data();
+	float* velY = velocitiesY.data();
+	float* rotation = rotations.data();
+	float* spin = spins.data();
+	float* lifetime = lifetimes.data();
+	unsigned char* type = types.data();
+
+	//Work out where the center of each type of bird is when it is sitting on the ground
+	float floors[NumBirdTypes];
+	for (unsigned int i = 0; i < NumBirdTypes; i++)
+		floors[i] = groundHeight + halfSizes[i];
+
+	//Move every bird. Each line only touches one or two of the lists, so the CPU can stream straight through them
+	//Every bird is moved on its own, so the birds are split across the job system's threads (see JobSystem.h). With only a few thousand birds, it all happens on this thread
+	float gravityX = gravity.x * deltaTime;
+	float gravityY = gravity.y * deltaTime;
+	JOBS->parallelFor(count, BIRDS_PER_JOB, [=, &floors](unsigned int first, unsigned int last, unsigned int slot)
+	{
+		for (unsigned int i = first; i < last; i++)
+		{
+			velX[i] += gravityX;
+			velY[i] += gravityY;
+			posX[i] += velX[i] * deltaTime;
+			posY[i] += velY[i] * deltaTime;
+			rotation[i] += spin[i] * deltaTime;
+			lifetime[i] -= deltaTime;
+
+			//Bounce off of the ground, losing some speed each time
+			float floor = floors[type[i]];
+			if (posY[i] < floor && velY[i] < 0.0f)
+			{
+				posY[i] = floor;
+				velY[i] *= -GROUND_BOUNCE;
+				velX[i] *= GROUND_FRICTION;
+				spin[i] *= GROUND_FRICTION;
+			}
+		}
+	});
+
+	//Remove the expired birds by sliding the rest down over them. This keeps the birds in the same order, so they are drawn in the same order every frame
+	//This stays on one thread since where each bird ends up depends on how many birds before it were removed
+	unsigned int kept = 0;
+	for (unsigned int i = 0; i < count; i++)
+	{
+		if (lifetime[i] <= 0.0f)
+			continue;
+
+		if (kept != i)
+		{
+			posX[kept] = posX[i];
+			posY[kept] = posY[i];
+			velX[kept] = velX[i];
+			velY[kept] = velY[i];
+			rotation[kept] = rotation[i];
+			spin[kept] = spin[i];
+			lifetime[kept] = lifetime[i];
+			type[kept] = type[i];
+		}
+		kept++;
+	}
+
+	//Shrink the lists down to the birds that are left. Shrinking never frees the memory, so spawning more later doesn't have to allocate
+	if (kept != count)
+	{
+		positionsX.resize(kept);
+		positionsY.resize(kept);
+		velocitiesX.resize(kept);
+		velocitiesY.resize(kept);
+		rotations.resize(kept);
+		spins.resize(kept);
+		lifetimes.resize(kept);
+		types.resize(kept);
+	}
+}
+
+void BirdStore::clear()
+{
+	positionsX.clear();
+	positionsY.clear();
+	velocitiesX.clear();
+	velocitiesY.clear();
+	rotations.clear();
+	spins.clear();
+	lifetimes.clear();
+	types.clear();
+}
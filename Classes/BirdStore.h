@@ -0,0 +1,124 @@
+/*
+============================================================
+	Bird Store:
+		- Holds huge numbers of 'simple' birds without making a Node for each one
+			> A pooled bird (see BirdPool.h) is a whole Sprite with its own transform, action list, children and physics body. That is fine for a few thousand, but not for 50,000
+			> A simple bird is just a position, velocity, rotation, spin, lifetime and type. Each of those is kept in its own tightly packed list (called 'structure of arrays')
+			> Updating every bird is a straight loop over a few lists of floats, which the CPU (and the compiler) is very good at
+		- Simple birds fall with gravity and bounce off of the ground, but don't hit each other or anything in the physics world
+		- Each bird has a lifetime. Birds whose time is up are removed in one pass over the lists, instead of each bird running its own DelayTime + RemoveSelf actions
+		- With tens of thousands of birds, the movement is split across the job system's threads (see JobSystem.h). step() doesn't touch any nodes, so it can also be run as a job itself
+		- Every bird is drawn with one batched triangles command per type (more if there are more birds than fit in one command). Cocos2D merges these into as few draw calls as it can
+
+	Usage:
+		- Create it with BirdStore::create() and add it to the scene like any other node. Set the ground height with setGroundHeight()
+		- Call step() once a frame with the frame time. It is not scheduled on its own so the owner decides when it happens
+		- Add birds with spawn(). Call reserve() first when adding a lot at once
+
+	Note:
+		- The birds are drawn in the store's own space. Leave the store at the origin with no scale or rotation to have the positions line up with the rest of the scene
+		- When the display is headless, the birds are still simulated but nothing is drawn
+============================================================
+*/
+
+#ifndef BIRDSTORE_H
+#define BIRDSTORE_H
+
+//Core Libraries
+#include <vector>
+
+//3rd Party Libraries
+#include "cocos2d.h"
+
+//Wrapper Classes
+#include "BirdPool.h"
+
+//Namespaces
+using namespace cocos2d;
+
+/*
+	Bird Store Class:
+	> Setters
+		- Set the gravity and the height of the ground
+	> Getters
+		- Get the number of birds
+	> Methods
+		- Reserve room for birds
+		- Spawn a bird
+		- Step every bird forward and remove the expired ones
+		- Remove every bird
+*/
+class BirdStore : public Node
+{
+public:
+	//--- Constructors and Destructors ---//
+	BirdStore();
+	~BirdStore();
+
+	//--- Engine Functions ---//
+	virtual bool init(); //Look up the textures and sizes of each bird type
+	virtual void draw(Renderer* renderer, const Mat4& transform, uint32_t flags); //Build the vertices for every bird and hand them to the renderer
+	CREATE_FUNC(BirdStore);
+
+
+
+	//--- Setters ---//
+	void setGravity(Vec2 gravity); //Set the acceleration applied to every bird. Default is the same as the physics world, (0, -98.1)
+	void setGroundHeight(float height); //Set the height of the top of the ground. Birds bounce off of it. Default is 0
+
+
+
+	//--- Getters ---//
+	unsigned int getCount() const; //Get how many birds are in the store
+
+
+
+	//--- Methods ---//
+	void reserve(unsigned int count); //Make room for this many birds in total so the lists don't have to grow one spawn at a time
+
+	/*
+		Add a bird to the store
+
+		@param Type -> The kind of bird. Only changes how it looks and how big it is
+		@param Position -> Where the center of the bird starts
+		@param Velocity -> How fast the bird starts out moving, in pixels per second
+		@param Lifetime -> How many seconds until the bird is removed
+	*/
+	void spawn(BirdType type, Vec2 position, Vec2 velocity, float lifetime);
+
+	/*
+		Move every bird forward in time, then remove the ones whose lifetimes are up
+
+		@param DeltaTime -> How much time has passed, in seconds
+	*/
+	void step(float deltaTime);
+
+	void clear(); //Remove every bird. The lists keep their memory so they don't have to grow again
+
+private:
+	//--- Private Data ---//
+	//The birds. Every list has one entry per bird, and bird i is entry i in every list
+	std::vector<float> positionsX;
+	std::vector<float> positionsY;
+	std::vector<float> velocitiesX;
+	std::vector<float> velocitiesY;
+	std::vector<float> rotations; //Counter-clockwise, in radians
+	std::vector<float> spins; //How fast each bird is turning, in radians per second
+	std::vector<float> lifetimes; //Seconds left until the bird is removed
+	std::vector<unsigned char> types; //The BirdType of each bird. Kept as a byte so the list stays small
+
+	Vec2 gravity; //The acceleration applied to every bird
+	float groundHeight; //The height of the top of the ground
+	float halfSizes[NumBirdTypes]; //Half the width of each type of bird once it is scaled. The images are roughly square so this is used for the height as well
+	Texture2D* textures[NumBirdTypes]; //The texture for each type. nullptr if the display is headless
+
+	//--- Drawing ---//
+	GLProgramState* programStates[NumBirdTypes]; //The shader for each type, with its texture set. nullptr if the display is headless
+	BlendFunc blendFuncs[NumBirdTypes]; //How each type is blended, depending on if its texture has premultiplied alpha
+	Tex2F texCoordsMin[NumBirdTypes], texCoordsMax[NumBirdTypes]; //The corners of each type's image in its texture. Part of the sprite atlas when it is loaded, otherwise the whole texture
+	std::vector<V3F_C4B_T2F> vertices[NumBirdTypes]; //The corners of every bird, sorted by type. Rebuilt every time the store is drawn
+	std::vector<unsigned short> indices; //Two triangles for every bird. The same for every command so it is only built once
+	std::vector<TrianglesCommand> commands; //The commands handed to the renderer. Kept around since the renderer only holds on to pointers until the frame is drawn
+};
+
+#endif
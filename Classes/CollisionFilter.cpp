@@ -0,0 +1,110 @@
+#include "CollisionFilter.h"
+
+//--- Static Variables ---//
+CollisionFilter* CollisionFilter::inst = nullptr;
+
+
+
+//--- Constructor ---//
+CollisionFilter::CollisionFilter()
+{
+	//Start with Cocos2D's defaults
+	reset();
+}
+
+
+
+//--- Setters ---//
+void CollisionFilter::setCollides(PhysicsCategory categoryA, PhysicsCategory categoryB, bool collides)
+{
+	//Change both sides so the pair is the same no matter which body is looked at
+	if (collides)
+	{
+		collisionMasks[categoryA] |= PHYSICS_CATEGORY_BIT(categoryB);
+		collisionMasks[categoryB] |= PHYSICS_CATEGORY_BIT(categoryA);
+	}
+	else
+	{
+		collisionMasks[categoryA] &= ~PHYSICS_CATEGORY_BIT(categoryB);
+		collisionMasks[categoryB] &= ~PHYSICS_CATEGORY_BIT(categoryA);
+	}
+}
+
+void CollisionFilter::setContactTest(PhysicsCategory categoryA, PhysicsCategory categoryB, bool sendsContacts)
+{
+	//Cocos2D only sends an event when both bodies test against each other, so both sides have to be changed
+	if (sendsContacts)
+	{
+		contactTestMasks[categoryA] |= PHYSICS_CATEGORY_BIT(categoryB);
+		contactTestMasks[categoryB] |= PHYSICS_CATEGORY_BIT(categoryA);
+	}
+	else
+	{
+		contactTestMasks[categoryA] &= ~PHYSICS_CATEGORY_BIT(categoryB);
+		contactTestMasks[categoryB] &= ~PHYSICS_CATEGORY_BIT(categoryA);
+	}
+}
+
+
+
+//--- Getters ---//
+bool CollisionFilter::getCollides(PhysicsCategory categoryA, PhysicsCategory categoryB) const
+{
+	return (collisionMasks[categoryA] & PHYSICS_CATEGORY_BIT(categoryB)) != 0;
+}
+
+int CollisionFilter::getCollisionMask(PhysicsCategory category) const
+{
+	return collisionMasks[category];
+}
+
+int CollisionFilter::getContactTestMask(PhysicsCategory category) const
+{
+	return contactTestMasks[category];
+}
+
+PhysicsCategory CollisionFilter::getCategory(const PhysicsShape* shape)
+{
+	//Find the one bit that is set. Anything with no bits or more than one (like Cocos2D's default of every bit) doesn't have a category
+	int bitmask = shape->getCategoryBitmask();
+	for (int category = 0; category < NumPhysicsCategories; category++)
+	{
+		if (bitmask == PHYSICS_CATEGORY_BIT(category))
+			return (PhysicsCategory)category;
+	}
+
+	return NumPhysicsCategories;
+}
+
+
+
+//--- Methods ---//
+void CollisionFilter::apply(PhysicsBody* body, PhysicsCategory category) const
+{
+	body->setCategoryBitmask(PHYSICS_CATEGORY_BIT(category));
+	body->setCollisionBitmask(collisionMasks[category]);
+	body->setContactTestBitmask(contactTestMasks[category]);
+}
+
+void CollisionFilter::reset()
+{
+	//Everything collides with everything and nothing sends contact events. These are the same as Cocos2D's defaults
+	for (unsigned int i = 0; i < NumPhysicsCategories; i++)
+	{
+		collisionMasks[i] = (int)0xFFFFFFFF;
+		contactTestMasks[i] = 0;
+	}
+}
+
+
+
+//--- Singleton Instance ---//
+CollisionFilter* CollisionFilter::getInstance()
+{
+	//Generate the singleton if it hasn't been created yet
+	if (!inst)
+		inst = new CollisionFilter();
+
+	//Return the singleton
+	return inst;
+}
@@ -0,0 +1,142 @@
+/*
+============================================================
+	Collision Filter:
+		- Sorts every physics body into a category (ground, birds, pigs, etc) and decides which categories hit each other
+			> Each category is one bit. A body's 'collision mask' has the bits of every category it should bounce off of
+			> Two bodies only collide if BOTH of their masks have the other's bit, so turning off a pair on one side is enough
+		- Also decides which pairs of categories send contact events (the 'contact test mask'). Bodies that don't test against each other never send an event, which saves a lot of time when thousands of birds are touching
+			> The ContactDispatcher turns these on for you when a handler is added, so you don't normally have to touch them
+		- Bird-vs-bird collisions can be turned off for stress testing. The birds fall straight through each other and pile up on the ground, so the physics only has to deal with the ground contacts
+
+	Usage:
+		- Call apply() on a body with its category once it is built. The masks come from the table, so every body in a category behaves the same
+		- If the table is changed with setCollides(), bodies that already exist keep their old masks until apply() is called on them again
+
+	Note:
+		- This class uses the Singleton design pattern
+			> There is a macro "COLLISION_FILTER->" that provides a shortcut for getting the singleton instance
+		- Bodies that have never had apply() called on them keep Cocos2D's defaults. They are in every category and collide with everything
+============================================================
+*/
+
+#ifndef COLLISIONFILTER_H
+#define COLLISIONFILTER_H
+
+//3rd Party Libraries
+#include "cocos2d.h"
+
+//Namespaces
+using namespace cocos2d;
+
+/*
+	Physics Category Enum
+	- The kinds of physics bodies in the game. Each one gets its own bit in the bitmasks
+
+	> Ground -> The ground box along the bottom of the scene
+	> Bird -> Awake birds. Both the yellow and the red birds use this. The red bird's children don't have bodies, so they don't need a category
+	> SleepingBird -> Birds that have been put to sleep (see PhysicsTuning.h). They are moved to their own category so only they send contact events
+	> Pig -> Not spawned by the demo yet. Here so you can add them without changing every mask
+	> Debris -> Not spawned by the demo yet. Broken bits of blocks, etc
+*/
+enum PhysicsCategory
+{
+	Ground,
+	Bird,
+	SleepingBird,
+	Pig,
+	Debris,
+	NumPhysicsCategories
+};
+
+#define PHYSICS_CATEGORY_BIT(category) (1 << (category)) //Get the bitmask bit for a category
+
+
+
+/*
+	Collision Filter Class:
+	> Setters
+		- Set if two categories collide
+		- Set if two categories send contact events
+	> Getters
+		- Get the masks for a category
+		- Get the category of a physics shape
+	> Methods
+		- Apply a category to a body
+		- Reset the table
+*/
+class CollisionFilter
+{
+protected:
+	//--- Constructor ---//
+	CollisionFilter(); //The constructor is protected so only one instance of this class can ever exist. This is called the singleton pattern.
+
+public:
+	//--- Setters ---//
+	/*
+		Set if two categories bounce off of each other. Both directions are changed
+
+		@param CategoryA -> The first category
+		@param CategoryB -> The second category. Can be the same as the first. Ex: setCollides(Bird, Bird, false) turns off bird-vs-bird collisions
+		@param Collides -> True if they should collide. Everything collides by default
+	*/
+	void setCollides(PhysicsCategory categoryA, PhysicsCategory categoryB, bool collides);
+
+	/*
+		Set if two categories send contact events when they touch. Both directions are changed
+
+		@param CategoryA -> The first category
+		@param CategoryB -> The second category. Can be the same as the first
+		@param SendsContacts -> True if they should send contact events. Nothing does by default
+	*/
+	void setContactTest(PhysicsCategory categoryA, PhysicsCategory categoryB, bool sendsContacts);
+
+
+
+	//--- Getters ---//
+	bool getCollides(PhysicsCategory categoryA, PhysicsCategory categoryB) const; //Get if two categories bounce off of each other
+	int getCollisionMask(PhysicsCategory category) const; //Get the collision mask given to bodies in a category
+	int getContactTestMask(PhysicsCategory category) const; //Get the contact test mask given to bodies in a category
+
+	/*
+		Get the category of a physics shape from its category bitmask
+
+		@param Shape -> The shape to look at
+		@return Returns -> The category. NumPhysicsCategories if the shape doesn't have exactly one of our category bits (ex: apply() was never called on its body)
+	*/
+	static PhysicsCategory getCategory(const PhysicsShape* shape);
+
+
+
+	//--- Methods ---//
+	/*
+		Put a body in a category and give it that category's masks
+
+		@param Body -> The body. Every shape on the body is changed
+		@param Category -> The category to put it in
+	*/
+	void apply(PhysicsBody* body, PhysicsCategory category) const;
+
+	void reset(); //Put the table back to the defaults. Everything collides with everything and nothing sends contact events
+
+
+
+	//--- Singleton Instance ---//
+	/*
+		Get the instance of the singleton. You shouldn't ever need to call this directly since the macro (COLLISION_FILTER->) automatically calls it
+
+		@return Returns -> The singleton instance of this class. This is the ONLY instance of this class so intrefacing HAS to be done through this instance.
+	*/
+	static CollisionFilter* getInstance();
+
+private:
+	//--- Private Data ---//
+	int collisionMasks[NumPhysicsCategories]; //The collision mask for each category. Bits outside of our categories are always left on so bodies without a category still collide with everything
+	int contactTestMasks[NumPhysicsCategories]; //The contact test mask for each category
+
+	//--- Singleton Instance ---//
+	static CollisionFilter* inst; //The singleton instance. Ie: The only instance of this class that can ever exist
+};
+
+#define COLLISION_FILTER CollisionFilter::getInstance() //Macro to make using the collision filter easier. Automatically gets the singleton instance
+
+#endif
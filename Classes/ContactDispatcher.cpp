@@ -0,0 +1,102 @@
+#include "ContactDispatcher.h"
+
+//--- Constructors and Destructors ---//
+ContactDispatcher::ContactDispatcher()
+{
+	//Init the private data. The handler slots start out empty
+	listener = nullptr;
+	clear();
+}
+
+ContactDispatcher::~ContactDispatcher()
+{
+	//The listener belongs to the owner node and is removed along with it, so there is nothing to clean up
+	listener = nullptr;
+}
+
+
+
+//--- Setters ---//
+void ContactDispatcher::setHandler(PhysicsCategory categoryA, PhysicsCategory categoryB, const ContactBeginHandler& onBegin, const ContactSeparateHandler& onSeparate)
+{
+	//Fill in both directions of the table so the lookup works no matter which shape Cocos2D calls A
+	HandlerSlot& forward = slots[categoryA][categoryB];
+	forward.onBegin = onBegin;
+	forward.onSeparate = onSeparate;
+	forward.swapped = false;
+
+	if (categoryA != categoryB)
+	{
+		HandlerSlot& backward = slots[categoryB][categoryA];
+		backward.onBegin = onBegin;
+		backward.onSeparate = onSeparate;
+		backward.swapped = true;
+	}
+
+	//Make sure the pair actually sends contact events
+	COLLISION_FILTER->setContactTest(categoryA, categoryB, true);
+}
+
+
+
+//--- Methods ---//
+void ContactDispatcher::listen(Node* owner)
+{
+	//One listener for every contact in the scene
+	listener = EventListenerPhysicsContact::create();
+	listener->onContactBegin = CC_CALLBACK_1(ContactDispatcher::onContactBegin, this);
+	listener->onContactSeparate = CC_CALLBACK_1(ContactDispatcher::onContactSeparate, this);
+	owner->getEventDispatcher()->addEventListenerWithSceneGraphPriority(listener, owner);
+}
+
+void ContactDispatcher::clear()
+{
+	for (unsigned int a = 0; a < NumPhysicsCategories; a++)
+	{
+		for (unsigned int b = 0; b < NumPhysicsCategories; b++)
+		{
+			slots[a][b].onBegin = nullptr;
+			slots[a][b].onSeparate = nullptr;
+			slots[a][b].swapped = false;
+		}
+	}
+}
+
+
+
+//--- Utility Functions ---//
+const ContactDispatcher::HandlerSlot* ContactDispatcher::findSlot(PhysicsContact& contact) const
+{
+	PhysicsCategory categoryA = CollisionFilter::getCategory(contact.getShapeA());
+	PhysicsCategory categoryB = CollisionFilter::getCategory(contact.getShapeB());
+	if (categoryA == NumPhysicsCategories || categoryB == NumPhysicsCategories)
+		return nullptr;
+
+	return &slots[categoryA][categoryB];
+}
+
+bool ContactDispatcher::onContactBegin(PhysicsContact& contact)
+{
+	//Let the collision happen as normal if nobody is handling it
+	const HandlerSlot* slot = findSlot(contact);
+	if (!slot || !slot->onBegin)
+		return true;
+
+	PhysicsBody* bodyA = contact.getShapeA()->getBody();
+	PhysicsBody* bodyB = contact.getShapeB()->getBody();
+	return (slot->swapped) ? slot->onBegin(contact, bodyB, bodyA) : slot->onBegin(contact, bodyA, bodyB);
+}
+
+void ContactDispatcher::onContactSeparate(PhysicsContact& contact)
+{
+	const HandlerSlot* slot = findSlot(contact);
+	if (!slot || !slot->onSeparate)
+		return;
+
+	PhysicsBody* bodyA = contact.getShapeA()->getBody();
+	PhysicsBody* bodyB = contact.getShapeB()->getBody();
+	if (slot->swapped)
+		slot->onSeparate(contact, bodyB, bodyA);
+	else
+		slot->onSeparate(contact, bodyA, bodyB);
+}
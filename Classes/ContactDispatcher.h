@@ -0,0 +1,98 @@
+/*
+============================================================
+	Contact Dispatcher:
+		- Sends physics contact events to a handler picked by the categories of the two bodies (see CollisionFilter.h)
+			> The handlers are kept in a flat table with one slot for every pair of categories, so finding the handler is a single lookup
+			> There is only ever one contact listener. The usual Cocos2D way is one listener per node (or per pair of bodies), and every one of them gets told about every contact
+		- Adding a handler turns on the contact events for that pair in the collision filter. Pairs without a handler never send events in the first place
+
+	Usage:
+		- Add handlers with setHandler(), then call listen() once with the node that owns the dispatcher
+		- The bodies are handed to the handler in the same order as the categories it was added with. Ex: a (SleepingBird, Bird) handler always gets the sleeping bird first
+
+	Note:
+		- Bodies that are already built keep their old contact test masks. Add the handlers before building the bodies, or call COLLISION_FILTER->apply() on them again
+============================================================
+*/
+
+#ifndef CONTACTDISPATCHER_H
+#define CONTACTDISPATCHER_H
+
+//Core Libraries
+#include <functional>
+
+//3rd Party Libraries
+#include "cocos2d.h"
+
+//Wrapper Classes
+#include "CollisionFilter.h"
+
+//Namespaces
+using namespace cocos2d;
+
+//The handler types. The bodies are given in the order of the categories the handler was added with
+typedef std::function<bool(PhysicsContact& contact, PhysicsBody* bodyA, PhysicsBody* bodyB)> ContactBeginHandler; //Return false to stop the two bodies from colliding this time
+typedef std::function<void(PhysicsContact& contact, PhysicsBody* bodyA, PhysicsBody* bodyB)> ContactSeparateHandler;
+
+
+
+/*
+	Contact Dispatcher Class:
+	> Setters
+		- Set the handlers for a pair of categories
+	> Methods
+		- Start listening for contacts
+		- Remove every handler
+*/
+class ContactDispatcher
+{
+public:
+	//--- Constructors and Destructors ---//
+	ContactDispatcher();
+	~ContactDispatcher();
+
+
+
+	//--- Setters ---//
+	/*
+		Set the functions called when bodies of two categories start and stop touching. Replaces whatever was there before for that pair
+
+		@param CategoryA -> The category of the first body given to the handlers
+		@param CategoryB -> The category of the second body given to the handlers. Can be the same as the first
+		@param OnBegin -> Called when they start touching. Can be empty
+		@param OnSeparate (optional) -> Called when they stop touching. Can be empty
+	*/
+	void setHandler(PhysicsCategory categoryA, PhysicsCategory categoryB, const ContactBeginHandler& onBegin, const ContactSeparateHandler& onSeparate = ContactSeparateHandler());
+
+
+
+	//--- Methods ---//
+	/*
+		Add the contact listener to the event dispatcher. Only call this once
+
+		@param Owner -> The node the listener belongs to. The listener is removed when the node is cleaned up, so the handlers are never called after the owner is gone
+	*/
+	void listen(Node* owner);
+
+	void clear(); //Remove every handler. The contact events stay turned on in the collision filter
+
+private:
+	//--- Private Data ---//
+	//The handlers for one pair of categories
+	struct HandlerSlot
+	{
+		ContactBeginHandler onBegin;
+		ContactSeparateHandler onSeparate;
+		bool swapped; //True if the handler was added with the categories the other way around, so the bodies have to be swapped before calling it
+	};
+
+	HandlerSlot slots[NumPhysicsCategories][NumPhysicsCategories]; //The table of handlers. Indexed by the categories of shape A and shape B
+	EventListenerPhysicsContact* listener; //The one contact listener. nullptr until listen() is called
+
+	//--- Utility Functions ---//
+	const HandlerSlot* findSlot(PhysicsContact& contact) const; //Get the handlers for the two shapes in a contact. nullptr if either shape doesn't have a category
+	bool onContactBegin(PhysicsContact& contact); //Called by the listener. Passes the contact on to the right handler
+	void onContactSeparate(PhysicsContact& contact); //Called by the listener. Passes the contact on to the right handler
+};
+
+#endif
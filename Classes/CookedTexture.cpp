@@ -0,0 +1,85 @@
+#include "CookedTexture.h"
+#include "LZ4Block.h"
+#include "MappedFile.h"
+
+//Core Libraries
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+//--- Methods ---//
+std::string CookedTexture::getCookedPath(const std::string& imagePath)
+{
+	//Backslashes are turned into forward slashes, since every platform understands those. Ex: "Demo/Background\\spr_Background.jpg"
+	std::string cookedPath = imagePath;
+	std::replace(cookedPath.begin(), cookedPath.end(), '\\', '/');
+
+	//Only swap the extension if the dot is in the file name, not in a folder name
+	size_t dot = cookedPath.find_last_of('.');
+	size_t slash = cookedPath.find_last_of('/');
+	if (dot == std::string::npos || (slash != std::string::npos && dot < slash))
+		return cookedPath + COOKED_TEXTURE_EXTENSION;
+
+	return cookedPath.substr(0, dot) + COOKED_TEXTURE_EXTENSION;
+}
+
+Image* CookedTexture::load(const std::string& fullPath)
+{
+	//A missing file is normal (ex: the image was never cooked), so there is no error for that
+	MappedFile file;
+	if (fullPath.empty() || !file.open(fullPath) || file.getSize() < sizeof(CookedTextureHeader))
+		return nullptr;
+
+	//Map the whole thing. The biggest texture is only a few MB
+	const unsigned char* bytes = file.mapAll();
+	if (!bytes)
+		return nullptr;
+
+	CookedTextureHeader header;
+	memcpy(&header, bytes, sizeof(header));
+	//An uncompressed payload is read straight out of the mapped file, so its size has to match what is actually stored. Otherwise a broken header could read past the end of the file
+	if (memcmp(header.magic, COOKED_TEXTURE_MAGIC, 4) != 0 || header.version != COOKED_TEXTURE_VERSION || sizeof(header) + (uint64_t)header.storedSize > file.getSize()
+		|| (!(header.flags & COOKED_TEXTURE_FLAG_LZ4) && header.payloadSize != header.storedSize))
+	{
+		std::cout << "ERROR: '" << fullPath << "' is not a cooked texture, or was cooked by a different version of the cooker" << std::endl;
+		return nullptr;
+	}
+
+	//Decompress the payload if it needs it. Otherwise it is used right out of the mapped file
+	const unsigned char* payload = bytes + sizeof(header);
+	std::vector<unsigned char> decompressed;
+	if (header.flags & COOKED_TEXTURE_FLAG_LZ4)
+	{
+		decompressed.resize(header.payloadSize);
+		if (!LZ4Block::decompress(payload, header.storedSize, decompressed.data(), decompressed.size()))
+		{
+			std::cout << "ERROR: The pixels in '" << fullPath << "' are broken" << std::endl;
+			return nullptr;
+		}
+		payload = decompressed.data();
+	}
+
+	//The payload is a PVR, so Cocos2D's image loader picks up the mips and the premultiplied alpha itself
+	//It copies the pixels out, so the file can be unmapped as soon as this returns
+	//The image isn't autoreleased since the autorelease pool only belongs to the main thread
+	Image* image = new (std::nothrow) Image();
+	if (!image || !image->initWithImageData(payload, (ssize_t)header.payloadSize) || image->getWidth() != (int)header.width || image->getHeight() != (int)header.height)
+	{
+		std::cout << "ERROR: Could not load the cooked texture '" << fullPath << "'" << std::endl;
+		CC_SAFE_RELEASE(image);
+		return nullptr;
+	}
+
+	return image;
+}
+
+void CookedTexture::applyTexParameters(Texture2D* texture)
+{
+	//Without this, the GPU only ever uses the full size image and the mips are never touched
+	if (!texture || !texture->hasMipmaps())
+		return;
+
+	Texture2D::TexParams params = { GL_LINEAR_MIPMAP_LINEAR, GL_LINEAR, GL_CLAMP_TO_EDGE, GL_CLAMP_TO_EDGE };
+	texture->setTexParameters(params);
+}
@@ -0,0 +1,100 @@
+/*
+============================================================
+	Cooked Texture:
+		- Loads textures that were 'cooked' ahead of time by the TextureCooker tool (see proj.texcook/main.cpp) instead of decoding a PNG or JPG
+			> Decoding a PNG or JPG is most of the time it takes to load an image. The full screen background is the slowest of all
+			> A cooked texture is already in the exact layout the GPU wants: raw RGBA pixels with the alpha multiplied in. Loading it is just reading the file
+		- A cooked texture can come with a 'mip chain': smaller copies of the image, each half the size of the last. The GPU uses them when the image is drawn small, so it doesn't shimmer
+		- The pixels can be stored as they are, or compressed with LZ4 (see LZ4Block.h)
+			> Uncompressed files are memory mapped (see MappedFile.h) and handed over without being read into a buffer first
+			> Compressed files are smaller on disk and take a quick decompress. Neither needs any decoding
+		- If there is no cooked version of an image (or it is broken or out of date), the original image is loaded instead
+
+	File Format:
+		- All values are little-endian. Every platform this project targets is little-endian so the structs are read directly
+		- One CookedTextureHeader, then the payload
+		- The payload is a PVR (version 3) image with RGBA8888 pixels and the premultiplied alpha flag set (or RGB888 if the image has no alpha), followed by the mip chain if there is one
+			> Cocos2D already knows how to load PVRs with mips and premultiplied alpha, so its Image class does the work of handing them to the GPU
+
+	Usage:
+		- Use getCookedPath() to get where the cooked version of an image would be, then load() it. AssetPreloader does this for every image it is given
+		- Upload the image with the texture cache as normal, then call applyTexParameters() so the mips get used
+
+	Note:
+		- Everything here is safe to call from worker threads, except applyTexParameters() which needs OpenGL
+============================================================
+*/
+
+#ifndef COOKEDTEXTURE_H
+#define COOKEDTEXTURE_H
+
+//Core Libraries
+#include <string>
+#include <stdint.h>
+
+//3rd Party Libraries
+#include "cocos2d.h"
+
+//Namespaces
+using namespace cocos2d;
+
+//File format constants
+#define COOKED_TEXTURE_MAGIC "CDTX" //The first 4 bytes of every cooked texture. Stands for Cocos Demo Texture
+#define COOKED_TEXTURE_VERSION 1 //Bump this whenever the layout of the header or the payload changes
+#define COOKED_TEXTURE_EXTENSION ".ctex" //The extension cooked textures are saved with. They sit next to where the original image is, with the same name
+#define COOKED_TEXTURE_FLAG_LZ4 0x1 //The payload is compressed with LZ4
+
+/*
+	Cooked Texture Header
+	- The first 32 bytes of a cooked texture
+
+	> Magic -> Always COOKED_TEXTURE_MAGIC. Used to make sure the file is actually a cooked texture
+	> Version -> The version of the format the file was written with
+	> Flags -> COOKED_TEXTURE_FLAG_LZ4 if the payload is compressed
+	> Width, Height -> The size of the texture in pixels
+	> MipCount -> How many images are in the payload, counting the full size one. 1 if there is no mip chain
+	> StoredSize -> How many bytes of payload come after the header
+	> PayloadSize -> How many bytes the payload is once it is decompressed. The same as the stored size if it isn't compressed
+*/
+struct CookedTextureHeader
+{
+	char magic[4];
+	uint16_t version;
+	uint16_t flags;
+	uint32_t width;
+	uint32_t height;
+	uint32_t mipCount;
+	uint32_t storedSize;
+	uint32_t payloadSize;
+	uint32_t reserved;
+};
+
+static_assert(sizeof(CookedTextureHeader) == 32, "The cooked texture header must be exactly 32 bytes!");
+
+
+
+/*
+	Cooked Texture Class:
+	> Methods
+		- Get the path of the cooked version of an image
+		- Load a cooked texture
+		- Set a texture up to use its mips
+*/
+class CookedTexture
+{
+public:
+	//--- Methods ---//
+	static std::string getCookedPath(const std::string& imagePath); //Get where the cooked version of an image would be. The same path with the extension swapped. Ex: "Demo/Background/spr_Background.ctex"
+
+	/*
+		Load a cooked texture. This only reads the file (and decompresses it if it is compressed). Nothing is decoded
+
+		@param FullPath -> The full path of the cooked texture on disk
+		@return Returns -> The image, with a reference count of 1 (not autoreleased, so it can be made on a worker thread). Release it once it is uploaded. nullptr if the file is missing or broken
+	*/
+	static Image* load(const std::string& fullPath);
+
+	static void applyTexParameters(Texture2D* texture); //Use the texture's mips when it is drawn smaller than it is, if it has them. Call on the main thread after uploading
+};
+
+#endif
@@ -1,8 +1,23 @@
 #include "DemoScene.h"
 #include "DisplayHandler.h"
 #include "InputHandler.h"
-#include "AudioEngine.h"
-using experimental::AudioEngine;
+#include "BirdPool.h"
+#include "Profiler.h"
+#include "VoiceManager.h"
+#include "SoundCache.h"
+#include "SpriteAtlas.h"
+#include "GlyphCache.h"
+#include "FramePacer.h"
+#include "JobSystem.h"
+
+//Core Libraries
+#include <algorithm>
+#include <iomanip>
+#include <sstream>
+
+//The sound played when birds are spawned, and how loud. It is played under full volume so a burst of spawns in one frame has room to come out louder
+static const char* SPAWN_SOUND_PATH = "Demo/Sounds/sound_SpawnObject.mp3";
+static const float SPAWN_SOUND_VOLUME = 0.6f;
 
 //Init the static physics world pointer. Set it to be a nullptr which means it points to nothing
 PhysicsWorld* DemoScene::physicsWorld = nullptr;
@@ -35,6 +50,15 @@ Scene* DemoScene::createScene()
 
 
 
+	//Stop the physics world from stepping itself
+	//By default, Cocos2D steps the physics while it is drawing the scene, by however long the frame took. We step it ourselves at the end of update() instead
+	//The stepper always steps by the same amount of time so the physics doesn't change with the frame rate, and so we can time exactly how long it takes
+	//*** What happens if you remove this line? Hint: Everything will move twice as fast! ***//
+	physicsWorld->setAutoStep(false);
+	layer->physicsStepper.setPhysicsWorld(physicsWorld);
+
+
+
 	//Return the newly built scene
 	//This is then passed to the director with director->runWithScene() or director->replaceScene() etc. In this case, director->runWithScene() is called in AppDelagate.cpp
 	return scene;
@@ -58,6 +82,13 @@ bool DemoScene::init()
 
 
 
+	//Load the sounds. In the game, these have already been loaded by the preloader in AppDelegate.cpp, so this finds them already loaded and returns right away
+	//A headless display (the benchmarks) never plays a sound and the preloader skips them, so don't start the audio engine for nothing
+	if (!DISPLAY->isHeadless())
+		initSounds();
+
+
+
 	//VERY IMPORTANT LINE!
 	//Allow for the update() function to be called by Cocos2D
 	//Without this line, update() would NEVER be called. 
@@ -73,11 +104,44 @@ bool DemoScene::init()
 
 void DemoScene::update(float deltaTime)
 {
+	//Time the whole update so it shows up in the profiler overlay (press P). This disappears completely in release builds
+	PROFILE_SCOPE("DemoScene::update");
+
+
+
+	//If the physics is being stepped on its own thread, last frame's step might still be running. Nothing here waits for it
+	//Anything below that adds, removes or changes a body goes through physicsStepper.runWhenIdle(). It is saved until the step is done (at the latest when the next step is started further down), so the rest of the frame carries on alongside the worker
+	//With threading off, runWhenIdle() just runs it straight away
+
+	//Give back every bird whose lifetime ran out this frame, all in one go
+	//The timer wheel only looks at the timers that are due, so this costs next to nothing on frames where no birds expire
+	lifetimeTimers.advance(deltaTime);
+	releaseExpiredBirds();
+
+
+
+	//Apply all of the input that came in since the last frame
+	//The mouse and keyboard events are queued up as they happen and only applied here, so everything below sees the same input for the whole frame
+	//This is the partner of clearForNextFrame() at the bottom of this function
+	INPUTS->processQueuedEvents();
+
+
+
+	//Match the quality the frame pacer asked for. It watches how long the frames are taking and lowers the quality one step at a time when they go over budget. See FramePacer.h
+	//Nothing changes until the pacer changes its level, so this is just a compare on almost every frame
+	//*** Try pressing F to switch the target to 120 fps, then hold S with the profiler open (press P). Watch the quality drop in the overlay and the console! ***//
+	if (PACER->getQualityLevel() != appliedQuality)
+		applyQuality(PACER->getQualityLevel());
+
+
+
 	//Update the mouse particles so they actually follow the mouse
 	//If we didn't call this every frame in update(), they would stay where the mouse was on the very first frame of the game
 	//We are using the input handler class to get the mouse position as a Vec2 and simply using that directly
 	//INPUTS is a macro for InputHandler::getInstance() as InputHandler uses the same design pattern as the Director. This pattern is called the singleton pattern
-	mouseParticles->setPosition(INPUTS->getMousePosition());
+	//There are no particles when the display is headless
+	if (mouseParticles)
+		mouseParticles->setPosition(INPUTS->getMousePosition());
 
 
 
@@ -87,7 +151,8 @@ void DemoScene::update(float deltaTime)
 		//With the left mouse button, we are going to spawn a single bird.
 		//This bird has a physics body attached to it so it will fall and collide according to physics
 		//*** What happens if you change this to getMouseButton() instead of getMouseButtonPress()? Try it to find out! ***//
-		spawnSoloObject();
+		//The pool changes the bird's body, so it waits for the physics step if one is running. The mouse position is the same all frame, so it still spawns where the mouse was
+		physicsStepper.runWhenIdle([this]() { spawnSoloObject(); });
 	}
 	else if (INPUTS->getMouseButtonPress(MouseButton::BUTTON_RIGHT))
 	{
@@ -95,7 +160,37 @@ void DemoScene::update(float deltaTime)
 		//The 'parent' is a red bird with a physics body, just like with the left mouse button.
 		//The 'children' are a blue circle and another smaller blue bird. These children are 'attached' to the parent and so they will move along with it
 		//The children can still move independently of the parent but will be dragged along behind it whenever the parent is moving
-		spawnParentAndChildren();
+		physicsStepper.runWhenIdle([this]() { spawnParentAndChildren(); });
+	}
+
+
+
+	//Spawn lots of birds at once
+	//These use the batch spawn functions, which get all of the birds from the pool in one go instead of one at a time
+	//*** Try changing the number of birds in the burst. How many can you spawn before the game starts to slow down? ***//
+	if (INPUTS->getKeyPress(KeyCode::KEY_B))
+	{
+		//Pressing B spawns a ring of yellow birds around the mouse
+		//The frame pacer can throttle the held-down spawns when the frames are going over budget. spawnScale is 1 unless it has
+		spawnBirdBurst(BirdType::Yellow, std::max(1u, (unsigned int)(16 * spawnScale)), INPUTS->getMousePosition(), 60.0f);
+	}
+
+	//Holding S sprays out simple birds from the mouse, 500 a frame
+	//Simple birds don't have a node or a physics body. They only bounce off of the ground, but they are so cheap that you can have 50,000 of them. See BirdStore.h
+	//*** Try holding S with the profiler open (press P). Compare the "Simple birds" line to Physics::step with the same number of normal birds! ***//
+	if (INPUTS->getKey(KeyCode::KEY_S))
+		spawnSimpleBirds(BirdType::Yellow, (unsigned int)(500 * spawnScale), INPUTS->getMousePosition(), 250.0f);
+
+	if (INPUTS->getMouseButtonPress(MouseButton::BUTTON_MIDDLE))
+	{
+		//Start the trail wherever the mouse is when the middle button is first pressed
+		lastTrailPoint = INPUTS->getMousePosition();
+	}
+	else if (INPUTS->getMouseButton(MouseButton::BUTTON_MIDDLE))
+	{
+		//While the middle button is held, drag out a trail of yellow birds behind the mouse. A bird is placed every 30 pixels the mouse moves
+		//*** What happens if you make the spacing smaller? Try 5 instead of 30! ***//
+		spawnBirdsAlongPath(BirdType::Yellow, lastTrailPoint, INPUTS->getMousePosition(), 30.0f / spawnScale);
 	}
 
 
@@ -107,18 +202,50 @@ void DemoScene::update(float deltaTime)
 		//This is where it is useful that we got the reference to the physics world in the create scene function
 		//IMPORTANT NOTE: You might remember gravity is defined as -9.81 m/s/s from physics. Cocos2D's physics engines work on a 10x scale. You can use -9.81 but your forces will have to be dialed down to compensate
 		//*** What happens if you use 9.81 instead of 98.1? Try moving the decimal over to find out! ***//
-		physicsWorld->setGravity(Vec2(0.0f, 98.1f));
+		//The physics world's gravity and the bodies can't be changed in the middle of a threaded step, so that part waits for it. The simple birds aren't in the physics world, so theirs is changed right away
+		physicsStepper.runWhenIdle([this]()
+		{
+			physicsWorld->setGravity(Vec2(0.0f, 98.1f));
+			wakeAllBirds(); //Sleeping birds don't feel gravity, so they have to be woken up or they would stay stuck to the ground
+		});
+		birdStore->setGravity(Vec2(0.0f, 98.1f));
 	}
 	else if (INPUTS->getKeyRelease(KeyCode::KEY_G))
 	{
 		//When the user releases the G key, we are resetting gravity to the proper value.
 		//This is where it is useful that we got the reference to the physics world in the create scene function
 		//IMPORTANT NOTE: You might remember gravity is defined as -9.81 m/s/s from physics. Cocos2D's physics engines work on a 10x scale. You can use -9.81 but your forces will have to be dialed down to compensate
-		physicsWorld->setGravity(Vec2(0.0f, -98.1f));
+		physicsStepper.runWhenIdle([this]()
+		{
+			physicsWorld->setGravity(Vec2(0.0f, -98.1f));
+			wakeAllBirds();
+		});
+		birdStore->setGravity(Vec2(0.0f, -98.1f));
 	}
 
 
 
+	//Turn the bird trails on and off with the E key. Only the birds spawned after that are changed
+	if (INPUTS->getKeyPress(KeyCode::KEY_E))
+		setBirdTrails(!getBirdTrails());
+
+
+
+	//Turn bird-vs-bird collisions on and off with the C key
+	//With them off, the birds fall straight through each other and the only contacts left are with the ground. Try it with thousands of birds in the scene and watch the physics time in the profiler overlay!
+	if (INPUTS->getKeyPress(KeyCode::KEY_C))
+		setBirdCollisions(!getBirdCollisions());
+
+
+
+	//Move the physics step onto its own thread with the T key
+	//The step then runs while the frame is being drawn instead of before it. Watch the physics time in the profiler overlay drop with a big pile of birds!
+	//The physics debug drawing (space bar) is off while it is, since it would read the bodies while the worker is stepping them
+	if (INPUTS->getKeyPress(KeyCode::KEY_T))
+		setThreadedPhysics(!getThreadedPhysics());
+
+
+
 	//Swtich to the next debug drawing mode if the space bar is pressed. getKeyReleased() is used instead of _Pressed() so it happens when the user lets the button go
 	if (INPUTS->getKeyRelease(KeyCode::KEY_SPACE))
 	{
@@ -135,6 +262,100 @@ void DemoScene::update(float deltaTime)
 
 
 
+	//Switch the frame rate target with the F key (30 -> 60 -> 120 -> Uncapped), and turn the adaptive quality on and off with the Q key
+	//With the adaptive quality off, the quality goes back to full and stays there no matter how slow the frames get
+	if (INPUTS->getKeyPress(KeyCode::KEY_F))
+		PACER->nextTarget();
+	if (INPUTS->getKeyPress(KeyCode::KEY_Q))
+		PACER->setAdaptiveQuality(!PACER->getAdaptiveQuality());
+
+
+
+	//Show or hide the profiler overlay with the P key, or save the profile with F9 (CSV) and F10 (Chrome trace)
+	//The profiler shows how long each part of the frame is taking. Try spawning a ton of birds with it open!
+	//The files are saved to the writable path for the game, which is printed to the console
+	//*** Try adding PROFILE_SCOPE("Your Name") to the top of one of your own functions. It will show up in the overlay automatically! ***//
+	if (INPUTS->getKeyPress(KeyCode::KEY_P) && profilerOverlay)
+		profilerOverlay->setVisible(!profilerOverlay->isVisible());
+	if (INPUTS->getKeyPress(KeyCode::KEY_F9))
+		PROFILER->exportCSV(FileUtils::getInstance()->getWritablePath() + "profile.csv");
+	if (INPUTS->getKeyPress(KeyCode::KEY_F10))
+		PROFILER->exportChromeTrace(FileUtils::getInstance()->getWritablePath() + "profile_trace.json");
+
+	//Refresh the overlay a few times a second. Updating a label's text rebuilds it, so doing it every frame would show up in the profile itself
+	if (profilerOverlay && profilerOverlay->isVisible())
+	{
+		overlayRefreshTimer -= deltaTime;
+		if (overlayRefreshTimer <= 0.0f)
+		{
+			//The simple birds are moved on a job, and the profiler only records the main thread, so their time gets a line of its own
+			std::ostringstream simpleBirdsText;
+			simpleBirdsText << "Simple birds: " << birdStore->getCount() << " | Step: " << std::fixed << std::setprecision(2) << lastSimpleBirdsStepTime << " ms";
+
+			profilerOverlay->setString(PROFILER->getOverlayText() + VOICES->getStatsText() + "\n" + SOUNDS->getStatsText() + "\n" + PACER->getStatsText() + "\n" + JOBS->getStatsText() + "\n" + simpleBirdsText.str());
+			overlayRefreshTimer = 0.25f;
+		}
+	}
+
+
+
+	//Start the sounds that were asked for this frame. Every spawn sound from this frame is merged into one play, and old voices are cut off if there are too many
+	VOICES->update(deltaTime);
+
+
+
+	//Move the simple birds and remove the ones whose lifetimes are up. This is one pass over a few lists of numbers, no matter how many birds there are
+	//It is handed to the job system (see JobSystem.h) so it runs on another thread while the particles and the physics are updated below. The simple birds aren't in the physics world, so they never touch the same thing
+	//The job times itself, since BirdStore::step only shows up in the profiler when it happens to run on the main thread. The time is only read after the job is waited on below
+	JobHandle simpleBirdsJob = JOBS->run([this, deltaTime]()
+	{
+		uint64_t stepStart = Profiler::now();
+		birdStore->step(deltaTime);
+		lastSimpleBirdsStepTime = (float)((Profiler::now() - stepStart) / 1000000.0);
+	});
+
+
+
+	//Move every trail to its bird, then update every particle in the scene at once
+	//The particles from all of the emitters are cut into chunks and spread out over the job system's threads. Each thread builds the quads for its chunks and they are merged together at the end. See ParticleUpdater.h
+	//The step itself stays on the main thread since it lets go of the trails that have died out, and deleting a node anywhere else isn't safe. Only the chunks are handed out
+	//*** Try spawning a bunch of birds with trails and open the profiler (press P). Then try particleUpdater->setThreadCount(1) in initScene() and compare ParticleUpdater::step! ***//
+	for (unsigned int i = 0; i < birdTrails.size(); i++)
+		birdTrails[i].emitter->setPosition(birdTrails[i].bird->getPosition());
+	particleUpdater->step(deltaTime);
+
+
+
+	//Step the physics world
+	//We told the physics world not to step itself in createScene() so we could do it here and time it
+	//The stepper only steps in fixed chunks of time (1/60th of a second by default). Depending on how long the frame was, this might be 0, 1 or a few steps
+	//This happens before the restart check below so the restart always starts the next frame with a clean physics world
+	//*** Try physicsStepper.setStepRate(20.0f) in initScene(). The physics gets choppy but the birds still move smoothly. That is the interpolation at work! ***//
+	//The tuning settings (iterations, broadphase, etc) are handed to the physics world right before the step. See PhysicsTuning.h
+	//Afterwards, any sleeping birds that got hit are woken up and any birds that have settled are put to sleep. This is timed as part of the step since it is part of what the physics costs
+	//When the physics is threaded, advance() waits for last frame's step (usually long done by now), runs the spawns and releases that were saved up with runWhenIdle() and hands the next step to the worker without waiting for it. Sleeping is turned off then since the bodies can't be touched until the step is done
+	{
+		PROFILE_SCOPE("Physics::step");
+		uint64_t physicsStart = Profiler::now();
+		if (physicsTuningDirty && physicsTuning.applyTo(groundBody))
+			physicsTuningDirty = false;
+		unsigned int stepsTaken = physicsStepper.advance(deltaTime);
+		if (stepsTaken > 0 && !physicsStepper.isThreaded())
+			updateSleepingBirds(physicsStepper.getFixedDeltaTime() * (float)stepsTaken);
+		lastPhysicsStepTime = (float)((Profiler::now() - physicsStart) / 1000000.0);
+	}
+
+
+
+	//Wait for the simple birds to finish moving. If the job hasn't been picked up yet, the main thread just runs it itself
+	//Everything after this (the restart and the drawing) can use them again
+	{
+		PROFILE_SCOPE("DemoScene::waitForJobs");
+		JOBS->wait(simpleBirdsJob);
+	}
+
+
+
 	//Reload the scene if the R key is hit by the user
 	if (INPUTS->getKeyRelease(KeyCode::KEY_R))
 	{
@@ -151,6 +372,13 @@ void DemoScene::update(float deltaTime)
 	INPUTS->clearForNextFrame();
 }
 
+void DemoScene::onExit()
+{
+	//The worker thread can't still be stepping the bodies while Cocos2D cleans up the nodes they belong to
+	physicsStepper.waitForStep();
+	Scene::onExit();
+}
+
 
 
 //--- Init Functions ---//
@@ -160,6 +388,25 @@ void DemoScene::initScene()
 	//0 means none. We don't set it to anything by default and so this matches what Cocos2D is rendering as well
 	debugDrawType = 0;
 
+	//Init how long spawned birds stay in the scene before going back to the pool
+	birdLifetime = 5.0f;
+
+	//Init the profiling values. The overlay is only made if the display isn't headless
+	profilerOverlay = nullptr;
+	overlayRefreshTimer = 0.0f;
+	lastPhysicsStepTime = 0.0f;
+	lastSimpleBirdsStepTime = 0.0f;
+
+	//Init the physics tuning. The defaults are what Chipmunk already uses, so there is nothing to hand to the physics world yet
+	physicsTuning = PhysicsTuning::getDefault();
+	physicsTuningDirty = false;
+
+	//Init the frame pacing values. Everything starts at full quality, and the first update() catches up to whatever the frame pacer's level already is
+	appliedQuality = QualityLevel::Full;
+	fullSubsteps = physicsStepper.getSubsteps();
+	fullMaxSteps = physicsStepper.getMaxStepsPerFrame();
+	spawnScale = 1.0f;
+
 
 
 	//Create the background sprite
@@ -170,7 +417,12 @@ void DemoScene::initScene()
 	//Cocos2D automatically tracks which images you are using so it won't load in the same image twice. This is great since it prevents a lot of unnecessary memory from being used
 	//*** What happens if you change the anchor point? Try setting the anchor point to different positions. Try (0,0), (1, 1) and any others you want. Watch what happens to the background ***//
 	//*** What happens if you use a different image? Try using a bird image then try another background image! ***//
-	Sprite* spr_Background = Sprite::create("Demo/Background\\spr_Background.jpg"); //Load the handle from the image file
+	//If the display is headless, there is no GPU to load the image with. Use an empty node instead so the ground collider still has something to be attached to
+	Node* spr_Background;
+	if (DISPLAY->isHeadless())
+		spr_Background = Node::create(); //Create an empty node
+	else
+		spr_Background = Sprite::create("Demo/Background\\spr_Background.jpg"); //Load the handle from the image file
 	spr_Background->setPosition(DISPLAY->getWindowSizeAsVec2() / 2.0f); //Center the image in the window. We can get the window size of the display handler singleton and simply divide it by 2 to center the sprite
 	spr_Background->setAnchorPoint(Vec2(0.5f, 0.5f)); //Ensure the middle of the background is the anchor point. The anchor point is the point of the sprite you are positioning. (0.5, 0.5) is the center
 
@@ -184,26 +436,86 @@ void DemoScene::initScene()
 	//*** What happens if we remove the line "spr_Background->setPhysicsBody(body_Ground);"? Try it to find out! ***//
 	//*** What happens if we change the -100 to +100 in the this->addChild() line. Try it to find out! Hint: Spawn some birds! ***//
 	//*** What happens if you remove the 'this->addChild()' entirely? Try it to find out! Hint: This line will prove to be very important! ***//
-	PhysicsBody* body_Ground = PhysicsBody::createBox(Size(director->getWinSizeInPixels().width, 15.0f)); //Create a box collider for the ground
+	PhysicsBody* body_Ground = PhysicsBody::createBox(Size(DISPLAY->getWindowSize().width, 15.0f)); //Create a box collider for the ground
 	body_Ground->setDynamic(false); //We don't want the box collider to move around, we just want other stuff to hit it
 	body_Ground->setPositionOffset(Vec2(0.0f, -215.0f)); //Move the collider to where the grass portion of the background sprite is
+	COLLISION_FILTER->apply(body_Ground, PhysicsCategory::Ground); //Put it in the ground category so it can be filtered. See CollisionFilter.h
 	spr_Background->setPhysicsBody(body_Ground); //Attach the physics body to the background sprite
 	this->addChild(spr_Background, -100); //Add the sprite, pushed way to the back. The second parameter is the draw order. -ve is back, +ve is front
+	groundBody = body_Ground; //Keep hold of the ground body so the physics tuning can find the physics world through it
+
+
+
+	//Listen for contacts so sleeping birds can be woken up when something hits them
+	//Every contact goes through the one dispatcher, which looks the handler up by the categories of the two bodies. Only the pairs given a handler here send contact events at all
+	//Sleeping birds are the only birds that send events, so this doesn't cost anything until birds start sleeping. See PhysicsTuning.h
+	//*** Try adding a handler for (Bird, Ground) that prints something. Then try spawning a few thousand birds and watch the frame rate! ***//
+	ContactBeginHandler wakeOnHit = CC_CALLBACK_3(DemoScene::onSleepingBirdHit, this);
+	ContactSeparateHandler wakeOnSeparate = CC_CALLBACK_3(DemoScene::onSleepingBirdSeparate, this);
+	contactDispatcher.setHandler(PhysicsCategory::SleepingBird, PhysicsCategory::Bird, wakeOnHit, wakeOnSeparate);
+	contactDispatcher.setHandler(PhysicsCategory::SleepingBird, PhysicsCategory::Pig, wakeOnHit, wakeOnSeparate);
+	contactDispatcher.setHandler(PhysicsCategory::SleepingBird, PhysicsCategory::Debris, wakeOnHit, wakeOnSeparate);
+	contactDispatcher.listen(this);
+
+
+
+	//Create the layers the birds are added to
+	//Every yellow bird uses the exact same image, so they all go into a SpriteBatchNode. A SpriteBatchNode draws all of its children in a single draw call, no matter how many there are
+	//With the sprite atlas loaded (see SpriteAtlas.h), the texture is the whole atlas and each bird just shows its own part of it
+	//The red birds have a draw node attached to them, which can't go into a SpriteBatchNode, so they just get a normal node to keep them all together
+	//If the display is headless, there are no textures to batch with so both layers are just normal nodes
+	//*** What happens to the frame rate with thousands of birds if you use a normal node for the yellow birds too? Try it to find out! ***//
+	if (DISPLAY->isHeadless())
+		birdLayers[BirdType::Yellow] = Node::create();
+	else
+		birdLayers[BirdType::Yellow] = SpriteBatchNode::createWithTexture(BIRD_POOL->getTexture(BirdType::Yellow), 256);
+	birdLayers[BirdType::Red] = Node::create();
+	this->addChild(birdLayers[BirdType::Yellow], 0);
+	this->addChild(birdLayers[BirdType::Red], 0);
+
+	//The birds are drawn between their last two physics steps so they move smoothly even when the frame rate doesn't line up with the physics
+	physicsStepper.addInterpolatedLayer(birdLayers[BirdType::Yellow]);
+	physicsStepper.addInterpolatedLayer(birdLayers[BirdType::Red]);
+
+	//Create the store for the simple birds, drawn on top of the normal ones
+	//The top of the ground collider is where the simple birds bounce, since they aren't in the physics world
+	birdStore = BirdStore::create();
+	birdStore->setGroundHeight(DISPLAY->getWindowSize().height / 2.0f - 215.0f + 7.5f);
+	this->addChild(birdStore, 1);
+
+	//Create the updater that runs every particle emitter in the scene. It sits at the origin of the scene, so the particles are drawn right where they were spawned
+	//It is made even when the display is headless so the trails are still simulated. They just aren't drawn
+	particleUpdater = ParticleUpdater::create();
+	this->addChild(particleUpdater, 0);
+	birdTrailsEnabled = true;
+
+
+
+	//Everything after this point is only there to be looked at (particles, text and the menu)
+	//If the display is headless, nothing is being drawn so we skip all of it. The physics and the birds still work exactly the same
+	if (DISPLAY->isHeadless())
+	{
+		mouseParticles = nullptr;
+		return;
+	}
 
 
 
 	//Create the particle system that follows the mouse
-	//Cocos2D has a bunch of different types of particle systems. You can use a data member of type ParticleSystem and set it to any of them
-	//In order to use our own custom image for the particles, we have to add it manually to the texture cache. We are adding a snowflake image here
-	//*** What happens if you change the parameter for the createWithTotalParticles() function. It is set to 100. Try 1000 and 10. What is an appropriate number? ***//
-	//*** What other particle systems does Cocos2D have? How do they look? Try changing the 'ParticleMeteor' to the other particle types. Hint: Look at the docs below and look for the 'Examples' heading ***//
+	//Cocos2D has a bunch of different types of particle systems. This one is our own version of Cocos2D's ParticleMeteor that can handle a lot more particles. See ParticleEmitter.h
+	//Cocos2D's ParticleMeteor gets slow well before 1000 particles, since every particle is a big struct that is updated one at a time
+	//In order to use our own custom image for the particles, we have to give it a texture. We are using the snowflake image from the sprite atlas here, so the particles share a texture with the birds
+	//*** What happens if you change the parameter for the createMeteor() function. It is set to 5000. Try 100000 and 10. What is an appropriate number? ***//
+	//*** Try swapping in ParticleMeteor::createWithTotalParticles() (and changing mouseParticles back to a ParticleSystem) to compare the two with the profiler open! ***//
 	//*** Docs: http://www.cocos2d-x.org/wiki/Particles ***//
-	mouseParticles = ParticleMeteor::createWithTotalParticles(100);
+	mouseParticles = ParticleEmitter::createMeteor(5000);
 	mouseParticles->setEndColorVar(Color4F(0.75f, 0.75f, 0.75f, 0.75f));
 	mouseParticles->setPosition(INPUTS->getMousePosition());
-	mouseParticles->setTexture(director->getTextureCache()->addImage("Demo/Particles/spr_SnowParticle.png"));
+	particleFrame = SPRITE_ATLAS->getFrameId("Demo/Particles/spr_SnowParticle.png");
+	mouseParticles->setDisplayFrame(SPRITE_ATLAS->getFrame(particleFrame));
 	mouseParticles->setLife(0.5f);
-	this->addChild(mouseParticles);
+	mouseParticleSettings = mouseParticles->getSettings(); //Remember the full settings so the frame pacer can cap the particles and then put them back
+	particleUpdater->addEmitter(mouseParticles); //The updater updates and draws it now, so it isn't added to the scene itself
 
 
 
@@ -216,7 +528,9 @@ void DemoScene::initScene()
 	//*** Try adding your own font or get one from the website below! Or, just switch the label to the other font that comes with Cocos2D! Hint: check the fonts sub-folder in the Resources folder! ***//
 	//*** Try removing the enableShadow() line! What happens? Now, try to see what other effects you can use! ***//
 	//*** TTF Download Site: http://all-free-download.com/font/ ***//
-	Label* textLabel = Label::createWithTTF("Cocos2D!", "Fonts/arial.ttf", 100.0f);
+	//The labels are made through the glyph cache (see GlyphCache.h) so their letters come from the cache baked at build time. It is the same as Label::createWithTTF() otherwise
+	//*** If you add your own font, add it to DEMO_FONTS in CMakeLists.txt and load() it in AppDelegate so it gets a cache too ***//
+	Label* textLabel = GLYPHS->createLabel("Cocos2D!", "Fonts/arial.ttf", 100.0f);
 	textLabel->setAnchorPoint(Vec2(0.0f, 1.0f));
 	textLabel->setPosition(0.0f, DISPLAY->getWindowSize().height);
 	textLabel->enableShadow();
@@ -224,6 +538,17 @@ void DemoScene::initScene()
 
 
 
+	//Create the profiler overlay in the bottom left
+	//It starts hidden. Press P to show it. The text is filled in by update()
+	profilerOverlay = GLYPHS->createLabel("", "Fonts/arial.ttf", 12.0f);
+	profilerOverlay->setAnchorPoint(Vec2(0.0f, 0.0f));
+	profilerOverlay->setPosition(4.0f, 4.0f);
+	profilerOverlay->enableShadow();
+	profilerOverlay->setVisible(false);
+	this->addChild(profilerOverlay, 101);
+
+
+
 	//Create the restart button
 	//The restart button is positioned in the top right of the view and can be pressed to clear everything by reloading the scene
 	initRestartButton();
@@ -233,7 +558,7 @@ void DemoScene::initRestartButton()
 {
 	//Create the label for the restart menu button. This is the text for the button. It is created like the other label we made but we don't have to do any special positioning
 	//We also don't need need to add it to the scene because we will be adding the parent menu object to the scene instead
-	Label* restartButtonLabel = Label::createWithTTF("Clear Everything!", "Fonts/arial.ttf", 20.0f);
+	Label* restartButtonLabel = GLYPHS->createLabel("Clear Everything!", "Fonts/arial.ttf", 20.0f);
 	restartButtonLabel->enableShadow();
 
 
@@ -275,7 +600,14 @@ void DemoScene::initSounds()
 	//Preload the sound effect so we can use it later without having to load it
 	//*** What happens if you remove this line? Try it and then spawn an object. Hint: there will only be an issue the first time you spawn a bird. It also might be hard to tell!!! ***//
 	//*** Try adding another sound effect yourself. Get a '.mp3' file off a safe website and add it here. Try adding a background theme too! ***//
-	AudioEngine::preload("Demo/Sounds/sound_SpawnObject.mp3");
+	//The sound cache hands back an id for the path. Everything after this uses the id, so the path is never looked up again while playing
+	spawnSound = SOUNDS->getId(SPAWN_SOUND_PATH);
+	SOUNDS->load(spawnSound);
+
+	//Only let 4 copies of the spawn sound play at once. Past that, the oldest one is cut off to make room for the new one
+	//*** Try setting this to 1, then to 32, and hold down B. Can you hear the difference? Look at the voice counts in the profiler overlay (press P) too! ***//
+	VOICES->setMaxVoices(spawnSound, 4);
+	VOICES->setStealMode(VoiceSteal::Oldest);
 }
 
 
@@ -288,51 +620,43 @@ void DemoScene::spawnSoloObject()
 	//IMPORTANT NOTE: The mouse position is updated by Cocos2D through the input handler's event management system. This means there may be a slight delay as Cocos2D has to call the functions separately
 	Vec2 mousePos = INPUTS->getMousePosition();
 
+	//Time the spawn for the profiler
+	PROFILE_SCOPE("DemoScene::spawnSoloObject");
 
 
-	//Create a new sprite
-	//This follows a very similar format to the background sprite creation
-	//We load the handle and set the anchor point just like before
-	//We are setting the scale to 0.25 which is 1/4 the normal size. By default, Cocos2D translates the image size directly into the game. The bird is 256x256 which is most of our screen! So we are just scaling it down to fit better
-	//We are setting the position to be the mouse position we just got from the input handler.
-	Sprite* newSprite = Sprite::create("Demo/Birds/spr_BirdYellow.png"); //Load the handle
-	newSprite->setPosition(mousePos); //Place the new bird at the mouse position
-	newSprite->setScale(0.25f); //Scale the bird since it loads in quite large 
-	newSprite->setAnchorPoint(Vec2(0.5f, 0.5f)); //Ensure the middle of the bird is the anchor point
-
 
-
-	//Create the physics body and add the bird to the scene
-	//We are using getContentSize() which returns the size of the object in pixels. Since it is scaled by 0.25x, it will be 1/4 the size of the image
-	//Unlike the background, we are setting this physics body to be dynamic. This means it will interact with gravity as we expect.
-	PhysicsBody* body_Bird = PhysicsBody::createCircle(newSprite->getContentSize().width / 2.0f);
-	body_Bird->setDynamic(true);
-	newSprite->setPhysicsBody(body_Bird); //Connect the physics body and the sprite
-	this->addChild(newSprite, 0); //Add the bird to the scene in the middle rendering layer
+	//Get a yellow bird from the bird pool
+	//The pool hands us a sprite that already has its image loaded, its scale and anchor point set, and its physics body attached
+	//Building a brand new sprite and physics body every click is slow when thousands of birds are being spawned, so the pool keeps old birds around and gives them back to us instead
+	//All we have to do is place the bird at the mouse position and add it to the scene
+	//See BirdPool::createBird() for how the bird is actually built. It is exactly how it used to be built here
+	Node* newSprite = BIRD_POOL->acquire(BirdType::Yellow); //Get the bird from the pool
+	newSprite->setPosition(mousePos); //Place the new bird at the mouse position
+	birdLayers[BirdType::Yellow]->addChild(newSprite); //Add the bird to the yellow bird layer, which is in the middle rendering layer of the scene
 
 
 
-	//Run a sequence of actions on the new bird we just added
-	//A sequence is group of actions
-	//An action is a pre-defined Cocos2D data type that has some form of effect, usually over a certain time
-	//You can use a bunch of sub-class actions. You have to use the create function for them. You could define them as variables ahead of time or simply create them in the parameter list for the sequence like below
-	//DelayTime() is an action that simply waits a given number of seconds
-	//RemoveSelf() simply deletes the node that is running the action 
-	//This sequence of actions means that the node will do nothing special for 5s and then delete itself. This prevents us from continually spawning new sprites and running out of memory
-	//IMPORTANT NOTE: As with menu creation, you NEED a NULL at the end of the action list. Without it, Cocos2D will crash
-	//*** Try changing the order of the actions. What happens? ***//
-	//*** Try changing one of the actions to be something different. Take a look at the docs linked below to find some of the other types ***//
-	//*** Try adding another action to the list. Play around with different options and see what you can do! ***//
+	//Give the bird back to the pool after 5s (or whatever the bird lifetime is set to). This prevents us from continually spawning new sprites and running out of memory
+	//This used to be a sequence of actions: Sequence::create(DelayTime::create(5.0f), RemoveSelf::create(), NULL)
+	//That works, but every bird's DelayTime gets ticked every single frame just to count down. With thousands of birds, that adds up
+	//Instead, the bird's lifetime goes on a timer wheel, which only looks at the timers that are actually due. See TimerWheel.h
+	//Actions are still great for effects that change over time. See spawnParentAndChildren() for some
 	//*** Docs: http://www.cocos2d-x.org/wiki/Actions ***//
-	newSprite->runAction(Sequence::create(DelayTime::create(5.0f), RemoveSelf::create(), NULL));
+	scheduleBirdExpiry(newSprite);
+
+	//Give the bird a particle trail that follows it around until it goes back to the pool
+	attachTrail(newSprite);
 	
 
 
 	//Play the sound now that the object has been spawned
-	//Since we use the same file path as we did when we pre-loaded the sound in initSounds(), it should immediately play the one already loaded
+	//Since we use the same sound id we got when we pre-loaded the sound in initSounds(), it should immediately play the one already loaded
+	//The sound goes through the voice manager instead of straight to AudioEngine. It only starts a few copies of the sound at once and merges the plays from the same frame. See VoiceManager.h
 	//*** Try playing your own unique sound here instead of the one we put in ***//
 	//*** Try making it so a sound plays when the user presses a button. Hint: Place the check in a function that is called every frame ***//
-	AudioEngine::play2d("Demo/Sounds/sound_SpawnObject.mp3");
+	//No sounds are played when the display is headless since nobody is there to hear them
+	if (!DISPLAY->isHeadless())
+		VOICES->play(spawnSound, SPAWN_SOUND_VOLUME);
 }
 
 void DemoScene::spawnParentAndChildren()
@@ -343,76 +667,39 @@ void DemoScene::spawnParentAndChildren()
 	//IMPORTANT NOTE: The mouse position is updated by Cocos2D through the input handler's event management system. This means there may be a slight delay as Cocos2D has to call the functions separately
 	Vec2 mousePos = INPUTS->getMousePosition();
 
+	//Time the spawn for the profiler
+	PROFILE_SCOPE("DemoScene::spawnParentAndChildren");
 
 
-	//Create the 'parent' sprite
-	//This follows a very similar format to the background sprite creation
-	//We load the handle and set the anchor point just like before
-	//We are setting the scale to 0.25 which is 1/4 the normal size. By default, Cocos2D translates the image size directly into the game. The bird is 256x256 which is most of our screen! So we are just scaling it down to fit better
-	//We are setting the position to be the mouse position we just got from the input handler.
-	Sprite* parentSprite = Sprite::create("Demo/Birds/spr_BirdRed.png"); //Load the handle
-	parentSprite->setPosition(mousePos); //Place the new bird at the mouse position
-	parentSprite->setScale(0.25f); //Scale the bird since it loads in quite large 
-	parentSprite->setAnchorPoint(Vec2(0.5f, 0.5f)); //Ensure the middle of the bird is the anchor point
-
-
-	//Create a physics body and add it to the parent bird
-	//We are using getContentSize() which returns the size of the object in pixels. Since it is scaled by 0.25x, it will be 1/4 the size of the image
-	//Unlike the background, we are setting this physics body to be dynamic. This means it will interact with gravity as we expect.
-	PhysicsBody* body_Parent = PhysicsBody::createCircle(parentSprite->getContentSize().width / 2.0f);
-	body_Parent->setDynamic(true);
-	parentSprite->setPhysicsBody(body_Parent); //Connect the physics body and the sprite
-
 
-
-	//Create a child draw node
-	//Child:
-	//		> This will become a child of the parent sprite we just created. This means that it will be 'attached' to the parent sprite
+	//Get the 'parent' red bird from the bird pool
+	//The pool hands us the whole bundle: the red bird with its physics body, plus its two children
+	//Child A:
+	//		> A draw node with a blue dot drawn on it. It is a child of the red bird so it is 'attached' to it
 	//		> If the parent sprite moves, this will move with it. Think of a character wearing a hat. Whenever the character moves, the hat stays on their head
-	//		> We can still move this child separately but in this case, we don't
-	//Draw node:
-	//		> Similar to a sprite but draws its own image instead of using a sprite
-	//		> Can be used to draw circles, rectangles, triangles, etc
-	//		> Looks a bit like the debug draw shapes
-	//		> Useful for drawing basic shapes like lines. Ex: Can be used to draw a line behind a bullet to create a trail
-	//*** What happens if you change 'parentSprite->addChild()' to 'this->addChild()'? Why is this? ***//
-	//*** Try drawing a different shape, instead of a dot. Try drawing a rectangle for instance ***//
-	DrawNode* child_A = DrawNode::create();
-	child_A->drawDot(Vec2(0.0f, 0.0f), 64.0f, Color4F(0.0f, 0.0f, 1.0f, 0.5f));
-	parentSprite->addChild(child_A);
-
-
-
-	//Create the second child as a sprite
-	//Creating it like normal, just using an image from the resources folder
-	//Note the position change
-	//		> This puts the child on the top right of the parent bird
-	//				> When positioning a child, the position becomes relative to the parent instead
-	//						> (0,0) is now defined as the bottom left corner of the parent, as opposed to the bottom left of the window
-	//				> The parent bird's image size is 256x256. We want it to be positioned in the top right corner so we offset it by the size of the image
-	//						> You might remember that the bird is scaled by 0.25. So, shouldn't this mean that we actually only want to offset by 64? 
-	//						> Not quite. The parent's scale actually affects the children as well. Scaling the parent will scale everything underneath it.
-	//*** Try adding a positional offset to the other child object. What happens and why? ***//
-	//*** What happens if you scale this child object now? Does the parent get affected? ***//
-	//*** What happens if you make this a child of the child draw node instead? Does it look different? Why or why not? ***//
-	Sprite* child_B = Sprite::create("Demo/Birds/spr_BirdBlue.png");
-	child_B->setPosition(Vec2(256.0f, 256.0f));
-	parentSprite->addChild(child_B);
+	//Child B:
+	//		> A small blue bird sprite positioned in the top right corner of the parent
+	//		> When positioning a child, the position becomes relative to the parent instead. (0,0) is now defined as the bottom left corner of the parent, as opposed to the bottom left of the window
+	//		> The parent's scale actually affects the children as well. Scaling the parent will scale everything underneath it.
+	//See BirdPool::createBird() for how the bundle is actually built. It is exactly how it used to be built here
+	//*** Try drawing a different shape, instead of a dot. Try drawing a rectangle for instance. Hint: Look in BirdPool::createBird() ***//
+	Node* parentSprite = BIRD_POOL->acquire(BirdType::Red); //Get the bird bundle from the pool
+	parentSprite->setPosition(mousePos); //Place the new bird at the mouse position
+	Node* child_A = parentSprite->getChildByName(RED_BIRD_DOT_NAME); //The blue dot draw node. Will be nullptr if the display is headless
+	Node* child_B = parentSprite->getChildByName(RED_BIRD_CHILD_NAME); //The small blue bird. Will be nullptr if the display is headless
 	
 
 
-	//Add the parent to the scene and thus the children as well
+	//Add the parent to the red bird layer of the scene and thus the children as well
 	//The children are added automatically since their parent has been added
-	this->addChild(parentSprite, 0); 
+	birdLayers[BirdType::Red]->addChild(parentSprite); 
 
 
 
-	//Run an action on the parent sprite
-	//This is the exact same sequence we run on the object we created in spawnSoloObject() above
-	//It simply waits 5s and then deletes itself
-	//Helps prevent overloading the memory
-	//IMPORTANT NOTE: Again, all lists in Cocos2D like this require a NULL at the end, otherwise it will crash
-	parentSprite->runAction(Sequence::create(DelayTime::create(5.0f), RemoveSelf::create(), NULL));
+	//Give the parent back to the pool once the bird lifetime (5s by default) is up, exactly like the bird in spawnSoloObject() above
+	//Its children go back to the pool along with it
+	scheduleBirdExpiry(parentSprite);
+	attachTrail(parentSprite);
 
 
 
@@ -425,7 +712,8 @@ void DemoScene::spawnParentAndChildren()
 	//				> In the spawn example below, the object will rotate, scale, and tint at the same time. It does not wait until one is finished before starting the next
 	//		> *** Docs: http://www.cocos2d-x.org/wiki/Actions (Look for "Sequences and How To Run Them") ***//
 	//IMPORTANT NOTE: Again, all lists in Cocos2D like this require a NULL at the end, otherwise it will crash
-	child_A->runAction(Sequence::create(RotateBy::create(3.0f, Vec3(1800.0f, 0.0f, 0.0f)), FadeOut::create(2.0f), NULL));
+	if (child_A)
+		child_A->runAction(Sequence::create(RotateBy::create(3.0f, Vec3(1800.0f, 0.0f, 0.0f)), FadeOut::create(2.0f), NULL));
 
 
 
@@ -439,13 +727,249 @@ void DemoScene::spawnParentAndChildren()
 	//		> *** Docs: http://www.cocos2d-x.org/wiki/Actions (Look for "Sequences and How To Run Them") ***//
 	//IMPORTANT NOTE: Again, all lists in Cocos2D like this require a NULL at the end, otherwise it will crash
 	//*** Try changing RotateBy() to RotateTo() and ScaleTo() to ScaleBy(). What is the difference between _To() and _By()? Hint: It is mentioned in the docs above! ***//
-	child_B->runAction(Spawn::create(RotateBy::create(3.0f, Vec3(0.0f, 0.0f, 3600.0f)), ScaleTo::create(3.0f, 1.5f, 1.5f), TintTo::create(3.0f, Color3B(255.0f, 255.0f, 0.0f)), NULL));
+	if (child_B)
+		child_B->runAction(Spawn::create(RotateBy::create(3.0f, Vec3(0.0f, 0.0f, 3600.0f)), ScaleTo::create(3.0f, 1.5f, 1.5f), TintTo::create(3.0f, Color3B(255.0f, 255.0f, 0.0f)), NULL));
 	
 
 
 	//Play the sound now that the object has been spawned
-	//Since we use the same file path as we did when we pre-loaded the sound in initSounds(), it should immediately play the one already loaded
-	AudioEngine::play2d("Demo/Sounds/sound_SpawnObject.mp3");
+	//Since we use the same sound id we got when we pre-loaded the sound in initSounds(), it should immediately play the one already loaded
+	if (!DISPLAY->isHeadless())
+		VOICES->play(spawnSound, SPAWN_SOUND_VOLUME);
+}
+
+void DemoScene::spawnBirdBatch(BirdType type, const std::vector<Vec2>& positions)
+{
+	if (positions.empty())
+		return;
+
+	//The pool changes the bodies as it hands them out, so the physics can't be in the middle of a step
+	//If it is, the batch is saved and spawned as soon as the step is done instead of waiting for it here. With threading off, it is spawned right away
+	physicsStepper.runWhenIdle([this, type, positions]() { addBirdBatch(type, positions); });
+}
+
+void DemoScene::addBirdBatch(BirdType type, const std::vector<Vec2>& positions)
+{
+	PROFILE_SCOPE("DemoScene::spawnBirdBatch");
+
+	//Get every bird for the batch from the pool at once
+	//The pool looks up the texture and the collider size once for the whole batch, rather than once per bird
+	std::vector<Node*> batch;
+	BIRD_POOL->acquireBatch(type, positions.size(), batch);
+
+	//If the birds are going into a SpriteBatchNode, make sure it has room for all of them up front so it doesn't grow one bird at a time
+	SpriteBatchNode* batchNode = dynamic_cast<SpriteBatchNode*>(birdLayers[type]);
+	if (batchNode)
+	{
+		ssize_t neededCapacity = batchNode->getChildrenCount() + batch.size();
+		if (batchNode->getTextureAtlas()->getCapacity() < neededCapacity)
+			batchNode->getTextureAtlas()->resizeCapacity(neededCapacity);
+	}
+
+	//Place every bird and add them all to their layer in one pass
+	Node* layer = birdLayers[type];
+	for (unsigned int i = 0; i < batch.size(); i++)
+	{
+		Node* bird = batch[i];
+		bird->setPosition(positions[i]);
+		layer->addChild(bird);
+
+		//Give the bird back to the pool once its lifetime is up, the same way spawnSoloObject() does
+		scheduleBirdExpiry(bird);
+
+		//Red birds get the same child actions as in spawnParentAndChildren()
+		if (type == BirdType::Red)
+		{
+			Node* child_A = bird->getChildByName(RED_BIRD_DOT_NAME);
+			Node* child_B = bird->getChildByName(RED_BIRD_CHILD_NAME);
+			if (child_A)
+				child_A->runAction(Sequence::create(RotateBy::create(3.0f, Vec3(1800.0f, 0.0f, 0.0f)), FadeOut::create(2.0f), NULL));
+			if (child_B)
+				child_B->runAction(Spawn::create(RotateBy::create(3.0f, Vec3(0.0f, 0.0f, 3600.0f)), ScaleTo::create(3.0f, 1.5f, 1.5f), TintTo::create(3.0f, Color3B(255.0f, 255.0f, 0.0f)), NULL));
+		}
+	}
+
+	//Play the spawn sound once for the whole batch instead of once per bird
+	if (!DISPLAY->isHeadless())
+		VOICES->play(spawnSound, SPAWN_SOUND_VOLUME);
+}
+
+void DemoScene::spawnBirdBurst(BirdType type, unsigned int count, Vec2 center, float radius)
+{
+	//Space the birds evenly around a circle
+	std::vector<Vec2> positions;
+	positions.reserve(count);
+	for (unsigned int i = 0; i < count; i++)
+	{
+		float angle = 2.0f * (float)M_PI * (float)i / (float)count;
+		positions.push_back(Vec2(center.x + cosf(angle) * radius, center.y + sinf(angle) * radius));
+	}
+
+	//Spawn them all at once
+	spawnBirdBatch(type, positions);
+}
+
+void DemoScene::spawnBirdsAlongPath(BirdType type, Vec2 start, Vec2 end, float spacing)
+{
+	//Work out how many birds fit between the last one and the end of the line
+	Vec2 direction = end - start;
+	float distance = direction.length();
+	unsigned int count = (unsigned int)(distance / spacing);
+	if (count == 0)
+		return;
+
+	//Place a bird every 'spacing' pixels along the line
+	direction.normalize();
+	std::vector<Vec2> positions;
+	positions.reserve(count);
+	for (unsigned int i = 1; i <= count; i++)
+		positions.push_back(start + direction * (spacing * (float)i));
+
+	//The next part of the trail starts where the last bird was placed, so the spacing stays even from frame to frame
+	lastTrailPoint = positions.back();
+
+	//Spawn them all at once
+	spawnBirdBatch(type, positions);
+}
+
+void DemoScene::spawnSimpleBirds(BirdType type, unsigned int count, Vec2 center, float speed)
+{
+	//Throw the birds out in every direction, with the speed changing a little from bird to bird so they don't all land in a ring
+	//The angles are spread out with the golden angle so the fountain looks random but is the same every time (which keeps the benchmark repeatable)
+	birdStore->reserve(birdStore->getCount() + count);
+	for (unsigned int i = 0; i < count; i++)
+	{
+		float angle = 2.39996323f * (float)i;
+		float birdSpeed = speed * (0.5f + 0.5f * (float)(i % 7) / 6.0f);
+		birdStore->spawn(type, center, Vec2(cosf(angle) * birdSpeed, sinf(angle) * birdSpeed), birdLifetime);
+	}
+}
+
+void DemoScene::setBirdLifetime(float lifetime)
+{
+	//Set how long new birds stay in the scene. Birds that are already spawned keep the lifetime they were spawned with
+	birdLifetime = lifetime;
+}
+
+float DemoScene::getLastPhysicsStepTime() const
+{
+	//Return how long the physics step took last frame, in milliseconds
+	return lastPhysicsStepTime;
+}
+
+PhysicsStepper& DemoScene::getPhysicsStepper()
+{
+	//Return the stepper so its settings can be changed
+	return physicsStepper;
+}
+
+void DemoScene::setPhysicsTuning(const PhysicsTuning& tuning)
+{
+	//Don't change anything while the physics might be in the middle of a step
+	physicsStepper.waitForStep();
+
+	//Store the settings. They are handed to the physics world right before the next step, since the ground body might not be in the world yet
+	physicsTuning = tuning;
+	physicsTuningDirty = true;
+
+	//If sleeping was just turned off, nothing is ever going to wake the birds that are already asleep
+	if (physicsTuning.sleepTimeThreshold <= 0.0f || physicsStepper.isThreaded())
+		wakeAllBirds();
+}
+
+const PhysicsTuning& DemoScene::getPhysicsTuning() const
+{
+	//Return the current settings
+	return physicsTuning;
+}
+
+void DemoScene::setBirdCollisions(bool enabled)
+{
+	//The masks are about to be changed on every bird, so the physics can't be in the middle of a step
+	physicsStepper.waitForStep();
+
+	//Change the table for every pair of bird categories
+	COLLISION_FILTER->setCollides(PhysicsCategory::Bird, PhysicsCategory::Bird, enabled);
+	COLLISION_FILTER->setCollides(PhysicsCategory::Bird, PhysicsCategory::SleepingBird, enabled);
+
+	//The birds that are already out keep their old masks until they are given them again. The ones in the pool get them when they are next spawned
+	for (unsigned int type = 0; type < NumBirdTypes; type++)
+	{
+		for (Node* bird : birdLayers[type]->getChildren())
+		{
+			PhysicsBody* body = bird->getPhysicsBody();
+			if (body)
+				COLLISION_FILTER->apply(body, isSleepingBird(bird) ? PhysicsCategory::SleepingBird : PhysicsCategory::Bird);
+		}
+	}
+
+	//Anything that was resting on another bird has nothing holding it up anymore
+	if (!enabled)
+		wakeAllBirds();
+}
+
+bool DemoScene::getBirdCollisions() const
+{
+	return COLLISION_FILTER->getCollides(PhysicsCategory::Bird, PhysicsCategory::Bird);
+}
+
+void DemoScene::setThreadedPhysics(bool enabled)
+{
+	//Turning it off waits for the step that is running and puts the birds where it left them
+	physicsStepper.setThreaded(enabled);
+
+	//Sleeping needs the contact events and changes the bodies after every step, which can't happen while the worker has them. Wake everything so nothing is left frozen
+	if (enabled)
+		wakeAllBirds();
+
+	//The debug drawing is turned off while the worker is stepping (see applyDebugDraw()), and comes back on with whatever mode was picked when it stops
+	applyDebugDraw();
+}
+
+bool DemoScene::getThreadedPhysics() const
+{
+	return physicsStepper.isThreaded();
+}
+
+BirdStore* DemoScene::getBirdStore()
+{
+	return birdStore;
+}
+
+TimerWheel& DemoScene::getTimerWheel()
+{
+	return lifetimeTimers;
+}
+
+ParticleUpdater* DemoScene::getParticleUpdater()
+{
+	return particleUpdater;
+}
+
+void DemoScene::setBirdTrails(bool enabled)
+{
+	birdTrailsEnabled = enabled;
+}
+
+bool DemoScene::getBirdTrails() const
+{
+	return birdTrailsEnabled;
+}
+
+unsigned int DemoScene::getSleepingBirdCount() const
+{
+	//Count the sleeping birds in every layer
+	unsigned int count = 0;
+	for (unsigned int type = 0; type < NumBirdTypes; type++)
+	{
+		for (Node* bird : birdLayers[type]->getChildren())
+		{
+			if (isSleepingBird(bird))
+				count++;
+		}
+	}
+
+	return count;
 }
 
 void DemoScene::nextDebugDraw()
@@ -458,9 +982,57 @@ void DemoScene::nextDebugDraw()
 		debugDrawType = 0;
 
 	//Set the correct debug draw type depending on the new value
+	applyDebugDraw();
+}
+
+void DemoScene::applyQuality(QualityLevel level)
+{
+	QualityLevel previous = appliedQuality;
+
+	//Cap the mouse particles. Fewer particles can be alive and they are spawned more slowly to match, so the cap doesn't make them come out in bursts
+	//The particles past the cap are dropped straight away
+	if (mouseParticles)
+	{
+		ParticleEmitterSettings settings = mouseParticleSettings;
+		if (level >= QualityLevel::CappedParticles)
+		{
+			settings.totalParticles = (unsigned int)(settings.totalParticles * FRAME_PACER_PARTICLE_SCALE);
+			settings.emissionRate *= FRAME_PACER_PARTICLE_SCALE;
+		}
+		mouseParticles->setSettings(settings);
+	}
+
+	//Skip the debug drawing. The type picked with the space bar is kept, so it comes back once the quality is raised
+	appliedQuality = level;
+	applyDebugDraw();
+
+	//Reduce the physics. Each substep costs about as much as a full step, and a slow frame can otherwise take several steps to catch up, which makes the next frame even slower
+	//Whatever the settings were (ex: the benchmark's --substeps) are remembered when they are reduced, and put back when the quality is raised again
+	if (previous < QualityLevel::FewerSubsteps && level >= QualityLevel::FewerSubsteps)
+	{
+		fullSubsteps = physicsStepper.getSubsteps();
+		fullMaxSteps = physicsStepper.getMaxStepsPerFrame();
+		physicsStepper.setSubsteps(1);
+		physicsStepper.setMaxStepsPerFrame(std::min(fullMaxSteps, (unsigned int)FRAME_PACER_MAX_STEPS));
+	}
+	else if (previous >= QualityLevel::FewerSubsteps && level < QualityLevel::FewerSubsteps)
+	{
+		physicsStepper.setSubsteps(fullSubsteps);
+		physicsStepper.setMaxStepsPerFrame(fullMaxSteps);
+	}
+
+	//Throttle the held-down spawns. Single clicks always spawn their bird, since they can't pile up fast enough to matter
+	spawnScale = (level >= QualityLevel::ThrottledSpawns) ? FRAME_PACER_SPAWN_SCALE : 1.0f;
+}
+
+void DemoScene::applyDebugDraw()
+{
 	//Use the physicsWorld reference we set in the createScene() function
 	//The 'Draw Mask' is just what we want to see be drawn
-	switch (debugDrawType)
+	//Nothing is drawn while the frame pacer is skipping the debug drawing
+	//Nothing is drawn while the physics is threaded either. The debug drawing reads every shape and body while the frame is drawn, which is exactly when the worker is stepping them
+	int drawType = (appliedQuality >= QualityLevel::NoDebugDraw || physicsStepper.isThreaded()) ? 0 : debugDrawType;
+	switch (drawType)
 	{
 	case 0: //None
 		physicsWorld->setDebugDrawMask(PhysicsWorld::DEBUGDRAW_NONE);
@@ -486,11 +1058,281 @@ void DemoScene::nextDebugDraw()
 void DemoScene::onRestartButtonPress()
 {
 	//Reloading the scene can be accomplished by simply replacing the scene with the same scene we are running
-	//This is the exact same logic as changing to a different scene
+	//This is the exact same logic as changing to a different scene: director->replaceScene(DemoScene::createScene());
 	//replaceScene() simply ends the current scene and switches to the new scene. popScene stores the active scene so we can come back to it with no data loss. Use the appropriate choice for your game
-	//Note that we don't have to do anything else. Cocos2D handles clearing the physics world, cleaning up the sprites, etc.
-	//*** Try to create a menu scene for this demo project. Add a button in the menu to switch to this scene and one in here to go back! ***//
-	//*** Try adding a transition to the scene swap! For instance, replace the line below with "director->replaceScene(TransitionPageTurn::create(2.0f, DemoScene::createScene(), false));" to add a page turn effect! ***//
+	//Cocos2D handles clearing the physics world, cleaning up the sprites, etc.
+	//BUT, that rebuilds EVERYTHING. The background, the labels, the particles, the physics world and the ground all get thrown away and built again, which causes a visible hitch
+	//The only thing that actually changes while playing is the birds (and the gravity / debug drawing), so we just reset those instead. See resetScene()
+	//*** Try to create a menu scene for this demo project. Add a button in the menu to switch to this scene and one in here to go back! You will need replaceScene() for that! ***//
+	//*** Try adding a transition to the scene swap! For instance, use "director->replaceScene(TransitionPageTurn::create(2.0f, DemoScene::createScene(), false));" to add a page turn effect! ***//
 	//*** Docs: http://www.cocos2d-x.org/wiki/Building_and_Transitioning_Scenes ***//
-	director->replaceScene(DemoScene::createScene());
-}
\ No newline at end of file
+	BIRD_POOL->printStats();
+	VOICES->printStats();
+	SOUNDS->printStats();
+	resetScene();
+}
+
+void DemoScene::resetScene()
+{
+	//Let the physics finish its step first
+	physicsStepper.waitForStep();
+
+	//Every bird is about to go back to the pool, so none of their lifetimes matter anymore
+	lifetimeTimers.clear();
+	expiredBirds.clear();
+
+	//Give every bird back to the pool. This takes them out of the scene and the physics world, but they aren't deleted so the next spawns are quick
+	//The pool wakes up any birds that were asleep when it resets them, so everything that was remembered about sleeping can be thrown away
+	BIRD_POOL->reclaimAll();
+	birdsToWake.clear();
+	birdRestTimes.assign(birdRestTimes.size(), 0.0f);
+
+	//The simple birds aren't in the pool. They are just numbers in a list, so clearing the list is all it takes
+	birdStore->clear();
+
+	//Every trail goes with its bird. The mouse particles are kept
+	for (unsigned int i = 0; i < birdTrails.size(); i++)
+		particleUpdater->removeEmitter(birdTrails[i].emitter);
+	birdTrails.clear();
+
+	//Put gravity back to normal in case the G key was being held
+	physicsWorld->setGravity(Vec2(0.0f, -98.1f));
+	birdStore->setGravity(Vec2(0.0f, -98.1f));
+
+	//Turn the physics debug drawing off again
+	debugDrawType = 0;
+	applyDebugDraw();
+
+	//Forget where the birds were on the last step and any time left over in the stepper
+	physicsStepper.reset();
+
+	//Stop any trail that was being drawn with the middle mouse button
+	lastTrailPoint = INPUTS->getMousePosition();
+
+	//Everything else (the background, the ground, the labels, the particles, the menu and all of the loaded images and sounds) is left exactly as it is
+}
+
+
+//--- Physics Callbacks ---//
+bool DemoScene::onSleepingBirdHit(PhysicsContact& contact, PhysicsBody* sleeper, PhysicsBody* other)
+{
+	//Only wake the sleeping bird if it was actually hit. A bird gently settling on top of it shouldn't wake the whole pile
+	if (other->getVelocity().length() > physicsTuning.idleSpeedThreshold)
+		birdsToWake.push_back(sleeper->getNode());
+
+	//Let the collision happen as normal
+	return true;
+}
+
+void DemoScene::onSleepingBirdSeparate(PhysicsContact& contact, PhysicsBody* sleeper, PhysicsBody* other)
+{
+	//Something awake stopped touching a sleeping bird. The sleeping bird might have been resting on it, so wake it up to be safe
+	//Two sleeping birds separating never gets here since there is no (SleepingBird, SleepingBird) handler. That happens when a bird goes to sleep on top of another one
+	birdsToWake.push_back(sleeper->getNode());
+}
+
+
+
+//--- Sleeping Birds ---//
+void DemoScene::updateSleepingBirds(float stepTime)
+{
+	PROFILE_SCOPE("Physics::sleep");
+
+	//Wake up everything that was hit during the step. The list is swapped out first since waking a bird can send more contact events
+	std::vector<Node*> hitBirds;
+	hitBirds.swap(birdsToWake);
+	for (unsigned int i = 0; i < hitBirds.size(); i++)
+		wakeBird(hitBirds[i]);
+
+	//Nothing else to do if sleeping is turned off
+	if (physicsTuning.sleepTimeThreshold <= 0.0f)
+		return;
+
+	//Add up how long each awake bird has been sitting still and put it to sleep once it has been still for long enough
+	//The spin counts too, so a bird rolling along the ground doesn't fall asleep
+	for (unsigned int type = 0; type < NumBirdTypes; type++)
+	{
+		float radius = BIRD_POOL->getRadius((BirdType)type);
+		for (Node* bird : birdLayers[type]->getChildren())
+		{
+			PhysicsBody* body = bird->getPhysicsBody();
+			if (!body || isSleepingBird(bird))
+				continue;
+
+			unsigned int index = (unsigned int)bird->getTag();
+			if (index >= birdRestTimes.size())
+				birdRestTimes.resize(index + 1, 0.0f);
+
+			float speed = body->getVelocity().length() + fabsf(body->getAngularVelocity()) * radius * bird->getScale();
+			if (speed < physicsTuning.idleSpeedThreshold)
+				birdRestTimes[index] += stepTime;
+			else
+				birdRestTimes[index] = 0.0f;
+
+			if (birdRestTimes[index] >= physicsTuning.sleepTimeThreshold)
+				putBirdToSleep(bird);
+		}
+	}
+}
+
+void DemoScene::putBirdToSleep(Node* bird)
+{
+	PhysicsBody* body = bird->getPhysicsBody();
+
+	//Change the category first. Freezing the body ends its contacts with other sleeping birds, and they need to see this bird as asleep already so they don't wake up
+	COLLISION_FILTER->apply(body, PhysicsCategory::SleepingBird);
+
+	//Stop it completely and make it non-dynamic. A non-dynamic body with no velocity never moves and is skipped by the solver
+	body->setVelocity(Vec2::ZERO);
+	body->setAngularVelocity(0.0f);
+	body->resetForces();
+	body->setDynamic(false);
+}
+
+void DemoScene::wakeBird(Node* bird)
+{
+	//The bird might have already been woken up by something else this frame
+	if (!isSleepingBird(bird))
+		return;
+
+	//Change the category first so the contacts that end when the body changes don't try to wake it again
+	PhysicsBody* body = bird->getPhysicsBody();
+	COLLISION_FILTER->apply(body, PhysicsCategory::Bird);
+	body->setDynamic(true);
+
+	//Start counting from 0 again
+	unsigned int index = (unsigned int)bird->getTag();
+	if (index < birdRestTimes.size())
+		birdRestTimes[index] = 0.0f;
+}
+
+void DemoScene::wakeAllBirds()
+{
+	for (unsigned int type = 0; type < NumBirdTypes; type++)
+	{
+		for (Node* bird : birdLayers[type]->getChildren())
+			wakeBird(bird);
+	}
+}
+
+void DemoScene::wakeBirdsNear(Vec2 position, float radius)
+{
+	//Compare the squared distances so there is no square root for every bird
+	float radiusSquared = radius * radius;
+	for (unsigned int type = 0; type < NumBirdTypes; type++)
+	{
+		for (Node* bird : birdLayers[type]->getChildren())
+		{
+			if (isSleepingBird(bird) && bird->getPosition().distanceSquared(position) <= radiusSquared)
+				wakeBird(bird);
+		}
+	}
+}
+
+void DemoScene::scheduleBirdExpiry(Node* bird)
+{
+	//The timer only puts the bird on the expired list. They are all given back to the pool together in releaseExpiredBirds()
+	lifetimeTimers.schedule(birdLifetime, [this, bird]() { expiredBirds.push_back(bird); });
+}
+
+void DemoScene::attachTrail(Node* bird)
+{
+	if (!birdTrailsEnabled)
+		return;
+
+	//A short, faint trail of sparks. The particles stay where they are spawned, so they are left behind as the bird moves
+	ParticleEmitterSettings trail;
+	trail.totalParticles = 150;
+	trail.gravity = Vec2::ZERO;
+	trail.speed = 10.0f;
+	trail.speedVar = 5.0f;
+	trail.angle = 90.0f;
+	trail.angleVar = 360.0f;
+	trail.life = 0.75f;
+	trail.lifeVar = 0.25f;
+	trail.emissionRate = (float)trail.totalParticles / trail.life;
+	trail.startSize = 20.0f;
+	trail.startSizeVar = 5.0f;
+	trail.endSize = 0.0f;
+	trail.endSizeVar = 0.0f;
+	trail.startColor = Color4F(1.0f, 0.8f, 0.3f, 0.6f);
+	trail.startColorVar = Color4F(0.0f, 0.2f, 0.2f, 0.1f);
+	trail.endColor = Color4F(1.0f, 0.3f, 0.0f, 0.0f);
+	trail.endColorVar = Color4F(0.0f, 0.0f, 0.0f, 0.0f);
+
+	//It uses the same snowflake image as the mouse particles. There isn't one when the display is headless
+	ParticleEmitter* emitter = ParticleEmitter::create(trail);
+	emitter->setPosition(bird->getPosition());
+	if (mouseParticles)
+		emitter->setDisplayFrame(SPRITE_ATLAS->getFrame(particleFrame));
+	particleUpdater->addEmitter(emitter);
+
+	BirdTrail birdTrail;
+	birdTrail.bird = bird;
+	birdTrail.emitter = emitter;
+	birdTrails.push_back(birdTrail);
+}
+
+void DemoScene::releaseExpiredBirds()
+{
+	if (expiredBirds.empty())
+		return;
+
+	//Taking the birds out of the physics world can't happen in the middle of a threaded step, so they are released once it is done. With threading off, that is right away
+	//The list is handed over so any birds that expire in the meantime go in the next batch
+	std::vector<Node*> birds;
+	birds.swap(expiredBirds);
+	physicsStepper.runWhenIdle([this, birds]() { releaseBirds(birds); });
+}
+
+void DemoScene::releaseBirds(std::vector<Node*> birds)
+{
+	PROFILE_SCOPE("DemoScene::releaseExpiredBirds");
+
+	for (unsigned int i = 0; i < birds.size(); i++)
+	{
+		Node* bird = birds[i];
+
+		//Sleeping birds don't touch each other, so nothing tells the birds resting on this one that it is gone. Wake up everything close enough to be touching it
+		//The largest bird is about as wide as this one, so anything whose center is within one and a half widths could be touching it
+		if (physicsTuning.sleepTimeThreshold > 0.0f)
+			wakeBirdsNear(bird->getPosition(), bird->getBoundingBox().size.width * 1.5f);
+
+		//Its rest time starts from 0 the next time it is spawned
+		unsigned int index = (unsigned int)bird->getTag();
+		if (index < birdRestTimes.size())
+			birdRestTimes[index] = 0.0f;
+
+		//Give it back to the pool. Removing it from the physics world can put it on the wake list, and the pool might delete it so it can't be touched after this
+		BIRD_POOL->release(bird);
+	}
+
+	//Forget about every released bird in one pass over the wake list. Only the pointers are compared, so it doesn't matter if they were deleted
+	std::sort(birds.begin(), birds.end());
+	if (!birdsToWake.empty())
+		birdsToWake.erase(std::remove_if(birdsToWake.begin(), birdsToWake.end(), [&birds](Node* bird) { return std::binary_search(birds.begin(), birds.end(), bird); }), birdsToWake.end());
+
+	//The stepper remembers where each bird was on the last step to draw it in between. The pool hands the same birds out again, so forget them or a respawned bird would be drawn sliding in from where it used to be
+	physicsStepper.forgetNodes(birds);
+
+	//Stop the trails of the released birds the same way. Their particles are left to die out on their own, then the updater removes them
+	if (!birdTrails.empty())
+	{
+		unsigned int kept = 0;
+		for (unsigned int i = 0; i < birdTrails.size(); i++)
+		{
+			if (std::binary_search(birds.begin(), birds.end(), birdTrails[i].bird))
+				particleUpdater->stopEmitter(birdTrails[i].emitter);
+			else
+				birdTrails[kept++] = birdTrails[i];
+		}
+		birdTrails.resize(kept);
+	}
+}
+
+bool DemoScene::isSleepingBird(Node* node) const
+{
+	//Only sleeping birds are ever put in the sleeping category
+	PhysicsBody* body = (node) ? node->getPhysicsBody() : nullptr;
+	return body && body->getCategoryBitmask() == PHYSICS_CATEGORY_BIT(PhysicsCategory::SleepingBird);
+}
@@ -3,6 +3,20 @@
 //3rd Party Libraries
 #include "cocos2d.h"
 
+//Wrapper Classes
+#include "BirdPool.h"
+#include "BirdStore.h"
+#include "ParticleEmitter.h"
+#include "ParticleUpdater.h"
+#include "PhysicsStepper.h"
+#include "TimerWheel.h"
+#include "PhysicsTuning.h"
+#include "CollisionFilter.h"
+#include "ContactDispatcher.h"
+#include "SoundCache.h"
+#include "SpriteAtlas.h"
+#include "FramePacer.h"
+
 //Namespaces
 using namespace cocos2d;
 
@@ -14,6 +28,7 @@ public:
 	static cocos2d::Scene* createScene(); //The function that actually builds the scene and returns it. Called in AppDelegate.cpp right before director->runWithScene()
 	virtual bool init(); //An init function that sets up the values for this class and returns a flag indicating if it succeeded or not. Sort of like the constructor for scenes
 	void update(float deltaTime); //A function that is called every frame. This is essentially your game loop
+	void onExit(); //Called when the scene stops running. Makes sure the physics isn't in the middle of a step while the scene is being taken apart
 	CREATE_FUNC(DemoScene); //This is a special macro'd function created by Cocos2D. It automatically releases the memory for this scene when it is no longer being used by anything
 
 	//Init Functions (These functions and others are ours, not Cocos2D's)
@@ -22,26 +37,111 @@ public:
 	void initSounds(); //Load the sounds we want to use so they don't get loaded the first time they are used
 
 	//Methods
-	void spawnSoloObject(); //Spawn a single yellow bird
-	void spawnParentAndChildren(); //Spawn a red bird with two child objects. One is a draw node and the other is another sprite
+	void spawnSoloObject(); //Spawn a single yellow bird. Changes a physics body, so only call it while the physics isn't being stepped (see PhysicsStepper::runWhenIdle())
+	void spawnParentAndChildren(); //Spawn a red bird with two child objects. One is a draw node and the other is another sprite. Only call it while the physics isn't being stepped, like spawnSoloObject()
+	void spawnBirdBatch(BirdType type, const std::vector<Vec2>& positions); //Spawn a whole batch of birds at once, one at each position. The texture and collider are only looked up once for the whole batch. If the physics is being stepped on its own thread, they are spawned once the step is done
+	void spawnBirdBurst(BirdType type, unsigned int count, Vec2 center, float radius); //Spawn a ring of birds around a point all at once
+	void spawnBirdsAlongPath(BirdType type, Vec2 start, Vec2 end, float spacing); //Spawn birds evenly spaced along a line. Used to draw a trail of birds while the middle mouse button is held
+	void spawnSimpleBirds(BirdType type, unsigned int count, Vec2 center, float speed); //Throw a fountain of simple birds out from a point. These have no node or physics body, so tens of thousands of them are fine. See BirdStore.h
 	void nextDebugDraw(); //Switch the setting on the physics debug draw to view the different types available with Cocos2D
+	void applyQuality(QualityLevel level); //Cut back (or bring back) the particles, debug drawing, physics substeps and spawns to match a quality level from the frame pacer. See FramePacer.h
+	void resetScene(); //Clear out every bird and put the gravity and debug drawing back to normal. Much faster than rebuilding the whole scene since the background, labels, etc are all kept
+	void setBirdLifetime(float lifetime); //Set how many seconds spawned birds stay in the scene before going back to the pool. Default is 5s. The benchmark makes this really long so the birds pile up
+	float getLastPhysicsStepTime() const; //Get how long the physics step took last frame, in milliseconds. Measured in every build, not just when profiling
+	PhysicsStepper& getPhysicsStepper(); //Get the fixed timestep stepper so the step rate, substeps, etc can be changed
+	void setPhysicsTuning(const PhysicsTuning& tuning); //Change the solver, broadphase and sleep settings. See PhysicsTuning.h. Applied right before the next physics step
+	const PhysicsTuning& getPhysicsTuning() const; //Get the current solver, broadphase and sleep settings
+	unsigned int getSleepingBirdCount() const; //Get how many birds are currently asleep
+	void setBirdCollisions(bool enabled); //Turn bird-vs-bird collisions on or off. With them off, the birds fall through each other and pile up on the ground. Used for stress testing
+	bool getBirdCollisions() const; //Get if birds collide with each other
+	void setThreadedPhysics(bool enabled); //Step the physics on its own thread while the frame is drawn. Sleeping birds are turned off while this is on. See PhysicsStepper.h
+	bool getThreadedPhysics() const; //Get if the physics is stepped on its own thread
+	BirdStore* getBirdStore(); //Get the store that holds the simple birds
+	TimerWheel& getTimerWheel(); //Get the timer wheel that runs the bird lifetimes. Use it to run your own callbacks after a delay. It is ticked at the start of update()
+	ParticleUpdater* getParticleUpdater(); //Get the updater that runs every particle emitter in the scene. Use it to change the thread count or turn on deterministic mode
+	void setBirdTrails(bool enabled); //Give the birds spawned with the mouse buttons a particle trail. On by default. Birds that already have one keep it
+	bool getBirdTrails() const; //Get if birds spawned with the mouse buttons get a particle trail
 
 	//Menu Callbacks
 	void onRestartButtonPress(); //Simple callback function that is called whenever the button in the top right is presseds
 
+	//Physics Callbacks (sent through the contact dispatcher)
+	bool onSleepingBirdHit(PhysicsContact& contact, PhysicsBody* sleeper, PhysicsBody* other); //Called when something starts touching a sleeping bird. Wakes it up if it was hit hard enough
+	void onSleepingBirdSeparate(PhysicsContact& contact, PhysicsBody* sleeper, PhysicsBody* other); //Called when something stops touching a sleeping bird. Wakes it up in case it was resting on whatever left
+
 private:
 	//Engine
 	Director* director; //A reference to the director so we don't have to call getInstance() every time we want to use it
 
 	//Following particle system
-	ParticleSystem* mouseParticles; //A particle system that is going to follow the mouse cursor every frame. Only thing we need to hold on to so we can explicity control it
+	ParticleEmitter* mouseParticles; //A particle system that is going to follow the mouse cursor every frame. Only thing we need to hold on to so we can explicity control it
+	ParticleEmitterSettings mouseParticleSettings; //The mouse particles' settings at full quality. The frame pacer's quality is applied on top of these
+	ParticleUpdater* particleUpdater; //Updates and draws every emitter in the scene (the mouse particles and the bird trails) across a few threads
+	AtlasFrameId particleFrame; //The sprite atlas frame drawn for every particle. Looked up once when the mouse particles are made
+
+	//Bird trails
+	struct BirdTrail
+	{
+		Node* bird; //The bird being followed
+		ParticleEmitter* emitter; //The emitter following it. Held on to by the particle updater
+	};
+	std::vector<BirdTrail> birdTrails; //Every bird that has a trail
+	bool birdTrailsEnabled; //If the birds spawned with the mouse buttons get a trail
+	void attachTrail(Node* bird); //Start a trail following a bird that was just spawned
+
+	//Sounds
+	SoundId spawnSound; //The sound cache's id for the spawn sound. Set in initSounds()
 
 	//This scene's physics world
 	//Reference to the physics world used within the scene. Prevents having to call: director->getRunningScene()->getPhysicsWorld() every time we want to do something
 	//HAS to be static because the create function we set its value in is a static function. The compiler will complain if we try to use a non-static member in a static function
 	static PhysicsWorld* physicsWorld; 
+	PhysicsStepper physicsStepper; //Steps the physics world with a fixed timestep and smooths out the birds' movement between steps
 
 	//The current debug draw type
 	int debugDrawType; //The current type of debug drawing being used. Default is 0. 0 = none, 1 = contact, 2 = shapes, 3 = all
+	void applyDebugDraw(); //Hand the debug draw type to the physics world. Nothing is drawn while the frame pacer has the debug drawing turned off
+
+	//Frame Pacing
+	QualityLevel appliedQuality; //The frame pacer's quality level that the scene was last changed to match
+	unsigned int fullSubsteps; //The physics substeps from before the frame pacer reduced them. Put back once the quality is raised again
+	unsigned int fullMaxSteps; //The physics steps per frame from before the frame pacer reduced them
+	float spawnScale; //How much of the held-down spawns actually happen. 1 at full quality
+
+	//Spawning
+	float birdLifetime; //How many seconds a spawned bird stays in the scene before it goes back to the pool
+	Node* birdLayers[NumBirdTypes]; //The node every bird of each type is added to. The yellow birds go in a SpriteBatchNode so they are all drawn at once
+	Vec2 lastTrailPoint; //Where the last bird in the trail was spawned while the middle mouse button is held
+	BirdStore* birdStore; //Holds the simple birds. They are simulated and drawn in bulk instead of each being its own node
+	void addBirdBatch(BirdType type, const std::vector<Vec2>& positions); //Does the actual spawning for spawnBirdBatch() once the physics isn't being stepped
+
+	//Lifetimes
+	TimerWheel lifetimeTimers; //Counts down every bird's lifetime, and anything else that should happen after a delay
+	std::vector<Node*> expiredBirds; //Birds whose lifetimes ran out this frame. They are all given back to the pool together
+	void scheduleBirdExpiry(Node* bird); //Start the countdown for a bird that was just spawned
+	void releaseExpiredBirds(); //Give every expired bird back to the pool, waking up anything that was resting on them first. Held until the physics step is done if it is threaded
+	void releaseBirds(std::vector<Node*> birds); //Does the actual releasing for releaseExpiredBirds() once the physics isn't being stepped
+
+	//Physics Tuning
+	PhysicsTuning physicsTuning; //The solver, broadphase and sleep settings
+	bool physicsTuningDirty; //True if the settings have changed and haven't been given to the physics world yet
+	PhysicsBody* groundBody; //The ground's physics body. Used to find the Chipmunk space when applying the settings
+	ContactDispatcher contactDispatcher; //Sends the contact events to the handler for each pair of categories. See ContactDispatcher.h
+	std::vector<float> birdRestTimes; //How long each bird has been sitting still, in seconds. Indexed by the bird's tag (its index in the bird pool)
+	std::vector<Node*> birdsToWake; //Sleeping birds that were hit during the physics step. Bodies can't be changed in the middle of a step so they are woken up right after
+
+	//Profiling
+	Label* profilerOverlay; //The text in the bottom left showing where the frame time goes. Toggled with the P key. nullptr if the display is headless
+	float overlayRefreshTimer; //How long until the overlay text is refreshed
+	float lastPhysicsStepTime; //How long the physics step took last frame, in milliseconds
+	float lastSimpleBirdsStepTime; //How long moving the simple birds took last frame, in milliseconds. Written by the job, so only read it after the job has been waited on
+
+	//Sleeping Birds
+	void updateSleepingBirds(float stepTime); //Wake up the birds that were hit and put the ones that have been still for long enough to sleep
+	void putBirdToSleep(Node* bird); //Freeze a bird in place. It stops colliding with the ground and other sleeping birds
+	void wakeBird(Node* bird); //Unfreeze a bird so it is simulated normally again
+	void wakeAllBirds(); //Wake up every bird. Used when something changes for all of them, like the gravity
+	void wakeBirdsNear(Vec2 position, float radius); //Wake up every bird close to a point. Used when a bird is removed so the ones resting on it fall
+	bool isSleepingBird(Node* node) const; //Check if a node is one of our birds and is asleep
 };
 
@@ -10,6 +10,7 @@ DisplayHandler::DisplayHandler()
 {
 	//Init the private data
 	hasBeenInit = false;
+	headless = false;
 	windowSize = Size(0.0f, 0.0f);
 }
 
@@ -79,6 +80,31 @@ void DisplayHandler::init(float windowWidth, float windowHeight, const std::stri
 	}
 }
 
+void DisplayHandler::initHeadless(float windowWidth, float windowHeight)
+{
+	//Only init once, just like init()
+	if (!hasBeenInit)
+	{
+		//Don't create an OpenGL view at all. Just remember the size so positions can still be worked out the same way they are with a real window
+		windowSize = Size(windowWidth, windowHeight);
+
+		//Set the flags so the rest of the game knows not to load anything that needs a GPU
+		headless = true;
+		hasBeenInit = true;
+	}
+	else //If the display has already been init
+	{
+		//Output the same warning as init()
+		std::cout << "WARNING: The initHeadless() function for the display handler has been called after the display was already initialized!" << std::endl;
+	}
+}
+
+bool DisplayHandler::isHeadless() const
+{
+	//Return if the display is running without a window
+	return headless;
+}
+
 void DisplayHandler::createDebugConsole(bool createInReleaseMode)
 {
 #if _DEBUG
@@ -113,9 +139,13 @@ DisplayHandler* DisplayHandler::getInstance()
 //--- Utility Functions ---//
 void DisplayHandler::openConsoleWindow()
 {
+#ifdef _WIN32
+
 	//Create the console window
 	AllocConsole();
 
 	//Bind the window so that outputs go to it
 	freopen("CONOUT$", "w", stdout);
+
+#endif
 }
\ No newline at end of file
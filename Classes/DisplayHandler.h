@@ -42,6 +42,7 @@ using namespace cocos2d;
 		- Get the size of the window in pixels as 'Size' or as 'Vec2'
 	> Methods
 		- Init
+		- Init without a window (headless)
 */
 class DisplayHandler
 {
@@ -85,6 +86,21 @@ public:
 	*/
 	void init(float windowWidth, float windowHeight, const std::string windowTitle, bool useFullscreen, float windowScaleFactor = 1.0f);
 
+	/*
+		Use this INSTEAD of init() to run without a window or a GPU. No OpenGL view is created so nothing can be drawn and no textures can be loaded. The window size is still stored so the rest of the game can position things like normal. Used by the benchmark driver
+
+		@param WindowWidth -> The size of the pretend window horizontally, in pixels
+		@param WindowHeight -> The size of the pretend window vertically, in pixels
+	*/
+	void initHeadless(float windowWidth, float windowHeight);
+
+	/*
+		Get if the display was started with initHeadless() instead of init(). Anything that needs textures, fonts, particles or sounds should check this and skip itself when it is true
+
+		@return Returns -> True if there is no window and nothing is being drawn. False if there is a real window
+	*/
+	bool isHeadless() const;
+
 	/*
 		Creates a debug console window. This allows for the use of couts, printfs, logs etc to be viewed in a cmd window. By default, this function ONLY creates a window in debug mode. It can still create a window in release mode if you want though
 
@@ -106,6 +122,7 @@ private:
 	//--- Private Class Data ---//
 	Size windowSize; //Size (in pixels) of the window. .width and .height can be used to get the information within
 	bool hasBeenInit; //Prevents the display from being init more than once
+	bool headless; //True if there is no window. Set by initHeadless()
 
 	//--- Singleton Instance ---//
 	static DisplayHandler* inst; //The singleton instance of this class. Ie: the only instance that can ever exist
@@ -0,0 +1,306 @@
+#include "FramePacer.h"
+#include "DisplayHandler.h"
+
+//Core Libraries
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+//--- Static Variables ---//
+FramePacer* FramePacer::inst = nullptr;
+
+
+
+//--- Constructor and Destructor ---//
+FramePacer::FramePacer()
+{
+	//Init the private data
+	//The director draws at 60fps unless it is told otherwise, so that is the default target
+	target = FrameTarget::FPS60;
+	adaptiveQuality = true;
+	quality = QualityLevel::Full;
+	averageMs = -1.0;
+	overBudgetTime = 0.0;
+	underBudgetTime = 0.0;
+	settleTime = 0.0;
+	attached = false;
+	frameStarted = false;
+}
+
+FramePacer::~FramePacer()
+{
+}
+
+
+
+//--- Setters ---//
+void FramePacer::setTarget(FrameTarget _target)
+{
+	target = _target;
+
+	//Tell the director how long each frame should last. Uncapped just asks for frames far faster than any screen can show them
+	//There is no director drawing frames when the display is headless, so there is nothing to tell
+	if (!DISPLAY->isHeadless())
+	{
+		float interval = 1.0f / 1000.0f;
+		if (target == FrameTarget::FPS30)
+			interval = 1.0f / 30.0f;
+		else if (target == FrameTarget::FPS60)
+			interval = 1.0f / 60.0f;
+		else if (target == FrameTarget::FPS120)
+			interval = 1.0f / 120.0f;
+		Director::getInstance()->setAnimationInterval(interval);
+	}
+
+	//The old timings were against a different budget, so start counting again
+	overBudgetTime = 0.0;
+	underBudgetTime = 0.0;
+	settleTime = FRAME_PACER_SETTLE_SECONDS;
+
+	std::cout << "Frame Pacer -> Target set to " << getTargetName(target) << " (" << std::fixed << std::setprecision(1) << getBudgetMs() << " ms per frame)" << std::defaultfloat << std::endl;
+}
+
+void FramePacer::setAdaptiveQuality(bool enabled)
+{
+	adaptiveQuality = enabled;
+	overBudgetTime = 0.0;
+	underBudgetTime = 0.0;
+
+	std::cout << "Frame Pacer -> Adaptive quality turned " << (enabled ? "on" : "off") << std::endl;
+	if (!enabled && quality != QualityLevel::Full)
+		setQuality(QualityLevel::Full, "adaptive quality was turned off");
+}
+
+
+
+//--- Getters ---//
+FrameTarget FramePacer::getTarget() const
+{
+	return target;
+}
+
+double FramePacer::getBudgetMs() const
+{
+	switch (target)
+	{
+	case FrameTarget::FPS30:
+		return 1000.0 / 30.0;
+
+	case FrameTarget::FPS60:
+		return 1000.0 / 60.0;
+
+	case FrameTarget::FPS120:
+		return 1000.0 / 120.0;
+
+	default:
+		return FRAME_PACER_UNCAPPED_BUDGET_MS;
+	}
+}
+
+bool FramePacer::getAdaptiveQuality() const
+{
+	return adaptiveQuality;
+}
+
+QualityLevel FramePacer::getQualityLevel() const
+{
+	return quality;
+}
+
+double FramePacer::getAverageFrameMs() const
+{
+	return std::max(averageMs, 0.0);
+}
+
+std::string FramePacer::getStatsText() const
+{
+	std::ostringstream text;
+	text << std::fixed << std::setprecision(1);
+	text << "Pacing: " << getTargetName(target) << " | Work: " << getAverageFrameMs() << "/" << getBudgetMs() << " ms | Quality: " << (int)quality << " (" << getQualityName(quality) << ")";
+	if (!adaptiveQuality)
+		text << " [fixed]";
+	return text.str();
+}
+
+const char* FramePacer::getTargetName(FrameTarget target)
+{
+	switch (target)
+	{
+	case FrameTarget::FPS30:
+		return "30 fps";
+
+	case FrameTarget::FPS60:
+		return "60 fps";
+
+	case FrameTarget::FPS120:
+		return "120 fps";
+
+	default:
+		return "Uncapped";
+	}
+}
+
+const char* FramePacer::getQualityName(QualityLevel level)
+{
+	switch (level)
+	{
+	case QualityLevel::Full:
+		return "Full";
+
+	case QualityLevel::CappedParticles:
+		return "Capped particles";
+
+	case QualityLevel::NoDebugDraw:
+		return "No debug draw";
+
+	case QualityLevel::FewerSubsteps:
+		return "Fewer substeps";
+
+	default:
+		return "Throttled spawns";
+	}
+}
+
+
+
+//--- Methods ---//
+void FramePacer::init(FrameTarget _target)
+{
+	//Listen to the director so every frame is timed from the start of the update to the end of the draw
+	//The time the director spends sleeping until the next frame (and showing the frame) is left out, since that is just time left over
+	if (!attached && !DISPLAY->isHeadless())
+	{
+		EventDispatcher* dispatcher = Director::getInstance()->getEventDispatcher();
+		dispatcher->addCustomEventListener(Director::EVENT_BEFORE_UPDATE, [this](EventCustom*)
+		{
+			onFrameStart();
+		});
+		dispatcher->addCustomEventListener(Director::EVENT_AFTER_DRAW, [this](EventCustom*)
+		{
+			onFrameEnd();
+		});
+		attached = true;
+	}
+
+	setTarget(_target);
+}
+
+void FramePacer::nextTarget()
+{
+	switch (target)
+	{
+	case FrameTarget::FPS30:
+		setTarget(FrameTarget::FPS60);
+		break;
+
+	case FrameTarget::FPS60:
+		setTarget(FrameTarget::FPS120);
+		break;
+
+	case FrameTarget::FPS120:
+		setTarget(FrameTarget::Uncapped);
+		break;
+
+	default:
+		setTarget(FrameTarget::FPS30);
+		break;
+	}
+}
+
+void FramePacer::addFrame(double workMs, double frameSeconds)
+{
+	//Keep a running average so a single slow frame (ex: a big burst of birds) doesn't change the quality on its own
+	if (averageMs < 0.0)
+		averageMs = workMs;
+	else
+		averageMs += (workMs - averageMs) * FRAME_PACER_SMOOTHING;
+
+	if (!adaptiveQuality)
+		return;
+
+	//A huge gap between frames (ex: the window being dragged) would count as a long time over budget all at once, so it is only counted as a short one
+	frameSeconds = std::min(frameSeconds, 0.1);
+
+	//Give the average a moment to catch up after a change before judging it again
+	if (settleTime > 0.0)
+	{
+		settleTime -= frameSeconds;
+		return;
+	}
+
+	//Count how long the frames have been over or under the budget in a row
+	//Anything in between the two thresholds is fine where it is, so both counts start over
+	double budget = getBudgetMs();
+	if (averageMs > budget * FRAME_PACER_LOWER_THRESHOLD)
+	{
+		overBudgetTime += frameSeconds;
+		underBudgetTime = 0.0;
+	}
+	else if (averageMs < budget * FRAME_PACER_RAISE_THRESHOLD)
+	{
+		underBudgetTime += frameSeconds;
+		overBudgetTime = 0.0;
+	}
+	else
+	{
+		overBudgetTime = 0.0;
+		underBudgetTime = 0.0;
+	}
+
+	//Move the quality one step at a time. Lowering happens quickly so the game doesn't stay slow for long, raising happens slowly so it doesn't bounce straight back down
+	if (overBudgetTime >= FRAME_PACER_LOWER_SECONDS && quality != QualityLevel::Lowest)
+		setQuality((QualityLevel)((int)quality + 1), "over budget");
+	else if (underBudgetTime >= FRAME_PACER_RAISE_SECONDS && quality != QualityLevel::Full)
+		setQuality((QualityLevel)((int)quality - 1), "headroom returned");
+}
+
+
+
+//--- Singleton Instance ---//
+FramePacer* FramePacer::getInstance()
+{
+	//Generate the singleton if it hasn't been created yet
+	if (!inst)
+		inst = new FramePacer();
+
+	//Return the singleton
+	return inst;
+}
+
+
+
+//--- Utility Functions ---//
+void FramePacer::setQuality(QualityLevel level, const char* reason)
+{
+	bool lowered = (int)level > (int)quality;
+	quality = level;
+	overBudgetTime = 0.0;
+	underBudgetTime = 0.0;
+	settleTime = FRAME_PACER_SETTLE_SECONDS;
+
+	std::cout << "Frame Pacer -> Quality " << (lowered ? "lowered" : "raised") << " to " << (int)quality << " (" << getQualityName(quality) << ") since " << reason
+		<< ". Frames took " << std::fixed << std::setprecision(1) << getAverageFrameMs() << " ms of a " << getBudgetMs() << " ms budget" << std::defaultfloat << std::endl;
+}
+
+void FramePacer::onFrameStart()
+{
+	frameStart = Clock::now();
+	frameStarted = true;
+}
+
+void FramePacer::onFrameEnd()
+{
+	//The update is skipped while the director is paused, so there is nothing to time
+	if (!frameStarted)
+		return;
+	frameStarted = false;
+
+	//The very first frame has nothing before it, so it counts as one frame of the target
+	Clock::time_point now = Clock::now();
+	double workMs = std::chrono::duration<double, std::milli>(now - frameStart).count();
+	double frameSeconds = (lastFrameStart == Clock::time_point()) ? getBudgetMs() / 1000.0 : std::chrono::duration<double>(frameStart - lastFrameStart).count();
+	lastFrameStart = frameStart;
+
+	addFrame(workMs, frameSeconds);
+}
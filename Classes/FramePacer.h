@@ -0,0 +1,192 @@
+/*
+============================================================
+	Frame Pacer:
+		- Tells the director how often to draw a frame (30, 60 or 120 times a second, or as fast as it can) and keeps track of how long each frame actually takes to make
+			> The director sleeps for whatever is left of the frame once it is drawn, so the time between frames always looks like the target. The pacer only times the part where work is being done: from the start of the update to the end of the draw
+			> That 'work time' is compared against the frame budget. Ex: at 60fps, each frame has 16.7 ms to get everything done
+		- If the frames keep going over the budget, the quality is lowered one step at a time until they fit again. Each step keeps everything from the steps before it
+			> 1 - Capped Particles -> The mouse particles can only have a quarter as many particles alive
+			> 2 - No Debug Draw -> The physics debug drawing is skipped, even if it is turned on with the space bar
+			> 3 - Fewer Substeps -> The physics isn't split into substeps, and only a couple of steps are allowed per frame
+			> 4 - Throttled Spawns -> The held-down spawns (S, the middle mouse button and bursts) only make a quarter as many birds
+		- Once there is plenty of time left over again, the quality is raised back one step at a time
+			> Lowering happens after half a second over budget, raising only after a few seconds well under it. The gap stops the quality from flipping back and forth every frame
+		- Every change of target and quality is printed to the console
+
+	Usage:
+		- Call init() once in AppDelegate, after the window has been created
+		- The scene reads getQualityLevel() every frame and changes its own settings to match. The pacer doesn't know anything about the scene
+		- Use nextTarget() or setTarget() to change the frame rate, and setAdaptiveQuality(false) to keep the quality at full no matter what
+
+	Note:
+		- Nothing is timed when the display is headless, since there is no director drawing frames. The quality always stays at full so the benchmarks are comparable
+		- Uncapped still lowers the quality if the frames can't keep up with 60fps
+		- The graphics driver might still hold the frame rate to the monitor's (vsync), even when it is uncapped
+		- This class uses the Singleton design pattern
+			> There is a macro "PACER->" that provides a shortcut for getting the singleton instance
+============================================================
+*/
+
+#ifndef FRAMEPACER_H
+#define FRAMEPACER_H
+
+//Core Libraries
+#include <chrono>
+#include <string>
+
+//3rd Party Libraries
+#include "cocos2d.h"
+
+//Namespaces
+using namespace cocos2d;
+
+#define FRAME_PACER_UNCAPPED_BUDGET_MS (1000.0 / 60.0) //The budget the quality is held to when the frame rate is uncapped
+#define FRAME_PACER_LOWER_THRESHOLD 0.9 //The quality is lowered when the average work time is over this much of the budget
+#define FRAME_PACER_RAISE_THRESHOLD 0.6 //The quality is raised when the average work time is under this much of the budget
+#define FRAME_PACER_LOWER_SECONDS 0.5 //How long the frames have to be over the threshold before the quality is lowered
+#define FRAME_PACER_RAISE_SECONDS 3.0 //How long the frames have to be under the threshold before the quality is raised
+#define FRAME_PACER_SETTLE_SECONDS 1.0 //How long to wait after a change before looking at the frames again, so the average can catch up to the new quality
+#define FRAME_PACER_SMOOTHING 0.1 //How much of each new frame goes into the average. Lower is smoother but slower to react
+#define FRAME_PACER_PARTICLE_SCALE 0.25f //How much of the mouse particles are kept once they are capped
+#define FRAME_PACER_SPAWN_SCALE 0.25f //How many of the held-down spawns are kept once they are throttled
+#define FRAME_PACER_MAX_STEPS 2 //The most physics steps allowed per frame once the substeps are reduced
+
+/*
+	Frame Target Enum
+	- How often the director draws a frame
+
+	> FPS30, FPS60, FPS120 -> That many frames per second
+	> Uncapped -> As many frames as the game can make
+*/
+enum class FrameTarget
+{
+	FPS30,
+	FPS60,
+	FPS120,
+	Uncapped
+};
+
+/*
+	Quality Level Enum
+	- How much of the scene is cut back to fit the frame budget. Each level keeps everything cut by the levels before it
+
+	> Full -> Nothing is cut back
+	> CappedParticles -> The mouse particles are capped
+	> NoDebugDraw -> The physics debug drawing is skipped
+	> FewerSubsteps -> The physics substeps and steps per frame are reduced
+	> ThrottledSpawns -> The held-down spawns make fewer birds
+*/
+enum class QualityLevel
+{
+	Full,
+	CappedParticles,
+	NoDebugDraw,
+	FewerSubsteps,
+	ThrottledSpawns,
+
+	Lowest = ThrottledSpawns
+};
+
+
+
+/*
+	Frame Pacer Class:
+	> Setters
+		- Set the frame target
+		- Turn the adaptive quality on or off
+	> Getters
+		- Get the frame target and its budget
+		- Get the quality level
+		- Get the average work time
+		- Get a line of stats for the overlay
+	> Methods
+		- Start timing the director's frames
+		- Switch to the next frame target
+		- Add a frame's time by hand
+*/
+class FramePacer
+{
+protected:
+	//--- Constructor ---//
+	FramePacer(); //The constructor is protected so only one instance of this class can ever exist. This is called the singleton pattern.
+
+public:
+	//--- Destructor ---//
+	~FramePacer();
+
+
+
+	//--- Setters ---//
+	void setTarget(FrameTarget target); //Set how often the director draws a frame. The quality is judged against the new budget from here on
+	void setAdaptiveQuality(bool enabled); //Turn the quality changes on or off. On by default. Turning it off puts the quality back to full straight away
+
+
+
+	//--- Getters ---//
+	FrameTarget getTarget() const; //Get how often the director draws a frame
+	double getBudgetMs() const; //Get how long each frame has to get its work done, in milliseconds
+	bool getAdaptiveQuality() const; //Get if the quality is changed to fit the budget
+	QualityLevel getQualityLevel() const; //Get how much of the scene should be cut back right now
+	double getAverageFrameMs() const; //Get the average work time of the recent frames, in milliseconds
+	std::string getStatsText() const; //Get the target, the work time and the quality as a line of text. Used in the profiler overlay
+	static const char* getTargetName(FrameTarget target); //Get a target as text. Ex: "60 fps"
+	static const char* getQualityName(QualityLevel level); //Get a quality level as text. Ex: "No debug draw"
+
+
+
+	//--- Methods ---//
+	/*
+		Start pacing the frames. Call this once in AppDelegate, after the window has been created. Does nothing but remember the target if the display is headless
+
+		@param Target -> How often the director should draw a frame
+	*/
+	void init(FrameTarget target);
+
+	void nextTarget(); //Switch to the next target. 30 -> 60 -> 120 -> Uncapped -> 30
+
+	/*
+		Add a frame's timing. The director's events call this once a frame, but it can be called directly to try the pacer out without a window
+
+		@param WorkMs -> How long the frame spent working (updating and drawing), in milliseconds
+		@param FrameSeconds -> How long it has been since the last frame started, in seconds. Used to time how long the frames have been over or under the budget
+	*/
+	void addFrame(double workMs, double frameSeconds);
+
+
+
+	//--- Singleton Instance ---//
+	/*
+		Get the instance of the singleton. You shouldn't ever need to call this directly since the macro (PACER->) automatically calls it
+
+		@return Returns -> The singleton instance of this class. This is the ONLY instance of this class so intrefacing HAS to be done through this instance.
+	*/
+	static FramePacer* getInstance();
+
+private:
+	//--- Private Data ---//
+	typedef std::chrono::steady_clock Clock;
+
+	FrameTarget target; //How often the director draws a frame
+	bool adaptiveQuality; //If the quality is changed to fit the budget
+	QualityLevel quality; //How much of the scene is cut back right now
+	double averageMs; //The average work time of the recent frames. Less than 0 until the first frame comes in
+	double overBudgetTime; //How long the frames have been over the lowering threshold in a row, in seconds
+	double underBudgetTime; //How long the frames have been under the raising threshold in a row, in seconds
+	double settleTime; //How long until the frames are looked at again after a change, in seconds
+	bool attached; //If the director's events are being listened to
+	Clock::time_point frameStart; //When the current frame's update started
+	Clock::time_point lastFrameStart; //When the last frame's update started
+	bool frameStarted; //If the update has started this frame and the draw hasn't finished yet
+
+	//--- Utility Functions ---//
+	void setQuality(QualityLevel level, const char* reason); //Change the quality level and print the change
+	void onFrameStart(); //Called by the director right before the update
+	void onFrameEnd(); //Called by the director right after the draw, before the frame is shown
+
+	//--- Singleton Instance ---//
+	static FramePacer* inst; //The singleton instance. Ie: The only instance of this class that can ever exist
+};
+
+#define PACER FramePacer::getInstance() //Macro to make using the frame pacer easier. Automatically gets the singleton instance
+
+#endif
@@ -0,0 +1,244 @@
+#include "GlyphCache.h"
+#include "DisplayHandler.h"
+#include "MappedFile.h"
+
+//Core Libraries
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+//--- Static Variables ---//
+GlyphCache* GlyphCache::inst = nullptr;
+
+
+
+//--- Cached Font ---//
+//The font a cache's atlas belongs to. A label only asks its font for kerning, since every letter is already in the atlas
+class CachedGlyphFont : public Font
+{
+public:
+	CachedGlyphFont(const GlyphKerningPair* pairs, unsigned int count, int _lineHeight)
+	{
+		lineHeight = _lineHeight;
+		for (unsigned int i = 0; i < count; i++)
+			kerning[getKey(pairs[i].left, pairs[i].right)] = pairs[i].amount;
+	}
+
+	virtual FontAtlas* createFontAtlas() override
+	{
+		//The atlas is built by the glyph cache, never by the font
+		return nullptr;
+	}
+
+	virtual int* getHorizontalKerningForTextUTF32(const std::u32string& text, int& outNumLetters) const override
+	{
+		//The label deletes the array. Each letter gets the kerning between it and the letter before it, the same as FreeType fonts do
+		outNumLetters = (int)text.length();
+		if (kerning.empty() || text.empty())
+			return nullptr;
+
+		int* amounts = new int[text.length()];
+		amounts[0] = 0;
+		for (size_t i = 1; i < text.length(); i++)
+		{
+			std::unordered_map<uint32_t, int>::const_iterator pair = kerning.find(getKey(text[i - 1], text[i]));
+			amounts[i] = (pair != kerning.end()) ? pair->second : 0;
+		}
+		return amounts;
+	}
+
+	virtual int getFontMaxHeight() const override
+	{
+		return lineHeight;
+	}
+
+private:
+	std::unordered_map<uint32_t, int> kerning; //The kerning for each pair of letters that has any
+	int lineHeight;
+
+	static uint32_t getKey(char32_t left, char32_t right)
+	{
+		return ((uint32_t)left << 16) | ((uint32_t)right & 0xFFFF);
+	}
+};
+
+
+
+//--- Cached Glyph Label ---//
+//A label that draws from a glyph cache's atlas. It uses Cocos2D's distance field shader, and is scaled from the bake size to the size that was asked for
+class CachedGlyphLabel : public Label
+{
+public:
+	static CachedGlyphLabel* create(FontAtlas* atlas, float scale, const std::string& text)
+	{
+		CachedGlyphLabel* label = new (std::nothrow) CachedGlyphLabel();
+		if (!label)
+			return nullptr;
+
+		//Hand over the atlas the same way a distance field TTF label gets its own. This picks the distance field shader
+		//The label is then marked as a TTF label, since that is the only kind the shader is given its text colour for
+		label->setFontAtlas(atlas, true, false);
+		label->_currentLabelType = LabelType::TTF;
+		label->setFontScale(scale);
+		label->setString(text);
+		label->autorelease();
+		return label;
+	}
+
+	virtual ~CachedGlyphLabel()
+	{
+		//A label only gives its atlas back to Cocos2D's font atlas cache, which has never heard of this one. Give it back here instead
+		//The label still checks the cache for it afterwards, but it only compares the pointer so it doesn't matter if the atlas is gone by then
+		CC_SAFE_RELEASE(_fontAtlas);
+	}
+};
+
+
+
+//--- Constructor and Destructor ---//
+GlyphCache::GlyphCache()
+{
+	//Nothing is loaded until load() is called
+}
+
+GlyphCache::~GlyphCache()
+{
+	unload();
+}
+
+
+
+//--- Getters ---//
+bool GlyphCache::isLoaded(const std::string& fontPath) const
+{
+	return fonts.find(fontPath) != fonts.end();
+}
+
+std::string GlyphCache::getCachePath(const std::string& fontPath)
+{
+	//Only swap the extension if the dot is in the file name, not in a folder name
+	size_t dot = fontPath.find_last_of('.');
+	size_t slash = fontPath.find_last_of("/\\");
+	if (dot == std::string::npos || (slash != std::string::npos && dot < slash))
+		return fontPath + GLYPH_CACHE_EXTENSION;
+
+	return fontPath.substr(0, dot) + GLYPH_CACHE_EXTENSION;
+}
+
+
+
+//--- Methods ---//
+bool GlyphCache::load(const std::string& fontPath)
+{
+	if (isLoaded(fontPath))
+		return true;
+
+	//The texture has to go to the GPU, so there is nothing to load without one
+	if (DISPLAY->isHeadless())
+		return false;
+
+	std::chrono::steady_clock::time_point loadStart = std::chrono::steady_clock::now();
+	std::string cachePath = getCachePath(fontPath);
+	MappedFile file;
+	if (!FileUtils::getInstance()->isFileExist(cachePath) || !file.open(FileUtils::getInstance()->fullPathForFilename(cachePath)))
+	{
+		std::cout << "Glyph Cache -> No glyph cache at '" << cachePath << "', labels using '" << fontPath << "' are drawn by FreeType instead" << std::endl;
+		return false;
+	}
+
+	//Make sure it is actually a glyph cache, and that it isn't cut off
+	const unsigned char* bytes = file.mapAll();
+	GlyphCacheHeader header;
+	if (!bytes || file.getSize() < sizeof(header))
+		return false;
+	memcpy(&header, bytes, sizeof(header));
+	size_t entriesSize = header.glyphCount * sizeof(GlyphCacheEntry);
+	size_t kerningSize = header.kerningCount * sizeof(GlyphKerningPair);
+	size_t pixelsSize = (size_t)header.width * header.height;
+	if (memcmp(header.magic, GLYPH_CACHE_MAGIC, 4) != 0 || header.version != GLYPH_CACHE_VERSION || header.bakeSize == 0 || file.getSize() < sizeof(header) + entriesSize + kerningSize + pixelsSize)
+	{
+		std::cout << "ERROR: '" << cachePath << "' is not a glyph cache, or was baked by a different version of the baker. Labels using '" << fontPath << "' are drawn by FreeType instead" << std::endl;
+		return false;
+	}
+
+	//The entries and kerning pairs are copied out since the structs might not be lined up in memory where they sit in the file
+	std::vector<GlyphCacheEntry> entries(header.glyphCount);
+	std::vector<GlyphKerningPair> kerning(header.kerningCount);
+	memcpy(entries.data(), bytes + sizeof(header), entriesSize);
+	memcpy(kerning.data(), bytes + sizeof(header) + entriesSize, kerningSize);
+
+	//Send the distance field straight from the mapped file to the GPU. Only the alpha channel is used by the shader, so it is one byte per pixel
+	Texture2D* texture = new (std::nothrow) Texture2D();
+	const unsigned char* pixels = bytes + sizeof(header) + entriesSize + kerningSize;
+	if (!texture || !texture->initWithData(pixels, (ssize_t)pixelsSize, Texture2D::PixelFormat::A8, header.width, header.height, Size(header.width, header.height)))
+	{
+		std::cout << "ERROR: Could not create the texture for '" << cachePath << "'" << std::endl;
+		CC_SAFE_RELEASE(texture);
+		return false;
+	}
+
+	//Build the atlas. It keeps the font and the texture alive from here on
+	CachedGlyphFont* font = new CachedGlyphFont(kerning.data(), header.kerningCount, header.lineHeight);
+	FontAtlas* atlas = new FontAtlas(*font);
+	font->release();
+	atlas->setLineHeight(header.lineHeight);
+	atlas->addTexture(texture, 0);
+	texture->release();
+
+	for (unsigned int i = 0; i < entries.size(); i++)
+	{
+		const GlyphCacheEntry& entry = entries[i];
+		Rect rect = CC_RECT_PIXELS_TO_POINTS(Rect(entry.x, entry.y, entry.width, entry.height));
+
+		FontLetterDefinition definition = FontLetterDefinition();
+		definition.U = rect.origin.x;
+		definition.V = rect.origin.y;
+		definition.width = rect.size.width;
+		definition.height = rect.size.height;
+		definition.offsetX = entry.offsetX;
+		definition.offsetY = entry.offsetY;
+		definition.textureID = 0;
+		definition.validDefinition = true;
+		definition.xAdvance = entry.xAdvance;
+		atlas->addLetterDefinition((char32_t)entry.codepoint, definition);
+	}
+
+	CachedFont cached = { atlas, (float)header.bakeSize };
+	fonts[fontPath] = cached;
+
+	std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - loadStart;
+	std::cout << "Glyph Cache -> Loaded " << header.glyphCount << " letters of '" << fontPath << "' (" << header.width << "x" << header.height << ", baked at size " << header.bakeSize << ") in " << elapsed.count() << " ms" << std::endl;
+	return true;
+}
+
+Label* GlyphCache::createLabel(const std::string& text, const std::string& fontPath, float size)
+{
+	//Without a cache, it is just a normal label
+	std::unordered_map<std::string, CachedFont>::iterator cached = fonts.find(fontPath);
+	if (cached == fonts.end())
+		return Label::createWithTTF(text, fontPath, size);
+
+	//The letters are all baked at one size, so the label is scaled to the size that was asked for
+	return CachedGlyphLabel::create(cached->second.atlas, size / cached->second.bakeSize, text);
+}
+
+void GlyphCache::unload()
+{
+	for (std::unordered_map<std::string, CachedFont>::iterator it = fonts.begin(); it != fonts.end(); it++)
+		it->second.atlas->release();
+	fonts.clear();
+}
+
+
+
+//--- Singleton Instance ---//
+GlyphCache* GlyphCache::getInstance()
+{
+	//Generate the singleton if it hasn't been created yet
+	if (!inst)
+		inst = new GlyphCache();
+
+	//Return the singleton
+	return inst;
+}
@@ -0,0 +1,197 @@
+/*
+============================================================
+	Glyph Cache:
+		- Loads the glyph caches baked by the GlyphBaker tool (see proj.glyphs/main.cpp) and makes labels that draw their letters from them
+			> A normal TTF label has FreeType draw ('rasterise') every letter the first time it is used, at every font size separately. The title, the restart button and the profiler each needed their own set
+			> The baker draws every letter once at build time, and saves them all into one texture. Loading it is just reading the file, so no letters are drawn at startup at all
+		- The letters are stored as 'signed distance fields' instead of normal images. Each pixel says how far it is from the edge of the letter, instead of how covered it is
+			> Cocos2D's distance field shader turns that back into a sharp edge at any size, so ONE cache is used for every size of the font. A normal label needs a set of letters per size
+		- The caches are held for the whole game, so restarting the scene just makes new labels that point at the same texture
+		- If a font has no cache (ex: the Visual Studio project, which doesn't run the baker), createLabel() makes a normal TTF label instead
+			> Everything still works exactly the same, the letters are just drawn by FreeType again
+
+	File Format:
+		- All values are little-endian. Every platform this project targets is little-endian so the structs are read directly
+		- One GlyphCacheHeader, then one GlyphCacheEntry per letter, then one GlyphKerningPair per pair of letters that sit closer (or further apart) than normal, then the texture
+		- The texture is one byte per pixel, top row first. 128 is the edge of a letter, higher is inside it, lower is outside it
+
+	Usage:
+		- Call load() once at startup with the path of the '.ttf' file. The cache is the '.glyphs' file next to it with the same name
+		- Make labels with createLabel() instead of Label::createWithTTF(). It takes the same text, font and size
+
+	Note:
+		- Only the letters that were baked can be drawn. The baker bakes every printable ASCII character by default, which covers every label in the demo
+		- Outlines and glows need FreeType, so use Label::createWithTTF() for labels that need them. Shadows work fine
+		- Very small text (ex: 12) is a bit sharper than FreeType's, since the edge is only smoothed over a fraction of a pixel
+		- This class uses the Singleton design pattern
+			> There is a macro "GLYPHS->" that provides a shortcut for getting the singleton instance
+============================================================
+*/
+
+#ifndef GLYPHCACHE_H
+#define GLYPHCACHE_H
+
+//Core Libraries
+#include <string>
+#include <unordered_map>
+#include <stdint.h>
+
+//3rd Party Libraries
+#include "cocos2d.h"
+
+//Namespaces
+using namespace cocos2d;
+
+//File format constants
+#define GLYPH_CACHE_MAGIC "CDGC" //The first 4 bytes of every glyph cache. Stands for Cocos Demo Glyph Cache
+#define GLYPH_CACHE_VERSION 1 //Bump this whenever the layout of the header, the entries or the kerning pairs changes
+#define GLYPH_CACHE_EXTENSION ".glyphs" //The extension glyph caches are saved with. They sit next to where the font is, with the same name
+
+/*
+	Glyph Cache Header
+	- The first 24 bytes of a glyph cache
+
+	> Magic -> Always GLYPH_CACHE_MAGIC. Used to make sure the file is actually a glyph cache
+	> Version -> The version of the format the file was written with
+	> GlyphCount -> How many entries come after the header
+	> Width, Height -> The size of the texture in pixels
+	> BakeSize -> The font size the letters were baked at. Every size is drawn by scaling from this one
+	> Spread -> How many pixels out from the edge of a letter the distance goes before it is cut off, at the bake size
+	> LineHeight -> How far apart lines of text are, at the bake size
+	> KerningCount -> How many kerning pairs come after the entries
+*/
+struct GlyphCacheHeader
+{
+	char magic[4];
+	uint16_t version;
+	uint16_t glyphCount;
+	uint16_t width;
+	uint16_t height;
+	uint16_t bakeSize;
+	uint16_t spread;
+	uint16_t lineHeight;
+	uint16_t reserved;
+	uint32_t kerningCount;
+};
+
+/*
+	Glyph Cache Entry
+	- One letter. 24 bytes each
+
+	> Codepoint -> The letter. Ex: 65 for 'A'
+	> X, Y -> The top left corner of the letter in the texture, in pixels. Y goes down
+	> Width, Height -> The size of the letter in the texture, including the spread around it. 0 for letters with nothing to draw, like a space
+	> OffsetX -> How far right of the pen the letter starts
+	> OffsetY -> How far below the top of the line the letter starts
+	> XAdvance -> How far the pen moves right after the letter
+*/
+struct GlyphCacheEntry
+{
+	uint32_t codepoint;
+	uint16_t x;
+	uint16_t y;
+	uint16_t width;
+	uint16_t height;
+	float offsetX;
+	float offsetY;
+	int16_t xAdvance;
+	uint16_t reserved;
+};
+
+/*
+	Glyph Kerning Pair
+	- How much closer two letters sit when one comes right after the other. 8 bytes each. Ex: the 'V' in "AV" tucks in under the 'A'
+
+	> Left, Right -> The two letters, in the order they appear
+	> Amount -> How far the right letter moves, at the bake size. Negative means closer
+*/
+struct GlyphKerningPair
+{
+	uint16_t left;
+	uint16_t right;
+	int16_t amount;
+	uint16_t reserved;
+};
+
+static_assert(sizeof(GlyphCacheHeader) == 24, "The glyph cache header must be exactly 24 bytes!");
+static_assert(sizeof(GlyphCacheEntry) == 24, "A glyph cache entry must be exactly 24 bytes!");
+static_assert(sizeof(GlyphKerningPair) == 8, "A glyph kerning pair must be exactly 8 bytes!");
+
+
+
+/*
+	Glyph Cache Class:
+	> Getters
+		- Get if a font's cache was loaded
+		- Get where a font's cache would be
+	> Methods
+		- Load a font's cache
+		- Make a label
+*/
+class GlyphCache
+{
+protected:
+	//--- Constructor ---//
+	GlyphCache(); //The constructor is protected so only one instance of this class can ever exist. This is called the singleton pattern.
+
+public:
+	//--- Destructor ---//
+	~GlyphCache();
+
+
+
+	//--- Getters ---//
+	bool isLoaded(const std::string& fontPath) const; //Get if a font's cache was loaded. False means its labels are drawn by FreeType
+	static std::string getCachePath(const std::string& fontPath); //Get where a font's cache would be. The same path with the extension swapped. Ex: "Fonts/arial.glyphs"
+
+
+
+	//--- Methods ---//
+	/*
+		Load the cache for a font. Call this on the main thread, once the window has been created, since the texture is sent to the GPU straight away
+
+		@param FontPath -> The path of the '.ttf' file, starting in the Resources folder. Ex: "Fonts/arial.ttf"
+		@return Returns -> True if the cache was loaded (or already was). False if it is missing or broken, or if the display is headless, in which case the font's labels are drawn by FreeType
+	*/
+	bool load(const std::string& fontPath);
+
+	/*
+		Make a label. Use this instead of Label::createWithTTF()
+
+		@param Text -> The text to show
+		@param FontPath -> The path of the '.ttf' file, starting in the Resources folder. Ex: "Fonts/arial.ttf"
+		@param Size -> The font size
+		@return Returns -> The label, autoreleased like any other. It draws from the cache if the font's cache was loaded, otherwise it is a normal TTF label
+	*/
+	Label* createLabel(const std::string& text, const std::string& fontPath, float size);
+
+	void unload(); //Let go of every cache. Labels already made from them keep working, but new labels are drawn by FreeType
+
+
+
+	//--- Singleton Instance ---//
+	/*
+		Get the instance of the singleton. You shouldn't ever need to call this directly since the macro (GLYPHS->) automatically calls it
+
+		@return Returns -> The singleton instance of this class. This is the ONLY instance of this class so intrefacing HAS to be done through this instance.
+	*/
+	static GlyphCache* getInstance();
+
+private:
+	//--- Private Data ---//
+	//A font with a loaded cache
+	struct CachedFont
+	{
+		FontAtlas* atlas; //Every letter and the texture they are in. Shared by every label made from the font
+		float bakeSize; //The font size the letters were baked at
+	};
+
+	std::unordered_map<std::string, CachedFont> fonts; //Every loaded cache, by the path of its font
+
+	//--- Singleton Instance ---//
+	static GlyphCache* inst; //The singleton instance. Ie: The only instance of this class that can ever exist
+};
+
+#define GLYPHS GlyphCache::getInstance() //Macro to make using the glyph cache easier. Automatically gets the singleton instance
+
+#endif
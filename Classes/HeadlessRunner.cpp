@@ -0,0 +1,272 @@
+#include "HeadlessRunner.h"
+#include "DemoScene.h"
+#include "InputHandler.h"
+#include "Profiler.h"
+
+//Core Libraries
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+
+//Shorthand for the clock used to time each part of the frame
+typedef std::chrono::high_resolution_clock Clock;
+
+//Get the number of milliseconds between two points in time
+static double millisecondsBetween(Clock::time_point start, Clock::time_point end)
+{
+	return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+
+
+//--- Constructors and Destructors ---//
+HeadlessRunner::HeadlessRunner(float _fixedDeltaTime)
+{
+	//Init the private data
+	fixedDeltaTime = _fixedDeltaTime;
+	scene = nullptr;
+	demoScene = nullptr;
+	nextScriptEvent = 0;
+	currentFrame = 0;
+}
+
+HeadlessRunner::~HeadlessRunner()
+{
+	//Stop the scene the same way the director does when a scene is replaced, then let go of it
+	if (scene)
+	{
+		scene->onExitTransitionDidStart();
+		scene->onExit();
+		scene->cleanup();
+		scene->release();
+	}
+
+	//Clean up the pointers
+	scene = nullptr;
+	demoScene = nullptr;
+}
+
+
+
+//--- Setters ---//
+void HeadlessRunner::setScript(const std::vector<ScriptedInput>& _script)
+{
+	//Copy the script and sort it by frame. stable_sort keeps events on the same frame in the order they were given
+	script = _script;
+	std::stable_sort(script.begin(), script.end(), [](const ScriptedInput& a, const ScriptedInput& b) { return a.frame < b.frame; });
+
+	//Skip any events for frames that have already been run
+	nextScriptEvent = 0;
+	while (nextScriptEvent < script.size() && script[nextScriptEvent].frame < currentFrame)
+		nextScriptEvent++;
+}
+
+
+
+//--- Getters ---//
+Scene* HeadlessRunner::getScene() const
+{
+	return scene;
+}
+
+DemoScene* HeadlessRunner::getDemoScene() const
+{
+	return demoScene;
+}
+
+unsigned int HeadlessRunner::getCurrentFrame() const
+{
+	return currentFrame;
+}
+
+const std::vector<FrameTiming>& HeadlessRunner::getFrameTimings() const
+{
+	return frameTimings;
+}
+
+
+
+//--- Methods ---//
+bool HeadlessRunner::init()
+{
+	//Build the scene exactly like AppDelegate does
+	scene = DemoScene::createScene();
+	if (!scene)
+		return false;
+
+	//Hold on to the scene. Normally the director would do this with runWithScene()
+	scene->retain();
+
+	//Find the DemoScene layer inside the scene
+	for (Node* child : scene->getChildren())
+	{
+		demoScene = dynamic_cast<DemoScene*>(child);
+		if (demoScene)
+			break;
+	}
+	if (!demoScene)
+		return false;
+
+	//Start the scene running. This is what the director does when it switches to a new scene. Bodies are only added to the physics world once their node is running
+	scene->onEnter();
+	scene->onEnterTransitionDidFinish();
+
+	//Clear out anything that was autoreleased while building the scene
+	PoolManager::getInstance()->getCurrentPool()->clear();
+
+	return true;
+}
+
+void HeadlessRunner::run(unsigned int numFrames)
+{
+	//Make room for the new timings up front so the vector doesn't grow in the middle of the run
+	frameTimings.reserve(frameTimings.size() + numFrames);
+
+	//Get the pieces of the engine that would normally be ticked by the director
+	ActionManager* actionManager = Director::getInstance()->getActionManager();
+
+	for (unsigned int i = 0; i < numFrames; i++)
+	{
+		FrameTiming timing;
+		Clock::time_point frameStart = Clock::now();
+
+		//Inject this frame's input before the scene updates, just like the event listeners would
+		injectScriptForFrame();
+
+		//Tick the actions first. The director's scheduler runs the action manager before any scheduled update() functions
+		Clock::time_point actionStart = Clock::now();
+		actionManager->update(fixedDeltaTime);
+		Clock::time_point actionEnd = Clock::now();
+
+		//Run the scene's game loop. The scene steps the physics itself at the end of its update
+		demoScene->update(fixedDeltaTime);
+		Clock::time_point updateEnd = Clock::now();
+
+		//Clear the autorelease pool. The director does this at the end of every frame so all of the actions created this frame are cleaned up
+		PoolManager::getInstance()->getCurrentPool()->clear();
+		Clock::time_point frameEnd = Clock::now();
+
+		//Store the timings for this frame. The physics step happens inside the update, so it is taken back out of the update time
+		timing.actions = millisecondsBetween(actionStart, actionEnd);
+		timing.physics = demoScene->getLastPhysicsStepTime();
+		timing.update = millisecondsBetween(actionEnd, updateEnd) - timing.physics;
+		timing.total = millisecondsBetween(frameStart, frameEnd);
+		frameTimings.push_back(timing);
+
+		//There is no director drawing frames, so tell the profiler when each one ends
+		PROFILE_FRAME_END();
+
+		currentFrame++;
+	}
+}
+
+void HeadlessRunner::clearTimings()
+{
+	frameTimings.clear();
+}
+
+TimingSummary HeadlessRunner::summarize(std::vector<double> samples)
+{
+	TimingSummary summary = { 0.0, 0.0, 0.0, 0.0, 0.0 };
+	if (samples.empty())
+		return summary;
+
+	//Sort the samples so the percentiles can be read straight out of the list
+	std::sort(samples.begin(), samples.end());
+
+	//Use the nearest-rank method. Ex: the 95th percentile is the sample 95% of the way through the sorted list
+	auto percentile = [&samples](double p) -> double
+	{
+		unsigned int rank = (unsigned int)std::ceil(p * samples.size());
+		if (rank < 1)
+			rank = 1;
+		return samples[rank - 1];
+	};
+
+	summary.p50 = percentile(0.50);
+	summary.p95 = percentile(0.95);
+	summary.p99 = percentile(0.99);
+	summary.max = samples.back();
+
+	double sum = 0.0;
+	for (unsigned int i = 0; i < samples.size(); i++)
+		sum += samples[i];
+	summary.mean = sum / samples.size();
+
+	return summary;
+}
+
+void HeadlessRunner::printReport(std::ostream& output) const
+{
+	//Split the frame timings into one list per part of the frame
+	std::vector<double> update, physics, actions, total;
+	update.reserve(frameTimings.size());
+	physics.reserve(frameTimings.size());
+	actions.reserve(frameTimings.size());
+	total.reserve(frameTimings.size());
+	for (unsigned int i = 0; i < frameTimings.size(); i++)
+	{
+		update.push_back(frameTimings[i].update);
+		physics.push_back(frameTimings[i].physics);
+		actions.push_back(frameTimings[i].actions);
+		total.push_back(frameTimings[i].total);
+	}
+
+	//Print one line per part of the frame
+	const char* names[4] = { "update", "physics", "actions", "total" };
+	const std::vector<double>* lists[4] = { &update, &physics, &actions, &total };
+
+	output << "Frames: " << frameTimings.size() << " (dt = " << fixedDeltaTime << "s)" << std::endl;
+	output << std::left << std::setw(10) << "section" << std::right
+		<< std::setw(10) << "p50 ms" << std::setw(10) << "p95 ms" << std::setw(10) << "p99 ms"
+		<< std::setw(10) << "max ms" << std::setw(10) << "mean ms" << std::endl;
+
+	output << std::fixed << std::setprecision(3);
+	for (unsigned int i = 0; i < 4; i++)
+	{
+		TimingSummary summary = summarize(*lists[i]);
+		output << std::left << std::setw(10) << names[i] << std::right
+			<< std::setw(10) << summary.p50 << std::setw(10) << summary.p95 << std::setw(10) << summary.p99
+			<< std::setw(10) << summary.max << std::setw(10) << summary.mean << std::endl;
+	}
+	output.unsetf(std::ios_base::floatfield);
+}
+
+
+
+//--- Utility Functions ---//
+void HeadlessRunner::injectScriptForFrame()
+{
+	//Queue every event for this frame, just like the real event listeners do. The scene applies them at the start of its update
+	while (nextScriptEvent < script.size() && script[nextScriptEvent].frame == currentFrame)
+	{
+		const ScriptedInput& scripted = script[nextScriptEvent];
+		InputEvent event = { InputEvent::MouseMove, scripted.code, scripted.position.x, scripted.position.y, InputHandler::getTimestamp() };
+		switch (scripted.type)
+		{
+		case ScriptedInput::MouseMove:
+			event.type = InputEvent::MouseMove;
+			break;
+
+		case ScriptedInput::MouseDown:
+			event.type = InputEvent::MouseDown;
+			break;
+
+		case ScriptedInput::MouseUp:
+			event.type = InputEvent::MouseUp;
+			break;
+
+		case ScriptedInput::KeyDown:
+			event.type = InputEvent::KeyDown;
+			break;
+
+		case ScriptedInput::KeyUp:
+			event.type = InputEvent::KeyUp;
+			break;
+		}
+
+		INPUTS->queueEvent(event);
+		nextScriptEvent++;
+	}
+}
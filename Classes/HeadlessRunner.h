@@ -0,0 +1,181 @@
+/*
+============================================================
+	Headless Runner:
+		- Runs a DemoScene without a window, a GPU or the Director's main loop
+		- Every frame is exactly the same length (a fixed timestep) so two runs with the same script always do the same thing
+		- Input comes from a script instead of the user. The script is a list of mouse / keyboard events and the frame they happen on
+		- The time spent in the scene's update(), the physics step and the action manager is measured every frame so it can be reported as percentiles
+
+	Usage:
+		- Call DISPLAY->initHeadless() and INPUTS->init() first, then init() on the runner
+		- Give the runner a script with setScript() and call run() with the number of frames you want
+		- Use printReport() to output the timings, or getFrameTimings() to look at them yourself
+		- See proj.benchmark/main.cpp for an example
+============================================================
+*/
+
+#ifndef HEADLESSRUNNER_H
+#define HEADLESSRUNNER_H
+
+//Core Libraries
+#include <vector>
+#include <iostream>
+
+//3rd Party Libraries
+#include "cocos2d.h"
+
+//Forward Declarations
+class DemoScene;
+
+//Namespaces
+using namespace cocos2d;
+
+/*
+	Scripted Input
+	- A single input event in the script given to the headless runner
+	- The event is queued in the input handler at the start of the given frame and applied when the scene updates
+
+	> Frame -> The frame the event happens on. The first frame is 0
+	> Type -> What kind of event it is
+	> Code -> The mouse button or key code for button events. Ignored for mouse moves
+	> Position -> The new mouse position for mouse moves, from the BOTTOM LEFT. Ignored for button events
+*/
+struct ScriptedInput
+{
+	enum Type
+	{
+		MouseMove,
+		MouseDown,
+		MouseUp,
+		KeyDown,
+		KeyUp
+	};
+
+	unsigned int frame;
+	Type type;
+	int code;
+	Vec2 position;
+};
+
+/*
+	Frame Timing
+	- How long each part of a single frame took, in milliseconds
+*/
+struct FrameTiming
+{
+	double update; //DemoScene::update(), not counting the physics step
+	double physics; //Stepping the physics world. DemoScene does this at the end of its update and reports how long it took
+	double actions; //Ticking every running action
+	double total; //The whole frame, including the script and the autorelease pool
+};
+
+/*
+	Timing Summary
+	- Percentiles of a list of timings, in milliseconds
+*/
+struct TimingSummary
+{
+	double p50;
+	double p95;
+	double p99;
+	double max;
+	double mean;
+};
+
+
+
+/*
+	Headless Runner Class:
+	> Setters
+		- Set the input script
+	> Getters
+		- Get the scene, the frame timings and the current frame
+	> Methods
+		- Init
+		- Run a number of frames
+		- Clear the timings
+		- Summarize a list of timings
+		- Print the report
+*/
+class HeadlessRunner
+{
+public:
+	//--- Constructors and Destructors ---//
+	/*
+		Create the runner. Nothing is built until init() is called
+
+		@param FixedDeltaTime (optional) -> The length of every frame, in seconds. Defaulted to 1/60th of a second
+	*/
+	HeadlessRunner(float fixedDeltaTime = 1.0f / 60.0f);
+	~HeadlessRunner();
+
+
+
+	//--- Setters ---//
+	/*
+		Set the input script. The events don't have to be in order, they get sorted by frame
+
+		@param Script -> The list of events to inject
+	*/
+	void setScript(const std::vector<ScriptedInput>& script);
+
+
+
+	//--- Getters ---//
+	Scene* getScene() const; //Get the scene that holds the DemoScene. This is what owns the physics world
+	DemoScene* getDemoScene() const; //Get the DemoScene being run
+	unsigned int getCurrentFrame() const; //Get the number of frames that have been run so far
+	const std::vector<FrameTiming>& getFrameTimings() const; //Get the timings of every frame run since the last clearTimings()
+
+
+
+	//--- Methods ---//
+	/*
+		Build the scene and start it running. The display must already be headless and the input handler must already be init
+
+		@return Returns -> True if the scene was built. False if not
+	*/
+	bool init();
+
+	/*
+		Run a number of frames. Can be called more than once, the frames carry on from where the last call stopped
+
+		@param NumFrames -> How many frames to run
+	*/
+	void run(unsigned int numFrames);
+
+	/*
+		Throw away the timings recorded so far. Useful to ignore a warm-up period (ex: while the birds are being spawned)
+	*/
+	void clearTimings();
+
+	/*
+		Work out the percentiles of a list of timings
+
+		@param Samples -> The timings, in milliseconds. Copied since it has to be sorted
+		@return Returns -> The percentiles, max and mean of the samples. All zero if there are no samples
+	*/
+	static TimingSummary summarize(std::vector<double> samples);
+
+	/*
+		Output the percentiles for the update, physics, action and total timings
+
+		@param Output -> Where to print the report. Ex: std::cout
+	*/
+	void printReport(std::ostream& output) const;
+
+private:
+	//--- Private Data ---//
+	float fixedDeltaTime; //The length of every frame, in seconds
+	Scene* scene; //The scene being run. Retained by the runner since there is no director holding on to it
+	DemoScene* demoScene; //The DemoScene layer inside the scene
+	std::vector<ScriptedInput> script; //The input events, sorted by frame
+	unsigned int nextScriptEvent; //The index of the next event in the script that hasn't been queued yet
+	unsigned int currentFrame; //The number of frames run so far
+	std::vector<FrameTiming> frameTimings; //The timings of every frame since the last clearTimings()
+
+	//--- Utility Functions ---//
+	void injectScriptForFrame(); //Queue every event in the script that happens on the current frame
+};
+
+#endif
@@ -1,5 +1,103 @@
 #include "InputHandler.h"
 #include "DisplayHandler.h"
+#include "InputRecorder.h"
+#include "InputReplayer.h"
+#include "Profiler.h"
+
+//Core Libraries
+#include <chrono>
+#include <iostream>
+
+//SIMD
+//The per-frame bit-plane work is done 128 bits at a time when SSE2 is available (all x64 CPUs and any x86 CPU built with /arch:SSE2, which is the default in Visual Studio)
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define INPUT_USE_SSE2 1
+#include <emmintrin.h>
+#else
+#define INPUT_USE_SSE2 0
+#endif
+
+//Make sure every key fits before the mouse buttons start
+static_assert((NUM_KEY_CODES) <= MOUSE_BIT_OFFSET, "There are more key codes than bits set aside for the keyboard!");
+static_assert(MOUSE_BIT_OFFSET + (NUM_MOUSE_BUTTONS) <= INPUT_BIT_WORDS * 64, "There are more mouse buttons than bits set aside for the mouse!");
+
+//Get the bit a key or mouse button is stored in
+#define KEY_BIT(key) ((int)(key))
+#define MOUSE_BIT(button) (MOUSE_BIT_OFFSET + (int)(button) + 1) //+1 to compensate for the enum in Cocos starting at -1
+
+
+
+//--- Bit-Plane Functions ---//
+#if INPUT_USE_SSE2
+//Load or store one half (128 bits) of a bit-plane
+//These are the unaligned versions since the input handler is made with new, which only promises 8 byte alignment on 32-bit Windows. They are just as fast as the aligned ones when the data happens to be aligned anyway
+static inline __m128i loadHalf(const InputBitPlane& plane, unsigned int half) { return _mm_loadu_si128((const __m128i*)plane.words + half); }
+static inline void storeHalf(InputBitPlane& plane, unsigned int half, __m128i bits) { _mm_storeu_si128((__m128i*)plane.words + half, bits); }
+#endif
+
+//Check if any button was pressed (PRESSED = down & (~lastDown | changed)) across all of the words at once
+static bool anyBitsPressed(const InputSnapshot& buttons)
+{
+#if INPUT_USE_SSE2
+	__m128i lowHalf = _mm_and_si128(loadHalf(buttons.down, 0), _mm_or_si128(_mm_andnot_si128(loadHalf(buttons.lastDown, 0), _mm_set1_epi32(-1)), loadHalf(buttons.changed, 0)));
+	__m128i highHalf = _mm_and_si128(loadHalf(buttons.down, 1), _mm_or_si128(_mm_andnot_si128(loadHalf(buttons.lastDown, 1), _mm_set1_epi32(-1)), loadHalf(buttons.changed, 1)));
+	__m128i combined = _mm_or_si128(lowHalf, highHalf);
+	return _mm_movemask_epi8(_mm_cmpeq_epi8(combined, _mm_setzero_si128())) != 0xFFFF;
+#else
+	uint64_t combined = 0;
+	for (unsigned int i = 0; i < INPUT_BIT_WORDS; i++)
+		combined |= buttons.down.words[i] & (~buttons.lastDown.words[i] | buttons.changed.words[i]);
+	return combined != 0;
+#endif
+}
+
+//Check if any button was released (RELEASED = ~down & (lastDown | changed)) across all of the words at once
+static bool anyBitsReleased(const InputSnapshot& buttons)
+{
+#if INPUT_USE_SSE2
+	__m128i lowHalf = _mm_andnot_si128(loadHalf(buttons.down, 0), _mm_or_si128(loadHalf(buttons.lastDown, 0), loadHalf(buttons.changed, 0)));
+	__m128i highHalf = _mm_andnot_si128(loadHalf(buttons.down, 1), _mm_or_si128(loadHalf(buttons.lastDown, 1), loadHalf(buttons.changed, 1)));
+	__m128i combined = _mm_or_si128(lowHalf, highHalf);
+	return _mm_movemask_epi8(_mm_cmpeq_epi8(combined, _mm_setzero_si128())) != 0xFFFF;
+#else
+	uint64_t combined = 0;
+	for (unsigned int i = 0; i < INPUT_BIT_WORDS; i++)
+		combined |= ~buttons.down.words[i] & (buttons.lastDown.words[i] | buttons.changed.words[i]);
+	return combined != 0;
+#endif
+}
+
+//Check if any button is down right now
+static bool anyBitsDown(const InputSnapshot& buttons)
+{
+#if INPUT_USE_SSE2
+	__m128i combined = _mm_or_si128(loadHalf(buttons.down, 0), loadHalf(buttons.down, 1));
+	return _mm_movemask_epi8(_mm_cmpeq_epi8(combined, _mm_setzero_si128())) != 0xFFFF;
+#else
+	uint64_t combined = 0;
+	for (unsigned int i = 0; i < INPUT_BIT_WORDS; i++)
+		combined |= buttons.down.words[i];
+	return combined != 0;
+#endif
+}
+
+//Move on to the next frame. Whatever is down now becomes what was down last frame and nothing has changed yet
+//This is what turns PRESSED into HELD and RELEASED into IDLE for every button at once
+static void advanceBitPlanes(InputSnapshot& buttons)
+{
+#if INPUT_USE_SSE2
+	storeHalf(buttons.lastDown, 0, loadHalf(buttons.down, 0));
+	storeHalf(buttons.lastDown, 1, loadHalf(buttons.down, 1));
+	storeHalf(buttons.changed, 0, _mm_setzero_si128());
+	storeHalf(buttons.changed, 1, _mm_setzero_si128());
+#else
+	for (unsigned int i = 0; i < INPUT_BIT_WORDS; i++)
+	{
+		buttons.lastDown.words[i] = buttons.down.words[i];
+		buttons.changed.words[i] = 0;
+	}
+#endif
+}
 
 //--- Static Variables ---//
 InputHandler* InputHandler::inst = 0;
@@ -17,6 +115,23 @@ InputHandler::InputHandler()
 	mousePosition = Vec2(0.0f, 0.0f);
 	scrollValue = 0.0f;
 	horizontalScrollValue = 0.0f;
+
+	//Nothing has been dropped from the queue yet
+	droppedEvents = 0;
+
+	//Nothing is being recorded or replayed yet
+	frameIndex = 0;
+	recorder = nullptr;
+	replayer = nullptr;
+	replaying = false;
+
+	//Start with every mouse button and key idle. All of the bits are 0
+	for (unsigned int i = 0; i < INPUT_BIT_WORDS; i++)
+	{
+		buttons.down.words[i] = 0;
+		buttons.lastDown.words[i] = 0;
+		buttons.changed.words[i] = 0;
+	}
 }
 
 InputHandler::~InputHandler()
@@ -34,6 +149,13 @@ InputHandler::~InputHandler()
 	//Clean up the mouse and keyboard listener pointers
 	mouseListener = nullptr;
 	keyboardListener = nullptr;
+
+	//Finish the recording so the file is complete, then clean up the recorder and replayer
+	stopRecording();
+	delete recorder;
+	delete replayer;
+	recorder = nullptr;
+	replayer = nullptr;
 }
 
 
@@ -56,20 +178,20 @@ Vec2 InputHandler::getMousePosition() const
 
 bool InputHandler::getMouseButtonPress(MouseButton button) const
 {
-	//If the mouse button requested is set to pressed, it was pressed this exact frame. +1 since the first mouse button is set to -1
-	return (mouseStates[(int)button + 1] == InputState::Pressed);
+	//If the mouse button requested is set to pressed, it was pressed this exact frame
+	return isButtonPressed(MOUSE_BIT(button));
 }
 
 bool InputHandler::getMouseButtonRelease(MouseButton button) const
 {
-	//If the mouse button requested is set to released, it was released this exact frame. +1 since the first mouse button is set to -1
-	return (mouseStates[(int)button + 1] == InputState::Released);
+	//If the mouse button requested is set to released, it was released this exact frame
+	return isButtonReleased(MOUSE_BIT(button));
 }
 
 bool InputHandler::getMouseButton(MouseButton button) const
 {
 	//If the mouse button requested is set to pressed OR set to held, it is currently down and so should return true
-	return (mouseStates[(int)button + 1] == InputState::Pressed || mouseStates[(int)button + 1] == InputState::Held);
+	return isButtonDown(MOUSE_BIT(button));
 }
 
 float InputHandler::getMouseScroll() const
@@ -90,87 +212,196 @@ float InputHandler::getHorizontalMouseScroll() const
 bool InputHandler::getKeyPress(KeyCode key) const
 {
 	//If the key requested is set to pressed, it was pressed this exact frame
-	return (keyboardStates[(int)key] == InputState::Pressed);
+	return isButtonPressed(KEY_BIT(key));
 }
 
 bool InputHandler::getKeyRelease(KeyCode key) const
 {
 	//If the key requested is set to released, it was released this exact frame
-	return (keyboardStates[(int)key] == InputState::Released);
+	return isButtonReleased(KEY_BIT(key));
 }
 
 bool InputHandler::getKey(KeyCode key) const
 {
 	//If the key requested is set to pressed OR set to held, it is currently down and so should return true
-	return (keyboardStates[(int)key] == InputState::Pressed || keyboardStates[(int)key] == InputState::Held);
+	return isButtonDown(KEY_BIT(key));
 }
 
 
 //Any 
 bool InputHandler::getAnyButtonPress() const
 {
-	//Loop through all of the mouse buttons. If any of them are pressed, immediately return true
-	for (unsigned int i = 0; i < NUM_MOUSE_BUTTONS; i++)
-	{
-		//Immediately return true upon finding a single button that was pressed
-		if (mouseStates[i] == InputState::Pressed)
-			return true;
-	}
+	//Check every key and mouse button at once using the bit-planes. This is only a few instructions so there is no need to loop through them all
+	return anyBitsPressed(buttons);
+}
+
+bool InputHandler::getAnyButtonRelease() const
+{
+	//Check every key and mouse button at once using the bit-planes
+	return anyBitsReleased(buttons);
+}
+
+bool InputHandler::getAnyButton() const
+{
+	//If any bit in the down plane is set, something is currently down
+	return anyBitsDown(buttons);
+}
+
+
+//Snapshot
+InputSnapshot InputHandler::getSnapshot() const
+{
+	//Return a copy of the bit-planes
+	return buttons;
+}
+
 
-	//If no mouse buttons were pressed, move to checking the keyboard. If any key was pressed, immediately return true
-	for (unsigned int i = 0; i < NUM_KEY_CODES; i++)
+
+//--- Input Injection ---//
+void InputHandler::injectMouseMove(Vec2 position)
+{
+	//Store the cursor position. It is already flipped so (0, 0) is the bottom left
+	mousePosition = position;
+}
+
+void InputHandler::injectMouseButton(MouseButton button, bool down)
+{
+	//Set the appropriate mouse button to be pressed or released
+	setButtonDown(MOUSE_BIT(button), down);
+}
+
+void InputHandler::injectMouseScroll(float scrollX, float scrollY)
+{
+	//Add on the scroll amounts. If the wheel moves more than once in a frame, all of the movement counts. They are reset to 0 in clearForNextFrame()
+	scrollValue += scrollY;
+	horizontalScrollValue += scrollX;
+}
+
+void InputHandler::injectKey(KeyCode key, bool down)
+{
+	//Set the appropriate key to be considered pressed or released
+	setButtonDown(KEY_BIT(key), down);
+
+	//Exit if the escape key was pressed and the flag is set to true
+	if (down && exitOnEscape && key == KeyCode::KEY_ESCAPE)
+		Director::getInstance()->end();
+}
+
+
+
+//--- Event Queue ---//
+bool InputHandler::queueEvent(const InputEvent& event)
+{
+	//Add the event to the queue. If it is full, count the event as dropped so it shows up when debugging
+	if (!eventQueue.push(event))
 	{
-		//Immediately return true upon finding a single button that was pressed
-		if (keyboardStates[i] == InputState::Pressed)
-			return true;
+		droppedEvents++;
+		return false;
 	}
 
-	//Return false if absolutely no buttons were pressed and so it reached this point
-	return false;
+	return true;
 }
 
-bool InputHandler::getAnyButtonRelease() const
+void InputHandler::processQueuedEvents()
 {
-	//Loop through all of the mouse buttons. If any of them are released, immediately return true
-	for (unsigned int i = 0; i < NUM_MOUSE_BUTTONS; i++)
+	PROFILE_SCOPE("Input::processQueuedEvents");
+
+	//If a recording is being played back, apply its events for this frame instead of the live input
+	if (replaying)
 	{
-		//Immediately return true upon finding a single button that was released
-		if (mouseStates[i] == InputState::Released)
-			return true;
+		InputEvent replayedEvent;
+		while (replayer->nextEvent(frameIndex, replayedEvent))
+			applyEvent(replayedEvent);
+
+		//Go back to the live input once the whole recording has been played
+		if (replayer->isFinished())
+			stopReplay();
 	}
 
-	//If no mouse buttons were pressed, move to checking the keyboard. If any key was released, immediately return true
-	for (unsigned int i = 0; i < NUM_KEY_CODES; i++)
+	//Apply every event in the order it happened
+	const InputEvent* event = eventQueue.peek();
+	while (event)
 	{
-		//Immediately return true upon finding a single button that was released
-		if (keyboardStates[i] == InputState::Released)
-			return true;
+		//If this event would undo a press or release that already happened this frame, stop here. It and everything after it waits for the next frame
+		//Without this, a quick click (down and up in the same frame) would never show up as a press. The events behind it wait too so they stay in order
+		if (wouldUndoEdge(*event))
+			break;
+
+		//Apply the event and move on to the next one
+		InputEvent nextEvent;
+		eventQueue.pop(nextEvent);
+		applyEvent(nextEvent);
+		event = eventQueue.peek();
 	}
+}
 
-	//Return false if absolutely no buttons were released and so it reached this point
-	return false;
+unsigned int InputHandler::getDroppedEventCount() const
+{
+	return droppedEvents;
 }
 
-bool InputHandler::getAnyButton() const
+uint64_t InputHandler::getTimestamp()
 {
-	//Loop through all of the mouse buttons. If any of them are down, immediately return true
-	for (unsigned int i = 0; i < NUM_MOUSE_BUTTONS; i++)
-	{
-		//Immediately return true upon finding a single button that was released
-		if (mouseStates[i] == InputState::Pressed || mouseStates[i] == InputState::Held)
-			return true;
-	}
+	//steady_clock is used since it can never jump backwards (unlike the system clock)
+	return (uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+
+
+//--- Record and Replay ---//
+bool InputHandler::startRecording(const std::string& path)
+{
+	//Create the recorder the first time it is needed
+	if (!recorder)
+		recorder = new InputRecorder();
 
-	//If no mouse buttons were pressed, move to checking the keyboard. If any key is down, immediately return true
-	for (unsigned int i = 0; i < NUM_KEY_CODES; i++)
+	//Frames are counted from now so the replay lines up no matter when the recording was started
+	if (!recorder->start(path, frameIndex))
 	{
-		//Immediately return true upon finding a single button that was released
-		if (keyboardStates[i] == InputState::Released || keyboardStates[i] == InputState::Held)
-			return true;
+		std::cout << "ERROR: Could not create the input recording '" << path << "'" << std::endl;
+		return false;
 	}
 
-	//Return false if absolutely no buttons are down and so it reached this point
-	return false;
+	return true;
+}
+
+void InputHandler::stopRecording()
+{
+	if (recorder)
+		recorder->stop(frameIndex);
+}
+
+bool InputHandler::startReplay(const std::string& path)
+{
+	//Create the replayer the first time it is needed
+	if (!replayer)
+		replayer = new InputReplayer();
+
+	//Frames in the recording are counted from now
+	replaying = replayer->open(path, frameIndex);
+	return replaying;
+}
+
+void InputHandler::stopReplay()
+{
+	replaying = false;
+	if (replayer)
+		replayer->close();
+}
+
+bool InputHandler::isRecording() const
+{
+	return recorder && recorder->isRecording();
+}
+
+bool InputHandler::isReplaying() const
+{
+	return replaying;
+}
+
+unsigned int InputHandler::getFrameIndex() const
+{
+	return frameIndex;
 }
 
 
@@ -194,37 +425,18 @@ bool InputHandler::init()
 
 void InputHandler::clearForNextFrame()
 {
-	//Loop through the mouse buttons and update their states. If they were pressed last frame, they are now held. If they were released last frame, they are now idle.
-	for (unsigned int i = 0; i < NUM_MOUSE_BUTTONS; i++)
-	{
-		//Ignore the buttons that are currently not being pressed. This will be true the large majority of the time, saving the two if checks afterwards
-		if (mouseStates[i] == InputState::Idle)
-			continue;
-
-		//If they button was pressed last frame, it is now considered held. If it was released last frame, is now considered idle
-		if (mouseStates[i] == InputState::Pressed)
-			mouseStates[i] = InputState::Held;
-		else if (mouseStates[i] == InputState::Released)
-			mouseStates[i] = InputState::Idle;
-	}
+	PROFILE_SCOPE("Input::clearForNextFrame");
 
-	//Loop through the keyboard buttons and update their states. If they were pressed last frame, they are now held. If they were released last frame, they are now idle.
-	for (unsigned int i = 0; i < NUM_KEY_CODES; i++)
-	{
-		//Ignore the keys that are currently not being pressed. This will be true the large majority of the time, saving the two if checks afterwards
-		if (keyboardStates[i] == InputState::Idle)
-			continue;
-
-		//If they button was pressed last frame, it is now considered held. If it was released last frame, is now considered idle
-		if (keyboardStates[i] == InputState::Pressed)
-			keyboardStates[i] = InputState::Held;
-		else if (keyboardStates[i] == InputState::Released)
-			keyboardStates[i] = InputState::Idle;
-	}
+	//Move every key and mouse button on to the next frame at once. If a button was pressed last frame, it is now considered held. If it was released last frame, it is now considered idle
+	//This works because the states are worked out from the bit-planes. Once 'last down' matches 'down' and nothing is marked as changed, pressed buttons read as held and released buttons read as idle
+	advanceBitPlanes(buttons);
 
 	//Reset the scroll wheel amounts to 0
 	scrollValue = 0.0f;
 	horizontalScrollValue = 0.0f;
+
+	//Move on to the next frame. Recorded and replayed events are matched up using this
+	frameIndex++;
 }
 
 
@@ -241,17 +453,11 @@ void InputHandler::initMouseListener()
 		//Cast the event as a mouse event
 		EventMouse* mouseEvent = dynamic_cast<EventMouse*>(event);
 
-		//Get the position of the mouse button press
-		Vec2 mouseClickPosition = mouseEvent->getLocation();
-
-		//Init the message to be output in the message box
-		std::stringstream message;
-
 		//Get the mouse button from the event handler
 		MouseButton mouseButton = mouseEvent->getMouseButton();
 
-		//Set the appropriate mouse button to be pressed (+1 to compensate for the enum in Cocos starting at -1)
-		mouseStates[(int)mouseButton + 1] = InputState::Pressed;
+		//Queue the mouse button to be pressed at the start of the next frame
+		queueButtonEvent(InputEvent::MouseDown, (int)mouseButton);
 	};
 
 
@@ -261,17 +467,11 @@ void InputHandler::initMouseListener()
 		//Cast the event as a mouse event
 		EventMouse* mouseEvent = dynamic_cast<EventMouse*>(event);
 
-		//Get the position of the mouse button press
-		Vec2 mouseUpPosition = mouseEvent->getLocation();
-
-		//Init the message to be output in the message box
-		std::stringstream message;
-
 		//Get the mouse button from the event handler
 		MouseButton mouseButton = mouseEvent->getMouseButton();
 
-		//Set the appropriate mouse button to be released (+1 to compensate for the enum in Cocos starting at -1)
-		mouseStates[(int)mouseButton + 1] = InputState::Released;
+		//Queue the mouse button to be released at the start of the next frame
+		queueButtonEvent(InputEvent::MouseUp, (int)mouseButton);
 	};
 
 
@@ -284,8 +484,9 @@ void InputHandler::initMouseListener()
 		//Get the position of the mouse from the event handler in UI space (ie: the Y axis is flipped since it is from the TOP LEFT instead of the BOTTOM RIGHT)
 		Vec2 mouseEventPos = mouseEvent->getLocationInView();
 
-		//Store the cursor position with a FLIPPED Y. To do this, add the height of the window to the position
-		mousePosition = Vec2(mouseEventPos.x, mouseEventPos.y + windowDimensions.height);
+		//Queue the cursor position with a FLIPPED Y. To do this, add the height of the window to the position
+		InputEvent moveEvent = { InputEvent::MouseMove, 0, mouseEventPos.x, mouseEventPos.y + windowDimensions.height, getTimestamp() };
+		queueLiveEvent(moveEvent);
 	};
 
 
@@ -295,9 +496,9 @@ void InputHandler::initMouseListener()
 		//Cast the event as a mouse event
 		EventMouse* mouseEvent = dynamic_cast<EventMouse*>(event);
 
-		//Get the scroll amounts from the mouse event
-		scrollValue = mouseEvent->getScrollY();
-		horizontalScrollValue = mouseEvent->getScrollX();
+		//Queue the scroll amounts from the mouse event
+		InputEvent scrollEvent = { InputEvent::MouseScroll, 0, mouseEvent->getScrollX(), mouseEvent->getScrollY(), getTimestamp() };
+		queueLiveEvent(scrollEvent);
 	};
 
 
@@ -314,20 +515,16 @@ void InputHandler::initKeyboardListener()
 	//On Key Pressed
 	keyboardListener->onKeyPressed = [&](EventKeyboard::KeyCode keyCode, Event* event)
 	{
-		//Set the appropriate key to be considered pressed
-		keyboardStates[(int)keyCode] = InputState::Pressed;
-
-		//Exit if the escape key was pressed and the flag is set to true
-		if (exitOnEscape && keyCode == KeyCode::KEY_ESCAPE)
-			Director::getInstance()->end();
+		//Queue the key to be pressed at the start of the next frame. Applying it will also exit if it was the escape key and the flag is set to true
+		queueButtonEvent(InputEvent::KeyDown, (int)keyCode);
 	};
 
 
 	//On Key Released
 	keyboardListener->onKeyReleased = [&](EventKeyboard::KeyCode keyCode, Event* event)
 	{
-		//Set the appropriate key to be considered released
-		keyboardStates[(int)keyCode] = InputState::Released;
+		//Queue the key to be released at the start of the next frame
+		queueButtonEvent(InputEvent::KeyUp, (int)keyCode);
 	};
 
 
@@ -336,6 +533,128 @@ void InputHandler::initKeyboardListener()
 }
 
 
+bool InputHandler::isButtonPressed(int bit) const
+{
+	//Pressed = down & (~lastDown | changed), for just this one bit
+	uint64_t mask = (uint64_t)1 << (bit & 63);
+	int word = bit >> 6;
+	return (buttons.down.words[word] & (~buttons.lastDown.words[word] | buttons.changed.words[word]) & mask) != 0;
+}
+
+bool InputHandler::isButtonReleased(int bit) const
+{
+	//Released = ~down & (lastDown | changed), for just this one bit
+	uint64_t mask = (uint64_t)1 << (bit & 63);
+	int word = bit >> 6;
+	return (~buttons.down.words[word] & (buttons.lastDown.words[word] | buttons.changed.words[word]) & mask) != 0;
+}
+
+bool InputHandler::isButtonDown(int bit) const
+{
+	//Down = pressed or held, which is just the down bit
+	uint64_t mask = (uint64_t)1 << (bit & 63);
+	return (buttons.down.words[bit >> 6] & mask) != 0;
+}
+
+void InputHandler::setButtonDown(int bit, bool down)
+{
+	//Set or clear the down bit and mark the button as changed this frame
+	uint64_t mask = (uint64_t)1 << (bit & 63);
+	int word = bit >> 6;
+	if (down)
+		buttons.down.words[word] |= mask;
+	else
+		buttons.down.words[word] &= ~mask;
+	buttons.changed.words[word] |= mask;
+}
+
+bool InputHandler::wouldUndoEdge(const InputEvent& event) const
+{
+	//Work out which button the event is for. Moves and scrolls can never undo anything
+	int bit;
+	bool down;
+	switch (event.type)
+	{
+	case InputEvent::MouseDown:
+	case InputEvent::MouseUp:
+		bit = MOUSE_BIT(event.code);
+		down = (event.type == InputEvent::MouseDown);
+		break;
+
+	case InputEvent::KeyDown:
+	case InputEvent::KeyUp:
+		bit = KEY_BIT(event.code);
+		down = (event.type == InputEvent::KeyDown);
+		break;
+
+	default:
+		return false;
+	}
+
+	//If the button already changed this frame and this event would flip it back, it would undo the first change
+	uint64_t mask = (uint64_t)1 << (bit & 63);
+	int word = bit >> 6;
+	bool changedThisFrame = (buttons.changed.words[word] & mask) != 0;
+	return changedThisFrame && (isButtonDown(bit) != down);
+}
+
+void InputHandler::applyEvent(const InputEvent& event)
+{
+	//Save the event if a recording is being made. It is saved with the frame it is actually applied on so the replay applies it on the same frame
+	if (recorder)
+		recorder->record(frameIndex, event);
+
+	//Send the event through the same injection functions the headless runner uses
+	switch (event.type)
+	{
+	case InputEvent::MouseMove:
+		injectMouseMove(Vec2(event.x, event.y));
+		break;
+
+	case InputEvent::MouseDown:
+		injectMouseButton((MouseButton)event.code, true);
+		break;
+
+	case InputEvent::MouseUp:
+		injectMouseButton((MouseButton)event.code, false);
+		break;
+
+	case InputEvent::MouseScroll:
+		injectMouseScroll(event.x, event.y);
+		break;
+
+	case InputEvent::KeyDown:
+		injectKey((KeyCode)event.code, true);
+		break;
+
+	case InputEvent::KeyUp:
+		injectKey((KeyCode)event.code, false);
+		break;
+	}
+}
+
+void InputHandler::queueButtonEvent(InputEvent::Type type, int code)
+{
+	//Button events don't use the position
+	InputEvent event = { type, code, 0.0f, 0.0f, getTimestamp() };
+	queueLiveEvent(event);
+}
+
+void InputHandler::queueLiveEvent(const InputEvent& event)
+{
+	//While a recording is being played back, the live input is ignored so it doesn't change what happens
+	//Escape still exits, otherwise there would be no way to quit during a long replay
+	if (replaying)
+	{
+		if (event.type == InputEvent::KeyDown && event.code == (int)KeyCode::KEY_ESCAPE && exitOnEscape)
+			Director::getInstance()->end();
+		return;
+	}
+
+	queueEvent(event);
+}
+
+
 
 //--- Singleton Instance ---//
 InputHandler* InputHandler::getInstance()
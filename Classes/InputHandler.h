@@ -13,6 +13,8 @@
 		- Also special 'anyButton' events
 			> Same as mouse and keyboard but checks for ANY key and ANY mouse
 			> Useful for splash screens and other similar systems where you just want the player to press ANYTHING before they move on
+		- The events from Cocos2D are queued as they come in and applied all at once at the start of the frame (processQueuedEvents())
+			> Events are applied in the order they happened, scrolling adds up, and a press and release in the same frame are both seen
 
 	Usage:
 		- You are free to use this class for the case studies and for GDW
@@ -31,9 +33,20 @@
 #ifndef INPUTHANDLER_H
 #define INPUTHANDLER_H
 
+//Core Libraries
+#include <stdint.h>
+#include <string>
+
 //3rd Party Libraries
 #include "cocos2d.h"
 
+//Wrapper Classes
+#include "SpscRingBuffer.h"
+
+//Forward Declarations
+class InputRecorder;
+class InputReplayer;
+
 //Namespaces
 using namespace cocos2d;
 
@@ -41,6 +54,7 @@ using namespace cocos2d;
 	Input State Enum
 	- Used for differentiating the types of input events
 	- Used for both the mouse input and keyboard input
+	- The states aren't stored directly anymore. They are worked out from the bit-planes below (see Input Bit Plane)
 
 	> Idle
 		- The key or button has not been touched for multiple frames. In general, this will be the majority of the keys (Never returns true in this state)
@@ -64,6 +78,70 @@ enum InputState
 #define NUM_KEY_CODES (int)cocos2d::EventKeyboard::KeyCode::KEY_PLAY + 1  //The number of keys supported by Cocos2D.
 typedef cocos2d::EventKeyboard::KeyCode KeyCode; //A shortcut for accessing KeyCodes
 typedef cocos2d::EventMouse::MouseButton MouseButton; //A shortcut for accessing MouseButtons
+#define INPUT_BIT_WORDS 4 //The number of 64-bit words in a bit-plane. 4 words is 256 bits, which is enough room for every key and every mouse button
+#define MOUSE_BIT_OFFSET 192 //The bit the mouse buttons start at. The keys use the bits before this, the mouse buttons use the last word
+#define INPUT_QUEUE_SIZE 1024 //The number of events that can be waiting in the queue at once. Has to be a power of two
+
+
+
+/*
+	Input Bit Plane
+	- One bit for every key and mouse button, packed into four 64-bit words (32 bytes total)
+	- The keys use bits 0 to 191 (the bit is the key code). The mouse buttons use bits 192 and up (+1 since the first mouse button is -1)
+	- The words are worked on two at a time with SIMD instructions. Those use unaligned loads, since the input handler is made with new and new doesn't promise 16 byte alignment everywhere
+*/
+struct InputBitPlane
+{
+	uint64_t words[INPUT_BIT_WORDS];
+};
+
+/*
+	Input Snapshot
+	- The whole button state of the input handler for one frame. Small enough to copy every frame if you want to keep a history
+	- The states are worked out from the planes like this:
+		> Pressed -> down & (~lastDown | changed)
+		> Released -> ~down & (lastDown | changed)
+		> Held / Idle -> down & lastDown / ~down & ~lastDown, when nothing changed
+
+	> Down -> The buttons that are down right now
+	> LastDown -> The buttons that were down at the end of last frame
+	> Changed -> The buttons that were pressed or released at some point this frame. Lets a quick tap that goes down and back up within one frame still count as a release
+*/
+struct InputSnapshot
+{
+	InputBitPlane down;
+	InputBitPlane lastDown;
+	InputBitPlane changed;
+};
+
+/*
+	Input Event
+	- A single input event waiting in the queue to be applied to the input handler
+	- Cocos2D's callbacks (or any other thread sampling the input) create these and the game drains them at the start of the frame
+
+	> Type -> What kind of event it is
+	> Code -> The mouse button or key code for button events. Ignored for the mouse move and scroll events
+	> X, Y -> The mouse position (from the BOTTOM LEFT) for mouse moves, or the scroll amounts for scroll events. Ignored for button events
+	> Timestamp -> When the event happened, in microseconds. Use InputHandler::getTimestamp() so every event uses the same clock
+*/
+struct InputEvent
+{
+	enum Type
+	{
+		MouseMove,
+		MouseDown,
+		MouseUp,
+		MouseScroll,
+		KeyDown,
+		KeyUp
+	};
+
+	Type type;
+	int code;
+	float x;
+	float y;
+	uint64_t timestamp;
+};
 
 
 
@@ -76,6 +154,16 @@ typedef cocos2d::EventMouse::MouseButton MouseButton; //A shortcut for accessing
 		- Get mouse button press / release / hold events
 		- Get key press / release / hold events
 		- Get any key or button press / release / hold events
+		- Get a snapshot of every button
+	> Input Injection
+		- Inject mouse moves, mouse buttons, scrolling and keys
+	> Event Queue
+		- Queue an event from the callbacks or another thread
+		- Apply the queued events at the start of the frame
+		- Get the number of events that didn't fit in the queue
+	> Record and Replay
+		- Record every event applied to a file
+		- Replay a recording instead of the live input
 	> Methods
 		- Init
 		- Clear inputs for the next frame
@@ -199,6 +287,116 @@ public:
 	bool getAnyButton() const;
 
 
+	//Snapshot
+	/*
+		Get a copy of the state of every key and mouse button this frame. This is just a few bit-planes so it is cheap to copy every frame
+
+		@return Returns -> The bit-planes for this frame. See the InputSnapshot struct for how to read them
+	*/
+	InputSnapshot getSnapshot() const;
+
+
+
+	//--- Input Injection ---//
+	/*
+		Move the mouse cursor as if the user moved it, right away. Queued events are applied through these functions too, so injected input goes through the exact same code as real input
+
+		@param Position -> The new position of the mouse cursor, from the BOTTOM LEFT of the screen (the same space getMousePosition() returns)
+	*/
+	void injectMouseMove(Vec2 position);
+
+	/*
+		Press or release a mouse button as if the user did it
+
+		@param Button -> The mouse button to change. Ex: MouseButton::BUTTON_LEFT
+		@param Down -> True to press the button, false to release it
+	*/
+	void injectMouseButton(MouseButton button, bool down);
+
+	/*
+		Scroll the mouse wheel as if the user did it. The values are in the same units Cocos2D gives the mouse listener. Scrolling more than once in a frame adds up
+
+		@param ScrollX -> The horizontal scroll amount
+		@param ScrollY -> The vertical scroll amount
+	*/
+	void injectMouseScroll(float scrollX, float scrollY);
+
+	/*
+		Press or release a key as if the user did it
+
+		@param Key -> The key to change. Ex: KeyCode::KEY_SPACE
+		@param Down -> True to press the key, false to release it
+	*/
+	void injectKey(KeyCode key, bool down);
+
+
+
+	//--- Event Queue ---//
+	/*
+		Add an event to the queue. It is applied the next time processQueuedEvents() is called. This is what the mouse and keyboard listeners do
+		This can be called from a different thread than the game (ex: a thread that samples the input more often than the frame rate) as long as only ONE thread ever queues events
+
+		@param Event -> The event to add. Fill in the timestamp with getTimestamp()
+		@return Returns -> True if the event was queued. False if the queue was full and the event was dropped
+	*/
+	bool queueEvent(const InputEvent& event);
+
+	/*
+		This HAS to be called EVERY FRAME at the START OF THE FRAME! Applies the queued events in the order they happened
+		If a button is pressed and released in the same frame, the release is held back until the next frame so the press isn't lost
+	*/
+	void processQueuedEvents();
+
+	/*
+		Get how many events were thrown away because the queue was full. If this isn't 0, the queue is too small or processQueuedEvents() isn't being called
+
+		@return Returns -> The number of events dropped since the program started
+	*/
+	unsigned int getDroppedEventCount() const;
+
+	/*
+		Get the current time in microseconds from a clock that only ever moves forward. Used to timestamp the input events
+
+		@return Returns -> The current time in microseconds. Only useful for comparing against other timestamps
+	*/
+	static uint64_t getTimestamp();
+
+
+
+	//--- Record and Replay ---//
+	/*
+		Start saving every event that gets applied to a file. See InputRecorder.h for the format
+		Replaying the file later gives the game exactly the same input on exactly the same frames. Useful for comparing the performance of two builds
+
+		@param Path -> Where to save the recording. Overwritten if it already exists
+		@return Returns -> True if the recording started. False if the file couldn't be created
+	*/
+	bool startRecording(const std::string& path);
+
+	/*
+		Stop recording and finish the file. This is done automatically when the program closes
+	*/
+	void stopRecording();
+
+	/*
+		Start playing back a recording. The live mouse and keyboard input is ignored until the replay is stopped (except for escape, so you can still quit)
+		The events are applied through the same code as the live input, on the same frames they were recorded on (counted from when the replay starts)
+
+		@param Path -> The recording to play back
+		@return Returns -> True if the recording was opened. False if not
+	*/
+	bool startReplay(const std::string& path);
+
+	/*
+		Stop playing back the recording and go back to the live input
+	*/
+	void stopReplay();
+
+	bool isRecording() const; //Get if a recording is being made
+	bool isReplaying() const; //Get if a recording is being played back. Turns false by itself once every event has been played
+	unsigned int getFrameIndex() const; //Get the number of frames the input handler has been through. Goes up by one every clearForNextFrame()
+
+
 
 	//--- Methods ---//
 	/*
@@ -233,16 +431,36 @@ private:
 	Vec2 mousePosition; //The current position of the mouse, stored as a Vec2. Updated every time the mouse is moved.
 	float scrollValue; //The value for the mouse wheel scrolling on the standard Y-axis (Note: this is the standard up and down scrolling)
 	float horizontalScrollValue; //The value for the mouse wheel scrolling on the non-standard X-axis (NOTE: this is NOT up and down scrolling!)
-	InputState mouseStates[NUM_MOUSE_BUTTONS]; //States for all of the mouse buttons in cocos2D. +2 since unset is a button as well and is defaulted to -1
 	EventListenerMouse* mouseListener; //The listener for the mouse events
 
 	//Keyboard
-	InputState keyboardStates[NUM_KEY_CODES]; //States for all of the keycodes in cocos2D
 	EventListenerKeyboard* keyboardListener; //The listener for the keyboard events
 
+	//Buttons
+	//Every key and mouse button is stored as bits instead of a full InputState each. The whole thing fits in a couple of cache lines
+	InputSnapshot buttons; //The down, last-down and changed bit-planes for every key and mouse button
+
+	//Event Queue
+	SpscRingBuffer<InputEvent, INPUT_QUEUE_SIZE> eventQueue; //The events waiting to be applied at the start of the next frame
+	std::atomic<unsigned int> droppedEvents; //How many events didn't fit in the queue. Atomic since it is written by whichever thread is queueing events
+
+	//Record and Replay
+	unsigned int frameIndex; //The number of frames so far. Every event is recorded with the frame it was applied on
+	InputRecorder* recorder; //Saves the applied events to a file. Only created once a recording is started
+	InputReplayer* replayer; //Plays back a recording. Only created once a replay is started
+	std::atomic<bool> replaying; //If true, the live input is ignored and the events come from the replayer instead. Atomic since the listeners check it
+
 	//--- Utility Functions ---//
 	void initMouseListener(); //Set up the mouse event handling through the listener
 	void initKeyboardListener(); //Set up the keyboard event handling through the listener
+	bool isButtonPressed(int bit) const; //Check the bit-planes to see if a key or mouse button was pressed this frame
+	bool isButtonReleased(int bit) const; //Check the bit-planes to see if a key or mouse button was released this frame
+	bool isButtonDown(int bit) const; //Check the bit-planes to see if a key or mouse button is down right now
+	void setButtonDown(int bit, bool down); //Set a key or mouse button to be down or up and mark it as changed this frame
+	bool wouldUndoEdge(const InputEvent& event) const; //Check if an event would undo a press or release that already happened this frame
+	void applyEvent(const InputEvent& event); //Apply a single event through the injection functions
+	void queueButtonEvent(InputEvent::Type type, int code); //Timestamp and queue a mouse button or key event
+	void queueLiveEvent(const InputEvent& event); //Queue an event from the mouse or keyboard listener. Ignored while a recording is being replayed
 
 	//--- Singleton Instance ---//
 	static InputHandler* inst; //The singleton instance. Ie: The only instance of this class that can ever exist
@@ -0,0 +1,95 @@
+#include "InputRecorder.h"
+
+//Core Libraries
+#include <cstring>
+
+
+
+//--- Constructors and Destructors ---//
+InputRecorder::InputRecorder()
+{
+	//Init the private data
+	memset(&header, 0, sizeof(header));
+	startFrame = 0;
+}
+
+InputRecorder::~InputRecorder()
+{
+	//Finish the file if the recording was never stopped. The frame count isn't known here, so it is left as however many frames had events
+	if (isRecording())
+		stop(startFrame);
+}
+
+
+
+//--- Getters ---//
+bool InputRecorder::isRecording() const
+{
+	return file.is_open();
+}
+
+uint64_t InputRecorder::getEventCount() const
+{
+	return header.eventCount;
+}
+
+
+
+//--- Methods ---//
+bool InputRecorder::start(const std::string& path, unsigned int _startFrame)
+{
+	//Finish any recording that is already going
+	if (isRecording())
+		stop(_startFrame);
+
+	//Create the file
+	file.open(path.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+	if (!file.is_open())
+		return false;
+
+	//Fill in the header. The counts are filled in when the recording stops
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, INPUT_RECORDING_MAGIC, 4);
+	header.version = INPUT_RECORDING_VERSION;
+	header.recordSize = (uint16_t)sizeof(InputRecord);
+	header.startTimestamp = InputHandler::getTimestamp();
+	startFrame = _startFrame;
+
+	//Write the header as a placeholder so the records start in the right spot
+	file.write((const char*)&header, sizeof(header));
+	return file.good();
+}
+
+void InputRecorder::stop(unsigned int currentFrame)
+{
+	if (!isRecording())
+		return;
+
+	//Go back and fill in the real counts in the header. The recording covers at least up to the last frame with an event
+	if (currentFrame - startFrame > header.frameCount)
+		header.frameCount = currentFrame - startFrame;
+	file.seekp(0, std::ios::beg);
+	file.write((const char*)&header, sizeof(header));
+	file.close();
+}
+
+void InputRecorder::record(unsigned int frame, const InputEvent& event)
+{
+	if (!isRecording())
+		return;
+
+	//Pack the event into a record. Frames and timestamps are stored relative to the start of the recording
+	InputRecord record;
+	record.frame = frame - startFrame;
+	record.type = (uint8_t)event.type;
+	record.reserved = 0;
+	record.code = (int16_t)event.code;
+	record.x = event.x;
+	record.y = event.y;
+	record.timestamp = (event.timestamp > header.startTimestamp) ? event.timestamp - header.startTimestamp : 0;
+	file.write((const char*)&record, sizeof(record));
+
+	//Keep track of how much has been recorded. The frame count is kept up to date in case the recording is never stopped properly
+	header.eventCount++;
+	header.frameCount = record.frame + 1;
+}
@@ -0,0 +1,138 @@
+/*
+============================================================
+	Input Recorder:
+		- Saves every input event the input handler applies to a compact binary file
+		- The file can be played back with the InputReplayer so the game gets exactly the same input on exactly the same frames
+			> Combined with a fixed timestep (see HeadlessRunner) this gives an identical workload every run, so frame timings can be compared between builds
+
+	File Format:
+		- All values are little-endian. Every platform this project targets is little-endian so the structs are written directly
+		- One InputRecordingHeader at the start of the file, then one InputRecord per event in the order they were applied
+		- The frame count and event count in the header are filled in when the recording is stopped
+			> If the program crashes before that, the replayer works out the event count from the size of the file instead
+
+	Usage:
+		- Use INPUTS->startRecording() and INPUTS->stopRecording() rather than using this class directly
+============================================================
+*/
+
+#ifndef INPUTRECORDER_H
+#define INPUTRECORDER_H
+
+//Core Libraries
+#include <fstream>
+#include <string>
+#include <stdint.h>
+
+//Wrapper Classes
+#include "InputHandler.h"
+
+//File format constants
+#define INPUT_RECORDING_MAGIC "CDIR" //The first 4 bytes of every recording. Stands for Cocos Demo Input Recording
+#define INPUT_RECORDING_VERSION 1 //Bump this whenever the layout of the header or the records changes
+
+/*
+	Input Recording Header
+	- The first 32 bytes of a recording
+
+	> Magic -> Always INPUT_RECORDING_MAGIC. Used to make sure the file is actually a recording
+	> Version -> The version of the format the file was written with
+	> RecordSize -> The size of a single InputRecord in bytes. Lets old readers skip records they don't understand
+	> FrameCount -> How many frames the recording covers
+	> EventCount -> How many records come after the header
+	> StartTimestamp -> The time the recording started, in microseconds (see InputHandler::getTimestamp()). The record timestamps are relative to this
+*/
+struct InputRecordingHeader
+{
+	char magic[4];
+	uint16_t version;
+	uint16_t recordSize;
+	uint32_t frameCount;
+	uint32_t reserved;
+	uint64_t eventCount;
+	uint64_t startTimestamp;
+};
+
+/*
+	Input Record
+	- A single input event in a recording. 24 bytes each
+
+	> Frame -> The frame the event was applied on
+	> Type -> The InputEvent::Type of the event
+	> Code -> The mouse button or key code. Every code in Cocos2D fits in 16 bits
+	> X, Y -> The mouse position or the scroll amounts, depending on the type
+	> Timestamp -> When the event happened, in microseconds since the recording started
+*/
+struct InputRecord
+{
+	uint32_t frame;
+	uint8_t type;
+	uint8_t reserved;
+	int16_t code;
+	float x;
+	float y;
+	uint64_t timestamp;
+};
+
+static_assert(sizeof(InputRecordingHeader) == 32, "The input recording header must be exactly 32 bytes!");
+static_assert(sizeof(InputRecord) == 24, "An input record must be exactly 24 bytes!");
+
+
+
+/*
+	Input Recorder Class:
+	> Getters
+		- Get if a recording is in progress
+		- Get the number of events recorded
+	> Methods
+		- Start and stop recording
+		- Record an event
+*/
+class InputRecorder
+{
+public:
+	//--- Constructors and Destructors ---//
+	InputRecorder();
+	~InputRecorder(); //Stops the recording if it is still going so the file is complete
+
+
+
+	//--- Getters ---//
+	bool isRecording() const; //Get if a recording is in progress
+	uint64_t getEventCount() const; //Get the number of events recorded so far
+
+
+
+	//--- Methods ---//
+	/*
+		Start recording to a file. The file is overwritten if it already exists
+
+		@param Path -> Where to save the recording
+		@param StartFrame -> The frame the recording starts on. Frames in the file are stored relative to this so a replay always starts at frame 0
+		@return Returns -> True if the file was created. False if not
+	*/
+	bool start(const std::string& path, unsigned int startFrame);
+
+	/*
+		Finish the recording. Fills in the header and closes the file
+
+		@param CurrentFrame -> The frame the recording stopped on. Used to work out how many frames the recording covers
+	*/
+	void stop(unsigned int currentFrame);
+
+	/*
+		Add an event to the recording
+
+		@param Frame -> The frame the event was applied on
+		@param Event -> The event that was applied
+	*/
+	void record(unsigned int frame, const InputEvent& event);
+
+private:
+	//--- Private Data ---//
+	std::ofstream file; //The file being written to. ofstream buffers the writes so every event isn't a separate write to disk
+	InputRecordingHeader header; //The header for the file. Written as a placeholder at the start and again when the recording stops
+	unsigned int startFrame; //The frame the recording started on
+};
+
+#endif
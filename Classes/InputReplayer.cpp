@@ -0,0 +1,155 @@
+#include "InputReplayer.h"
+
+//Core Libraries
+#include <cstring>
+#include <iostream>
+
+
+
+//--- Constructors and Destructors ---//
+InputReplayer::InputReplayer()
+{
+	//Init the private data
+	memset(&header, 0, sizeof(header));
+	window = nullptr;
+	windowStart = 0;
+	windowLength = 0;
+	nextRecord = 0;
+	startFrame = 0;
+}
+
+InputReplayer::~InputReplayer()
+{
+	close();
+}
+
+
+
+//--- Getters ---//
+bool InputReplayer::isOpen() const
+{
+	return file.isOpen();
+}
+
+bool InputReplayer::isFinished() const
+{
+	return nextRecord >= header.eventCount;
+}
+
+unsigned int InputReplayer::getFrameCount() const
+{
+	return header.frameCount;
+}
+
+uint64_t InputReplayer::getEventCount() const
+{
+	return header.eventCount;
+}
+
+
+
+//--- Methods ---//
+bool InputReplayer::open(const std::string& path, unsigned int _startFrame)
+{
+	//Close whatever was open before
+	close();
+
+	//Open the file and make sure it is at least big enough for the header
+	if (!file.open(path) || file.getSize() < sizeof(InputRecordingHeader))
+	{
+		std::cout << "ERROR: Could not open the input recording '" << path << "'" << std::endl;
+		close();
+		return false;
+	}
+
+	//Read the header out of the start of the file
+	const unsigned char* headerData = file.map(0, sizeof(InputRecordingHeader));
+	if (!headerData)
+	{
+		close();
+		return false;
+	}
+	memcpy(&header, headerData, sizeof(header));
+	file.unmap();
+
+	//Make sure it is actually a recording, and one this version knows how to read
+	if (memcmp(header.magic, INPUT_RECORDING_MAGIC, 4) != 0 || header.version != INPUT_RECORDING_VERSION || header.recordSize != sizeof(InputRecord))
+	{
+		std::cout << "ERROR: '" << path << "' is not an input recording this version can play" << std::endl;
+		close();
+		return false;
+	}
+
+	//If the recording wasn't stopped properly, the event count in the header is 0. Work it out from the size of the file instead
+	uint64_t eventsInFile = (file.getSize() - sizeof(InputRecordingHeader)) / sizeof(InputRecord);
+	if (header.eventCount == 0 || header.eventCount > eventsInFile)
+		header.eventCount = eventsInFile;
+
+	startFrame = _startFrame;
+	return true;
+}
+
+void InputReplayer::close()
+{
+	//Closing the file unmaps the window as well
+	file.close();
+	memset(&header, 0, sizeof(header));
+	window = nullptr;
+	windowStart = 0;
+	windowLength = 0;
+	nextRecord = 0;
+}
+
+bool InputReplayer::nextEvent(unsigned int frame, InputEvent& event)
+{
+	//Stop once every event has been played
+	if (isFinished())
+		return false;
+
+	//Read the next record and check if it happens yet
+	InputRecord record;
+	if (!readRecord(nextRecord, record))
+	{
+		//If the file can't be read any further, treat the recording as finished
+		nextRecord = header.eventCount;
+		return false;
+	}
+	if (startFrame + record.frame > frame)
+		return false;
+
+	//Unpack the record back into an event
+	event.type = (InputEvent::Type)record.type;
+	event.code = record.code;
+	event.x = record.x;
+	event.y = record.y;
+	event.timestamp = header.startTimestamp + record.timestamp;
+
+	nextRecord++;
+	return true;
+}
+
+
+
+//--- Utility Functions ---//
+bool InputReplayer::readRecord(uint64_t index, InputRecord& record)
+{
+	//Work out where the record is in the file
+	uint64_t offset = sizeof(InputRecordingHeader) + index * sizeof(InputRecord);
+
+	//If the record isn't completely inside the current window, map a new window starting at the record
+	if (!window || offset < windowStart || offset + sizeof(InputRecord) > windowStart + windowLength)
+	{
+		window = file.map(offset, INPUT_REPLAY_WINDOW_SIZE);
+		if (!window)
+			return false;
+
+		windowStart = offset;
+		windowLength = (size_t)((file.getSize() - offset < INPUT_REPLAY_WINDOW_SIZE) ? file.getSize() - offset : INPUT_REPLAY_WINDOW_SIZE);
+		if (windowLength < sizeof(InputRecord))
+			return false;
+	}
+
+	//Copy the record out. memcpy is used since the records aren't guaranteed to be aligned in the window
+	memcpy(&record, window + (offset - windowStart), sizeof(record));
+	return true;
+}
@@ -0,0 +1,93 @@
+/*
+============================================================
+	Input Replayer:
+		- Plays back a recording made by the InputRecorder
+		- The recording is streamed from a memory-mapped file a window at a time, so even a recording that is hours long never has to fit in memory
+		- Every event is handed back on the same frame it was recorded on. The input handler applies it through the same code the live input uses
+
+	Usage:
+		- Use INPUTS->startReplay() and INPUTS->stopReplay() rather than using this class directly
+		- See InputRecorder.h for the file format
+============================================================
+*/
+
+#ifndef INPUTREPLAYER_H
+#define INPUTREPLAYER_H
+
+//Core Libraries
+#include <string>
+#include <stdint.h>
+
+//Wrapper Classes
+#include "InputRecorder.h"
+#include "MappedFile.h"
+
+//The amount of the recording mapped into memory at once. 4MB is about 175,000 events
+#define INPUT_REPLAY_WINDOW_SIZE (4 * 1024 * 1024)
+
+/*
+	Input Replayer Class:
+	> Getters
+		- Get if a recording is open
+		- Get if every event has been played
+		- Get the number of frames and events in the recording
+	> Methods
+		- Open and close a recording
+		- Get the next event for a frame
+*/
+class InputReplayer
+{
+public:
+	//--- Constructors and Destructors ---//
+	InputReplayer();
+	~InputReplayer();
+
+
+
+	//--- Getters ---//
+	bool isOpen() const; //Get if a recording is open
+	bool isFinished() const; //Get if every event in the recording has been played
+	unsigned int getFrameCount() const; //Get the number of frames the recording covers
+	uint64_t getEventCount() const; //Get the number of events in the recording
+
+
+
+	//--- Methods ---//
+	/*
+		Open a recording to play back. Checks the header to make sure it is a recording this version can read
+
+		@param Path -> The recording to open
+		@param StartFrame -> The frame the playback starts on. The frames in the recording are added to this
+		@return Returns -> True if the recording was opened. False if it doesn't exist or isn't a valid recording
+	*/
+	bool open(const std::string& path, unsigned int startFrame);
+
+	/*
+		Close the recording
+	*/
+	void close();
+
+	/*
+		Get the next event in the recording, if it happens on or before the given frame. Call this in a loop until it returns false to get every event for the frame
+
+		@param Frame -> The current frame
+		@param Event -> Where to store the event
+		@return Returns -> True if there was an event for this frame. False if the next event is on a later frame or the recording is finished
+	*/
+	bool nextEvent(unsigned int frame, InputEvent& event);
+
+private:
+	//--- Private Data ---//
+	MappedFile file; //The recording. Mapped a window at a time
+	InputRecordingHeader header; //The header read from the start of the file
+	const unsigned char* window; //The part of the file that is currently mapped
+	uint64_t windowStart; //The offset in the file the window starts at
+	size_t windowLength; //The length of the window in bytes
+	uint64_t nextRecord; //The index of the next record to be played
+	unsigned int startFrame; //The frame the playback started on
+
+	//--- Utility Functions ---//
+	bool readRecord(uint64_t index, InputRecord& record); //Read a record out of the file, moving the window if it isn't already mapped
+};
+
+#endif
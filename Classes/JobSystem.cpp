@@ -0,0 +1,385 @@
+#include "JobSystem.h"
+
+//Core Libraries
+#include <algorithm>
+#include <sstream>
+
+//--- Static Variables ---//
+JobSystem* JobSystem::inst = nullptr;
+
+//Which queue belongs to the thread this is read on. -1 for threads that aren't part of the job system, which use the shared queue
+static thread_local int currentQueueIndex = -1;
+
+
+
+//--- Job ---//
+//A single piece of work, and everything needed to know when it can start and who is waiting on it
+struct Job
+{
+	std::function<void()> work; //What the job runs
+	std::atomic<unsigned int> pendingDependencies; //How many things still have to happen before the job can go on a queue. Starts at 1 for the submit() itself
+	std::atomic<bool> done; //Set once the job has finished
+	std::mutex mutex; //Protects the dependents, so a job can't be added to the list after the list has already been started
+	std::vector<JobHandle> dependents; //The jobs waiting on this one
+};
+
+
+
+//--- Constructor and Destructor ---//
+JobSystem::JobSystem()
+{
+	//Init the private data. There are no workers until init() is called
+	queuedJobs = 0;
+	sleepingWorkers = 0;
+	quitWorkers = false;
+	sharedQueue.jobsRun = 0;
+	sharedQueue.jobsStolen = 0;
+}
+
+JobSystem::~JobSystem()
+{
+	shutdown();
+}
+
+
+
+//--- Getters ---//
+unsigned int JobSystem::getThreadCount() const
+{
+	return std::max((unsigned int)queues.size(), 1u);
+}
+
+bool JobSystem::isDone(const JobHandle& job) const
+{
+	return !job || job->done.load(std::memory_order_acquire);
+}
+
+JobStats JobSystem::getStats() const
+{
+	JobStats stats = { sharedQueue.jobsRun, sharedQueue.jobsStolen };
+	for (unsigned int i = 0; i < queues.size(); i++)
+	{
+		stats.jobsRun += queues[i]->jobsRun;
+		stats.jobsStolen += queues[i]->jobsStolen;
+	}
+	return stats;
+}
+
+std::string JobSystem::getStatsText() const
+{
+	JobStats stats = getStats();
+	std::ostringstream text;
+	text << "Jobs: " << getThreadCount() << " threads | Run: " << stats.jobsRun << " | Stolen: " << stats.jobsStolen;
+	return text.str();
+}
+
+
+
+//--- Methods ---//
+void JobSystem::init(unsigned int threadCount)
+{
+	shutdown();
+
+	//One thread per core by default. hardware_concurrency() can return 0 if it doesn't know
+	if (threadCount == 0)
+		threadCount = std::max(std::thread::hardware_concurrency(), 1u);
+	threadCount = std::min(threadCount, (unsigned int)JOB_MAX_THREADS);
+
+	//Make every queue before any worker starts, since the workers steal from each other's queues straight away
+	for (unsigned int i = 0; i < threadCount; i++)
+	{
+		queues.push_back(std::unique_ptr<JobQueue>(new JobQueue()));
+		queues[i]->jobsRun = 0;
+		queues[i]->jobsStolen = 0;
+	}
+
+	//The calling thread is the main thread and gets the first queue. The workers get the rest
+	currentQueueIndex = 0;
+	quitWorkers = false;
+	for (unsigned int i = 1; i < threadCount; i++)
+		workers.push_back(std::thread(&JobSystem::workerLoop, this, i));
+}
+
+void JobSystem::shutdown()
+{
+	{
+		std::lock_guard<std::mutex> lock(sleepMutex);
+		quitWorkers = true;
+	}
+	wakeWorkers.notify_all();
+
+	for (unsigned int i = 0; i < workers.size(); i++)
+		workers[i].join();
+	workers.clear();
+
+	//Run anything that was left over so nobody waits on a job that never happens
+	//The queues have to stay around until then, since the jobs can start more jobs
+	JobHandle job;
+	while (findJob(job))
+		runJob(job);
+
+	queues.clear();
+	currentQueueIndex = -1;
+}
+
+JobHandle JobSystem::create(const std::function<void()>& work)
+{
+	JobHandle job = std::make_shared<Job>();
+	job->work = work;
+	job->pendingDependencies = 1;
+	job->done = false;
+	return job;
+}
+
+void JobSystem::addDependency(const JobHandle& job, const JobHandle& dependsOn)
+{
+	if (!job || !dependsOn)
+		return;
+
+	//Add the job to the other one's list, unless it has already finished. The lock makes sure it can't finish in between checking and adding
+	std::lock_guard<std::mutex> lock(dependsOn->mutex);
+	if (dependsOn->done)
+		return;
+
+	job->pendingDependencies++;
+	dependsOn->dependents.push_back(job);
+}
+
+void JobSystem::submit(const JobHandle& job)
+{
+	//Take away the count that stood for the submit. If nothing else is left, the job is ready
+	if (job && --job->pendingDependencies == 0)
+		push(job);
+}
+
+JobHandle JobSystem::run(const std::function<void()>& work)
+{
+	JobHandle job = create(work);
+	submit(job);
+	return job;
+}
+
+JobHandle JobSystem::run(const std::function<void()>& work, const std::vector<JobHandle>& dependencies)
+{
+	JobHandle job = create(work);
+	for (unsigned int i = 0; i < dependencies.size(); i++)
+		addDependency(job, dependencies[i]);
+	submit(job);
+	return job;
+}
+
+void JobSystem::wait(const JobHandle& job)
+{
+	//Help out until the job is done. If there is nothing to take, the job is running somewhere else (or waiting on something that is), so just give up the rest of the time slice
+	while (!isDone(job))
+	{
+		JobHandle other;
+		if (findJob(other))
+			runJob(other);
+		else
+			std::this_thread::yield();
+	}
+}
+
+void JobSystem::wait(const std::vector<JobHandle>& jobs)
+{
+	for (unsigned int i = 0; i < jobs.size(); i++)
+		wait(jobs[i]);
+}
+
+void JobSystem::parallelFor(unsigned int count, unsigned int grainSize, const ParallelForBody& body, unsigned int maxThreads)
+{
+	if (count == 0)
+		return;
+
+	//Work out how many pieces there are, and how many threads are worth using on them
+	grainSize = std::max(grainSize, 1u);
+	unsigned int numPieces = (count + grainSize - 1) / grainSize;
+	unsigned int numThreads = getThreadCount();
+	if (maxThreads > 0)
+		numThreads = std::min(numThreads, maxThreads);
+	numThreads = std::min(numThreads, numPieces);
+
+	//Every thread takes the next piece nobody has taken yet until they are all gone. A thread that finishes early just takes more
+	std::atomic<unsigned int> nextPiece(0);
+	auto runPieces = [&](unsigned int slot)
+	{
+		for (unsigned int piece = nextPiece++; piece < numPieces; piece = nextPiece++)
+			body(piece * grainSize, std::min(count, (piece + 1) * grainSize), slot);
+	};
+
+	//Start a helper job for every other thread. They go on this thread's queue, where the idle threads steal them from
+	//A helper that starts after every piece is taken just finishes straight away, so it doesn't matter how late they get going
+	std::vector<JobHandle> helpers;
+	helpers.reserve(numThreads);
+	for (unsigned int slot = 1; slot < numThreads; slot++)
+		helpers.push_back(run([&runPieces, slot]() { runPieces(slot); }));
+
+	//Work on the loop here too, then wait for the helpers. They use things on this function's stack, so they HAVE to be done before it returns
+	runPieces(0);
+	wait(helpers);
+}
+
+void JobSystem::resetStats()
+{
+	sharedQueue.jobsRun = 0;
+	sharedQueue.jobsStolen = 0;
+	for (unsigned int i = 0; i < queues.size(); i++)
+	{
+		queues[i]->jobsRun = 0;
+		queues[i]->jobsStolen = 0;
+	}
+}
+
+
+
+//--- Singleton Instance ---//
+JobSystem* JobSystem::getInstance()
+{
+	//Generate the singleton if it hasn't been created yet
+	if (!inst)
+		inst = new JobSystem();
+
+	//Return the singleton
+	return inst;
+}
+
+
+
+//--- Utility Functions ---//
+void JobSystem::workerLoop(unsigned int queueIndex)
+{
+	currentQueueIndex = (int)queueIndex;
+
+	while (true)
+	{
+		//Look for a job a few times before giving up. Jobs usually come in bunches, so the next one is often only a moment away
+		JobHandle job;
+		bool found = false;
+		for (unsigned int attempt = 0; attempt < JOB_SPIN_COUNT && !found; attempt++)
+		{
+			found = findJob(job);
+			if (!found)
+				std::this_thread::yield();
+		}
+
+		if (found)
+		{
+			runJob(job);
+			continue;
+		}
+
+		//Go to sleep until a job is queued or it is time to quit
+		//The count is checked while holding the lock, and push() takes the same lock before waking anyone, so a job queued right now can't be missed
+		std::unique_lock<std::mutex> lock(sleepMutex);
+		sleepingWorkers++;
+		wakeWorkers.wait(lock, [this]() { return quitWorkers || queuedJobs > 0; });
+		sleepingWorkers--;
+		if (quitWorkers)
+			return;
+	}
+}
+
+void JobSystem::push(const JobHandle& job)
+{
+	//Count the job before it goes on the queue, so the count is never lower than the number of jobs a thread could find
+	queuedJobs++;
+	JobQueue& queue = getCurrentQueue();
+	{
+		std::lock_guard<std::mutex> lock(queue.mutex);
+		queue.jobs.push_back(job);
+	}
+
+	//Wake a worker up if any are asleep. Nobody needs the lock while they are all awake, since they are already looking for work
+	if (sleepingWorkers > 0)
+	{
+		std::lock_guard<std::mutex> lock(sleepMutex);
+		wakeWorkers.notify_one();
+	}
+}
+
+bool JobSystem::findJob(JobHandle& jobOut)
+{
+	//Nothing is queued anywhere, so don't bother locking every queue to find that out
+	if (queuedJobs == 0)
+		return false;
+
+	//Take the newest job off of this thread's own queue first
+	int ownIndex = currentQueueIndex;
+	if (ownIndex >= 0 && ownIndex < (int)queues.size())
+	{
+		JobQueue& own = *queues[ownIndex];
+		std::lock_guard<std::mutex> lock(own.mutex);
+		if (!own.jobs.empty())
+		{
+			jobOut = std::move(own.jobs.back());
+			own.jobs.pop_back();
+			queuedJobs--;
+			return true;
+		}
+	}
+
+	//Then anything handed in from outside the job system
+	{
+		std::lock_guard<std::mutex> lock(sharedQueue.mutex);
+		if (!sharedQueue.jobs.empty())
+		{
+			jobOut = std::move(sharedQueue.jobs.front());
+			sharedQueue.jobs.pop_front();
+			queuedJobs--;
+			return true;
+		}
+	}
+
+	//Then steal the oldest job from the other threads, starting with the one after this one so the thieves spread out
+	unsigned int numQueues = (unsigned int)queues.size();
+	for (unsigned int i = 1; i <= numQueues; i++)
+	{
+		unsigned int victim = (unsigned int)(ownIndex + (int)i) % numQueues;
+		if ((int)victim == ownIndex)
+			continue;
+
+		JobQueue& other = *queues[victim];
+		std::lock_guard<std::mutex> lock(other.mutex);
+		if (!other.jobs.empty())
+		{
+			jobOut = std::move(other.jobs.front());
+			other.jobs.pop_front();
+			queuedJobs--;
+			getCurrentQueue().jobsStolen++;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+void JobSystem::runJob(const JobHandle& job)
+{
+	job->work();
+	getCurrentQueue().jobsRun++;
+
+	//Mark it done and grab the list of jobs waiting on it in one go, so addDependency() can't add to the list after this
+	std::vector<JobHandle> dependents;
+	{
+		std::lock_guard<std::mutex> lock(job->mutex);
+		job->done.store(true, std::memory_order_release);
+		dependents.swap(job->dependents);
+	}
+
+	//Start every waiting job that was only waiting on this one
+	for (unsigned int i = 0; i < dependents.size(); i++)
+	{
+		if (--dependents[i]->pendingDependencies == 0)
+			push(dependents[i]);
+	}
+}
+
+JobSystem::JobQueue& JobSystem::getCurrentQueue()
+{
+	int index = currentQueueIndex;
+	if (index >= 0 && index < (int)queues.size())
+		return *queues[index];
+
+	return sharedQueue;
+}
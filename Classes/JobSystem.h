@@ -0,0 +1,198 @@
+/*
+============================================================
+	Job System:
+		- Runs small pieces of work ('jobs') on a pool of worker threads that lives for the whole game. Anything in the scene can hand work to it instead of starting its own threads
+			> Before this, the particle updater had its own threads and everything else ran on the main thread one thing after another
+			> The asset preloader still has its own threads (see AssetPreloader.h). They spend most of their time waiting on the disk, which would hold up the jobs behind them
+		- Every thread has its own queue of jobs. Jobs a thread starts go on the back of its own queue, and it takes its next job from the back too, so it keeps working on what it just started (which is likely still in the cache)
+			> A thread that runs out of work 'steals' from the front of another thread's queue. The oldest jobs are usually the biggest (ex: the first half of a big loop), so a steal is worth the trip
+			> This is called 'work stealing'. Nobody hands the jobs out, so there is no single queue for every thread to fight over
+		- A job can depend on other jobs. It only goes on a queue once every job it depends on has finished
+		- parallelFor() splits a loop into pieces and runs them on as many threads as are free. The thread that calls it works on the loop too
+		- Waiting on a job doesn't just sleep. The waiting thread runs other jobs until the one it wants is done, so jobs can wait on other jobs without tying up a thread
+
+	Usage:
+		- AppDelegate starts the workers with init() and stops them with shutdown(). The thread that calls init() is the 'main' thread and counts as one of the threads
+		- run() a function to start it right away, or create() it, addDependency() and then submit() it to start it once other jobs are done
+		- wait() on a job before using anything it writes to
+		- Use parallelFor() for loops where every item can be worked on separately (ex: moving thousands of particles)
+
+	Note:
+		- Jobs can't touch Cocos2D nodes, textures or anything else that isn't thread safe. Stick to your own lists of numbers, and do the node work on the main thread before or after
+		- The profiler only records the main thread. PROFILE_SCOPE() inside a job that ends up on a worker is skipped
+		- Each queue is a std::deque with its own mutex. Only the owner and the odd thief ever lock it, so the lock is almost never fought over
+		- If init() was never called, there are no workers and the jobs run on whichever thread waits on them
+		- This class uses the Singleton design pattern
+			> There is a macro "JOBS->" that provides a shortcut for getting the singleton instance
+============================================================
+*/
+
+#ifndef JOBSYSTEM_H
+#define JOBSYSTEM_H
+
+//Core Libraries
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <stdint.h>
+
+#define JOB_MAX_THREADS 64 //The most threads the job system will start, counting the main thread
+#define JOB_SPIN_COUNT 64 //How many times a worker looks for a job before it goes to sleep. Spinning for a moment means a job handed out right after the last one finished doesn't have to wake the thread
+
+//A job. Only the job system looks inside, everybody else just holds on to the handle
+struct Job;
+typedef std::shared_ptr<Job> JobHandle;
+
+//The body of a parallelFor(). Runs the items from first up to (but not including) last. Slot is which of the threads working on the loop is running it, from 0 (the caller) up to one less than the number of threads
+typedef std::function<void(unsigned int first, unsigned int last, unsigned int slot)> ParallelForBody;
+
+/*
+	Job Stats Struct
+	- Counters for the job system. They add up from the start, or since resetStats() was called
+
+	> JobsRun -> How many jobs have finished
+	> JobsStolen -> How many of those were taken from another thread's queue
+*/
+struct JobStats
+{
+	uint64_t jobsRun;
+	uint64_t jobsStolen;
+};
+
+
+
+/*
+	Job System Class:
+	> Getters
+		- Get the number of threads
+		- Get if a job is done
+		- Get the counters
+	> Methods
+		- Start and stop the workers
+		- Create, chain together and submit jobs
+		- Wait for a job
+		- Run a loop across every thread
+*/
+class JobSystem
+{
+protected:
+	//--- Constructor ---//
+	JobSystem(); //The constructor is protected so only one instance of this class can ever exist. This is called the singleton pattern.
+
+public:
+	//--- Destructor ---//
+	~JobSystem();
+
+
+
+	//--- Getters ---//
+	unsigned int getThreadCount() const; //Get how many threads run jobs, counting the main thread. 1 means there are no workers
+	bool isDone(const JobHandle& job) const; //Get if a job has finished. An empty handle counts as done
+	JobStats getStats() const; //Get the counters
+	std::string getStatsText() const; //Get the thread count and the counters as a line of text. Used in the profiler overlay
+
+
+
+	//--- Methods ---//
+	/*
+		Start the worker threads. Call this once from the main thread before anything uses the jobs. Calling it again stops the old workers first
+
+		@param ThreadCount -> How many threads, counting the one calling this. 0 means one per CPU core. Clamped to JOB_MAX_THREADS
+	*/
+	void init(unsigned int threadCount);
+
+	void shutdown(); //Stop the worker threads. Any jobs still queued are run on the calling thread first, so nothing is lost
+
+	/*
+		Make a job without starting it, so dependencies can be added to it first
+
+		@param Work -> The function the job runs
+		@return Returns -> The job. Hand it to submit() to start it
+	*/
+	JobHandle create(const std::function<void()>& work);
+
+	/*
+		Make a job wait for another one. Only call this before the job is submitted
+
+		@param Job -> The job that has to wait
+		@param DependsOn -> The job it waits for. If it is already done, nothing happens
+	*/
+	void addDependency(const JobHandle& job, const JobHandle& dependsOn);
+
+	void submit(const JobHandle& job); //Start a job. It goes on the calling thread's queue once every job it depends on is done
+
+	JobHandle run(const std::function<void()>& work); //Make a job and start it straight away
+	JobHandle run(const std::function<void()>& work, const std::vector<JobHandle>& dependencies); //Make a job that starts once all of the given jobs are done
+
+	/*
+		Wait for a job to finish. The calling thread runs other jobs in the meantime
+
+		@param Job -> The job to wait for. Nothing happens if the handle is empty
+	*/
+	void wait(const JobHandle& job);
+
+	void wait(const std::vector<JobHandle>& jobs); //Wait for every job in the list
+
+	/*
+		Run a loop across every thread and wait for it to finish. The items are cut into pieces of grainSize, and each thread takes the next piece as soon as it is free
+
+		@param Count -> How many items there are
+		@param GrainSize -> How many items are in each piece. Big enough that grabbing a piece costs nothing next to working on it, small enough that every thread gets some
+		@param Body -> The function run on each piece. Pieces run at the same time, so they can't write to the same things unless they use the slot to keep them apart
+		@param MaxThreads -> The most threads to use, counting the caller. 0 means all of them
+	*/
+	void parallelFor(unsigned int count, unsigned int grainSize, const ParallelForBody& body, unsigned int maxThreads = 0);
+
+	void resetStats(); //Set the counters back to 0
+
+
+
+	//--- Singleton Instance ---//
+	/*
+		Get the instance of the singleton. You shouldn't ever need to call this directly since the macro (JOBS->) automatically calls it
+
+		@return Returns -> The singleton instance of this class. This is the ONLY instance of this class so intrefacing HAS to be done through this instance.
+	*/
+	static JobSystem* getInstance();
+
+private:
+	//--- Private Data ---//
+	//One thread's queue. Padded so two threads' queues never share a cache line
+	struct JobQueue
+	{
+		std::deque<JobHandle> jobs; //The owner pushes and pops the back, thieves take from the front
+		std::mutex mutex; //Protects the jobs
+		std::atomic<uint64_t> jobsRun; //How many jobs the owner has run. Only the owner adds to it, so it is never fought over
+		std::atomic<uint64_t> jobsStolen; //How many of those it stole
+		char padding[64];
+	};
+
+	std::vector<std::unique_ptr<JobQueue>> queues; //One per thread. The main thread is 0
+	JobQueue sharedQueue; //Where jobs from threads that aren't part of the job system go (ex: the physics worker). Every thread takes from it
+	std::vector<std::thread> workers; //The worker threads. One less than the thread count
+	std::atomic<unsigned int> queuedJobs; //How many jobs are sitting in the queues. The workers sleep while this is 0
+	std::atomic<unsigned int> sleepingWorkers; //How many workers are asleep. Nobody needs to be woken up while this is 0
+	std::mutex sleepMutex; //Lets the workers go to sleep without missing a job that was queued at the same moment
+	std::condition_variable wakeWorkers; //Wakes a worker up when there is a job or it should quit
+	bool quitWorkers; //True when the workers should stop. Protected by the sleep mutex
+
+	//--- Utility Functions ---//
+	void workerLoop(unsigned int queueIndex); //What each worker runs. Runs jobs until it is told to quit
+	void push(const JobHandle& job); //Put a ready job on the calling thread's queue and wake a worker up for it
+	bool findJob(JobHandle& jobOut); //Take the calling thread's next job, from its own queue first, then the shared queue, then by stealing. False if there aren't any
+	void runJob(const JobHandle& job); //Run a job, mark it done and start anything that was waiting on it
+	JobQueue& getCurrentQueue(); //Get the queue belonging to the calling thread, or the shared one if it isn't part of the job system
+
+	//--- Singleton Instance ---//
+	static JobSystem* inst; //The singleton instance. Ie: The only instance of this class that can ever exist
+};
+
+#define JOBS JobSystem::getInstance() //Macro to make using the job system easier. Automatically gets the singleton instance
+
+#endif
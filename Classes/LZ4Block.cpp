@@ -0,0 +1,177 @@
+#include "LZ4Block.h"
+
+//Core Libraries
+#include <cstring>
+#include <stdint.h>
+#include <vector>
+
+//The rules of the block format. A match is at least 4 bytes, the last 5 bytes are always literals, and the last match has to start at least 12 bytes before the end
+static const size_t MIN_MATCH = 4;
+static const size_t LAST_LITERALS = 5;
+static const size_t MATCH_FIND_LIMIT = 12;
+static const size_t MAX_OFFSET = 65535;
+
+//How many bits of the hash are used to look up where a 4 byte sequence was last seen
+static const unsigned int HASH_BITS = 16;
+
+static uint32_t read32(const unsigned char* bytes)
+{
+	uint32_t value;
+	memcpy(&value, bytes, sizeof(value));
+	return value;
+}
+
+//Write a length that didn't fit in its 4 bits of the token. It is written 255 at a time, then whatever is left
+static bool writeLength(size_t length, unsigned char*& out, const unsigned char* outEnd)
+{
+	while (length >= 255)
+	{
+		if (out >= outEnd)
+			return false;
+		*out++ = 255;
+		length -= 255;
+	}
+
+	if (out >= outEnd)
+		return false;
+	*out++ = (unsigned char)length;
+	return true;
+}
+
+//Read a length that didn't fit in its 4 bits of the token
+static bool readLength(size_t& length, const unsigned char*& in, const unsigned char* inEnd)
+{
+	unsigned char byte;
+	do
+	{
+		if (in >= inEnd)
+			return false;
+		byte = *in++;
+		length += byte;
+	} while (byte == 255);
+
+	return true;
+}
+
+//Write one sequence. A match length of 0 means the literals are the last thing in the block
+static bool writeSequence(const unsigned char* literals, size_t literalLength, size_t offset, size_t matchLength, unsigned char*& out, const unsigned char* outEnd)
+{
+	//The token holds both lengths, 4 bits each. 15 means the rest of the length follows
+	if (out >= outEnd)
+		return false;
+	size_t matchCode = (matchLength > 0) ? matchLength - MIN_MATCH : 0;
+	*out++ = (unsigned char)(((literalLength < 15) ? literalLength : 15) << 4 | ((matchCode < 15) ? matchCode : 15));
+	if (literalLength >= 15 && !writeLength(literalLength - 15, out, outEnd))
+		return false;
+
+	if ((size_t)(outEnd - out) < literalLength)
+		return false;
+	memcpy(out, literals, literalLength);
+	out += literalLength;
+
+	if (matchLength == 0)
+		return true;
+
+	//How far back the match is, then the rest of its length
+	if (outEnd - out < 2)
+		return false;
+	*out++ = (unsigned char)(offset & 0xFF);
+	*out++ = (unsigned char)(offset >> 8);
+	return matchCode < 15 || writeLength(matchCode - 15, out, outEnd);
+}
+
+
+
+//--- Methods ---//
+size_t LZ4Block::getMaxCompressedSize(size_t size)
+{
+	return size + size / 255 + 16;
+}
+
+size_t LZ4Block::compress(const unsigned char* source, size_t sourceSize, unsigned char* destination, size_t destinationCapacity)
+{
+	unsigned char* out = destination;
+	const unsigned char* outEnd = destination + destinationCapacity;
+
+	//Remember where each 4 byte sequence was last seen. If the same 4 bytes show up again close enough, that is a match
+	std::vector<int64_t> lastSeen((size_t)1 << HASH_BITS, -1);
+	size_t anchor = 0; //The first byte that hasn't been written yet
+	size_t position = 0;
+	size_t searchEnd = (sourceSize > MATCH_FIND_LIMIT) ? sourceSize - MATCH_FIND_LIMIT : 0;
+	while (position < searchEnd)
+	{
+		uint32_t sequence = read32(source + position);
+		uint32_t hash = (sequence * 2654435761u) >> (32 - HASH_BITS);
+		int64_t candidate = lastSeen[hash];
+		lastSeen[hash] = (int64_t)position;
+
+		if (candidate < 0 || position - (size_t)candidate > MAX_OFFSET || read32(source + candidate) != sequence)
+		{
+			position++;
+			continue;
+		}
+
+		//Found one. See how far it goes, stopping before the bytes that have to be literals
+		size_t matchLength = MIN_MATCH;
+		size_t maxLength = sourceSize - LAST_LITERALS - position;
+		while (matchLength < maxLength && source[candidate + matchLength] == source[position + matchLength])
+			matchLength++;
+
+		if (!writeSequence(source + anchor, position - anchor, position - (size_t)candidate, matchLength, out, outEnd))
+			return 0;
+
+		position += matchLength;
+		anchor = position;
+	}
+
+	//Everything after the last match goes out as literals
+	if (!writeSequence(source + anchor, sourceSize - anchor, 0, 0, out, outEnd))
+		return 0;
+
+	return (size_t)(out - destination);
+}
+
+bool LZ4Block::decompress(const unsigned char* source, size_t sourceSize, unsigned char* destination, size_t destinationSize)
+{
+	const unsigned char* in = source;
+	const unsigned char* inEnd = source + sourceSize;
+	unsigned char* out = destination;
+	unsigned char* outEnd = destination + destinationSize;
+
+	while (in < inEnd)
+	{
+		//Copy the literals straight across
+		unsigned char token = *in++;
+		size_t literalLength = token >> 4;
+		if (literalLength == 15 && !readLength(literalLength, in, inEnd))
+			return false;
+		if ((size_t)(inEnd - in) < literalLength || (size_t)(outEnd - out) < literalLength)
+			return false;
+		memcpy(out, in, literalLength);
+		in += literalLength;
+		out += literalLength;
+
+		//The last sequence has no match
+		if (in == inEnd)
+			break;
+
+		//Copy the match from earlier in the output. It can overlap the bytes being written (ex: a run of the same byte), so it is copied a byte at a time
+		if (inEnd - in < 2)
+			return false;
+		size_t offset = (size_t)in[0] | ((size_t)in[1] << 8);
+		in += 2;
+		size_t matchLength = token & 15;
+		if (matchLength == 15 && !readLength(matchLength, in, inEnd))
+			return false;
+		matchLength += MIN_MATCH;
+
+		if (offset == 0 || offset > (size_t)(out - destination) || (size_t)(outEnd - out) < matchLength)
+			return false;
+		const unsigned char* match = out - offset;
+		for (size_t i = 0; i < matchLength; i++)
+			out[i] = match[i];
+		out += matchLength;
+	}
+
+	return out == outEnd;
+}
@@ -0,0 +1,61 @@
+/*
+============================================================
+	LZ4 Block:
+		- Compresses and decompresses data in the LZ4 'block' format. Cocos2D doesn't come with LZ4, and only the block format is needed, so it is written out here
+			> LZ4 doesn't squeeze data down as much as zlib, but it decompresses several times faster. For loading textures, the time spent decompressing matters more than the size on disk
+		- The data is a list of 'sequences'. Each one is some bytes copied straight from the input (literals), then a copy of bytes that appeared earlier (a match)
+			> Decompressing is just copying bytes around, so there is nothing to decode like there is with a PNG
+		- The compressor is the simple 'greedy' one: it takes the first match it finds. It only runs when textures are cooked (see TextureCooker), so it doesn't need to be fast
+
+	Usage:
+		- Make room for getMaxCompressedSize() bytes, then call compress()
+		- The size of the original data isn't stored in the block, so keep it next to the block (ex: in a file header) and hand it to decompress()
+
+	Note:
+		- Blocks from any other LZ4 compressor can be decompressed too, since it is the standard block format
+		- decompress() checks every read and write, so a broken or cut off block returns false instead of writing past the end of the buffers
+============================================================
+*/
+
+#ifndef LZ4BLOCK_H
+#define LZ4BLOCK_H
+
+//Core Libraries
+#include <cstddef>
+
+/*
+	LZ4 Block Class:
+	> Methods
+		- Get the most space a compressed block can take
+		- Compress and decompress a block
+*/
+class LZ4Block
+{
+public:
+	//--- Methods ---//
+	static size_t getMaxCompressedSize(size_t size); //Get the most bytes compress() can write for data of a given size. Data that doesn't compress at all comes out a little bigger
+
+	/*
+		Compress data into an LZ4 block
+
+		@param Source -> The data to compress
+		@param SourceSize -> How many bytes of data there are
+		@param Destination -> Where to write the block
+		@param DestinationCapacity -> How much room there is to write to. getMaxCompressedSize() is always enough
+		@return Returns -> How many bytes the block is. 0 if it didn't fit
+	*/
+	static size_t compress(const unsigned char* source, size_t sourceSize, unsigned char* destination, size_t destinationCapacity);
+
+	/*
+		Decompress an LZ4 block
+
+		@param Source -> The block
+		@param SourceSize -> How many bytes the block is
+		@param Destination -> Where to write the original data
+		@param DestinationSize -> How many bytes the original data is. This has to be exact
+		@return Returns -> True if the block decompressed to exactly that many bytes. False if it is broken
+	*/
+	static bool decompress(const unsigned char* source, size_t sourceSize, unsigned char* destination, size_t destinationSize);
+};
+
+#endif
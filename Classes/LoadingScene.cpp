@@ -0,0 +1,57 @@
+#include "LoadingScene.h"
+#include "DisplayHandler.h"
+#include "InputHandler.h"
+#include "AssetPreloader.h"
+
+//--- Engine Functions ---//
+bool LoadingScene::init()
+{
+	//Ensure the super class's init function was called first
+	if (!Scene::init())
+		return false;
+
+
+
+	//Create the progress bar
+	//There is no text on this screen on purpose. The fonts are still loading, so a label would have to load its font right here and that is exactly what we are trying to avoid!
+	//A DrawNode doesn't need any images or fonts, so it can be shown before anything else is ready
+	progressBar = DrawNode::create();
+	this->addChild(progressBar);
+	shownProgress = 0.0f;
+
+
+
+	//Allow for the update() function to be called by Cocos2D so the bar fills up as the assets load
+	this->scheduleUpdate();
+
+
+
+	//Let cocos know that the init function was successful
+	return true;
+}
+
+void LoadingScene::update(float deltaTime)
+{
+	//There is nothing to click on while loading, but the input handler is still collecting events
+	//Apply and clear them every frame anyways so its queue doesn't fill up while we wait
+	INPUTS->processQueuedEvents();
+	INPUTS->clearForNextFrame();
+
+
+
+	//Slide the bar towards the real progress. Some of the assets load much faster than others so this keeps it from jumping around
+	//*** Try setting shownProgress straight to the progress instead. Which one looks better? ***//
+	float progress = PRELOADER->getProgress();
+	shownProgress += (progress - shownProgress) * std::min(1.0f, deltaTime * 10.0f);
+
+
+
+	//Redraw the bar. It is an outline with a filled box inside it that gets wider as things load
+	Vec2 windowSize = DISPLAY->getWindowSizeAsVec2();
+	Vec2 barSize = Vec2(windowSize.x * 0.6f, 16.0f);
+	Vec2 barOrigin = (windowSize - barSize) / 2.0f;
+
+	progressBar->clear();
+	progressBar->drawSolidRect(barOrigin, barOrigin + Vec2(barSize.x * shownProgress, barSize.y), Color4F(1.0f, 0.8f, 0.0f, 1.0f));
+	progressBar->drawRect(barOrigin, barOrigin + barSize, Color4F::WHITE);
+}
@@ -0,0 +1,22 @@
+#pragma once
+
+//3rd Party Libraries
+#include "cocos2d.h"
+
+//Namespaces
+using namespace cocos2d;
+
+
+class LoadingScene : public cocos2d::Scene
+{
+public:
+	//Engine Functions (Only functions supplied by Cocos2D)
+	virtual bool init(); //Create the progress bar. Sort of like the constructor for scenes
+	void update(float deltaTime); //Called every frame. Fills the progress bar up to however much the preloader has finished
+	CREATE_FUNC(LoadingScene); //This is a special macro'd function created by Cocos2D. It automatically releases the memory for this scene when it is no longer being used by anything
+
+private:
+	//Progress bar
+	DrawNode* progressBar; //The bar across the middle of the screen. Redrawn every frame as the assets load
+	float shownProgress; //How full the bar is drawn. Slides towards the real progress so the bar doesn't jump
+};
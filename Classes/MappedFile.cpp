@@ -0,0 +1,199 @@
+#include "MappedFile.h"
+
+//Platform Libraries
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+
+
+//--- Constructors and Destructors ---//
+MappedFile::MappedFile()
+{
+	//Init the private data
+#ifdef _WIN32
+	fileHandle = INVALID_HANDLE_VALUE;
+	mappingHandle = nullptr;
+#else
+	fileDescriptor = -1;
+#endif
+	view = nullptr;
+	viewLength = 0;
+	size = 0;
+}
+
+MappedFile::~MappedFile()
+{
+	//Let go of the OS handles
+	close();
+}
+
+
+
+//--- Getters ---//
+bool MappedFile::isOpen() const
+{
+#ifdef _WIN32
+	return fileHandle != INVALID_HANDLE_VALUE;
+#else
+	return fileDescriptor >= 0;
+#endif
+}
+
+uint64_t MappedFile::getSize() const
+{
+	return size;
+}
+
+
+
+//--- Methods ---//
+bool MappedFile::open(const std::string& path)
+{
+	//Close whatever was open before
+	close();
+
+#ifdef _WIN32
+	//Open the file for reading. The sequential scan flag tells Windows to read ahead since the file is read from front to back
+	fileHandle = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+	if (fileHandle == INVALID_HANDLE_VALUE)
+		return false;
+
+	//Get the size of the file
+	LARGE_INTEGER fileSize;
+	if (!GetFileSizeEx(fileHandle, &fileSize))
+	{
+		close();
+		return false;
+	}
+	size = (uint64_t)fileSize.QuadPart;
+
+	//Create the mapping object. Windows can't map an empty file so there is nothing else to do in that case
+	if (size > 0)
+	{
+		mappingHandle = CreateFileMappingA(fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		if (!mappingHandle)
+		{
+			close();
+			return false;
+		}
+	}
+#else
+	//Open the file for reading
+	fileDescriptor = ::open(path.c_str(), O_RDONLY);
+	if (fileDescriptor < 0)
+		return false;
+
+	//Get the size of the file
+	struct stat fileStats;
+	if (fstat(fileDescriptor, &fileStats) != 0)
+	{
+		close();
+		return false;
+	}
+	size = (uint64_t)fileStats.st_size;
+#endif
+
+	return true;
+}
+
+void MappedFile::close()
+{
+	//Unmap the view before closing the handles it came from
+	unmap();
+
+#ifdef _WIN32
+	if (mappingHandle)
+		CloseHandle(mappingHandle);
+	if (fileHandle != INVALID_HANDLE_VALUE)
+		CloseHandle(fileHandle);
+	mappingHandle = nullptr;
+	fileHandle = INVALID_HANDLE_VALUE;
+#else
+	if (fileDescriptor >= 0)
+		::close(fileDescriptor);
+	fileDescriptor = -1;
+#endif
+
+	size = 0;
+}
+
+const unsigned char* MappedFile::map(uint64_t offset, size_t length)
+{
+	//Only one view is mapped at a time
+	unmap();
+
+	//Make sure there is actually something to map
+	if (!isOpen() || offset >= size || length == 0)
+		return nullptr;
+
+	//Cut the length short if it goes past the end of the file
+	if (length > size - offset)
+		length = (size_t)(size - offset);
+
+	//The OS needs the view to start on a multiple of the granularity, so start a bit early and skip over the extra bytes in the pointer we return
+	uint64_t alignedOffset = offset - (offset % getGranularity());
+	size_t leadingBytes = (size_t)(offset - alignedOffset);
+	size_t alignedLength = length + leadingBytes;
+
+#ifdef _WIN32
+	view = MapViewOfFile(mappingHandle, FILE_MAP_READ, (DWORD)(alignedOffset >> 32), (DWORD)(alignedOffset & 0xFFFFFFFF), alignedLength);
+	if (!view)
+		return nullptr;
+#else
+	view = mmap(nullptr, alignedLength, PROT_READ, MAP_PRIVATE, fileDescriptor, (off_t)alignedOffset);
+	if (view == MAP_FAILED)
+	{
+		view = nullptr;
+		return nullptr;
+	}
+
+	//Tell the OS the view is read from front to back so it reads ahead and drops pages behind us
+	madvise(view, alignedLength, MADV_SEQUENTIAL);
+#endif
+
+	viewLength = alignedLength;
+	return (const unsigned char*)view + leadingBytes;
+}
+
+const unsigned char* MappedFile::mapAll()
+{
+	//Map from the start of the file to the end of it
+	return map(0, (size_t)size);
+}
+
+void MappedFile::unmap()
+{
+	if (!view)
+		return;
+
+#ifdef _WIN32
+	UnmapViewOfFile(view);
+#else
+	munmap(view, viewLength);
+#endif
+
+	view = nullptr;
+	viewLength = 0;
+}
+
+
+
+//--- Utility Functions ---//
+size_t MappedFile::getGranularity()
+{
+#ifdef _WIN32
+	//Windows views have to start on the allocation granularity (normally 64KB), not just the page size
+	SYSTEM_INFO systemInfo;
+	GetSystemInfo(&systemInfo);
+	return (size_t)systemInfo.dwAllocationGranularity;
+#else
+	return (size_t)sysconf(_SC_PAGESIZE);
+#endif
+}
@@ -0,0 +1,105 @@
+/*
+============================================================
+	Mapped File:
+		- Read-only access to a file through the operating system's memory mapping
+		- The file is never loaded into memory all at once. The OS pages in the parts that are actually read and can throw them away again when memory is needed
+			> This means huge files (ex: hours of recorded input) can be read without using hours worth of RAM
+		- A 'view' of any part of the file can be mapped. Only one view is mapped at a time, mapping a new one unmaps the old one
+			> Use mapAll() for small files you want to read all at once
+			> Use map() with a window size for huge files. This also keeps 32-bit builds from running out of address space
+
+	Note:
+		- Uses CreateFileMapping / MapViewOfFile on Windows and mmap on everything else
+		- The file is opened for sequential reading so the OS reads ahead
+============================================================
+*/
+
+#ifndef MAPPEDFILE_H
+#define MAPPEDFILE_H
+
+//Core Libraries
+#include <string>
+#include <stdint.h>
+#include <cstddef>
+
+/*
+	Mapped File Class:
+	> Getters
+		- Get if the file is open
+		- Get the size of the file
+	> Methods
+		- Open and close the file
+		- Map part of the file or the whole file
+		- Unmap the current view
+*/
+class MappedFile
+{
+public:
+	//--- Constructors and Destructors ---//
+	MappedFile();
+	~MappedFile(); //Unmaps and closes the file if it is still open
+
+	//A mapped file can't be copied since it owns the OS handles
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+
+
+
+	//--- Getters ---//
+	bool isOpen() const; //Get if a file is open
+	uint64_t getSize() const; //Get the size of the open file in bytes. 0 if no file is open
+
+
+
+	//--- Methods ---//
+	/*
+		Open a file for reading. Nothing is mapped until map() or mapAll() is called
+
+		@param Path -> The path to the file
+		@return Returns -> True if the file was opened. False if it doesn't exist or couldn't be read
+	*/
+	bool open(const std::string& path);
+
+	/*
+		Unmap the current view and close the file
+	*/
+	void close();
+
+	/*
+		Map part of the file into memory. Any view that was already mapped is unmapped first, so pointers into it are no longer valid
+
+		@param Offset -> Where the view starts, in bytes from the start of the file. Does NOT have to be aligned to anything
+		@param Length -> How many bytes to map. Cut short if it goes past the end of the file
+		@return Returns -> A pointer to the byte at the offset. nullptr if the mapping failed or the offset is past the end of the file
+	*/
+	const unsigned char* map(uint64_t offset, size_t length);
+
+	/*
+		Map the entire file into memory. Same as map(0, getSize())
+
+		@return Returns -> A pointer to the start of the file. nullptr if the mapping failed or the file is empty
+	*/
+	const unsigned char* mapAll();
+
+	/*
+		Unmap the current view, if there is one. The file stays open
+	*/
+	void unmap();
+
+private:
+	//--- Private Data ---//
+#ifdef _WIN32
+	void* fileHandle; //The Windows file handle. Stored as a void* so windows.h doesn't have to be included here
+	void* mappingHandle; //The Windows file mapping object
+#else
+	int fileDescriptor; //The file descriptor from open()
+#endif
+	void* view; //The start of the mapped view. This is aligned to the OS granularity so it can be a bit before the offset that was asked for
+	size_t viewLength; //The length of the mapped view, including the bit before the offset
+	uint64_t size; //The size of the file in bytes
+
+	//--- Utility Functions ---//
+	static size_t getGranularity(); //Get the alignment the OS needs for the start of a view
+};
+
+#endif
@@ -0,0 +1,515 @@
+#include "ParticleEmitter.h"
+#include "Profiler.h"
+
+//Core Libraries
+#include <algorithm>
+#include <cmath>
+
+//Pick the widest SIMD instructions the compiler is allowed to use. Each one works on PARTICLE_SIMD_WIDTH floats at once
+//AVX has to be turned on in the compiler (/arch:AVX or -mavx). SSE2 is always there on 64 bit x86. NEON is always there on 64 bit ARM
+#if defined(__AVX__)
+	#include <immintrin.h>
+	#define PARTICLE_SIMD_NAME "AVX"
+	#define PARTICLE_SIMD_WIDTH 8
+	typedef __m256 SimdFloat;
+	static inline SimdFloat simdLoad(const float* values) { return _mm256_loadu_ps(values); }
+	static inline void simdStore(float* values, SimdFloat vector) { _mm256_storeu_ps(values, vector); }
+	static inline SimdFloat simdSplat(float value) { return _mm256_set1_ps(value); }
+	static inline SimdFloat simdAdd(SimdFloat a, SimdFloat b) { return _mm256_add_ps(a, b); }
+	static inline SimdFloat simdMul(SimdFloat a, SimdFloat b) { return _mm256_mul_ps(a, b); }
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+	#include <emmintrin.h>
+	#define PARTICLE_SIMD_NAME "SSE"
+	#define PARTICLE_SIMD_WIDTH 4
+	typedef __m128 SimdFloat;
+	static inline SimdFloat simdLoad(const float* values) { return _mm_loadu_ps(values); }
+	static inline void simdStore(float* values, SimdFloat vector) { _mm_storeu_ps(values, vector); }
+	static inline SimdFloat simdSplat(float value) { return _mm_set1_ps(value); }
+	static inline SimdFloat simdAdd(SimdFloat a, SimdFloat b) { return _mm_add_ps(a, b); }
+	static inline SimdFloat simdMul(SimdFloat a, SimdFloat b) { return _mm_mul_ps(a, b); }
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+	#include <arm_neon.h>
+	#define PARTICLE_SIMD_NAME "NEON"
+	#define PARTICLE_SIMD_WIDTH 4
+	typedef float32x4_t SimdFloat;
+	static inline SimdFloat simdLoad(const float* values) { return vld1q_f32(values); }
+	static inline void simdStore(float* values, SimdFloat vector) { vst1q_f32(values, vector); }
+	static inline SimdFloat simdSplat(float value) { return vdupq_n_f32(value); }
+	static inline SimdFloat simdAdd(SimdFloat a, SimdFloat b) { return vaddq_f32(a, b); }
+	static inline SimdFloat simdMul(SimdFloat a, SimdFloat b) { return vmulq_f32(a, b); }
+#else
+	#define PARTICLE_SIMD_NAME "Scalar"
+#endif
+
+//The renderer can only take 65536 vertices in one go. 16383 particles is the most that fit with 4 corners each
+static const unsigned int MAX_PARTICLES_PER_COMMAND = 16383;
+
+//A particle's size or end size set to this means its end size is the same as its start size. Same as Cocos2D's ParticleSystem::START_SIZE_EQUAL_TO_END_SIZE
+static const float SIZE_EQUAL_TO_START = -1.0f;
+
+
+
+//--- Kernels ---//
+//Add the same amount to every value. Ex: gravity onto the velocities
+static void addToAll(float* values, float amount, unsigned int count, bool useSimd)
+{
+	unsigned int i = 0;
+#ifdef PARTICLE_SIMD_WIDTH
+	if (useSimd)
+	{
+		SimdFloat amounts = simdSplat(amount);
+		for (; i + PARTICLE_SIMD_WIDTH <= count; i += PARTICLE_SIMD_WIDTH)
+			simdStore(values + i, simdAdd(simdLoad(values + i), amounts));
+	}
+#endif
+
+	//Finish off whatever didn't fill a whole SIMD register (or everything, if SIMD isn't being used)
+	for (; i < count; i++)
+		values[i] += amount;
+}
+
+//Add each rate times the same scale onto each value. Ex: the velocities times the frame time onto the positions
+static void addScaled(float* values, const float* rates, float scale, unsigned int count, bool useSimd)
+{
+	unsigned int i = 0;
+#ifdef PARTICLE_SIMD_WIDTH
+	if (useSimd)
+	{
+		SimdFloat scales = simdSplat(scale);
+		for (; i + PARTICLE_SIMD_WIDTH <= count; i += PARTICLE_SIMD_WIDTH)
+			simdStore(values + i, simdAdd(simdLoad(values + i), simdMul(simdLoad(rates + i), scales)));
+	}
+#endif
+
+	for (; i < count; i++)
+		values[i] += rates[i] * scale;
+}
+
+
+
+//--- Static Variables ---//
+bool ParticleEmitter::simdEnabled = true;
+
+
+
+//--- Constructors and Destructors ---//
+ParticleEmitter::ParticleEmitter()
+{
+	//Init the private data. The settings are filled in by initWithSettings()
+	settings = ParticleEmitterSettings();
+	emitCounter = 0.0f;
+	randomState = 0x2545F491;
+	count = 0;
+	texture = nullptr;
+	programState = nullptr;
+	texCoordsMin = Tex2F{ 0.0f, 0.0f };
+	texCoordsMax = Tex2F{ 1.0f, 1.0f };
+}
+
+ParticleEmitter::~ParticleEmitter()
+{
+	CC_SAFE_RELEASE_NULL(programState);
+	CC_SAFE_RELEASE_NULL(texture);
+}
+
+
+
+//--- Engine Functions ---//
+ParticleEmitter* ParticleEmitter::create(const ParticleEmitterSettings& settings)
+{
+	//The same as Cocos2D's CREATE_FUNC, but with the settings passed through
+	ParticleEmitter* emitter = new ParticleEmitter();
+	if (emitter->initWithSettings(settings))
+	{
+		emitter->autorelease();
+		return emitter;
+	}
+
+	delete emitter;
+	return nullptr;
+}
+
+ParticleEmitter* ParticleEmitter::createMeteor(unsigned int totalParticles)
+{
+	//These are the exact values Cocos2D's ParticleMeteor uses
+	ParticleEmitterSettings meteor;
+	meteor.totalParticles = totalParticles;
+	meteor.gravity = Vec2(-200.0f, 200.0f);
+	meteor.speed = 15.0f;
+	meteor.speedVar = 5.0f;
+	meteor.angle = 90.0f;
+	meteor.angleVar = 360.0f;
+	meteor.life = 2.0f;
+	meteor.lifeVar = 1.0f;
+	meteor.emissionRate = (float)totalParticles / meteor.life;
+	meteor.startSize = 60.0f;
+	meteor.startSizeVar = 10.0f;
+	meteor.endSize = SIZE_EQUAL_TO_START;
+	meteor.endSizeVar = 0.0f;
+	meteor.startColor = Color4F(0.2f, 0.4f, 0.7f, 1.0f);
+	meteor.startColorVar = Color4F(0.0f, 0.0f, 0.2f, 0.1f);
+	meteor.endColor = Color4F(0.0f, 0.0f, 0.0f, 1.0f);
+	meteor.endColorVar = Color4F(0.0f, 0.0f, 0.0f, 0.0f);
+
+	return create(meteor);
+}
+
+bool ParticleEmitter::initWithSettings(const ParticleEmitterSettings& newSettings)
+{
+	if (!Node::init())
+		return false;
+
+	setSettings(newSettings);
+
+	//Build the indices for the biggest command. Every particle is two triangles, in the same corner order Cocos2D uses for sprites
+	indices.resize(MAX_PARTICLES_PER_COMMAND * 6);
+	for (unsigned int i = 0; i < MAX_PARTICLES_PER_COMMAND; i++)
+	{
+		unsigned short corner = (unsigned short)(i * 4);
+		indices[i * 6 + 0] = corner + 0;
+		indices[i * 6 + 1] = corner + 1;
+		indices[i * 6 + 2] = corner + 2;
+		indices[i * 6 + 3] = corner + 3;
+		indices[i * 6 + 4] = corner + 2;
+		indices[i * 6 + 5] = corner + 1;
+	}
+
+	return true;
+}
+
+void ParticleEmitter::onEnter()
+{
+	Node::onEnter();
+	scheduleUpdate();
+}
+
+void ParticleEmitter::onExit()
+{
+	unscheduleUpdate();
+	Node::onExit();
+}
+
+void ParticleEmitter::update(float deltaTime)
+{
+	simulate(deltaTime);
+}
+
+void ParticleEmitter::draw(Renderer* renderer, const Mat4& transform, uint32_t flags)
+{
+	if (count == 0 || !programState)
+		return;
+
+	PROFILE_SCOPE("ParticleEmitter::draw");
+
+	//The particles are in the parent's space but the renderer draws them in the emitter's, so move them back by the emitter's position
+	//Every particle left after simulate() is alive, so every one of them gets a quad
+	vertices.resize(count * 4);
+	buildVertices(0, count, getPosition(), texture->hasPremultipliedAlpha(), vertices.data());
+
+	//Hand them to the renderer in as few commands as will fit. The particles glow, so they are added together instead of blended
+	unsigned int numCommands = (count + MAX_PARTICLES_PER_COMMAND - 1) / MAX_PARTICLES_PER_COMMAND;
+	if (commands.size() < numCommands)
+		commands.resize(numCommands);
+
+	for (unsigned int i = 0; i < numCommands; i++)
+	{
+		unsigned int first = i * MAX_PARTICLES_PER_COMMAND;
+		unsigned int particlesInCommand = std::min(MAX_PARTICLES_PER_COMMAND, count - first);
+		TrianglesCommand::Triangles triangles;
+		triangles.verts = vertices.data() + first * 4;
+		triangles.indices = indices.data();
+		triangles.vertCount = (int)(particlesInCommand * 4);
+		triangles.indexCount = (int)(particlesInCommand * 6);
+
+		commands[i].init(_globalZOrder, texture->getName(), programState, BlendFunc::ADDITIVE, triangles, transform, flags);
+		renderer->addCommand(&commands[i]);
+	}
+}
+
+
+
+//--- Setters ---//
+void ParticleEmitter::setSettings(const ParticleEmitterSettings& newSettings)
+{
+	settings = newSettings;
+	allocate();
+}
+
+void ParticleEmitter::setTexture(Texture2D* newTexture)
+{
+	setTextureWithRect(newTexture, (newTexture) ? Rect(Vec2::ZERO, newTexture->getContentSize()) : Rect::ZERO);
+}
+
+void ParticleEmitter::setTextureWithRect(Texture2D* newTexture, const Rect& rect)
+{
+	//Hold on to the new texture and get a shader that draws with it
+	CC_SAFE_RETAIN(newTexture);
+	CC_SAFE_RELEASE_NULL(texture);
+	CC_SAFE_RELEASE_NULL(programState);
+	texture = newTexture;
+	if (!texture)
+		return;
+
+	//Work out which part of the texture the rect covers. The texture can be bigger than its content, so the pixels are divided by the real size
+	Rect pixels = CC_RECT_POINTS_TO_PIXELS(rect);
+	float textureWidth = (float)texture->getPixelsWide();
+	float textureHeight = (float)texture->getPixelsHigh();
+	texCoordsMin = Tex2F{ pixels.getMinX() / textureWidth, pixels.getMinY() / textureHeight };
+	texCoordsMax = Tex2F{ pixels.getMaxX() / textureWidth, pixels.getMaxY() / textureHeight };
+
+	//The renderer moves the vertices into place itself when it batches the commands, so the shader doesn't need the model view matrix
+	programState = GLProgramState::getOrCreateWithGLProgramName(GLProgram::SHADER_NAME_POSITION_TEXTURE_COLOR_NO_MVP, texture);
+	CC_SAFE_RETAIN(programState);
+}
+
+void ParticleEmitter::setDisplayFrame(SpriteFrame* frame)
+{
+	if (frame)
+		setTextureWithRect(frame->getTexture(), frame->getRect());
+	else
+		setTexture(nullptr);
+}
+
+void ParticleEmitter::setLife(float life)
+{
+	settings.life = life;
+}
+
+void ParticleEmitter::setEndColorVar(const Color4F& endColorVar)
+{
+	settings.endColorVar = endColorVar;
+}
+
+void ParticleEmitter::setSimdEnabled(bool enabled)
+{
+	simdEnabled = enabled;
+}
+
+
+
+//--- Getters ---//
+ParticleEmitterSettings& ParticleEmitter::getSettings()
+{
+	return settings;
+}
+
+unsigned int ParticleEmitter::getParticleCount() const
+{
+	return count;
+}
+
+Texture2D* ParticleEmitter::getTexture() const
+{
+	return texture;
+}
+
+GLProgramState* ParticleEmitter::getProgramState() const
+{
+	return programState;
+}
+
+bool ParticleEmitter::getSimdEnabled()
+{
+	return simdEnabled;
+}
+
+const char* ParticleEmitter::getSimdName()
+{
+	return PARTICLE_SIMD_NAME;
+}
+
+
+
+//--- Methods ---//
+void ParticleEmitter::simulate(float deltaTime)
+{
+	PROFILE_SCOPE("ParticleEmitter::simulate");
+
+	emitParticles(deltaTime);
+	updateParticles(0, count, deltaTime);
+	removeDeadParticles();
+}
+
+void ParticleEmitter::emitParticles(float deltaTime)
+{
+	//Spawn however many particles fit in the time that has passed. This is the same way Cocos2D works out how many to spawn
+	if (settings.emissionRate > 0.0f)
+	{
+		float rate = 1.0f / settings.emissionRate;
+		if (count < settings.totalParticles)
+			emitCounter += deltaTime;
+
+		unsigned int numToEmit = std::min(settings.totalParticles - count, (unsigned int)(emitCounter / rate));
+		for (unsigned int i = 0; i < numToEmit; i++)
+			emit();
+		emitCounter -= rate * (float)numToEmit;
+	}
+}
+
+void ParticleEmitter::updateParticles(unsigned int first, unsigned int last, float deltaTime)
+{
+	if (first >= last)
+		return;
+
+	//Run each kernel over the range. Each one only streams through one or two lists, so the CPU always knows what memory is coming next
+	unsigned int rangeCount = last - first;
+	addToAll(lifetimes.data() + first, -deltaTime, rangeCount, simdEnabled);
+	addToAll(velocitiesX.data() + first, settings.gravity.x * deltaTime, rangeCount, simdEnabled);
+	addToAll(velocitiesY.data() + first, settings.gravity.y * deltaTime, rangeCount, simdEnabled);
+	addScaled(positionsX.data() + first, velocitiesX.data() + first, deltaTime, rangeCount, simdEnabled);
+	addScaled(positionsY.data() + first, velocitiesY.data() + first, deltaTime, rangeCount, simdEnabled);
+	addScaled(sizes.data() + first, sizeRates.data() + first, deltaTime, rangeCount, simdEnabled);
+	addScaled(colorsR.data() + first, colorRatesR.data() + first, deltaTime, rangeCount, simdEnabled);
+	addScaled(colorsG.data() + first, colorRatesG.data() + first, deltaTime, rangeCount, simdEnabled);
+	addScaled(colorsB.data() + first, colorRatesB.data() + first, deltaTime, rangeCount, simdEnabled);
+	addScaled(colorsA.data() + first, colorRatesA.data() + first, deltaTime, rangeCount, simdEnabled);
+}
+
+unsigned int ParticleEmitter::buildVertices(unsigned int first, unsigned int last, Vec2 origin, bool premultiply, V3F_C4B_T2F* verticesOut) const
+{
+	//If the texture has its alpha already multiplied in, the colors need it multiplied in too
+	unsigned int written = 0;
+	for (unsigned int i = first; i < last; i++)
+	{
+		//Dead particles are skipped. They haven't been removed yet if this is called between updateParticles() and removeDeadParticles()
+		if (lifetimes[i] <= 0.0f)
+			continue;
+
+		float halfSize = std::max(sizes[i], 0.0f) * 0.5f;
+		float x = positionsX[i] - origin.x;
+		float y = positionsY[i] - origin.y;
+
+		float alpha = clampf(colorsA[i], 0.0f, 1.0f);
+		float colorScale = (premultiply) ? alpha * 255.0f : 255.0f;
+		Color4B color((GLubyte)(clampf(colorsR[i], 0.0f, 1.0f) * colorScale), (GLubyte)(clampf(colorsG[i], 0.0f, 1.0f) * colorScale), (GLubyte)(clampf(colorsB[i], 0.0f, 1.0f) * colorScale), (GLubyte)(alpha * 255.0f));
+
+		V3F_C4B_T2F* corners = verticesOut + written * 4;
+		corners[0].vertices = Vec3(x - halfSize, y + halfSize, 0.0f); //Top left
+		corners[1].vertices = Vec3(x - halfSize, y - halfSize, 0.0f); //Bottom left
+		corners[2].vertices = Vec3(x + halfSize, y + halfSize, 0.0f); //Top right
+		corners[3].vertices = Vec3(x + halfSize, y - halfSize, 0.0f); //Bottom right
+		corners[0].texCoords = Tex2F{ texCoordsMin.u, texCoordsMin.v };
+		corners[1].texCoords = Tex2F{ texCoordsMin.u, texCoordsMax.v };
+		corners[2].texCoords = Tex2F{ texCoordsMax.u, texCoordsMin.v };
+		corners[3].texCoords = Tex2F{ texCoordsMax.u, texCoordsMax.v };
+		corners[0].colors = color;
+		corners[1].colors = color;
+		corners[2].colors = color;
+		corners[3].colors = color;
+		written++;
+	}
+
+	return written;
+}
+
+void ParticleEmitter::removeDeadParticles()
+{
+	//Remove the dead particles by moving the last particle into their place. The order doesn't matter since the particles are added together when drawn
+	for (unsigned int i = 0; i < count; )
+	{
+		if (lifetimes[i] > 0.0f)
+		{
+			i++;
+			continue;
+		}
+
+		//Check the particle that was moved in on the next time around, since it might be dead too
+		count--;
+		positionsX[i] = positionsX[count];
+		positionsY[i] = positionsY[count];
+		velocitiesX[i] = velocitiesX[count];
+		velocitiesY[i] = velocitiesY[count];
+		lifetimes[i] = lifetimes[count];
+		sizes[i] = sizes[count];
+		sizeRates[i] = sizeRates[count];
+		colorsR[i] = colorsR[count];
+		colorsG[i] = colorsG[count];
+		colorsB[i] = colorsB[count];
+		colorsA[i] = colorsA[count];
+		colorRatesR[i] = colorRatesR[count];
+		colorRatesG[i] = colorRatesG[count];
+		colorRatesB[i] = colorRatesB[count];
+		colorRatesA[i] = colorRatesA[count];
+	}
+}
+
+void ParticleEmitter::clear()
+{
+	count = 0;
+	emitCounter = 0.0f;
+}
+
+
+
+//--- Utility Functions ---//
+void ParticleEmitter::allocate()
+{
+	//Every list gets room for every particle up front, so nothing is ever allocated while the particles are being spawned
+	unsigned int total = settings.totalParticles;
+	positionsX.resize(total);
+	positionsY.resize(total);
+	velocitiesX.resize(total);
+	velocitiesY.resize(total);
+	lifetimes.resize(total);
+	sizes.resize(total);
+	sizeRates.resize(total);
+	colorsR.resize(total);
+	colorsG.resize(total);
+	colorsB.resize(total);
+	colorsA.resize(total);
+	colorRatesR.resize(total);
+	colorRatesG.resize(total);
+	colorRatesB.resize(total);
+	colorRatesA.resize(total);
+	count = std::min(count, total);
+}
+
+void ParticleEmitter::emit()
+{
+	unsigned int i = count++;
+
+	//Start at the emitter, heading off in a random direction at a random speed
+	float angle = CC_DEGREES_TO_RADIANS(settings.angle + settings.angleVar * randomMinus1To1());
+	float speed = settings.speed + settings.speedVar * randomMinus1To1();
+	positionsX[i] = getPosition().x;
+	positionsY[i] = getPosition().y;
+	velocitiesX[i] = cosf(angle) * speed;
+	velocitiesY[i] = sinf(angle) * speed;
+
+	//Pick how long it lives. A particle that lives for no time at all still gets a tiny life so the rates below don't divide by 0
+	float life = std::max(settings.life + settings.lifeVar * randomMinus1To1(), 0.0001f);
+	lifetimes[i] = life;
+
+	//Pick the start and end sizes, and work out how fast it has to grow to get from one to the other over its life
+	float startSize = std::max(settings.startSize + settings.startSizeVar * randomMinus1To1(), 0.0f);
+	float endSize = (settings.endSize == SIZE_EQUAL_TO_START) ? startSize : std::max(settings.endSize + settings.endSizeVar * randomMinus1To1(), 0.0f);
+	sizes[i] = startSize;
+	sizeRates[i] = (endSize - startSize) / life;
+
+	//Same for the colors. Each channel is kept between 0 and 1 like Cocos2D does
+	float startR = clampf(settings.startColor.r + settings.startColorVar.r * randomMinus1To1(), 0.0f, 1.0f);
+	float startG = clampf(settings.startColor.g + settings.startColorVar.g * randomMinus1To1(), 0.0f, 1.0f);
+	float startB = clampf(settings.startColor.b + settings.startColorVar.b * randomMinus1To1(), 0.0f, 1.0f);
+	float startA = clampf(settings.startColor.a + settings.startColorVar.a * randomMinus1To1(), 0.0f, 1.0f);
+	float endR = clampf(settings.endColor.r + settings.endColorVar.r * randomMinus1To1(), 0.0f, 1.0f);
+	float endG = clampf(settings.endColor.g + settings.endColorVar.g * randomMinus1To1(), 0.0f, 1.0f);
+	float endB = clampf(settings.endColor.b + settings.endColorVar.b * randomMinus1To1(), 0.0f, 1.0f);
+	float endA = clampf(settings.endColor.a + settings.endColorVar.a * randomMinus1To1(), 0.0f, 1.0f);
+	colorsR[i] = startR;
+	colorsG[i] = startG;
+	colorsB[i] = startB;
+	colorsA[i] = startA;
+	colorRatesR[i] = (endR - startR) / life;
+	colorRatesG[i] = (endG - startG) / life;
+	colorRatesB[i] = (endB - startB) / life;
+	colorRatesA[i] = (endA - startA) / life;
+}
+
+float ParticleEmitter::randomMinus1To1()
+{
+	//A tiny xorshift generator. Much faster than rand() and gives the same particles every run
+	randomState ^= randomState << 13;
+	randomState ^= randomState >> 17;
+	randomState ^= randomState << 5;
+	return (float)(randomState & 0xFFFFFF) / 16777215.0f * 2.0f - 1.0f;
+}
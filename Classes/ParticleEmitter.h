@@ -0,0 +1,170 @@
+/*
+============================================================
+	Particle Emitter:
+		- A particle system that can handle tens of thousands of particles on the CPU. Made to replace Cocos2D's ParticleMeteor for the mouse particles
+			> Cocos2D keeps each particle as a struct with everything about it inside. Updating the position means jumping over the color, size, rotation, etc of every particle
+			> This keeps each value in its own tightly packed list instead (called 'structure of arrays'). Updating the positions is a straight walk down two lists of floats
+		- The update is split into tiny 'kernels' that each do one thing to one list. Ex: add the velocities onto the positions
+			> Each kernel works on 4 (SSE / NEON) or 8 (AVX) particles at once using SIMD instructions. Which one is used is picked when the game is compiled
+			> If the CPU doesn't have any of those, a plain loop is used instead. It can also be forced on with setSimdEnabled(false) to compare the two
+		- The particles behave like Cocos2D's 'gravity mode' particles: they shoot out at an angle, fall with gravity, and fade from their start color to their end color over their life
+		- Dead particles are removed by moving the last particle into their place, so the lists never have holes in them
+
+	Usage:
+		- Use createMeteor() to get the same look as ParticleMeteor, or create() and fill in getSettings() yourself
+		- The setters that DemoScene used on ParticleMeteor (setTexture(), setLife(), setEndColorVar()) work the same way
+		- The particles stay where they were emitted when the emitter moves, so it leaves a trail behind it (Cocos2D's PositionType::FREE)
+		- To update lots of emitters across several threads, give them to a ParticleUpdater instead of adding them to the scene. See ParticleUpdater.h
+
+	Note:
+		- The emitter is assumed to be in a parent with no scale or rotation, like the scene itself
+		- When the display is headless, the particles are still simulated but nothing is drawn
+============================================================
+*/
+
+#ifndef PARTICLEEMITTER_H
+#define PARTICLEEMITTER_H
+
+//Core Libraries
+#include <vector>
+
+//3rd Party Libraries
+#include "cocos2d.h"
+
+//Namespaces
+using namespace cocos2d;
+
+/*
+	Particle Emitter Settings
+	- How the particles are spawned and how they change over their life. The 'Var' values are how far each particle can randomly be from the value before it, in both directions
+*/
+struct ParticleEmitterSettings
+{
+	unsigned int totalParticles; //The most particles that can be alive at once
+	float emissionRate; //How many particles are spawned per second
+	Vec2 gravity; //The acceleration applied to every particle
+	float speed, speedVar; //How fast the particles start out moving
+	float angle, angleVar; //The direction the particles start out moving, in degrees. 0 is right, 90 is up
+	float life, lifeVar; //How many seconds each particle lives for
+	float startSize, startSizeVar; //The width of each particle when it spawns
+	float endSize, endSizeVar; //The width of each particle when it dies. Less than 0 means the same as its start size
+	Color4F startColor, startColorVar; //The color of each particle when it spawns
+	Color4F endColor, endColorVar; //The color of each particle when it dies
+};
+
+
+
+/*
+	Particle Emitter Class:
+	> Setters
+		- Set the settings, texture, life and end color variance
+		- Turn the SIMD kernels on or off
+	> Getters
+		- Get the settings and the number of particles alive
+		- Get the texture and shader
+		- Get which SIMD instructions are being used
+	> Methods
+		- Simulate a frame
+		- Spawn, update, build the vertices of and remove particles separately
+		- Remove every particle
+*/
+class ParticleEmitter : public Node
+{
+public:
+	//--- Constructors and Destructors ---//
+	ParticleEmitter();
+	~ParticleEmitter();
+
+	//--- Engine Functions ---//
+	static ParticleEmitter* create(const ParticleEmitterSettings& settings); //Create an emitter with the given settings. It is autoreleased like any other node
+	static ParticleEmitter* createMeteor(unsigned int totalParticles); //Create an emitter that looks like Cocos2D's ParticleMeteor. Blue and orange fire falling up and to the left
+	virtual bool initWithSettings(const ParticleEmitterSettings& settings); //Set everything up and make room for every particle
+	virtual void onEnter(); //Start updating every frame. Like Cocos2D's particles, the emitter updates itself
+	virtual void onExit(); //Stop updating
+	virtual void update(float deltaTime); //Spawn new particles and move the old ones. Called every frame while the emitter is in the running scene
+	virtual void draw(Renderer* renderer, const Mat4& transform, uint32_t flags); //Build a quad for every particle and hand them to the renderer
+
+
+
+	//--- Setters ---//
+	void setSettings(const ParticleEmitterSettings& settings); //Change every setting. The particles that are already alive keep going the way they were spawned
+	void setTexture(Texture2D* texture); //Set the image drawn for every particle. The whole texture is used
+	void setTextureWithRect(Texture2D* texture, const Rect& rect); //Set the image drawn for every particle to part of a texture, in points. Same as ParticleSystemQuad::setTextureWithRect()
+	void setDisplayFrame(SpriteFrame* frame); //Set the image drawn for every particle to a sprite frame (ex: from the sprite atlas, see SpriteAtlas.h). The frame can't be rotated
+	void setLife(float life); //Set how long each particle lives. Same as ParticleSystem::setLife()
+	void setEndColorVar(const Color4F& endColorVar); //Set how much each particle's end color can vary. Same as ParticleSystem::setEndColorVar()
+	static void setSimdEnabled(bool enabled); //Use the SIMD kernels (true, the default) or the plain loops (false) for every emitter. Only used for comparing the two
+
+
+
+	//--- Getters ---//
+	ParticleEmitterSettings& getSettings(); //Get the settings so they can be changed directly. Changes to the total number of particles only count once setSettings() is called
+	unsigned int getParticleCount() const; //Get how many particles are alive right now
+	Texture2D* getTexture() const; //Get the image drawn for every particle. nullptr if there isn't one
+	GLProgramState* getProgramState() const; //Get the shader the particles are drawn with. nullptr if there is no texture
+	static bool getSimdEnabled(); //Get if the SIMD kernels are being used
+	static const char* getSimdName(); //Get the name of the SIMD instructions the kernels were compiled with. Ex: "SSE". "Scalar" if there aren't any
+
+
+
+	//--- Methods ---//
+	/*
+		Spawn new particles and move every particle forward in time. update() calls this every frame, but it can also be called directly (ex: to benchmark it)
+
+		@param DeltaTime -> How much time has passed, in seconds
+	*/
+	void simulate(float deltaTime);
+
+	//simulate() is emitParticles(), updateParticles() and removeDeadParticles() in a row, and draw() uses buildVertices(). They are split out so ParticleUpdater can spread the update and the vertices over several threads
+	//Only updateParticles() and buildVertices() are safe to call from more than one thread at once, and only on ranges that don't overlap
+	void emitParticles(float deltaTime); //Spawn however many particles fit in the time that has passed
+	void updateParticles(unsigned int first, unsigned int last, float deltaTime); //Run the kernels over the particles from first up to (but not including) last
+
+	/*
+		Write the four corners of every living particle in a range. Dead particles that haven't been removed yet are skipped
+
+		@param First -> The first particle to write
+		@param Last -> One past the last particle to write
+		@param Origin -> Subtracted from every position. The emitter's position to draw it in its own space, or (0, 0) to draw it in its parent's space
+		@param Premultiply -> True if the texture has its alpha multiplied in already, so the colors need it multiplied in too
+		@param VerticesOut -> Where to write the corners. Needs room for 4 per particle in the range
+		@return Returns -> How many particles were written
+	*/
+	unsigned int buildVertices(unsigned int first, unsigned int last, Vec2 origin, bool premultiply, V3F_C4B_T2F* verticesOut) const;
+
+	void removeDeadParticles(); //Take the dead particles out of the lists
+
+	void clear(); //Kill every particle right away
+
+private:
+	//--- Private Data ---//
+	ParticleEmitterSettings settings; //How the particles are spawned
+	float emitCounter; //Time built up towards spawning the next particle
+	unsigned int randomState; //The state of the random number generator. Seeded the same every time so runs can be compared
+
+	//The particles. Every list has room for every particle, and particle i is entry i in every list. Only the first 'count' entries are alive
+	unsigned int count;
+	std::vector<float> positionsX, positionsY; //Where each particle is, in the parent's space
+	std::vector<float> velocitiesX, velocitiesY; //How fast each particle is moving
+	std::vector<float> lifetimes; //Seconds left until each particle dies
+	std::vector<float> sizes, sizeRates; //The width of each particle and how fast it changes per second
+	std::vector<float> colorsR, colorsG, colorsB, colorsA; //The color of each particle
+	std::vector<float> colorRatesR, colorRatesG, colorRatesB, colorRatesA; //How fast each channel moves towards the end color per second
+
+	//Drawing
+	Texture2D* texture; //The image for every particle. nullptr if the display is headless
+	GLProgramState* programState; //The shader, with the texture set
+	Tex2F texCoordsMin, texCoordsMax; //The corners of the image in the texture. (0, 0) and (1, 1) unless only part of the texture is used
+	std::vector<V3F_C4B_T2F> vertices; //The corners of every particle. Rebuilt every time the emitter is drawn
+	std::vector<unsigned short> indices; //Two triangles for every particle. The same for every command so it is only built once
+	std::vector<TrianglesCommand> commands; //The commands handed to the renderer
+
+	static bool simdEnabled; //True if the SIMD kernels are used
+
+	//--- Utility Functions ---//
+	void allocate(); //Size every list to hold the total number of particles
+	void emit(); //Spawn a single particle at the emitter's position
+	float randomMinus1To1(); //Get a random number from -1 to 1
+};
+
+#endif
@@ -0,0 +1,353 @@
+#include "ParticleUpdater.h"
+#include "Profiler.h"
+#include "JobSystem.h"
+
+//Core Libraries
+#include <algorithm>
+#include <cstring>
+
+//How many particles go in a chunk. Big enough that grabbing a chunk costs nothing next to updating it, small enough that the threads finish at about the same time
+//This doesn't change with the thread count, so deterministic mode cuts the particles up the same way no matter how many threads there are
+static const unsigned int PARTICLES_PER_CHUNK = 2048;
+
+//The most threads the particles can be split across
+static const unsigned int MAX_PARTICLE_THREADS = 16;
+
+//The renderer can only take 65536 vertices in one go. 16383 particles is the most that fit with 4 corners each
+static const unsigned int MAX_PARTICLES_PER_COMMAND = 16383;
+
+
+
+//--- Constructors and Destructors ---//
+ParticleUpdater::ParticleUpdater()
+{
+	//Init the private data. The thread count is set in init()
+	deterministic = false;
+	jobDeltaTime = 0.0f;
+}
+
+ParticleUpdater::~ParticleUpdater()
+{
+	//Let go of the emitters. Nothing is running on the other threads once step() has returned
+	removeAllEmitters();
+}
+
+
+
+//--- Engine Functions ---//
+bool ParticleUpdater::init()
+{
+	if (!Node::init())
+		return false;
+
+	//Build the indices for the biggest command. Every particle is two triangles, in the same corner order Cocos2D uses for sprites
+	indices.resize(MAX_PARTICLES_PER_COMMAND * 6);
+	for (unsigned int i = 0; i < MAX_PARTICLES_PER_COMMAND; i++)
+	{
+		unsigned short corner = (unsigned short)(i * 4);
+		indices[i * 6 + 0] = corner + 0;
+		indices[i * 6 + 1] = corner + 1;
+		indices[i * 6 + 2] = corner + 2;
+		indices[i * 6 + 3] = corner + 3;
+		indices[i * 6 + 4] = corner + 2;
+		indices[i * 6 + 5] = corner + 1;
+	}
+
+	//Use every thread the job system has by default. AppDelegate starts one per core
+	setThreadCount(JOBS->getThreadCount());
+
+	return true;
+}
+
+void ParticleUpdater::draw(Renderer* renderer, const Mat4& transform, uint32_t flags)
+{
+	if (mergedVertices.empty())
+		return;
+
+	PROFILE_SCOPE("ParticleUpdater::draw");
+
+	//Count the commands for every group that can be drawn. Groups without a shader are from emitters with no texture (ex: when the display is headless)
+	unsigned int numCommands = 0;
+	for (unsigned int i = 0; i < groups.size(); i++)
+	{
+		if (groups[i].programState)
+			numCommands += (groups[i].vertexCount / 4 + MAX_PARTICLES_PER_COMMAND - 1) / MAX_PARTICLES_PER_COMMAND;
+	}
+	if (commands.size() < numCommands)
+		commands.resize(numCommands);
+
+	//Hand every group to the renderer in as few commands as will fit. The particles glow, so they are added together instead of blended
+	unsigned int nextCommand = 0;
+	for (unsigned int i = 0; i < groups.size(); i++)
+	{
+		const TextureGroup& group = groups[i];
+		if (!group.programState)
+			continue;
+
+		unsigned int groupParticles = group.vertexCount / 4;
+		for (unsigned int first = 0; first < groupParticles; first += MAX_PARTICLES_PER_COMMAND)
+		{
+			unsigned int particlesInCommand = std::min(MAX_PARTICLES_PER_COMMAND, groupParticles - first);
+			TrianglesCommand::Triangles triangles;
+			triangles.verts = mergedVertices.data() + group.firstVertex + first * 4;
+			triangles.indices = indices.data();
+			triangles.vertCount = (int)(particlesInCommand * 4);
+			triangles.indexCount = (int)(particlesInCommand * 6);
+
+			TrianglesCommand& command = commands[nextCommand++];
+			command.init(_globalZOrder, group.texture->getName(), group.programState, BlendFunc::ADDITIVE, triangles, transform, flags);
+			renderer->addCommand(&command);
+		}
+	}
+}
+
+
+
+//--- Setters ---//
+void ParticleUpdater::setThreadCount(unsigned int threadCount)
+{
+	threadCount = std::min(std::max(threadCount, 1u), MAX_PARTICLE_THREADS);
+
+	//Every thread gets its own list to write into. The thread calling step() counts as one of the threads
+	outputs.clear();
+	outputs.resize(threadCount);
+}
+
+void ParticleUpdater::setDeterministic(bool enabled)
+{
+	deterministic = enabled;
+}
+
+
+
+//--- Getters ---//
+unsigned int ParticleUpdater::getThreadCount() const
+{
+	return (unsigned int)outputs.size();
+}
+
+bool ParticleUpdater::isDeterministic() const
+{
+	return deterministic;
+}
+
+unsigned int ParticleUpdater::getEmitterCount() const
+{
+	return (unsigned int)emitters.size();
+}
+
+unsigned int ParticleUpdater::getParticleCount() const
+{
+	unsigned int total = 0;
+	for (unsigned int i = 0; i < emitters.size(); i++)
+		total += emitters[i].emitter->getParticleCount();
+	return total;
+}
+
+const std::vector<V3F_C4B_T2F>& ParticleUpdater::getVertices() const
+{
+	return mergedVertices;
+}
+
+
+
+//--- Methods ---//
+void ParticleUpdater::addEmitter(ParticleEmitter* emitter)
+{
+	emitter->retain();
+	ManagedEmitter managed;
+	managed.emitter = emitter;
+	managed.removeWhenEmpty = false;
+	emitters.push_back(managed);
+}
+
+void ParticleUpdater::removeEmitter(ParticleEmitter* emitter)
+{
+	for (unsigned int i = 0; i < emitters.size(); i++)
+	{
+		if (emitters[i].emitter == emitter)
+		{
+			emitter->release();
+			emitters.erase(emitters.begin() + i);
+			return;
+		}
+	}
+}
+
+void ParticleUpdater::stopEmitter(ParticleEmitter* emitter)
+{
+	for (unsigned int i = 0; i < emitters.size(); i++)
+	{
+		if (emitters[i].emitter == emitter)
+		{
+			emitter->getSettings().emissionRate = 0.0f;
+			emitters[i].removeWhenEmpty = true;
+			return;
+		}
+	}
+}
+
+void ParticleUpdater::removeAllEmitters()
+{
+	for (unsigned int i = 0; i < emitters.size(); i++)
+		emitters[i].emitter->release();
+	emitters.clear();
+	mergedVertices.clear();
+	groups.clear();
+}
+
+void ParticleUpdater::step(float deltaTime)
+{
+	PROFILE_SCOPE("ParticleUpdater::step");
+
+	//Remove the stopped emitters whose particles have all died, keeping the rest in the same order
+	unsigned int kept = 0;
+	for (unsigned int i = 0; i < emitters.size(); i++)
+	{
+		if (emitters[i].removeWhenEmpty && emitters[i].emitter->getParticleCount() == 0)
+			emitters[i].emitter->release();
+		else
+			emitters[kept++] = emitters[i];
+	}
+	emitters.resize(kept);
+
+	//Spawn the new particles. This changes the size of each emitter's lists, so it has to happen before the threads start
+	for (unsigned int i = 0; i < emitters.size(); i++)
+		emitters[i].emitter->emitParticles(deltaTime);
+
+	//Cut the particles up and clear out last frame's lists. The lists keep their memory, so this doesn't allocate once they have grown
+	buildChunks();
+	for (unsigned int i = 0; i < outputs.size(); i++)
+	{
+		outputs[i].vertices.clear();
+		outputs[i].chunks.clear();
+	}
+
+	//Hand the chunks out across the job system. This thread does its share too, and parallelFor() only returns once every chunk is done
+	//Each piece is a single chunk, since a chunk is already big enough to be worth handing to another thread. If there is only one chunk, no other thread is woken up for it
+	jobDeltaTime = deltaTime;
+	JOBS->parallelFor((unsigned int)chunks.size(), 1, [this](unsigned int first, unsigned int last, unsigned int slot)
+	{
+		for (unsigned int i = first; i < last; i++)
+			runChunk(i, slot);
+	}, getThreadCount());
+
+	//Put every thread's quads together, then take the dead particles out now that nothing else is looking at the lists
+	mergeVertices();
+	for (unsigned int i = 0; i < emitters.size(); i++)
+		emitters[i].emitter->removeDeadParticles();
+}
+
+
+
+//--- Utility Functions ---//
+void ParticleUpdater::runChunk(unsigned int index, unsigned int thread)
+{
+	Chunk& chunk = chunks[index];
+	ThreadOutput& output = outputs[thread];
+
+	//Make room for every particle in the chunk, then shrink back down to the ones that were still alive
+	//The emitters are in the updater's space already, so the positions are used as they are
+	chunk.emitter->updateParticles(chunk.first, chunk.last, jobDeltaTime);
+	unsigned int firstVertex = (unsigned int)output.vertices.size();
+	output.vertices.resize(firstVertex + (chunk.last - chunk.first) * 4);
+	unsigned int written = chunk.emitter->buildVertices(chunk.first, chunk.last, Vec2::ZERO, chunk.premultiply, output.vertices.data() + firstVertex);
+	output.vertices.resize(firstVertex + written * 4);
+
+	chunk.thread = thread;
+	chunk.firstVertex = firstVertex;
+	chunk.vertexCount = written * 4;
+	output.chunks.push_back(index);
+}
+
+void ParticleUpdater::buildChunks()
+{
+	chunks.clear();
+	groups.clear();
+
+	for (unsigned int i = 0; i < emitters.size(); i++)
+	{
+		ParticleEmitter* emitter = emitters[i].emitter;
+
+		//Find the group for the emitter's texture, or start a new one. There are only ever a few textures, so a plain search is fine
+		Texture2D* texture = emitter->getTexture();
+		unsigned int group = 0;
+		while (group < groups.size() && groups[group].texture != texture)
+			group++;
+		if (group == groups.size())
+		{
+			TextureGroup newGroup;
+			newGroup.texture = texture;
+			newGroup.programState = emitter->getProgramState();
+			newGroup.firstVertex = 0;
+			newGroup.vertexCount = 0;
+			groups.push_back(newGroup);
+		}
+
+		//Cut the emitter's particles into chunks
+		bool premultiply = (texture) ? texture->hasPremultipliedAlpha() : false;
+		unsigned int count = emitter->getParticleCount();
+		for (unsigned int first = 0; first < count; first += PARTICLES_PER_CHUNK)
+		{
+			Chunk chunk;
+			chunk.emitter = emitter;
+			chunk.first = first;
+			chunk.last = std::min(first + PARTICLES_PER_CHUNK, count);
+			chunk.group = group;
+			chunk.premultiply = premultiply;
+			chunk.thread = 0;
+			chunk.firstVertex = 0;
+			chunk.vertexCount = 0;
+			chunks.push_back(chunk);
+		}
+	}
+}
+
+void ParticleUpdater::mergeVertices()
+{
+	PROFILE_SCOPE("ParticleUpdater::merge");
+
+	//Work out how big each group is and where it starts in the merged list
+	unsigned int totalVertices = 0;
+	for (unsigned int i = 0; i < chunks.size(); i++)
+		groups[chunks[i].group].vertexCount += chunks[i].vertexCount;
+	for (unsigned int i = 0; i < groups.size(); i++)
+	{
+		groups[i].firstVertex = totalVertices;
+		totalVertices += groups[i].vertexCount;
+		groups[i].vertexCount = 0;
+	}
+	mergedVertices.resize(totalVertices);
+
+	//Copy every chunk's quads onto the end of its group. Deterministic mode goes in chunk order, otherwise each thread's list is copied in the order it did them
+	if (deterministic)
+	{
+		for (unsigned int i = 0; i < chunks.size(); i++)
+		{
+			const Chunk& chunk = chunks[i];
+			if (chunk.vertexCount == 0)
+				continue;
+
+			TextureGroup& group = groups[chunk.group];
+			memcpy(mergedVertices.data() + group.firstVertex + group.vertexCount, outputs[chunk.thread].vertices.data() + chunk.firstVertex, chunk.vertexCount * sizeof(V3F_C4B_T2F));
+			group.vertexCount += chunk.vertexCount;
+		}
+	}
+	else
+	{
+		for (unsigned int thread = 0; thread < outputs.size(); thread++)
+		{
+			const ThreadOutput& output = outputs[thread];
+			for (unsigned int i = 0; i < output.chunks.size(); i++)
+			{
+				const Chunk& chunk = chunks[output.chunks[i]];
+				if (chunk.vertexCount == 0)
+					continue;
+
+				TextureGroup& group = groups[chunk.group];
+				memcpy(mergedVertices.data() + group.firstVertex + group.vertexCount, output.vertices.data() + chunk.firstVertex, chunk.vertexCount * sizeof(V3F_C4B_T2F));
+				group.vertexCount += chunk.vertexCount;
+			}
+		}
+	}
+}
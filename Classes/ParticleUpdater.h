@@ -0,0 +1,158 @@
+/*
+============================================================
+	Particle Updater:
+		- Updates every particle emitter in the scene at once, spread out over the job system's threads (see JobSystem.h), and draws all of them together
+			> On its own, each emitter updates itself on the main thread one after the other. With a trail on every bird, that is a lot of emitters in a row
+			> The particles from every emitter are cut into 'chunks' of a couple thousand. The chunks are run with a parallelFor(), so each thread grabs a chunk, runs the kernels over it and builds its quads
+		- Each thread writes its quads into its own list, so the threads never have to wait on each other while they work
+			> The number of quads in a chunk isn't known until it is updated, since particles die during the update. Separate lists means nobody has to know ahead of time
+			> Once every chunk is done, the lists are merged into one, grouped by texture, and handed to the renderer in as few commands as possible
+		- Spawning new particles and removing dead ones happen on the main thread before and after the threads run. Both need the emitter's lists to change size
+		- Deterministic mode makes the merged vertices exactly the same no matter how many threads there are or how fast each one is
+			> Threads take the next chunk as soon as they are free. Normally the lists are merged thread by thread, so the quads come out in a different order every frame
+			> That is fine to look at since the particles are added together, but it can't be compared byte for byte. In deterministic mode, the chunks are merged in chunk order no matter which thread did them
+
+	Usage:
+		- Create it and add it to the scene like any other node. Then hand it emitters with addEmitter(). Don't add those emitters to the scene themselves
+		- Call step() once a frame
+		- Use stopEmitter() to let an emitter's particles die out before it is removed (ex: when the bird it follows goes away)
+
+	Note:
+		- The emitters are assumed to be in the same space as the updater, with the updater sitting at the origin with no scale or rotation, like the scene itself
+		- The thread calling step() works on chunks too, so 1 thread means everything runs on that thread
+		- step() can be run as a job itself. The chunks are then shared out from whichever thread picked it up
+		- When the display is headless, the particles and vertices are still worked out but nothing is drawn
+============================================================
+*/
+
+#ifndef PARTICLEUPDATER_H
+#define PARTICLEUPDATER_H
+
+//Core Libraries
+#include <vector>
+
+//3rd Party Libraries
+#include "cocos2d.h"
+
+//Wrapper Classes
+#include "ParticleEmitter.h"
+
+//Namespaces
+using namespace cocos2d;
+
+/*
+	Particle Updater Class:
+	> Setters
+		- Set the number of threads
+		- Turn deterministic mode on or off
+	> Getters
+		- Get the number of threads
+		- Get if deterministic mode is on
+		- Get the number of emitters and particles
+		- Get the merged vertices
+	> Methods
+		- Add and remove emitters
+		- Let an emitter die out
+		- Update every emitter
+*/
+class ParticleUpdater : public Node
+{
+public:
+	//--- Constructors and Destructors ---//
+	ParticleUpdater();
+	~ParticleUpdater();
+
+	//--- Engine Functions ---//
+	CREATE_FUNC(ParticleUpdater); //Create an updater that uses every thread in the job system. It is autoreleased like any other node
+	virtual bool init(); //Build the index list and make room for every thread's quads
+	virtual void draw(Renderer* renderer, const Mat4& transform, uint32_t flags); //Hand the merged vertices to the renderer
+
+
+
+	//--- Setters ---//
+	/*
+		Set the most threads the particles are split across. They come from the job system, so it can't be more than the job system has
+
+		@param ThreadCount -> How many threads, counting the one calling step(). 1 runs everything on that thread. Clamped between 1 and 16
+	*/
+	void setThreadCount(unsigned int threadCount);
+
+	void setDeterministic(bool deterministic); //Make the merged vertices come out the same every time. Off by default
+
+
+
+	//--- Getters ---//
+	unsigned int getThreadCount() const; //Get the most threads the particles are split across, counting the one calling step()
+	bool isDeterministic() const; //Get if deterministic mode is on
+	unsigned int getEmitterCount() const; //Get how many emitters are being updated
+	unsigned int getParticleCount() const; //Get how many particles are alive across every emitter
+	const std::vector<V3F_C4B_T2F>& getVertices() const; //Get the merged vertices from the last step. Used to check that two runs came out the same
+
+
+
+	//--- Methods ---//
+	void addEmitter(ParticleEmitter* emitter); //Start updating an emitter. The updater holds on to it until it is removed
+	void removeEmitter(ParticleEmitter* emitter); //Stop updating an emitter right away. Its particles disappear
+	void stopEmitter(ParticleEmitter* emitter); //Stop an emitter from spawning any more particles. It is removed once the ones it has left die
+	void removeAllEmitters(); //Remove every emitter right away
+
+	/*
+		Spawn new particles, update every particle across the job system's threads, build and merge their quads, then remove the dead ones
+
+		@param DeltaTime -> How much time has passed, in seconds
+	*/
+	void step(float deltaTime);
+
+private:
+	//--- Private Data ---//
+	//An emitter being updated
+	struct ManagedEmitter
+	{
+		ParticleEmitter* emitter;
+		bool removeWhenEmpty; //True once stopEmitter() has been called
+	};
+
+	//A piece of one emitter's particles, worked on by a single thread
+	struct Chunk
+	{
+		ParticleEmitter* emitter;
+		unsigned int first, last; //The particles in the chunk
+		unsigned int group; //The texture group its quads go into
+		bool premultiply; //If the colors need the alpha multiplied in
+		unsigned int thread; //The thread that worked on it
+		unsigned int firstVertex, vertexCount; //Where its quads ended up in that thread's list
+	};
+
+	//Every quad drawn with the same texture. These end up next to each other in the merged list
+	struct TextureGroup
+	{
+		Texture2D* texture;
+		GLProgramState* programState;
+		unsigned int firstVertex, vertexCount; //Where the group is in the merged list
+	};
+
+	//Everything a single thread writes to. Padded so two threads never write to the same cache line
+	struct ThreadOutput
+	{
+		std::vector<V3F_C4B_T2F> vertices; //The quads of every chunk the thread did, one after the other
+		std::vector<unsigned int> chunks; //The chunks the thread did, in the order it did them
+		char padding[64];
+	};
+
+	std::vector<ManagedEmitter> emitters; //Every emitter being updated
+	std::vector<Chunk> chunks; //This frame's chunks. Rebuilt every step
+	std::vector<TextureGroup> groups; //This frame's texture groups. Rebuilt every step
+	std::vector<ThreadOutput> outputs; //One per thread. The thread calling step() is 0
+	std::vector<V3F_C4B_T2F> mergedVertices; //Every quad, grouped by texture
+	std::vector<unsigned short> indices; //Two triangles for every particle. The same for every command so it is only built once
+	std::vector<TrianglesCommand> commands; //The commands handed to the renderer
+	bool deterministic; //If the chunks are merged in chunk order
+	float jobDeltaTime; //The frame time for the chunks being worked on
+
+	//--- Utility Functions ---//
+	void runChunk(unsigned int index, unsigned int thread); //Update a chunk and write its quads into the thread's list
+	void buildChunks(); //Cut every emitter's particles into chunks and sort out the texture groups
+	void mergeVertices(); //Copy every thread's quads into the merged list, grouped by texture
+};
+
+#endif
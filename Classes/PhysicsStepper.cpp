@@ -0,0 +1,454 @@
+#include "PhysicsStepper.h"
+
+//Core Libraries
+#include <algorithm>
+
+//3rd Party Libraries
+#include "chipmunk/chipmunk.h"
+
+//--- Constructors and Destructors ---//
+PhysicsStepper::PhysicsStepper()
+{
+	//Init the private data
+	physicsWorld = nullptr;
+	fixedDeltaTime = 1.0f / 60.0f;
+	accumulator = 0.0f;
+	substeps = 1;
+	maxStepsPerFrame = 5;
+	stepsLastFrame = 0;
+	skippedSteps = 0;
+	interpolate = true;
+	threaded = false;
+	stepInFlight = false;
+	quitWorker = false;
+	transformsWaiting = false;
+	threadSpace = nullptr;
+	threadSteps = 0;
+	publishedBuffer = 0;
+
+	//Listen to the director so the nodes can be moved just for drawing
+	//EVENT_AFTER_UPDATE is sent once every update() is done, right before the scene is drawn. EVENT_AFTER_DRAW is sent once the drawing is done
+	EventDispatcher* dispatcher = Director::getInstance()->getEventDispatcher();
+	beforeDrawListener = dispatcher->addCustomEventListener(Director::EVENT_AFTER_UPDATE, [this](EventCustom*) { applyInterpolation(); });
+	afterDrawListener = dispatcher->addCustomEventListener(Director::EVENT_AFTER_DRAW, [this](EventCustom*) { restoreAfterDraw(); });
+}
+
+PhysicsStepper::~PhysicsStepper()
+{
+	//Stop the worker thread before anything it uses goes away
+	setThreaded(false);
+
+	//Stop listening to the director since the listeners point at this object
+	EventDispatcher* dispatcher = Director::getInstance()->getEventDispatcher();
+	dispatcher->removeEventListener(beforeDrawListener);
+	dispatcher->removeEventListener(afterDrawListener);
+}
+
+
+
+//--- Setters ---//
+void PhysicsStepper::setPhysicsWorld(PhysicsWorld* world)
+{
+	physicsWorld = world;
+	reset();
+}
+
+void PhysicsStepper::setStepRate(float stepsPerSecond)
+{
+	//Don't allow a rate of 0 or less since that would mean steps of infinite length
+	if (stepsPerSecond > 0.0f)
+		fixedDeltaTime = 1.0f / stepsPerSecond;
+}
+
+void PhysicsStepper::setSubsteps(unsigned int _substeps)
+{
+	//There always has to be at least one
+	substeps = (_substeps > 0) ? _substeps : 1;
+}
+
+void PhysicsStepper::setMaxStepsPerFrame(unsigned int _maxStepsPerFrame)
+{
+	//There always has to be at least one, otherwise nothing would ever move
+	maxStepsPerFrame = (_maxStepsPerFrame > 0) ? _maxStepsPerFrame : 1;
+}
+
+void PhysicsStepper::setInterpolation(bool enabled)
+{
+	interpolate = enabled;
+}
+
+void PhysicsStepper::setThreaded(bool enabled)
+{
+	if (enabled == threaded)
+		return;
+
+	if (enabled)
+	{
+		//Start the worker. It sleeps until advance() gives it something to step
+		quitWorker = false;
+		worker = std::thread(&PhysicsStepper::workerLoop, this);
+		threaded = true;
+	}
+	else
+	{
+		//Let the step that is running finish and put its results on the nodes, then tell the worker to stop
+		waitForStep();
+		{
+			std::lock_guard<std::mutex> lock(workerMutex);
+			quitWorker = true;
+		}
+		workerWake.notify_all();
+		worker.join();
+		threaded = false;
+	}
+}
+
+
+
+//--- Getters ---//
+float PhysicsStepper::getStepRate() const
+{
+	return 1.0f / fixedDeltaTime;
+}
+
+float PhysicsStepper::getFixedDeltaTime() const
+{
+	return fixedDeltaTime;
+}
+
+unsigned int PhysicsStepper::getSubsteps() const
+{
+	return substeps;
+}
+
+unsigned int PhysicsStepper::getMaxStepsPerFrame() const
+{
+	return maxStepsPerFrame;
+}
+
+bool PhysicsStepper::getInterpolation() const
+{
+	return interpolate;
+}
+
+unsigned int PhysicsStepper::getStepsLastFrame() const
+{
+	return stepsLastFrame;
+}
+
+unsigned int PhysicsStepper::getSkippedSteps() const
+{
+	return skippedSteps;
+}
+
+float PhysicsStepper::getAlpha() const
+{
+	return accumulator / fixedDeltaTime;
+}
+
+bool PhysicsStepper::isThreaded() const
+{
+	return threaded;
+}
+
+bool PhysicsStepper::isStepping() const
+{
+	std::lock_guard<std::mutex> lock(const_cast<std::mutex&>(workerMutex));
+	return stepInFlight;
+}
+
+
+
+//--- Methods ---//
+void PhysicsStepper::addInterpolatedLayer(Node* layer)
+{
+	layers.push_back(layer);
+	previousStates.push_back(std::vector<NodeState>());
+}
+
+unsigned int PhysicsStepper::advance(float deltaTime)
+{
+	stepsLastFrame = 0;
+	if (!physicsWorld)
+		return 0;
+
+	//The last frame's step has to be finished before the next one can start
+	waitForStep();
+
+	//Add the frame to the accumulator and work out how many whole steps fit in it
+	accumulator += deltaTime;
+	unsigned int numSteps = (unsigned int)(accumulator / fixedDeltaTime);
+
+	//If there are more steps than the cap, throw the extra ones away. The game will fall behind real time instead of getting slower and slower
+	if (numSteps > maxStepsPerFrame)
+	{
+		skippedSteps += numSteps - maxStepsPerFrame;
+		accumulator -= (numSteps - maxStepsPerFrame) * fixedDeltaTime;
+		numSteps = maxStepsPerFrame;
+	}
+
+	if (threaded)
+	{
+		//Hand all of the steps to the worker at once. The interpolation positions are stored when the results are copied onto the nodes instead
+		if (numSteps > 0)
+			startThreadedSteps(numSteps);
+		accumulator -= numSteps * fixedDeltaTime;
+	}
+	else
+	{
+		for (unsigned int i = 0; i < numSteps; i++)
+		{
+			//Only the last two steps matter for the interpolation, so the positions are only stored right before the last step
+			if (interpolate && i == numSteps - 1)
+				storePreviousStates();
+
+			stepOnce();
+			accumulator -= fixedDeltaTime;
+		}
+	}
+
+	//Floating point error can leave the accumulator just below 0. Don't let it build up
+	if (accumulator < 0.0f)
+		accumulator = 0.0f;
+
+	stepsLastFrame = numSteps;
+	return numSteps;
+}
+
+void PhysicsStepper::waitForStep()
+{
+	if (threaded)
+	{
+		//Sleep until the worker is done. Usually it finished long ago, while the last frame was being drawn
+		{
+			std::unique_lock<std::mutex> lock(workerMutex);
+			stepDone.wait(lock, [this]() { return !stepInFlight; });
+		}
+
+		//Move the nodes to where the step left the bodies. Where they were before is kept for the interpolation
+		if (transformsWaiting)
+		{
+			if (interpolate)
+				storePreviousStates();
+			applyPublishedTransforms();
+			transformsWaiting = false;
+		}
+	}
+
+	//Now that nothing is being stepped, run everything that had to wait. Swapped out first in case one of them queues another
+	std::vector<std::function<void()>> commands;
+	commands.swap(pendingCommands);
+	for (unsigned int i = 0; i < commands.size(); i++)
+		commands[i]();
+}
+
+void PhysicsStepper::runWhenIdle(const std::function<void()>& command)
+{
+	//Save it for later if the worker has the bodies
+	if (isStepping())
+	{
+		pendingCommands.push_back(command);
+		return;
+	}
+
+	//Otherwise catch up first. The finished step's transforms have to be copied onto the nodes before anything can be removed (the copy still points at them), and anything saved earlier has to run before this so everything happens in the order it was asked for
+	//The worker is done, so this never has to wait
+	waitForStep();
+	command();
+}
+
+void PhysicsStepper::forgetNodes(const std::vector<Node*>& sortedNodes)
+{
+	if (sortedNodes.empty())
+		return;
+
+	//Clear the node out of each of their stored states instead of removing them, so the rest of the list stays in the same order as the children. A state with no node never matches a child, so it is just skipped
+	for (unsigned int i = 0; i < previousStates.size(); i++)
+	{
+		for (unsigned int j = 0; j < previousStates[i].size(); j++)
+		{
+			if (std::binary_search(sortedNodes.begin(), sortedNodes.end(), previousStates[i][j].node))
+				previousStates[i][j].node = nullptr;
+		}
+	}
+}
+
+void PhysicsStepper::reset()
+{
+	//Let the worker finish first so nothing is changed underneath it
+	waitForStep();
+
+	//Start over with an empty accumulator and forget where everything was
+	accumulator = 0.0f;
+	skippedSteps = 0;
+	for (unsigned int i = 0; i < previousStates.size(); i++)
+		previousStates[i].clear();
+}
+
+
+
+//--- Utility Functions ---//
+void PhysicsStepper::stepOnce()
+{
+	//Every substep goes through the physics world so the nodes and bodies are kept in sync each time
+	//*** Try turning up the substeps and stacking a tall pile of birds. Does the pile stay together better? What does it cost in the profiler? ***//
+	float substepTime = fixedDeltaTime / (float)substeps;
+	for (unsigned int i = 0; i < substeps; i++)
+		physicsWorld->step(substepTime);
+}
+
+void PhysicsStepper::startThreadedSteps(unsigned int numSteps)
+{
+	//Stepping the world by 0 doesn't simulate anything, but it still adds and removes the bodies that were queued up since the last step and copies the node positions into the bodies
+	//This is the last time the physics world itself is used until the worker is done. Everything after this point only touches the Chipmunk space
+	physicsWorld->step(0.0f);
+
+	//Find the space through any body that is in it. Cocos2D doesn't give us the space from the world
+	threadSpace = nullptr;
+	for (PhysicsBody* body : physicsWorld->getAllBodies())
+	{
+		threadSpace = cpBodyGetSpace(body->getCPBody());
+		if (threadSpace)
+			break;
+	}
+	if (!threadSpace)
+		return;
+
+	//List the bodies whose transforms the worker should publish. The lists are reused so they don't have to grow every frame
+	threadBodies.clear();
+	for (unsigned int i = 0; i < layers.size(); i++)
+	{
+		for (Node* child : layers[i]->getChildren())
+		{
+			PhysicsBody* body = child->getPhysicsBody();
+			if (body)
+			{
+				ThreadedBody threadedBody = { child, body->getCPBody() };
+				threadBodies.push_back(threadedBody);
+			}
+		}
+	}
+
+	//Wake the worker up
+	{
+		std::lock_guard<std::mutex> lock(workerMutex);
+		threadSteps = numSteps;
+		stepInFlight = true;
+	}
+	workerWake.notify_all();
+}
+
+void PhysicsStepper::workerLoop()
+{
+	std::unique_lock<std::mutex> lock(workerMutex);
+	while (true)
+	{
+		//Sleep until there is a step to do
+		workerWake.wait(lock, [this]() { return stepInFlight || quitWorker; });
+		if (quitWorker)
+			return;
+
+		//The main thread won't touch the space, the body list or the step count until stepInFlight goes back to false, so the lock isn't needed while stepping
+		lock.unlock();
+
+		float substepTime = fixedDeltaTime / (float)substeps;
+		for (unsigned int step = 0; step < threadSteps; step++)
+		{
+			for (unsigned int i = 0; i < substeps; i++)
+				cpSpaceStep(threadSpace, substepTime);
+		}
+
+		//Write where every body ended up into the buffer the main thread isn't reading, then publish it
+		//Chipmunk's angles are counter-clockwise radians, Cocos2D's rotations are clockwise degrees
+		unsigned int writeBuffer = 1 - publishedBuffer;
+		std::vector<BodyTransform>& transforms = transformBuffers[writeBuffer];
+		transforms.resize(threadBodies.size());
+		for (unsigned int i = 0; i < threadBodies.size(); i++)
+		{
+			cpVect position = cpBodyGetPosition(threadBodies[i].body);
+			transforms[i].position = Vec2((float)position.x, (float)position.y);
+			transforms[i].rotation = -CC_RADIANS_TO_DEGREES((float)cpBodyGetAngle(threadBodies[i].body));
+		}
+		publishedBuffer = writeBuffer;
+
+		//Let the main thread know it is done
+		lock.lock();
+		stepInFlight = false;
+		transformsWaiting = true;
+		stepDone.notify_all();
+	}
+}
+
+void PhysicsStepper::applyPublishedTransforms()
+{
+	//The buffer lines up with the body list built in startThreadedSteps(). Nothing can have been removed since, because removals wait for the step to be done
+	const std::vector<BodyTransform>& transforms = transformBuffers[publishedBuffer];
+	for (unsigned int i = 0; i < threadBodies.size() && i < transforms.size(); i++)
+	{
+		threadBodies[i].node->setPosition(transforms[i].position);
+		threadBodies[i].node->setRotation(transforms[i].rotation);
+	}
+}
+
+void PhysicsStepper::storePreviousStates()
+{
+	//Remember where each child of each layer is. The list is reused so it doesn't have to grow every step
+	for (unsigned int i = 0; i < layers.size(); i++)
+	{
+		std::vector<NodeState>& states = previousStates[i];
+		states.clear();
+
+		const Vector<Node*>& children = layers[i]->getChildren();
+		states.reserve(children.size());
+		for (Node* child : children)
+		{
+			NodeState state = { child, child->getPosition(), child->getRotation() };
+			states.push_back(state);
+		}
+	}
+}
+
+void PhysicsStepper::applyInterpolation()
+{
+	drawnStates.clear();
+	if (!interpolate)
+		return;
+
+	//Draw each node between where it was on the step before the last one (the stored state) and where it is now (the last step)
+	float alpha = getAlpha();
+	for (unsigned int i = 0; i < layers.size(); i++)
+	{
+		const std::vector<NodeState>& states = previousStates[i];
+		const Vector<Node*>& children = layers[i]->getChildren();
+
+		//The children are in the same order as when they were stored, except some might have been removed and new ones added to the end
+		//So we can walk through both lists together. A node that isn't in the stored list was spawned since the last step and is just drawn where it is
+		unsigned int next = 0;
+		for (Node* child : children)
+		{
+			unsigned int search = next;
+			while (search < states.size() && states[search].node != child)
+				search++;
+			if (search == states.size())
+				continue;
+			next = search + 1;
+
+			//Remember the real position so it can be put back after drawing, then move the node to the in-between position
+			NodeState real = { child, child->getPosition(), child->getRotation() };
+			drawnStates.push_back(real);
+			child->setPosition(states[search].position.lerp(real.position, alpha));
+			child->setRotation(states[search].rotation + (real.rotation - states[search].rotation) * alpha);
+		}
+	}
+}
+
+void PhysicsStepper::restoreAfterDraw()
+{
+	//Put every node that was moved back where the physics actually has it. The next step reads the node positions, so this HAS to happen before then
+	for (unsigned int i = 0; i < drawnStates.size(); i++)
+	{
+		drawnStates[i].node->setPosition(drawnStates[i].position);
+		drawnStates[i].node->setRotation(drawnStates[i].rotation);
+	}
+	drawnStates.clear();
+}
@@ -0,0 +1,233 @@
+/*
+============================================================
+	Physics Stepper:
+		- Steps a physics world with a fixed timestep, no matter how long each frame actually took
+			> The frame time goes into an 'accumulator'. Every time there is a whole step's worth of time in it, the world is stepped once by exactly that much
+			> The physics behaves the same at 30fps as it does at 144fps, and every step costs about the same, so it is easy to predict how many bodies the game can handle
+			> Small steps also stop fast birds from passing straight through the ground when the frame rate drops (called 'tunneling')
+		- Each step can be split into substeps for a more stable (but more expensive) simulation
+		- A cap on the number of steps per frame stops the 'death spiral'. Without it, a slow frame means more steps next frame, which makes that frame slower, which means even more steps...
+		- The frame usually ends partway between two steps. The nodes in the interpolated layers are drawn that far between where they were on the last two steps so they still move smoothly
+			> This only changes where the nodes are drawn. Their positions go back to the real physics positions straight after drawing, so the game code never sees the in-between values
+		- The steps can run on a worker thread instead (see setThreaded()), so the physics for frame N happens while frame N is being drawn
+			> The worker steps the Chipmunk space directly and writes where every body ended up into one of two buffers. The main thread copies the other, finished buffer onto the nodes
+			> Anything that adds, removes or changes a body while the worker is stepping has to wait. Give it to runWhenIdle() and it is run as soon as the step is done
+			> The nodes show the physics from the step that was started the frame before, so everything is drawn one frame late
+
+	Usage:
+		- Turn off auto stepping on the physics world, give it to setPhysicsWorld() and call advance() once a frame with the frame time
+		- Add the node that holds the physics objects with addInterpolatedLayer(). Only the direct children of the layer are interpolated
+		- Call reset() when the objects are all cleared out (ex: when restarting)
+		- With threading on, hand anything that adds, removes or changes bodies to runWhenIdle() so the frame can carry on while the worker steps. For the odd one-off change (ex: a settings change), calling waitForStep() first is fine too
+
+	Note:
+		- The interpolation relies on the director's EVENT_AFTER_UPDATE and EVENT_AFTER_DRAW events. When nothing is being drawn (ex: the headless runner) it simply doesn't happen
+		- With threading on, the nodes are placed assuming the interpolated layers sit at the origin with no scale or rotation, and that the physics bodies are centered on their nodes. This is how DemoScene builds its bird layers
+		- With threading on, contact events would be sent from the worker thread, where the event dispatcher can't be used. Don't add contact handlers for anything that can touch while threading is on
+============================================================
+*/
+
+#ifndef PHYSICSSTEPPER_H
+#define PHYSICSSTEPPER_H
+
+//Core Libraries
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+//3rd Party Libraries
+#include "cocos2d.h"
+
+//Forward Declarations
+struct cpBody;
+struct cpSpace;
+
+//Namespaces
+using namespace cocos2d;
+
+/*
+	Physics Stepper Class:
+	> Setters
+		- Set the physics world to step
+		- Set the step rate, substeps and max steps per frame
+		- Turn the interpolation on or off
+		- Turn the worker thread on or off
+	> Getters
+		- Get the settings
+		- Get how many steps happened last frame and how many were skipped
+		- Get how far the frame is between the last two steps
+		- Get if a step is running on the worker thread
+	> Methods
+		- Add a layer to interpolate
+		- Advance by a frame
+		- Wait for the worker thread
+		- Run something once the physics isn't being stepped
+		- Forget nodes that are being reused
+		- Reset
+*/
+class PhysicsStepper
+{
+public:
+	//--- Constructors and Destructors ---//
+	PhysicsStepper();
+	~PhysicsStepper();
+
+
+
+	//--- Setters ---//
+	void setPhysicsWorld(PhysicsWorld* world); //Set the world to step. Auto stepping should be turned off on it
+
+	/*
+		Set how many physics steps happen per second of game time
+
+		@param StepsPerSecond -> The number of steps per second. Defaulted to 60
+	*/
+	void setStepRate(float stepsPerSecond);
+
+	/*
+		Set how many pieces each step is split into. Each substep costs about as much as a full step, so use this only when the physics needs it (ex: lots of stacked bodies)
+
+		@param Substeps -> The number of substeps. Defaulted to 1 (no splitting)
+	*/
+	void setSubsteps(unsigned int substeps);
+
+	/*
+		Set the most steps allowed in a single frame. If a frame takes longer than this many steps, the extra time is thrown away and the game runs in slow motion until it catches up
+
+		@param MaxStepsPerFrame -> The max number of steps. Defaulted to 5
+	*/
+	void setMaxStepsPerFrame(unsigned int maxStepsPerFrame);
+
+	void setInterpolation(bool enabled); //Turn the interpolation on or off. It is on by default
+
+	/*
+		Turn stepping on a worker thread on or off. Turning it off waits for the step that is running to finish first
+
+		@param Enabled -> True to step on the worker thread. Defaulted to false
+	*/
+	void setThreaded(bool enabled);
+
+
+
+	//--- Getters ---//
+	float getStepRate() const; //Get how many physics steps happen per second
+	float getFixedDeltaTime() const; //Get the length of a single step in seconds
+	unsigned int getSubsteps() const; //Get how many pieces each step is split into
+	unsigned int getMaxStepsPerFrame() const; //Get the most steps allowed in a single frame
+	bool getInterpolation() const; //Get if the interpolation is on
+	unsigned int getStepsLastFrame() const; //Get how many steps advance() took last time it was called
+	unsigned int getSkippedSteps() const; //Get how many steps have been thrown away because of the max steps per frame since the last reset()
+	float getAlpha() const; //Get how far the frame is between the last two steps. 0 is on the last step, 1 would be on the next one
+	bool isThreaded() const; //Get if the steps run on the worker thread
+	bool isStepping() const; //Get if the worker thread is in the middle of stepping. Always false if threading is off
+
+
+
+	//--- Methods ---//
+	/*
+		Add a layer whose children should be drawn between their last two physics positions
+
+		@param Layer -> The layer. The stepper doesn't hold on to it, so the layer has to stay around for as long as the stepper does
+	*/
+	void addInterpolatedLayer(Node* layer);
+
+	/*
+		Step the world as many times as there is time for
+
+		@param DeltaTime -> How long the frame took, in seconds
+		@return Returns -> The number of steps taken this frame. Can be 0 if the frame was shorter than a step
+	*/
+	unsigned int advance(float deltaTime);
+
+	/*
+		Wait for the worker thread to finish its step, move the nodes to where the step left the bodies and run everything given to runWhenIdle() in the meantime
+		Does nothing but run the waiting functions if threading is off. advance() calls this first, but call it yourself before touching any bodies earlier in the frame
+	*/
+	void waitForStep();
+
+	/*
+		Run a function that adds, removes or changes physics bodies. If the worker thread is stepping, it is saved and run by waitForStep() instead (advance() calls it before starting the next step)
+		The functions always run in the order they were given, and always after the last step's transforms have been copied onto the nodes
+
+		@param Command -> The function to run. It is run on the main thread either way
+	*/
+	void runWhenIdle(const std::function<void()>& command);
+
+	/*
+		Forget where some nodes were on the last step, so they aren't drawn sliding in from there. Call this when nodes are taken out of the interpolated layers to be reused (ex: birds going back to the pool)
+		Without it, a node that is put back in the same frame would be matched to where it was in its old life and drawn streaking across the screen
+
+		@param SortedNodes -> The nodes, sorted by their pointers. They are only compared, never used, so it doesn't matter if they have been deleted
+	*/
+	void forgetNodes(const std::vector<Node*>& sortedNodes);
+
+	void reset(); //Throw away the time left in the accumulator and everything remembered about the last step. Call this when the objects are cleared out
+
+private:
+	//--- Private Data ---//
+	//Where a node was on the step before the last one
+	struct NodeState
+	{
+		Node* node; //The node. The stored states only ever compare against this, never use it, since it might have been deleted since the step
+		Vec2 position;
+		float rotation;
+	};
+
+	//A body the worker thread writes the transform of. The node is only used on the main thread
+	struct ThreadedBody
+	{
+		Node* node;
+		cpBody* body;
+	};
+
+	//Where a body ended up after the worker's step
+	struct BodyTransform
+	{
+		Vec2 position;
+		float rotation;
+	};
+
+	PhysicsWorld* physicsWorld; //The world being stepped
+	float fixedDeltaTime; //The length of a step in seconds
+	float accumulator; //The time that has built up but hasn't been stepped yet
+	unsigned int substeps; //How many pieces each step is split into
+	unsigned int maxStepsPerFrame; //The most steps in a single frame
+	unsigned int stepsLastFrame; //How many steps were taken the last time advance() was called
+	unsigned int skippedSteps; //How many steps have been thrown away by the cap
+	bool interpolate; //If the nodes should be drawn between steps
+	std::vector<Node*> layers; //The layers whose children are interpolated
+	std::vector<std::vector<NodeState>> previousStates; //Where each layer's children were on the step before the last one, in the same order as the children
+	std::vector<NodeState> drawnStates; //The real positions of the nodes that were moved for drawing, so they can be put back afterwards
+	EventListenerCustom* beforeDrawListener; //Moves the nodes to their in-between positions once the update is done
+	EventListenerCustom* afterDrawListener; //Puts the nodes back once they have been drawn
+
+	//Threading
+	bool threaded; //If the steps run on the worker thread
+	std::thread worker; //The thread that steps the space
+	std::mutex workerMutex; //Protects stepInFlight and quitWorker
+	std::condition_variable workerWake; //Wakes the worker up when there is a step to do or it should quit
+	std::condition_variable stepDone; //Wakes the main thread up when the step is done
+	bool stepInFlight; //True from when the main thread hands the worker a step until the worker is done with it
+	bool quitWorker; //Tells the worker to stop
+	bool transformsWaiting; //True if the worker has published transforms that haven't been copied onto the nodes yet
+	cpSpace* threadSpace; //The space the worker steps. Only changed while the worker is idle
+	unsigned int threadSteps; //How many steps the worker should take. Only changed while the worker is idle
+	std::vector<ThreadedBody> threadBodies; //The bodies the worker writes the transforms of. Only changed while the worker is idle
+	std::vector<BodyTransform> transformBuffers[2]; //The double buffer. The worker fills one while the other holds the last finished step
+	std::atomic<unsigned int> publishedBuffer; //The index of the buffer holding the last finished step
+	std::vector<std::function<void()>> pendingCommands; //The functions given to runWhenIdle() while the worker was stepping
+
+	//--- Utility Functions ---//
+	void stepOnce(); //Step the world by one fixed step, split into the substeps
+	void startThreadedSteps(unsigned int numSteps); //Get the bodies ready and hand a number of steps to the worker
+	void workerLoop(); //What the worker thread runs. Waits for steps and does them until it is told to quit
+	void applyPublishedTransforms(); //Copy the last finished buffer onto the nodes
+	void storePreviousStates(); //Remember where every interpolated node is right now
+	void applyInterpolation(); //Move the nodes to where they should be drawn
+	void restoreAfterDraw(); //Put the nodes back to their real positions
+};
+
+#endif
@@ -0,0 +1,35 @@
+#include "PhysicsTuning.h"
+
+//3rd Party Libraries
+#include "chipmunk/chipmunk.h"
+
+PhysicsTuning PhysicsTuning::getDefault()
+{
+	//These are the values Chipmunk starts every space with
+	PhysicsTuning tuning;
+	tuning.iterations = 10;
+	tuning.collisionSlop = 0.1f;
+	tuning.spatialHashCellSize = 0.0f;
+	tuning.spatialHashCount = 0;
+	tuning.sleepTimeThreshold = 0.0f;
+	tuning.idleSpeedThreshold = 10.0f;
+	return tuning;
+}
+
+bool PhysicsTuning::applyTo(PhysicsBody* bodyInWorld) const
+{
+	//Find the space through the body. It is null until the body has actually been added
+	cpSpace* space = (bodyInWorld) ? cpBodyGetSpace(bodyInWorld->getCPBody()) : nullptr;
+	if (!space)
+		return false;
+
+	//Set the solver settings
+	cpSpaceSetIterations(space, (iterations > 0) ? iterations : 1);
+	cpSpaceSetCollisionSlop(space, collisionSlop);
+
+	//Swap the broadphase over to a spatial hash if asked to. Chipmunk moves every shape over to the new hash
+	if (spatialHashCellSize > 0.0f && spatialHashCount > 0)
+		cpSpaceUseSpatialHash(space, spatialHashCellSize, spatialHashCount);
+
+	return true;
+}
@@ -0,0 +1,70 @@
+/*
+============================================================
+	Physics Tuning:
+		- The knobs that decide how much each physics step costs once hundreds or thousands of birds are piled up
+			> Iterations -> How many times the solver goes over every contact each step. Fewer is cheaper but piles get squishy
+			> Collision Slop -> How far bodies are allowed to sink into each other before they are pushed apart. A little overlap stops piles from jittering
+			> Spatial Hash -> How the physics engine finds which bodies might be touching (the 'broadphase'). By default it uses a tree of bounding boxes
+				> A spatial hash splits the world into a grid instead. It is faster when every body is about the same size, like our birds
+				> The cell size should be about the size of a bird. The cell count should be about the number of birds (the engine rounds it up to a prime)
+			> Sleeping -> Birds that have stopped moving for long enough are frozen in place so they don't cost anything until something hits them
+		- Cocos2D doesn't give access to most of these, so they are set on the Chipmunk space directly
+
+	Usage:
+		- Fill in a PhysicsTuning (start from PhysicsTuning::getDefault()) and give it to DemoScene::setPhysicsTuning()
+
+	Note:
+		- Chipmunk has its own sleeping, but Cocos2D moves every body to match its node before every step and moving a body wakes it up, so it never gets to sleep
+			> The sleeping settings are used by DemoScene instead. It turns birds that have settled into non-dynamic bodies, which don't collide with the ground or with each other
+			> Sleeping birds are moved to the SleepingBird category (see CollisionFilter.h) so they are the only birds that send contact events
+		- Once the spatial hash is turned on, it can't be turned back off for that physics world. Restart the whole scene to go back to the tree
+============================================================
+*/
+
+#ifndef PHYSICSTUNING_H
+#define PHYSICSTUNING_H
+
+//3rd Party Libraries
+#include "cocos2d.h"
+
+//Namespaces
+using namespace cocos2d;
+
+/*
+	Physics Tuning
+	- The settings for a physics world
+
+	> Iterations -> How many times the solver goes over the contacts each step. Chipmunk's default is 10
+	> CollisionSlop -> How much overlap is allowed between bodies, in pixels. Chipmunk's default is 0.1
+	> SpatialHashCellSize -> The size of each grid cell in pixels. 0 keeps the default bounding box tree
+	> SpatialHashCount -> The number of cells in the spatial hash. Only used if the cell size isn't 0
+	> SleepTimeThreshold -> How long (in seconds) a bird has to stay still before it is put to sleep. 0 turns sleeping off
+	> IdleSpeedThreshold -> How slow (in pixels per second) a bird has to be moving to count as still
+*/
+struct PhysicsTuning
+{
+	int iterations;
+	float collisionSlop;
+	float spatialHashCellSize;
+	int spatialHashCount;
+	float sleepTimeThreshold;
+	float idleSpeedThreshold;
+
+	/*
+		Get the settings the physics world starts with. No spatial hash and no sleeping
+
+		@return Returns -> The default settings
+	*/
+	static PhysicsTuning getDefault();
+
+	/*
+		Set the iterations, collision slop and spatial hash on the physics world that a body is in
+		Cocos2D doesn't let us get to the Chipmunk space from the world, so a body that has been added to the world is used to find it instead
+
+		@param BodyInWorld -> Any body that is in the physics world. Bodies are only added to the world once their node is running in the scene
+		@return Returns -> True if the settings were applied. False if the body isn't in a world yet
+	*/
+	bool applyTo(PhysicsBody* bodyInWorld) const;
+};
+
+#endif
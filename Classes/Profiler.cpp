@@ -0,0 +1,303 @@
+#include "Profiler.h"
+
+//Core Libraries
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+//3rd Party Libraries
+#include "cocos2d.h"
+
+//--- Static Variables ---//
+Profiler* Profiler::inst = nullptr;
+
+//The time the profiler was created. Every timestamp is relative to this so they fit nicely in the exports
+static const std::chrono::steady_clock::time_point PROFILER_EPOCH = std::chrono::steady_clock::now();
+
+
+
+//--- Constructor and Destructor ---//
+Profiler::Profiler()
+{
+	//Init the private data
+	currentFrame = 0;
+	frameCount = 0;
+	depth = 0;
+	renderSample = 0;
+	enabled = true;
+	mainThread = std::this_thread::get_id();
+
+	//Build the whole history up front. Each frame keeps its sample list between uses so nothing is allocated once the profiler has warmed up
+	history.resize(PROFILER_HISTORY_FRAMES);
+	for (unsigned int i = 0; i < history.size(); i++)
+		history[i].samples.reserve(32);
+	history[currentFrame].index = 0;
+	history[currentFrame].start = now();
+	history[currentFrame].duration = 0;
+}
+
+Profiler::~Profiler()
+{
+	//Clean up the singleton pointer so a new profiler is built if it is used again
+	inst = nullptr;
+}
+
+
+
+//--- Setters ---//
+void Profiler::setEnabled(bool _enabled)
+{
+	enabled = _enabled;
+}
+
+
+
+//--- Getters ---//
+bool Profiler::isEnabled() const
+{
+	return enabled;
+}
+
+uint64_t Profiler::now()
+{
+	return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - PROFILER_EPOCH).count();
+}
+
+std::string Profiler::getOverlayText() const
+{
+#if DEMO_PROFILING
+	//Add up every section over the last second of frames. There are only ever a handful of different sections so a small list is plenty
+	struct SectionTotal
+	{
+		const char* name;
+		unsigned int depth;
+		double totalMs;
+		double maxMs;
+	};
+	std::vector<SectionTotal> sections;
+	double frameTotalMs = 0.0;
+	double frameMaxMs = 0.0;
+	unsigned int framesCounted = 0;
+
+	for (unsigned int age = 0; age < PROFILER_OVERLAY_FRAMES; age++)
+	{
+		const ProfileFrame* frame = getFrame(age);
+		if (!frame)
+			break;
+
+		double frameMs = frame->duration / 1000000.0;
+		frameTotalMs += frameMs;
+		if (frameMs > frameMaxMs)
+			frameMaxMs = frameMs;
+		framesCounted++;
+
+		for (unsigned int i = 0; i < frame->samples.size(); i++)
+		{
+			const ProfileSample& sample = frame->samples[i];
+
+			//Find the section, or add it if this is the first time it has been seen
+			unsigned int section = 0;
+			while (section < sections.size() && strcmp(sections[section].name, sample.name) != 0)
+				section++;
+			if (section == sections.size())
+			{
+				SectionTotal newSection = { sample.name, sample.depth, 0.0, 0.0 };
+				sections.push_back(newSection);
+			}
+
+			//A section can happen more than once a frame, so the times are added up per frame and averaged over the frames
+			double sampleMs = sample.duration / 1000000.0;
+			sections[section].totalMs += sampleMs;
+			if (sampleMs > sections[section].maxMs)
+				sections[section].maxMs = sampleMs;
+		}
+	}
+
+	if (framesCounted == 0)
+		return "Profiler: waiting for frames...";
+
+	//One line per section. The nested sections are indented under the ones they are inside of
+	std::ostringstream text;
+	text << std::fixed << std::setprecision(2);
+	text << "Frame: " << (frameTotalMs / framesCounted) << "ms avg, " << frameMaxMs << "ms max" << (enabled ? "" : " (paused)") << "\n";
+	for (unsigned int i = 0; i < sections.size(); i++)
+	{
+		text << std::string(sections[i].depth * 2 + 2, ' ') << sections[i].name << ": "
+			<< (sections[i].totalMs / framesCounted) << "ms avg, " << sections[i].maxMs << "ms max\n";
+	}
+
+	return text.str();
+#else
+	return "Profiler: compiled out (build with DEMO_PROFILING=1)";
+#endif
+}
+
+
+
+//--- Methods ---//
+unsigned int Profiler::beginSample(const char* name)
+{
+	//Only the main thread is recorded. Jobs running on the workers would be writing to the same list at the same time
+	if (std::this_thread::get_id() != mainThread)
+		return PROFILER_NO_SAMPLE;
+
+	//Add the sample to the current frame with no duration yet
+	ProfileFrame& frame = history[currentFrame];
+	ProfileSample sample = { name, now(), 0, depth };
+	frame.samples.push_back(sample);
+	depth++;
+
+	return frame.samples.size() - 1;
+}
+
+void Profiler::endSample(unsigned int index)
+{
+	if (index == PROFILER_NO_SAMPLE)
+		return;
+
+	//If the frame ended while the sample was open, the sample is gone. Just close up the depth
+	if (depth > 0)
+		depth--;
+
+	ProfileFrame& frame = history[currentFrame];
+	if (index >= frame.samples.size())
+		return;
+
+	//Fill in how long the section took
+	frame.samples[index].duration = now() - frame.samples[index].start;
+}
+
+void Profiler::endFrame()
+{
+	//Finish the frame that was being recorded
+	uint64_t frameEnd = now();
+	history[currentFrame].duration = frameEnd - history[currentFrame].start;
+
+	//If the profiler is paused, keep reusing the same frame so the history doesn't change
+	if (enabled)
+	{
+		frameCount++;
+		currentFrame = (currentFrame + 1) % history.size();
+	}
+
+	//Start the next frame. clear() keeps the memory of the sample list so it can be reused
+	ProfileFrame& frame = history[currentFrame];
+	frame.index = frameCount;
+	frame.start = frameEnd;
+	frame.duration = 0;
+	frame.samples.clear();
+	depth = 0;
+}
+
+void Profiler::attachToDirector()
+{
+#if DEMO_PROFILING
+	//The director doesn't have a function we can wrap the rendering with, but it does send out events around it
+	//Once the update is finished, everything until the end of the draw is the scene being visited and rendered
+	cocos2d::EventDispatcher* dispatcher = cocos2d::Director::getInstance()->getEventDispatcher();
+	dispatcher->addCustomEventListener(cocos2d::Director::EVENT_AFTER_UPDATE, [this](cocos2d::EventCustom*)
+	{
+		renderSample = beginSample("Render");
+	});
+	dispatcher->addCustomEventListener(cocos2d::Director::EVENT_AFTER_DRAW, [this](cocos2d::EventCustom*)
+	{
+		endSample(renderSample);
+		endFrame();
+	});
+#endif
+}
+
+bool Profiler::exportCSV(const std::string& path) const
+{
+	std::ofstream file(path.c_str());
+	if (!file.is_open())
+	{
+		std::cout << "ERROR: Could not save the profile to '" << path << "'" << std::endl;
+		return false;
+	}
+
+	//One row per sample, with a row for each frame as a whole as well. Oldest frame first
+	file << "frame,section,depth,start_ms,duration_ms\n";
+	file << std::fixed << std::setprecision(4);
+	for (int age = PROFILER_HISTORY_FRAMES - 1; age >= 0; age--)
+	{
+		const ProfileFrame* frame = getFrame(age);
+		if (!frame)
+			continue;
+
+		file << frame->index << ",Frame,-1," << frame->start / 1000000.0 << "," << frame->duration / 1000000.0 << "\n";
+		for (unsigned int i = 0; i < frame->samples.size(); i++)
+		{
+			const ProfileSample& sample = frame->samples[i];
+			file << frame->index << "," << sample.name << "," << sample.depth << "," << sample.start / 1000000.0 << "," << sample.duration / 1000000.0 << "\n";
+		}
+	}
+
+	std::cout << "Profile saved to " << path << std::endl;
+	return true;
+}
+
+bool Profiler::exportChromeTrace(const std::string& path) const
+{
+	std::ofstream file(path.c_str());
+	if (!file.is_open())
+	{
+		std::cout << "ERROR: Could not save the profile to '" << path << "'" << std::endl;
+		return false;
+	}
+
+	//Every sample becomes a 'complete' event (ph = X). Chrome trace times are in microseconds
+	file << "{\"traceEvents\":[\n";
+	file << std::fixed << std::setprecision(3);
+	bool first = true;
+	for (int age = PROFILER_HISTORY_FRAMES - 1; age >= 0; age--)
+	{
+		const ProfileFrame* frame = getFrame(age);
+		if (!frame)
+			continue;
+
+		file << (first ? "" : ",\n") << "{\"name\":\"Frame " << frame->index << "\",\"cat\":\"frame\",\"ph\":\"X\",\"pid\":1,\"tid\":1,\"ts\":"
+			<< frame->start / 1000.0 << ",\"dur\":" << frame->duration / 1000.0 << "}";
+		first = false;
+
+		for (unsigned int i = 0; i < frame->samples.size(); i++)
+		{
+			const ProfileSample& sample = frame->samples[i];
+			file << ",\n{\"name\":\"" << sample.name << "\",\"cat\":\"section\",\"ph\":\"X\",\"pid\":1,\"tid\":1,\"ts\":"
+				<< sample.start / 1000.0 << ",\"dur\":" << sample.duration / 1000.0 << "}";
+		}
+	}
+	file << "\n],\"displayTimeUnit\":\"ms\"}\n";
+
+	std::cout << "Profile saved to " << path << std::endl;
+	return true;
+}
+
+
+
+//--- Singleton Instance ---//
+Profiler* Profiler::getInstance()
+{
+	//Generate the singleton if it hasn't been created yet
+	if (!inst)
+		inst = new Profiler();
+
+	//Return the singleton
+	return inst;
+}
+
+
+
+//--- Utility Functions ---//
+const ProfileFrame* Profiler::getFrame(unsigned int age) const
+{
+	//The frame being recorded isn't finished, so age 0 is the one before it
+	if (age >= frameCount || age >= history.size() - 1)
+		return nullptr;
+
+	unsigned int index = (currentFrame + history.size() - 1 - age) % history.size();
+	return &history[index];
+}
@@ -0,0 +1,230 @@
+/*
+============================================================
+	Profiler:
+		- Times named sections of every frame (ex: the scene update, the physics step, rendering) so you can see where the frame actually goes
+		- Put PROFILE_SCOPE("Name") at the top of any block of code. It times everything from that line to the end of the block
+			> Scopes can be nested. The overlay and the exports show how deep each one was
+		- The last few hundred frames are kept so they can be looked at
+			> getOverlayText() averages the sections over the last second for the on-screen overlay
+			> exportCSV() saves every sample to a spreadsheet-friendly file
+			> exportChromeTrace() saves every sample as trace events. Open the file in chrome://tracing or https://ui.perfetto.dev to see a timeline
+
+	Usage:
+		- You are free to use this class for the case studies and for GDW
+		- You are free to edit / overwrite any or all of this class
+			> It is simply here to make your life easier
+
+	Note:
+		- The PROFILE_ macros compile to nothing unless DEMO_PROFILING is 1. It is turned on for debug builds (COCOS2D_DEBUG) and off for release builds
+			> Define DEMO_PROFILING=1 yourself to profile a release build
+		- The section names MUST be string literals (or anything else that lives forever) since only the pointer is stored
+		- Only the thread that first uses the profiler (the main thread) is recorded. Sections started on any other thread (ex: inside a job, see JobSystem.h) are skipped
+		- This class uses the Singleton design pattern
+			> There is a macro "PROFILER->" that provides a shortcut for getting the singleton instance
+============================================================
+*/
+
+#ifndef PROFILER_H
+#define PROFILER_H
+
+//Core Libraries
+#include <string>
+#include <thread>
+#include <vector>
+#include <stdint.h>
+
+//Turn the profiler on for debug builds only, unless it has been set already
+#ifndef DEMO_PROFILING
+#if defined(COCOS2D_DEBUG) && COCOS2D_DEBUG > 0
+#define DEMO_PROFILING 1
+#else
+#define DEMO_PROFILING 0
+#endif
+#endif
+
+#define PROFILER_HISTORY_FRAMES 600 //The number of frames kept for the exports. 10 seconds at 60fps
+#define PROFILER_OVERLAY_FRAMES 60 //The number of frames the overlay averages over
+#define PROFILER_NO_SAMPLE 0xFFFFFFFF //Returned by beginSample() when nothing was recorded (ex: it was called from a job on a worker thread)
+
+/*
+	Profile Sample
+	- A single timed section within a frame
+
+	> Name -> The name given to PROFILE_SCOPE()
+	> Start -> When the section started, in nanoseconds since the profiler was created
+	> Duration -> How long the section took, in nanoseconds
+	> Depth -> How many other sections it is inside of. 0 means it isn't inside any
+*/
+struct ProfileSample
+{
+	const char* name;
+	uint64_t start;
+	uint64_t duration;
+	unsigned int depth;
+};
+
+/*
+	Profile Frame
+	- Every sample taken during a single frame
+
+	> Index -> The number of the frame. The first frame is 0
+	> Start -> When the frame started, in nanoseconds since the profiler was created
+	> Duration -> How long the whole frame took, in nanoseconds
+	> Samples -> The sections timed during the frame, in the order they started
+*/
+struct ProfileFrame
+{
+	unsigned int index;
+	uint64_t start;
+	uint64_t duration;
+	std::vector<ProfileSample> samples;
+};
+
+
+
+/*
+	Profiler Class:
+	> Setters
+		- Pause / resume recording
+	> Getters
+		- Get if the profiler is recording
+		- Get the current time
+		- Get the text for the overlay
+	> Methods
+		- Begin / end a sample
+		- End the frame
+		- Attach to the director so rendering is timed
+		- Export to CSV or Chrome trace
+*/
+class Profiler
+{
+protected:
+	//--- Constructor ---//
+	Profiler(); //The constructor is protected so only one instance of this class can ever exist. This is called the singleton pattern.
+
+public:
+	//--- Destructor ---//
+	~Profiler();
+
+
+
+	//--- Setters ---//
+	void setEnabled(bool enabled); //Pause (false) or resume (true) recording. It is recording by default. Useful for freezing the history before exporting it
+
+
+
+	//--- Getters ---//
+	bool isEnabled() const; //Get if the profiler is recording
+	static uint64_t now(); //Get the current time in nanoseconds since the profiler was created
+
+	/*
+		Get a summary of the last second of frames, ready to be put into a label
+
+		@return Returns -> One line per section with its average and worst time in milliseconds
+	*/
+	std::string getOverlayText() const;
+
+
+
+	//--- Methods ---//
+	/*
+		Start timing a section. Use PROFILE_SCOPE() instead of calling this directly so the section is always ended
+
+		@param Name -> The name of the section. MUST be a string literal
+		@return Returns -> The index of the sample. Pass this to endSample(). PROFILER_NO_SAMPLE if it was called from a thread other than the main thread
+	*/
+	unsigned int beginSample(const char* name);
+
+	/*
+		Stop timing a section
+
+		@param Index -> The index returned by beginSample()
+	*/
+	void endSample(unsigned int index);
+
+	/*
+		Finish the current frame and start the next one. Called automatically once the director finishes drawing if attachToDirector() was called
+	*/
+	void endFrame();
+
+	/*
+		Listen to the director's events so the rendering is timed and frames end automatically. Call once the director has been set up
+	*/
+	void attachToDirector();
+
+	/*
+		Save every frame in the history to a CSV file. One row per sample
+
+		@param Path -> Where to save the file
+		@return Returns -> True if the file was saved
+	*/
+	bool exportCSV(const std::string& path) const;
+
+	/*
+		Save every frame in the history as Chrome trace events (JSON). Open the file in chrome://tracing or https://ui.perfetto.dev
+
+		@param Path -> Where to save the file
+		@return Returns -> True if the file was saved
+	*/
+	bool exportChromeTrace(const std::string& path) const;
+
+
+
+	//--- Singleton Instance ---//
+	/*
+		Get the instance of the singleton. You shouldn't ever need to call this directly since the macro (PROFILER->) automatically calls it
+
+		@return Returns -> The singleton instance of this class
+	*/
+	static Profiler* getInstance();
+
+private:
+	//--- Private Data ---//
+	std::vector<ProfileFrame> history; //The frames recorded so far. Used as a ring so the oldest frame is reused once it is full
+	unsigned int currentFrame; //The index in the history of the frame being recorded
+	unsigned int frameCount; //The number of frames that have been finished
+	unsigned int depth; //How many sections are open right now
+	unsigned int renderSample; //The sample for the rendering, started and ended by the director's events
+	bool enabled; //If false, nothing is recorded
+	std::thread::id mainThread; //The only thread whose sections are recorded. The samples aren't protected by a lock, so other threads would trample them
+
+	//--- Utility Functions ---//
+	const ProfileFrame* getFrame(unsigned int age) const; //Get a finished frame. Age 0 is the most recent one. nullptr if there aren't that many frames
+
+	//--- Singleton Instance ---//
+	static Profiler* inst; //The singleton instance. Ie: The only instance of this class that can ever exist
+};
+
+#define PROFILER Profiler::getInstance() //Macro to make using the profiler easier. Automatically gets the singleton instance
+
+
+
+/*
+	Profile Scope
+	- Times from when it is created to when it goes out of scope. Don't use this directly, use PROFILE_SCOPE()
+*/
+class ProfileScope
+{
+public:
+	ProfileScope(const char* name) { sample = PROFILER->beginSample(name); }
+	~ProfileScope() { PROFILER->endSample(sample); }
+
+private:
+	unsigned int sample; //The sample being timed
+};
+
+
+
+//--- Macros ---//
+//These are what you should actually put in your code. They disappear completely when DEMO_PROFILING is 0
+#if DEMO_PROFILING
+#define PROFILE_JOIN_INNER(a, b) a##b
+#define PROFILE_JOIN(a, b) PROFILE_JOIN_INNER(a, b)
+#define PROFILE_SCOPE(name) ProfileScope PROFILE_JOIN(profileScope_, __LINE__)(name) //Time from this line to the end of the block
+#define PROFILE_FRAME_END() PROFILER->endFrame() //Finish the frame. Only needed if the director isn't running (ex: the headless runner)
+#else
+#define PROFILE_SCOPE(name) ((void)0)
+#define PROFILE_FRAME_END() ((void)0)
+#endif
+
+#endif
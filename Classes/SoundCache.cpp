@@ -0,0 +1,437 @@
+#include "SoundCache.h"
+#include "MappedFile.h"
+
+//Core Libraries
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+
+//3rd Party Libraries
+#include "cocos2d.h"
+#include "AudioEngine.h"
+
+//Namespaces
+using namespace cocos2d;
+using cocos2d::experimental::AudioEngine;
+
+//The audio engine turns every sound into 16 bit samples when it decodes it, no matter what it was stored as
+static const size_t BYTES_PER_SAMPLE = 2;
+
+//How much of the start of an MP3 is searched for the first frame after the ID3 tag
+static const size_t MP3_SEARCH_BYTES = 4096;
+
+//The MP3 tables. Bitrates are in kilobits per second, indexed by the 4 bits in the frame header. Only layer III (the 'MP3' part) is needed
+static const unsigned int MP3_BITRATES_V1[16] = { 0, 32, 40, 48, 56, 64, 80, 96, 112, 128, 160, 192, 224, 256, 320, 0 };
+static const unsigned int MP3_BITRATES_V2[16] = { 0, 8, 16, 24, 32, 40, 48, 56, 64, 80, 96, 112, 128, 144, 160, 0 };
+static const unsigned int MP3_SAMPLE_RATES[3][3] = { { 44100, 48000, 32000 }, { 22050, 24000, 16000 }, { 11025, 12000, 8000 } }; //MPEG 1, 2 and 2.5
+
+//Read numbers stored in the file, one byte at a time so it works on any CPU
+static unsigned int readBigEndian32(const unsigned char* bytes) { return ((unsigned int)bytes[0] << 24) | ((unsigned int)bytes[1] << 16) | ((unsigned int)bytes[2] << 8) | (unsigned int)bytes[3]; }
+static unsigned int readLittleEndian32(const unsigned char* bytes) { return (unsigned int)bytes[0] | ((unsigned int)bytes[1] << 8) | ((unsigned int)bytes[2] << 16) | ((unsigned int)bytes[3] << 24); }
+static unsigned int readLittleEndian16(const unsigned char* bytes) { return (unsigned int)bytes[0] | ((unsigned int)bytes[1] << 8); }
+
+/*
+	Work out the length of an MP3 from the first frame header
+	If the first frame is a Xing / Info frame (which most encoders write), it has the exact number of frames in it. Otherwise the file is assumed to have the same bitrate all the way through
+*/
+static bool readMp3Info(MappedFile& file, unsigned int& sampleRateOut, unsigned int& channelsOut, double& framesOut)
+{
+	//Skip the ID3 tag at the start, if there is one. Its size is stored 7 bits per byte
+	uint64_t audioStart = 0;
+	const unsigned char* tag = file.map(0, 10);
+	if (tag && file.getSize() >= 10 && tag[0] == 'I' && tag[1] == 'D' && tag[2] == '3')
+	{
+		audioStart = 10 + (((uint64_t)(tag[6] & 0x7F) << 21) | ((uint64_t)(tag[7] & 0x7F) << 14) | ((uint64_t)(tag[8] & 0x7F) << 7) | (uint64_t)(tag[9] & 0x7F));
+		if (tag[5] & 0x10)
+			audioStart += 10; //There is a footer too
+	}
+	if (audioStart >= file.getSize())
+		return false;
+
+	//Find the first frame. Every frame starts with 11 bits all set
+	size_t searchLength = (size_t)std::min((uint64_t)MP3_SEARCH_BYTES, file.getSize() - audioStart);
+	const unsigned char* bytes = file.map(audioStart, searchLength);
+	if (!bytes)
+		return false;
+
+	for (size_t i = 0; i + 4 <= searchLength; i++)
+	{
+		if (bytes[i] != 0xFF || (bytes[i + 1] & 0xE0) != 0xE0)
+			continue;
+
+		//Pull the header apart. The version bits are 3 for MPEG 1, 2 for MPEG 2 and 0 for MPEG 2.5. The layer bits are 1 for layer III
+		unsigned int versionBits = (bytes[i + 1] >> 3) & 3;
+		unsigned int layerBits = (bytes[i + 1] >> 1) & 3;
+		unsigned int bitrateIndex = bytes[i + 2] >> 4;
+		unsigned int sampleRateIndex = (bytes[i + 2] >> 2) & 3;
+		if (versionBits == 1 || layerBits != 1 || bitrateIndex == 0 || bitrateIndex == 15 || sampleRateIndex == 3)
+			continue;
+
+		unsigned int version = (versionBits == 3) ? 0 : (versionBits == 2) ? 1 : 2;
+		bool mono = (bytes[i + 3] >> 6) == 3;
+		unsigned int bitrate = ((version == 0) ? MP3_BITRATES_V1[bitrateIndex] : MP3_BITRATES_V2[bitrateIndex]) * 1000;
+		unsigned int samplesPerFrame = (version == 0) ? 1152 : 576;
+		sampleRateOut = MP3_SAMPLE_RATES[version][sampleRateIndex];
+		channelsOut = mono ? 1 : 2;
+
+		//The Xing / Info header sits right after the 'side info', which is a different size for each version and channel count
+		size_t sideInfo = (version == 0) ? (mono ? 17 : 32) : (mono ? 9 : 17);
+		size_t xing = i + 4 + sideInfo;
+		if (xing + 12 <= searchLength && (memcmp(bytes + xing, "Xing", 4) == 0 || memcmp(bytes + xing, "Info", 4) == 0) && (readBigEndian32(bytes + xing + 4) & 1))
+		{
+			framesOut = (double)readBigEndian32(bytes + xing + 8) * (double)samplesPerFrame;
+			return true;
+		}
+
+		//No exact count, so work it out from the size of the file and the bitrate
+		double seconds = (double)(file.getSize() - audioStart - i) * 8.0 / (double)bitrate;
+		framesOut = seconds * (double)sampleRateOut;
+		return true;
+	}
+
+	return false;
+}
+
+//Work out the length of a WAV file from its 'fmt ' and 'data' chunks
+static bool readWavInfo(MappedFile& file, unsigned int& sampleRateOut, unsigned int& channelsOut, double& framesOut)
+{
+	const unsigned char* header = file.map(0, 12);
+	if (!header || file.getSize() < 12 || memcmp(header, "RIFF", 4) != 0 || memcmp(header + 8, "WAVE", 4) != 0)
+		return false;
+
+	//Walk the chunks until the data chunk. The format chunk always comes before it
+	unsigned int blockAlign = 0;
+	uint64_t offset = 12;
+	while (offset + 8 <= file.getSize())
+	{
+		const unsigned char* chunk = file.map(offset, 24);
+		if (!chunk)
+			return false;
+
+		unsigned int chunkSize = readLittleEndian32(chunk + 4);
+		if (memcmp(chunk, "fmt ", 4) == 0 && offset + 24 <= file.getSize())
+		{
+			channelsOut = readLittleEndian16(chunk + 10);
+			sampleRateOut = readLittleEndian32(chunk + 12);
+			blockAlign = readLittleEndian16(chunk + 20);
+		}
+		else if (memcmp(chunk, "data", 4) == 0)
+		{
+			if (blockAlign == 0)
+				return false;
+			framesOut = (double)chunkSize / (double)blockAlign;
+			return true;
+		}
+
+		//Chunks are padded out to an even size
+		offset += 8 + chunkSize + (chunkSize & 1);
+	}
+
+	return false;
+}
+
+
+
+//--- Static Variables ---//
+SoundCache* SoundCache::inst = nullptr;
+
+
+
+//--- Constructor ---//
+SoundCache::SoundCache()
+{
+	//Init the private data
+	budget = 16 * 1024 * 1024;
+	streamThreshold = 10.0f;
+	startTime = std::chrono::steady_clock::now();
+	stats = SoundCacheStats();
+}
+
+
+
+//--- Setters ---//
+void SoundCache::setMemoryBudget(size_t bytes)
+{
+	budget = bytes;
+}
+
+void SoundCache::setStreamThreshold(float seconds)
+{
+	streamThreshold = seconds;
+}
+
+
+
+//--- Getters ---//
+SoundId SoundCache::getId(const std::string& path)
+{
+	std::unordered_map<std::string, SoundId>::iterator existing = ids.find(path);
+	if (existing != ids.end())
+		return existing->second;
+
+	//First time seeing it. Nothing is read from the file until it is loaded
+	Sound sound;
+	sound.path = path;
+	sound.state = SoundState::Unloaded;
+	sound.bytes = 0;
+	sound.duration = 0.0f;
+	sound.infoRead = false;
+	sound.lastUsed = 0.0;
+	sounds.push_back(sound);
+
+	SoundId id = (SoundId)sounds.size() - 1;
+	ids[path] = id;
+	return id;
+}
+
+bool SoundCache::isValid(SoundId id) const
+{
+	return id < sounds.size();
+}
+
+const std::string& SoundCache::getPath(SoundId id) const
+{
+	static const std::string noPath;
+	return isValid(id) ? sounds[id].path : noPath;
+}
+
+SoundState SoundCache::getState(SoundId id) const
+{
+	return (id < sounds.size()) ? sounds[id].state : SoundState::Failed;
+}
+
+size_t SoundCache::getBytes(SoundId id) const
+{
+	return (id < sounds.size()) ? sounds[id].bytes : 0;
+}
+
+float SoundCache::getDuration(SoundId id) const
+{
+	return (id < sounds.size()) ? sounds[id].duration : 0.0f;
+}
+
+SoundCacheStats SoundCache::getStats() const
+{
+	SoundCacheStats current = stats;
+	current.sounds = (unsigned int)sounds.size();
+	current.budget = budget;
+	current.resident = 0;
+	current.streaming = 0;
+	for (unsigned int i = 0; i < sounds.size(); i++)
+	{
+		if (sounds[i].state == SoundState::Resident || sounds[i].state == SoundState::Loading)
+			current.resident++;
+		else if (sounds[i].state == SoundState::Streaming)
+			current.streaming++;
+	}
+
+	return current;
+}
+
+std::string SoundCache::getStatsText() const
+{
+	SoundCacheStats current = getStats();
+	std::ostringstream text;
+	text << "Sounds: " << current.resident << " in memory, " << current.streaming << " streaming | " << (current.bytesUsed / 1024) << "KB / " << (current.budget / 1024)
+		<< "KB (peak " << (current.peakBytesUsed / 1024) << "KB) | Hits: " << current.hits << " | Misses: " << current.misses << " | Evicted: " << current.evictions;
+	return text.str();
+}
+
+
+
+//--- Methods ---//
+void SoundCache::load(SoundId id, const std::function<void(bool)>& onLoaded)
+{
+	//There is nothing to load for an id that was never handed out (ex: INVALID_SOUND_ID)
+	if (!isValid(id))
+	{
+		if (onLoaded)
+			onLoaded(false);
+		return;
+	}
+
+	Sound& sound = sounds[id];
+
+	//Already done (or already going)
+	if (sound.state == SoundState::Loading)
+	{
+		if (onLoaded)
+			sound.waiting.push_back(onLoaded);
+		return;
+	}
+	if (sound.state != SoundState::Unloaded)
+	{
+		if (onLoaded)
+			onLoaded(sound.state != SoundState::Failed);
+		return;
+	}
+
+	//Find out how big it is before deciding anything. This only reads the first few KB of the file
+	if (!sound.infoRead)
+		readInfo(sound);
+
+	//Long sounds, and ones that won't fit even after throwing everything else out, are streamed. The audio engine decodes them as they play
+	if (sound.duration > streamThreshold || !makeRoom(id, sound.bytes))
+	{
+		sound.state = SoundState::Streaming;
+		if (onLoaded)
+			onLoaded(true);
+		return;
+	}
+
+	//Hand it to the audio engine to decode. The memory is counted now so two loads in a row don't both think they fit
+	sound.state = SoundState::Loading;
+	if (onLoaded)
+		sound.waiting.push_back(onLoaded);
+	stats.bytesUsed += sound.bytes;
+	stats.peakBytesUsed = std::max(stats.peakBytesUsed, stats.bytesUsed);
+	stats.loads++;
+
+	//Some platforms call back from the audio engine's own threads, so the result is passed back to the main thread before anything is touched
+	AudioEngine::preload(sound.path, [this, id](bool success)
+	{
+		Director::getInstance()->getScheduler()->performFunctionInCocosThread([this, id, success]() { finishLoading(id, success); });
+	});
+}
+
+bool SoundCache::acquire(SoundId id)
+{
+	if (!isValid(id))
+		return false;
+
+	Sound& sound = sounds[id];
+	if (sound.state == SoundState::Resident || sound.state == SoundState::Streaming)
+	{
+		sound.lastUsed = now();
+		stats.hits++;
+		return true;
+	}
+
+	//Not ready. Start loading it for next time, but don't wait for it
+	stats.misses++;
+	if (sound.state == SoundState::Unloaded)
+		load(id);
+	return false;
+}
+
+void SoundCache::unload(SoundId id)
+{
+	if (!isValid(id))
+		return;
+
+	Sound& sound = sounds[id];
+	if (sound.state == SoundState::Unloaded || sound.state == SoundState::Failed)
+		return;
+
+	//Sounds that are still loading can't be taken back from the audio engine. Their memory is let go of once they finish
+	if (sound.state == SoundState::Loading)
+		return;
+
+	if (sound.state == SoundState::Resident)
+		stats.bytesUsed -= sound.bytes;
+	AudioEngine::uncache(sound.path);
+	sound.state = SoundState::Unloaded;
+}
+
+void SoundCache::unloadAll()
+{
+	for (unsigned int i = 0; i < sounds.size(); i++)
+		unload(i);
+}
+
+void SoundCache::printStats() const
+{
+	//Output the counters to the console
+	std::cout << "Sound Cache -> " << getStatsText() << std::endl;
+}
+
+
+
+//--- Singleton Instance ---//
+SoundCache* SoundCache::getInstance()
+{
+	//Generate the singleton if it hasn't been created yet
+	if (!inst)
+		inst = new SoundCache();
+
+	//Return the singleton
+	return inst;
+}
+
+
+
+//--- Utility Functions ---//
+double SoundCache::now() const
+{
+	return std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+}
+
+void SoundCache::readInfo(Sound& sound)
+{
+	//If the file can't be read directly (ex: it is packed inside an Android APK), the size isn't known and it is counted as taking no memory
+	sound.infoRead = true;
+	MappedFile file;
+	if (!file.open(FileUtils::getInstance()->fullPathForFilename(sound.path)))
+		return;
+
+	unsigned int sampleRate = 0;
+	unsigned int channels = 0;
+	double frames = 0.0;
+	if (!readWavInfo(file, sampleRate, channels, frames) && !readMp3Info(file, sampleRate, channels, frames))
+		return;
+	if (sampleRate == 0)
+		return;
+
+	sound.duration = (float)(frames / (double)sampleRate);
+	sound.bytes = (size_t)frames * channels * BYTES_PER_SAMPLE;
+}
+
+bool SoundCache::makeRoom(SoundId id, size_t bytes)
+{
+	if (bytes > budget)
+		return false;
+
+	//Throw out the least recently used sound until it fits. There are only ever a handful of sounds, so a search each time is fine
+	//A sound used more recently than its own length might still be playing, and throwing it out would cut it off
+	double currentTime = now();
+	while (stats.bytesUsed + bytes > budget)
+	{
+		int oldest = -1;
+		for (unsigned int i = 0; i < sounds.size(); i++)
+		{
+			const Sound& sound = sounds[i];
+			if (i == id || sound.state != SoundState::Resident || sound.lastUsed + sound.duration > currentTime)
+				continue;
+			if (oldest < 0 || sound.lastUsed < sounds[oldest].lastUsed)
+				oldest = (int)i;
+		}
+
+		if (oldest < 0)
+			return false;
+
+		unload((SoundId)oldest);
+		stats.evictions++;
+	}
+
+	return true;
+}
+
+void SoundCache::finishLoading(SoundId id, bool success)
+{
+	Sound& sound = sounds[id];
+	if (success)
+		sound.state = SoundState::Resident;
+	else
+	{
+		std::cout << "ERROR: Could not load the sound '" << sound.path << "'" << std::endl;
+		sound.state = SoundState::Failed;
+		stats.bytesUsed -= sound.bytes;
+	}
+
+	//Let everyone waiting know. The list is swapped out first in case one of them loads something else
+	std::vector<std::function<void(bool)>> callbacks;
+	callbacks.swap(sound.waiting);
+	for (unsigned int i = 0; i < callbacks.size(); i++)
+		callbacks[i](success);
+}
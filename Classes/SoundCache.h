@@ -0,0 +1,189 @@
+/*
+============================================================
+	Sound Cache:
+		- Keeps track of which sounds have been decoded into raw samples (PCM) in memory, and how much memory that takes
+			> Short sounds are decoded once when they are loaded, so playing them never has to decode anything. That is what makes spawning lots of birds cheap
+			> Long sounds (music, etc) would take megabytes as PCM, so they are 'streamed' instead. They are decoded bit by bit while they play
+		- Every sound gets a 'sound id' the first time its path is seen. Everything else takes the id, so nothing has to compare or hash strings every time a sound plays
+		- There is a memory budget for the decoded sounds. Loading past it throws out the sound that was used the longest time ago (least recently used)
+			> If a sound still doesn't fit after that, it is streamed instead
+		- The size of each sound is read from the top of its file (MP3 and WAV) before it is loaded, so the budget is checked before anything is decoded
+
+	Usage:
+		- Get an id with getId(), then call load() with it. AssetPreloader does this for every sound it is given
+		- Call acquire() right before playing a sound. It returns false if the sound isn't ready, so the hot path never loads anything itself. VoiceManager does this for you
+		- Use getStats() or getStatsText() to see how much memory the sounds are using
+
+	Note:
+		- The decoding itself is done by Cocos2D's AudioEngine on its own threads. Its preload() keeps short sounds as PCM and this class decides which ones it gets to keep
+		- A sound that was used more recently than its own length might still be playing, so it is never thrown out
+		- This class uses the Singleton design pattern
+			> There is a macro "SOUNDS->" that provides a shortcut for getting the singleton instance
+============================================================
+*/
+
+#ifndef SOUNDCACHE_H
+#define SOUNDCACHE_H
+
+//Core Libraries
+#include <chrono>
+#include <functional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+//The id of a sound. The ids count up from 0 in the order the paths are first seen
+typedef unsigned int SoundId;
+#define INVALID_SOUND_ID 0xFFFFFFFF
+
+/*
+	Sound State Enum
+	- Where a sound is at
+
+	> Unloaded -> Not loaded yet, or thrown out to make room
+	> Loading -> The audio engine is decoding it
+	> Resident -> Decoded and in memory. Plays with no decoding at all
+	> Streaming -> Too long or too big for the budget. Decoded while it plays
+	> Failed -> The file couldn't be read or decoded
+*/
+enum class SoundState
+{
+	Unloaded,
+	Loading,
+	Resident,
+	Streaming,
+	Failed
+};
+
+/*
+	Sound Cache Stats Struct
+	- Counters for the sound cache. The hits, misses, loads and evictions add up from the start
+*/
+struct SoundCacheStats
+{
+	unsigned int sounds; //How many sounds have ids
+	unsigned int resident; //How many sounds are decoded in memory (or being decoded)
+	unsigned int streaming; //How many sounds are set to stream
+	size_t bytesUsed; //How much memory the decoded sounds take, in bytes
+	size_t peakBytesUsed; //The most memory the decoded sounds ever took at once
+	size_t budget; //The memory budget, in bytes
+	unsigned int hits; //How many times acquire() found the sound ready to play
+	unsigned int misses; //How many times acquire() found the sound wasn't ready
+	unsigned int loads; //How many times a sound was decoded into memory
+	unsigned int evictions; //How many times a sound was thrown out to make room
+};
+
+
+
+/*
+	Sound Cache Class:
+	> Setters
+		- Set the memory budget
+		- Set how long a sound can be before it is streamed
+	> Getters
+		- Get the id for a path and the path for an id
+		- Get the state, size and length of a sound
+		- Get the counters
+	> Methods
+		- Load and unload sounds
+		- Get a sound ready to play
+		- Print the counters
+*/
+class SoundCache
+{
+protected:
+	//--- Constructor ---//
+	SoundCache(); //The constructor is protected so only one instance of this class can ever exist. This is called the singleton pattern.
+
+public:
+	//--- Setters ---//
+	void setMemoryBudget(size_t bytes); //Set how much memory the decoded sounds can take. Default is 16MB. Lowering it doesn't throw anything out until the next load
+	void setStreamThreshold(float seconds); //Set how long a sound can be before it is streamed instead of decoded up front. Default is 10 seconds
+
+
+
+	//--- Getters ---//
+	/*
+		Get the id for a sound, giving it a new one if the path hasn't been seen before. This is the only place the path is looked up, so keep the id around
+
+		@param Path -> The path of the sound, starting in the Resources folder. Ex: "Demo/Sounds/sound_SpawnObject.mp3"
+		@return Returns -> The id of the sound
+	*/
+	SoundId getId(const std::string& path);
+
+	bool isValid(SoundId id) const; //Get if an id was handed out by getId(). INVALID_SOUND_ID never is
+	const std::string& getPath(SoundId id) const; //Get the path of a sound. The same string every time, so it is never copied. Empty for an id that isn't valid
+	SoundState getState(SoundId id) const; //Get if a sound is loaded, streaming, etc
+	size_t getBytes(SoundId id) const; //Get how much memory a sound takes decoded, in bytes. 0 until load() has read its file
+	float getDuration(SoundId id) const; //Get how long a sound is, in seconds. 0 until load() has read its file
+	SoundCacheStats getStats() const; //Get the counters
+	std::string getStatsText() const; //Get the counters as a line of text. Used in the profiler overlay
+
+
+
+	//--- Methods ---//
+	/*
+		Start loading a sound. Short sounds are decoded into memory, throwing out old ones if the budget is full. Long ones are set to stream. Does nothing if it is already loaded or loading
+
+		@param Id -> The id from getId(). An id that isn't valid counts as a sound that couldn't be loaded
+		@param OnLoaded -> Called on the main thread once the sound is ready (true) or couldn't be loaded (false). Optional
+	*/
+	void load(SoundId id, const std::function<void(bool)>& onLoaded = nullptr);
+
+	/*
+		Get a sound ready to play. Call this right before playing it. It counts as a use for the least recently used list
+		If it isn't loaded, it is NOT loaded here. It starts loading in the background and false is returned so nothing is decoded while the game is playing
+
+		@param Id -> The id from getId()
+		@return Returns -> True if the sound can be played right now. Always false for an id that isn't valid
+	*/
+	bool acquire(SoundId id);
+
+	void unload(SoundId id); //Throw a sound out of memory. Any voices of it that are playing are stopped. Does nothing for an id that isn't valid
+	void unloadAll(); //Throw every sound out of memory
+	void printStats() const; //Output the counters to the console
+
+
+
+	//--- Singleton Instance ---//
+	/*
+		Get the instance of the singleton. You shouldn't ever need to call this directly since the macro (SOUNDS->) automatically calls it
+
+		@return Returns -> The singleton instance of this class. This is the ONLY instance of this class so intrefacing HAS to be done through this instance.
+	*/
+	static SoundCache* getInstance();
+
+private:
+	//--- Private Data ---//
+	//Everything known about a sound
+	struct Sound
+	{
+		std::string path; //The path it was given with
+		SoundState state; //Where it is at
+		size_t bytes; //How much memory it takes decoded. Counted in bytesUsed while it is loading or resident
+		float duration; //How long it is, in seconds
+		bool infoRead; //If the size and length have been read from the file yet
+		double lastUsed; //When it was last acquired, in seconds since the cache was made
+		std::vector<std::function<void(bool)>> waiting; //Everyone waiting for it to finish loading
+	};
+
+	std::vector<Sound> sounds; //Every sound, indexed by id
+	std::unordered_map<std::string, SoundId> ids; //The id for each path. Only used by getId()
+	size_t budget; //How much memory the decoded sounds can take
+	float streamThreshold; //How long a sound can be before it is streamed
+	std::chrono::steady_clock::time_point startTime; //When the cache was made. Used for the least recently used times
+	SoundCacheStats stats; //The counters
+
+	//--- Utility Functions ---//
+	double now() const; //Get the seconds since the cache was made
+	void readInfo(Sound& sound); //Read the size and length of a sound from the top of its file
+	bool makeRoom(SoundId id, size_t bytes); //Throw out the least recently used sounds until there is room. Returns false if there isn't enough that can be thrown out
+	void finishLoading(SoundId id, bool success); //Called on the main thread when the audio engine is done decoding a sound
+
+	//--- Singleton Instance ---//
+	static SoundCache* inst; //The singleton instance. Ie: The only instance of this class that can ever exist
+};
+
+#define SOUNDS SoundCache::getInstance() //Macro to make using the sound cache easier. Automatically gets the singleton instance
+
+#endif
@@ -0,0 +1,211 @@
+#include "SpriteAtlas.h"
+#include "DisplayHandler.h"
+
+//Core Libraries
+#include <cstring>
+#include <iostream>
+
+//--- Static Variables ---//
+SpriteAtlas* SpriteAtlas::inst = nullptr;
+
+
+
+//--- Constructor and Destructor ---//
+SpriteAtlas::SpriteAtlas()
+{
+	//Init the private data. Nothing is loaded until load() is called
+	textureSize = Size::ZERO;
+}
+
+SpriteAtlas::~SpriteAtlas()
+{
+	unload();
+}
+
+
+
+//--- Getters ---//
+bool SpriteAtlas::isLoaded() const
+{
+	return !texturePath.empty();
+}
+
+const std::string& SpriteAtlas::getTexturePath() const
+{
+	return texturePath;
+}
+
+unsigned int SpriteAtlas::getFrameCount() const
+{
+	return (unsigned int)frames.size();
+}
+
+AtlasFrameId SpriteAtlas::getFrameId(const std::string& path)
+{
+	std::unordered_map<std::string, AtlasFrameId>::iterator existing = ids.find(path);
+	if (existing != ids.end())
+		return existing->second;
+
+	//Not in the atlas, so it is loaded on its own. Its size isn't known until then
+	Frame frame;
+	frame.path = path;
+	frame.rect = Rect::ZERO;
+	frame.packed = false;
+	frame.spriteFrame = nullptr;
+	frames.push_back(frame);
+
+	AtlasFrameId id = (AtlasFrameId)frames.size() - 1;
+	ids[path] = id;
+	return id;
+}
+
+SpriteFrame* SpriteAtlas::getFrame(AtlasFrameId id)
+{
+	Frame& frame = frames[id];
+	if (frame.spriteFrame)
+		return frame.spriteFrame;
+
+	//There are no textures without a GPU
+	Texture2D* texture = loadTexture(frame);
+	if (!texture)
+		return nullptr;
+
+	//Make the frame the first time only. Retain it so it stays around even if the sprite frame cache is cleared
+	frame.spriteFrame = SpriteFrame::createWithTexture(texture, CC_RECT_PIXELS_TO_POINTS(frame.rect));
+	frame.spriteFrame->retain();
+	return frame.spriteFrame;
+}
+
+Texture2D* SpriteAtlas::getTexture(AtlasFrameId id)
+{
+	SpriteFrame* spriteFrame = getFrame(id);
+	return (spriteFrame) ? spriteFrame->getTexture() : nullptr;
+}
+
+Rect SpriteAtlas::getRect(AtlasFrameId id) const
+{
+	return frames[id].rect;
+}
+
+Size SpriteAtlas::getSize(AtlasFrameId id) const
+{
+	return frames[id].rect.size;
+}
+
+bool SpriteAtlas::isPacked(AtlasFrameId id) const
+{
+	return frames[id].packed;
+}
+
+
+
+//--- Methods ---//
+bool SpriteAtlas::load(const std::string& indexPath)
+{
+	unload();
+
+	//The index is tiny (a few hundred bytes), so it is just read in one go
+	Data data = FileUtils::getInstance()->getDataFromFile(indexPath);
+	if (data.isNull() || (size_t)data.getSize() < sizeof(SpriteAtlasHeader))
+	{
+		std::cout << "Sprite Atlas -> No atlas at '" << indexPath << "', loading every image on its own" << std::endl;
+		return false;
+	}
+
+	//Make sure it is actually an atlas index, and that it isn't cut off
+	const unsigned char* bytes = data.getBytes();
+	SpriteAtlasHeader header;
+	memcpy(&header, bytes, sizeof(header));
+	size_t entriesSize = header.frameCount * sizeof(SpriteAtlasEntry);
+	if (memcmp(header.magic, SPRITE_ATLAS_MAGIC, 4) != 0 || header.version != SPRITE_ATLAS_VERSION || (size_t)data.getSize() < sizeof(header) + entriesSize + header.namesSize)
+	{
+		std::cout << "ERROR: '" << indexPath << "' is not a sprite atlas index, or was built by a different version of the packer" << std::endl;
+		return false;
+	}
+
+	//Every name ends in a 0, so a name can't run off the end as long as the last byte is a 0
+	const char* names = (const char*)(bytes + sizeof(header) + entriesSize);
+	if (header.namesSize == 0 || names[header.namesSize - 1] != '\0')
+	{
+		std::cout << "ERROR: The names in '" << indexPath << "' are cut off" << std::endl;
+		return false;
+	}
+
+	//Give every frame in the atlas its id, in the order they are in the index
+	frames.reserve(header.frameCount);
+	for (unsigned int i = 0; i < header.frameCount; i++)
+	{
+		SpriteAtlasEntry entry;
+		memcpy(&entry, bytes + sizeof(header) + i * sizeof(SpriteAtlasEntry), sizeof(entry));
+		if (entry.nameOffset >= header.namesSize)
+			continue;
+
+		Frame frame;
+		frame.path = names + entry.nameOffset;
+		frame.rect = Rect((float)entry.x, (float)entry.y, (float)entry.width, (float)entry.height);
+		frame.packed = true;
+		frame.spriteFrame = nullptr;
+		frames.push_back(frame);
+		ids[frame.path] = (AtlasFrameId)frames.size() - 1;
+	}
+
+	//The texture is the .png with the same name as the index
+	texturePath = indexPath.substr(0, indexPath.find_last_of('.')) + ".png";
+	textureSize = Size((float)header.width, (float)header.height);
+	std::cout << "Sprite Atlas -> " << frames.size() << " frames in a " << header.width << "x" << header.height << " atlas" << std::endl;
+	return true;
+}
+
+Sprite* SpriteAtlas::createSprite(AtlasFrameId id)
+{
+	//Use the frame directly so there is no search through the sprite frame cache by name
+	SpriteFrame* spriteFrame = getFrame(id);
+	return (spriteFrame) ? Sprite::createWithSpriteFrame(spriteFrame) : nullptr;
+}
+
+void SpriteAtlas::unload()
+{
+	//Let go of the frames. Cocos2D deletes them once nothing else is using them
+	for (unsigned int i = 0; i < frames.size(); i++)
+		CC_SAFE_RELEASE_NULL(frames[i].spriteFrame);
+
+	frames.clear();
+	ids.clear();
+	texturePath.clear();
+	textureSize = Size::ZERO;
+}
+
+
+
+//--- Singleton Instance ---//
+SpriteAtlas* SpriteAtlas::getInstance()
+{
+	//Generate the singleton if it hasn't been created yet
+	if (!inst)
+		inst = new SpriteAtlas();
+
+	//Return the singleton
+	return inst;
+}
+
+
+
+//--- Utility Functions ---//
+Texture2D* SpriteAtlas::loadTexture(Frame& frame)
+{
+	if (DISPLAY->isHeadless())
+		return nullptr;
+
+	//The preloader should have already put the texture in the cache, so this normally just finds it
+	Texture2D* texture = Director::getInstance()->getTextureCache()->addImage(frame.packed ? texturePath : frame.path);
+	if (!texture)
+		return nullptr;
+
+	//Images loaded on their own use the whole texture
+	if (!frame.packed)
+		frame.rect = Rect(Vec2::ZERO, texture->getContentSizeInPixels());
+	else if (texture->getContentSizeInPixels().width != textureSize.width || texture->getContentSizeInPixels().height != textureSize.height)
+		std::cout << "WARNING: The atlas texture '" << texturePath << "' is a different size than its index says. Rebuild the atlas" << std::endl;
+
+	return texture;
+}
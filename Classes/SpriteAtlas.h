@@ -0,0 +1,190 @@
+/*
+============================================================
+	Sprite Atlas:
+		- Loads the sprite atlas built by the AtlasPacker tool (see proj.atlas/main.cpp) and hands out its frames
+			> The birds and particles used to each have their own texture. A renderer can only batch draws that use the same texture, so every switch from a yellow bird to a blue one to a snowflake started a new draw call
+			> The packer copies every one of those images into a single texture at build time. Every sprite made from a frame of it uses the same texture, so they can all be drawn together
+		- Every frame gets a 'frame id' the first time its image path is looked up. Everything else takes the id, so nothing has to search by name while playing
+		- If the atlas wasn't built (ex: the Visual Studio project, which doesn't run the packer), an image that was asked for is loaded on its own instead
+			> Everything still works exactly the same, it just isn't batched
+
+	File Format:
+		- The atlas is two files with the same name: a .png with every image in it, and a .frames file saying where each image is
+		- All values are little-endian. Every platform this project targets is little-endian so the structs are read directly
+		- One SpriteAtlasHeader, then one SpriteAtlasEntry per frame, then every frame's image path one after the other, each ending in a 0
+
+	Usage:
+		- Call load() once at startup with the path of the .frames file, then add getTexturePath() to the preloader
+		- Get an id for each image with getFrameId(), using the same path you would have given Sprite::create(). Keep the id around
+		- Make sprites with createSprite(), or get the frame, texture and rect for your own drawing
+
+	Note:
+		- This class uses the Singleton design pattern
+			> There is a macro "SPRITE_ATLAS->" that provides a shortcut for getting the singleton instance
+		- The index can be read when the display is headless, so the sizes of the frames are known even though there are no textures
+============================================================
+*/
+
+#ifndef SPRITEATLAS_H
+#define SPRITEATLAS_H
+
+//Core Libraries
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <stdint.h>
+
+//3rd Party Libraries
+#include "cocos2d.h"
+
+//Namespaces
+using namespace cocos2d;
+
+//File format constants
+#define SPRITE_ATLAS_MAGIC "CDSA" //The first 4 bytes of every atlas index. Stands for Cocos Demo Sprite Atlas
+#define SPRITE_ATLAS_VERSION 1 //Bump this whenever the layout of the header or the entries changes
+
+//The id of a frame. The ids count up from 0, the frames in the atlas first and then any images loaded on their own
+typedef unsigned int AtlasFrameId;
+#define INVALID_FRAME_ID 0xFFFFFFFF
+
+/*
+	Sprite Atlas Header
+	- The first 16 bytes of an atlas index
+
+	> Magic -> Always SPRITE_ATLAS_MAGIC. Used to make sure the file is actually an atlas index
+	> Version -> The version of the format the file was written with
+	> FrameCount -> How many entries come after the header
+	> Width, Height -> The size of the atlas texture in pixels
+	> NamesSize -> How many bytes of image paths come after the entries
+*/
+struct SpriteAtlasHeader
+{
+	char magic[4];
+	uint16_t version;
+	uint16_t frameCount;
+	uint16_t width;
+	uint16_t height;
+	uint32_t namesSize;
+};
+
+/*
+	Sprite Atlas Entry
+	- Where one image is in the atlas. 12 bytes each
+
+	> X, Y -> The top left corner of the image in the atlas, in pixels. Y goes down, the same as the image itself
+	> Width, Height -> The size of the image in pixels. The images are never trimmed or rotated, so this is the size of the original image
+	> NameOffset -> Where the image's path starts in the names after the entries
+*/
+struct SpriteAtlasEntry
+{
+	uint16_t x;
+	uint16_t y;
+	uint16_t width;
+	uint16_t height;
+	uint32_t nameOffset;
+};
+
+static_assert(sizeof(SpriteAtlasHeader) == 16, "The sprite atlas header must be exactly 16 bytes!");
+static_assert(sizeof(SpriteAtlasEntry) == 12, "A sprite atlas entry must be exactly 12 bytes!");
+
+
+
+/*
+	Sprite Atlas Class:
+	> Getters
+		- Get if the atlas was loaded and the path of its texture
+		- Get the id of an image
+		- Get the frame, texture, rect and size of an id
+	> Methods
+		- Load the atlas
+		- Make a sprite from a frame
+*/
+class SpriteAtlas
+{
+protected:
+	//--- Constructor ---//
+	SpriteAtlas(); //The constructor is protected so only one instance of this class can ever exist. This is called the singleton pattern.
+
+public:
+	//--- Destructor ---//
+	~SpriteAtlas();
+
+
+
+	//--- Getters ---//
+	bool isLoaded() const; //Get if an atlas was loaded. False means every image is loaded on its own
+	const std::string& getTexturePath() const; //Get the path of the atlas texture. Empty if no atlas was loaded
+	unsigned int getFrameCount() const; //Get how many frames have ids, counting images loaded on their own
+
+	/*
+		Get the id for an image. If the image isn't in the atlas, it is given an id of its own and loaded by itself the first time its frame is needed
+
+		@param Path -> The path of the image, starting in the Resources folder. Ex: "Demo/Birds/spr_BirdRed.png"
+		@return Returns -> The id of the frame
+	*/
+	AtlasFrameId getFrameId(const std::string& path);
+
+	SpriteFrame* getFrame(AtlasFrameId id); //Get the frame for an id. nullptr if the display is headless since there are no textures without a GPU
+	Texture2D* getTexture(AtlasFrameId id); //Get the texture a frame is in. Every frame in the atlas shares the same one. nullptr if the display is headless
+	Rect getRect(AtlasFrameId id) const; //Get where a frame is in its texture, in pixels
+	Size getSize(AtlasFrameId id) const; //Get the size of a frame's image, in pixels. Known even when the display is headless, as long as it is in the atlas
+	bool isPacked(AtlasFrameId id) const; //Get if a frame is in the atlas, rather than loaded on its own
+
+
+
+	//--- Methods ---//
+	/*
+		Read an atlas index. Nothing is drawn from it until a frame is asked for, so this is fine to call before the texture is preloaded
+
+		@param IndexPath -> The path of the .frames file, starting in the Resources folder. The texture is the .png next to it with the same name
+		@return Returns -> True if the atlas was read. False if the file is missing or isn't an atlas index, in which case every image is loaded on its own
+	*/
+	bool load(const std::string& indexPath);
+
+	/*
+		Make a sprite showing a frame
+
+		@param Id -> The id from getFrameId()
+		@return Returns -> The sprite, autoreleased like any other. nullptr if the display is headless
+	*/
+	Sprite* createSprite(AtlasFrameId id);
+
+	void unload(); //Let go of the atlas and every frame. The ids that were handed out are no longer valid
+
+
+
+	//--- Singleton Instance ---//
+	/*
+		Get the instance of the singleton. You shouldn't ever need to call this directly since the macro (SPRITE_ATLAS->) automatically calls it
+
+		@return Returns -> The singleton instance of this class. This is the ONLY instance of this class so intrefacing HAS to be done through this instance.
+	*/
+	static SpriteAtlas* getInstance();
+
+private:
+	//--- Private Data ---//
+	//Everything known about a frame
+	struct Frame
+	{
+		std::string path; //The path of the original image
+		Rect rect; //Where it is in its texture, in pixels. The whole texture for images loaded on their own, once they are loaded
+		bool packed; //If it is in the atlas
+		SpriteFrame* spriteFrame; //Made the first time it is asked for. Held on to until unload()
+	};
+
+	std::vector<Frame> frames; //Every frame, indexed by id
+	std::unordered_map<std::string, AtlasFrameId> ids; //The id for each path. Only used by getFrameId()
+	std::string texturePath; //The path of the atlas texture
+	Size textureSize; //The size of the atlas texture, from the index
+
+	//--- Utility Functions ---//
+	Texture2D* loadTexture(Frame& frame); //Get the texture for a frame from the texture cache, loading it if it isn't there. Fills in the rect of frames loaded on their own
+
+	//--- Singleton Instance ---//
+	static SpriteAtlas* inst; //The singleton instance. Ie: The only instance of this class that can ever exist
+};
+
+#define SPRITE_ATLAS SpriteAtlas::getInstance() //Macro to make using the sprite atlas easier. Automatically gets the singleton instance
+
+#endif
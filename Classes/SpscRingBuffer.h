@@ -0,0 +1,127 @@
+/*
+============================================================
+	SPSC Ring Buffer:
+		- A fixed size queue for passing values from ONE thread to ONE other thread without any locks
+			> SPSC stands for Single Producer, Single Consumer
+			> One thread (the producer) only ever calls push()
+			> One thread (the consumer) only ever calls peek(), pop() and empty()
+		- The producer and consumer can also be the same thread. Ex: the input handler pushes events from Cocos2D's callbacks and drains them at the start of the frame
+		- Nothing is ever allocated after the buffer is created. If the buffer is full, push() fails instead of growing
+
+	Note:
+		- The capacity MUST be a power of two so the indices can wrap with a bit mask instead of a divide
+		- The head and tail are kept on separate cache lines so the two threads aren't fighting over the same line every time one of them moves
+============================================================
+*/
+
+#ifndef SPSCRINGBUFFER_H
+#define SPSCRINGBUFFER_H
+
+//Core Libraries
+#include <atomic>
+#include <cstddef>
+
+/*
+	SPSC Ring Buffer Class:
+	> Producer
+		- Push a value
+	> Consumer
+		- Peek at the oldest value
+		- Pop the oldest value
+		- Check if the buffer is empty
+	> Getters
+		- Get the capacity
+*/
+template <typename T, size_t Capacity>
+class SpscRingBuffer
+{
+	static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "The capacity of a ring buffer must be a power of two!");
+
+public:
+	//--- Constructor ---//
+	SpscRingBuffer()
+		: head(0), tail(0)
+	{
+	}
+
+
+
+	//--- Producer ---//
+	/*
+		Add a value to the back of the queue. Only call this from the producer thread
+
+		@param Value -> The value to copy into the queue
+		@return Returns -> True if the value was added. False if the queue was full and the value was thrown away
+	*/
+	bool push(const T& value)
+	{
+		//Only the producer writes the tail, so a relaxed load is enough. The head has to be acquired so we see the consumer has finished with the slot
+		size_t currentTail = tail.load(std::memory_order_relaxed);
+		if (currentTail - head.load(std::memory_order_acquire) >= Capacity)
+			return false;
+
+		//Copy the value in, then release the new tail so the consumer sees the value before it sees the tail move
+		slots[currentTail & (Capacity - 1)] = value;
+		tail.store(currentTail + 1, std::memory_order_release);
+		return true;
+	}
+
+
+
+	//--- Consumer ---//
+	/*
+		Get the oldest value in the queue without removing it. Only call this from the consumer thread
+
+		@return Returns -> A pointer to the oldest value. nullptr if the queue is empty. The pointer is only valid until pop() is called
+	*/
+	const T* peek() const
+	{
+		size_t currentHead = head.load(std::memory_order_relaxed);
+		if (currentHead == tail.load(std::memory_order_acquire))
+			return nullptr;
+
+		return &slots[currentHead & (Capacity - 1)];
+	}
+
+	/*
+		Remove the oldest value from the queue. Only call this from the consumer thread
+
+		@param Value -> Where to copy the oldest value
+		@return Returns -> True if a value was removed. False if the queue was empty
+	*/
+	bool pop(T& value)
+	{
+		size_t currentHead = head.load(std::memory_order_relaxed);
+		if (currentHead == tail.load(std::memory_order_acquire))
+			return false;
+
+		//Copy the value out, then release the new head so the producer knows the slot can be reused
+		value = slots[currentHead & (Capacity - 1)];
+		head.store(currentHead + 1, std::memory_order_release);
+		return true;
+	}
+
+	bool empty() const //Check if there is nothing in the queue. Only accurate from the consumer thread
+	{
+		return head.load(std::memory_order_relaxed) == tail.load(std::memory_order_acquire);
+	}
+
+
+
+	//--- Getters ---//
+	static size_t getCapacity() //Get the maximum number of values the queue can hold at once
+	{
+		return Capacity;
+	}
+
+private:
+	//--- Private Data ---//
+	//The padding keeps the head and tail 64 bytes (one cache line) apart. Padding is used instead of alignas() since C++11's new doesn't respect alignment that large
+	std::atomic<size_t> head; //The index of the oldest value. Only written by the consumer
+	char headPadding[64 - sizeof(std::atomic<size_t>)];
+	std::atomic<size_t> tail; //The index one past the newest value. Only written by the producer
+	char tailPadding[64 - sizeof(std::atomic<size_t>)];
+	T slots[Capacity]; //The values. The indices wrap around using the capacity as a mask
+};
+
+#endif
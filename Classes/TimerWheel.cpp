@@ -0,0 +1,262 @@
+#include "TimerWheel.h"
+
+//Core Libraries
+#include <cmath>
+
+//The size of each level. The first level has a slot for every tick, each level above it has fewer slots that each cover a whole trip around the level below
+static const unsigned int FIRST_LEVEL_BITS = 8;
+static const unsigned int UPPER_LEVEL_BITS = 6;
+static const unsigned int NUM_LEVELS = 4;
+static const unsigned int FIRST_LEVEL_SLOTS = 1 << FIRST_LEVEL_BITS;
+static const unsigned int UPPER_LEVEL_SLOTS = 1 << UPPER_LEVEL_BITS;
+
+//How far ahead a timer can be sorted. Anything further than this is put in the top level as if it was due at the very end of it, and sorted again when it comes back around
+static const unsigned long long MAX_SORT_TICKS = (1ULL << (FIRST_LEVEL_BITS + UPPER_LEVEL_BITS * (NUM_LEVELS - 1))) - 1;
+
+//Where a level's slots start in the list of slot heads
+static unsigned int levelOffset(unsigned int level)
+{
+	return (level == 0) ? 0 : FIRST_LEVEL_SLOTS + UPPER_LEVEL_SLOTS * (level - 1);
+}
+
+//How many bits of the tick are below a level. Ex: Each slot in level 1 covers 2^8 ticks
+static unsigned int levelShift(unsigned int level)
+{
+	return (level == 0) ? 0 : FIRST_LEVEL_BITS + UPPER_LEVEL_BITS * (level - 1);
+}
+
+
+
+//--- Constructors and Destructors ---//
+TimerWheel::TimerWheel()
+{
+	//Init the private data. Every slot starts out empty
+	slotHeads.assign(levelOffset(NUM_LEVELS), -1);
+	firstUnused = -1;
+	count = 0;
+	currentTick = 0;
+	tickLength = 1.0f / 60.0f;
+	leftoverTime = 0.0f;
+}
+
+TimerWheel::~TimerWheel()
+{
+	timers.clear();
+	slotHeads.clear();
+	dueTimers.clear();
+}
+
+
+
+//--- Setters ---//
+void TimerWheel::setTickLength(float newTickLength)
+{
+	tickLength = newTickLength;
+}
+
+
+
+//--- Getters ---//
+unsigned int TimerWheel::getCount() const
+{
+	return count;
+}
+
+double TimerWheel::getCurrentTime() const
+{
+	return (double)currentTick * (double)tickLength;
+}
+
+
+
+//--- Methods ---//
+TimerId TimerWheel::schedule(float delay, const std::function<void()>& callback)
+{
+	//Reuse an old timer if there is one, otherwise add a new one to the list
+	int index = firstUnused;
+	if (index >= 0)
+		firstUnused = timers[index].next;
+	else
+	{
+		index = (int)timers.size();
+		timers.push_back(Timer());
+		timers[index].generation = 1;
+	}
+
+	//Work out which tick it is due on. The part of a tick that has already gone by counts towards the delay, so it is measured from right now rather than from the last tick
+	//It always waits at least one tick so it can't go off in the middle of the tick it was scheduled in
+	double ticks = ceil(((double)delay + (double)leftoverTime) / (double)tickLength);
+	Timer& timer = timers[index];
+	timer.dueTick = currentTick + ((ticks < 1.0) ? 1ULL : (unsigned long long)ticks);
+	timer.callback = callback;
+	insert(index);
+	count++;
+
+	//The id is the generation in the top half and the index in the bottom half
+	return ((TimerId)timer.generation << 32) | (TimerId)(unsigned int)index;
+}
+
+bool TimerWheel::cancel(TimerId id)
+{
+	//Make sure the id still points at the same timer. If the timer went off and was reused, the generation won't match anymore
+	unsigned int index = (unsigned int)(id & 0xFFFFFFFFULL);
+	unsigned int generation = (unsigned int)(id >> 32);
+	if (index >= timers.size() || timers[index].generation != generation || timers[index].slot < 0)
+		return false;
+
+	unlink((int)index);
+	freeTimer((int)index);
+	return true;
+}
+
+unsigned int TimerWheel::advance(float deltaTime)
+{
+	//Work out how many whole ticks have passed
+	leftoverTime += deltaTime;
+	unsigned int numTicks = (unsigned int)(leftoverTime / tickLength);
+	leftoverTime -= (float)numTicks * tickLength;
+	if (leftoverTime < 0.0f)
+		leftoverTime = 0.0f;
+
+	//Go through the ticks one at a time, collecting every timer that is due. Nothing is run yet
+	dueTimers.clear();
+	unsigned int ticksDone = 0;
+	for (; ticksDone < numTicks; ticksDone++)
+	{
+		//Once every timer has been collected, every slot is empty and the rest of the ticks can simply be counted
+		if (count == dueTimers.size())
+			break;
+
+		currentTick++;
+
+		//Every time the first level goes all the way around, the next slot of the level above is spread out into it. If that level went all the way around too, the one above it is done as well, etc
+		if ((currentTick & (FIRST_LEVEL_SLOTS - 1)) == 0)
+		{
+			for (unsigned int level = 1; level < NUM_LEVELS; level++)
+			{
+				cascade(level);
+				if (((currentTick >> levelShift(level)) & (UPPER_LEVEL_SLOTS - 1)) != 0)
+					break;
+			}
+		}
+
+		//Everything in this tick's slot is due. Take the whole slot at once
+		int& head = slotHeads[currentTick & (FIRST_LEVEL_SLOTS - 1)];
+		for (int index = head; index >= 0; index = timers[index].next)
+		{
+			timers[index].slot = -1;
+			dueTimers.push_back(index);
+		}
+		head = -1;
+	}
+
+	currentTick += numTicks - ticksDone;
+
+	//Now run every callback. The callback is moved out first so the timer can be reused straight away if the callback schedules another one
+	unsigned int numDue = (unsigned int)dueTimers.size();
+	for (unsigned int i = 0; i < numDue; i++)
+	{
+		int index = dueTimers[i];
+		std::function<void()> callback = std::move(timers[index].callback);
+		freeTimer(index);
+		if (callback)
+			callback();
+	}
+
+	return numDue;
+}
+
+void TimerWheel::clear()
+{
+	//Throw away every callback and put every timer back on the unused list
+	firstUnused = -1;
+	for (int i = (int)timers.size() - 1; i >= 0; i--)
+	{
+		if (timers[i].slot >= 0)
+		{
+			timers[i].callback = nullptr;
+			timers[i].slot = -1;
+			timers[i].generation++;
+			if (timers[i].generation == 0)
+				timers[i].generation = 1;
+		}
+		timers[i].next = firstUnused;
+		firstUnused = i;
+	}
+
+	slotHeads.assign(slotHeads.size(), -1);
+	count = 0;
+}
+
+
+
+//--- Utility Functions ---//
+void TimerWheel::insert(int index)
+{
+	Timer& timer = timers[index];
+	unsigned long long ticksLeft = (timer.dueTick > currentTick) ? timer.dueTick - currentTick : 0;
+
+	//Find the lowest level that reaches far enough ahead, then the slot in it that covers the due tick
+	int slot;
+	if (ticksLeft < FIRST_LEVEL_SLOTS)
+		slot = (int)(timer.dueTick & (FIRST_LEVEL_SLOTS - 1));
+	else
+	{
+		unsigned int level = 1;
+		while (level < NUM_LEVELS - 1 && ticksLeft >= (1ULL << (levelShift(level) + UPPER_LEVEL_BITS)))
+			level++;
+
+		unsigned long long sortTick = (ticksLeft > MAX_SORT_TICKS) ? currentTick + MAX_SORT_TICKS : timer.dueTick;
+		slot = (int)(levelOffset(level) + ((sortTick >> levelShift(level)) & (UPPER_LEVEL_SLOTS - 1)));
+	}
+
+	//Add it to the front of the slot
+	timer.slot = slot;
+	timer.previous = -1;
+	timer.next = slotHeads[slot];
+	if (timer.next >= 0)
+		timers[timer.next].previous = index;
+	slotHeads[slot] = index;
+}
+
+void TimerWheel::unlink(int index)
+{
+	Timer& timer = timers[index];
+	if (timer.previous >= 0)
+		timers[timer.previous].next = timer.next;
+	else
+		slotHeads[timer.slot] = timer.next;
+	if (timer.next >= 0)
+		timers[timer.next].previous = timer.previous;
+
+	timer.slot = -1;
+}
+
+void TimerWheel::cascade(unsigned int level)
+{
+	//Take the whole slot, then sort every timer in it again. They are all due sooner now, so they drop into a lower level
+	int& head = slotHeads[levelOffset(level) + ((currentTick >> levelShift(level)) & (UPPER_LEVEL_SLOTS - 1))];
+	int index = head;
+	head = -1;
+	while (index >= 0)
+	{
+		int next = timers[index].next;
+		insert(index);
+		index = next;
+	}
+}
+
+void TimerWheel::freeTimer(int index)
+{
+	//Bump the generation so any ids for the old timer stop working. 0 is skipped so an id is never 0
+	Timer& timer = timers[index];
+	timer.callback = nullptr;
+	timer.slot = -1;
+	timer.generation++;
+	if (timer.generation == 0)
+		timer.generation = 1;
+
+	timer.next = firstUnused;
+	firstUnused = index;
+	count--;
+}
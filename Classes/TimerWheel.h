@@ -0,0 +1,130 @@
+/*
+============================================================
+	Timer Wheel:
+		- Runs callbacks after a delay. Used for bird lifetimes instead of giving every bird its own DelayTime action
+			> With actions, every bird's delay is ticked every frame just to count it down. 5,000 birds means 5,000 actions updated every frame even though none of them are done
+			> The wheel only looks at the timers that are actually due, so a frame where nothing expires costs almost nothing no matter how many timers there are
+		- Time is counted in whole 'ticks' (1/60th of a second by default). Timers go off on the first tick at or after their delay is up
+		- The timers are sorted into 'slots' by when they are due, like the hands of a clock
+			> The first level has a slot for each of the next 256 ticks. A timer that is due in 10 ticks goes in the slot 10 ahead of the current one
+			> The levels above it each cover 64 times as much time with the same number of slots. Every time the level below goes all the way around, the next slot up is emptied and its timers are spread out into the level below
+			> Four levels covers over 12 days at 60 ticks a second. Anything longer is held in the top level and re-sorted until it is due
+		- Every timer that goes off during advance() is collected first and then the callbacks are run together, so the owner can batch up the work they do
+
+	Usage:
+		- Call advance() once a frame with the frame time
+		- Add timers with schedule(). Keep the id it returns if the timer might need to be cancelled
+		- Call clear() to throw away every timer without running them (ex: when restarting)
+
+	Note:
+		- Callbacks can schedule new timers. A timer scheduled from a callback never goes off in the same advance() it was scheduled in
+		- Timers are stored in a list that is reused, so scheduling doesn't allocate once the wheel has been warmed up (as long as the callback is small, like a lambda capturing a couple of pointers)
+============================================================
+*/
+
+#ifndef TIMERWHEEL_H
+#define TIMERWHEEL_H
+
+//Core Libraries
+#include <functional>
+#include <vector>
+
+//The id of a timer. 0 is never a valid id
+typedef unsigned long long TimerId;
+
+/*
+	Timer Wheel Class:
+	> Setters
+		- Set the length of a tick
+	> Getters
+		- Get the number of timers waiting
+		- Get the current time
+	> Methods
+		- Schedule a callback
+		- Cancel a timer
+		- Advance by a frame
+		- Remove every timer
+*/
+class TimerWheel
+{
+public:
+	//--- Constructors and Destructors ---//
+	TimerWheel();
+	~TimerWheel();
+
+
+
+	//--- Setters ---//
+	/*
+		Set how long a tick is. Timers are only accurate to one tick, and a frame with more ticks in it takes longer to advance. Only change this while the wheel is empty
+
+		@param TickLength -> The length of a tick, in seconds. Default is 1/60th of a second
+	*/
+	void setTickLength(float tickLength);
+
+
+
+	//--- Getters ---//
+	unsigned int getCount() const; //Get how many timers are waiting to go off
+	double getCurrentTime() const; //Get how much time the wheel has advanced through, in seconds. Only counts whole ticks
+
+
+
+	//--- Methods ---//
+	/*
+		Run a function once a delay is up
+
+		@param Delay -> How long to wait, in seconds. Rounded up to the next tick. Even 0 waits one tick
+		@param Callback -> The function to run
+		@return Returns -> The id of the timer. Give this to cancel() to stop it
+	*/
+	TimerId schedule(float delay, const std::function<void()>& callback);
+
+	/*
+		Stop a timer before it goes off
+
+		@param Id -> The id from schedule()
+		@return Returns -> True if the timer was stopped. False if it already went off, was already cancelled, or the id is bad
+	*/
+	bool cancel(TimerId id);
+
+	/*
+		Move time forward and run the callbacks of every timer that is now due
+
+		@param DeltaTime -> How much time has passed, in seconds
+		@return Returns -> How many timers went off
+	*/
+	unsigned int advance(float deltaTime);
+
+	void clear(); //Remove every timer without running them. The time keeps going from where it was
+
+private:
+	//--- Private Data ---//
+	//A single timer. The timers are kept in one list and linked together into the slots by their indices
+	struct Timer
+	{
+		unsigned long long dueTick; //The tick the timer goes off on
+		std::function<void()> callback; //What to run when it does
+		int previous; //The timer before this one in the same slot. -1 if it is the first
+		int next; //The timer after this one in the same slot (or the next unused timer). -1 if it is the last
+		int slot; //The slot the timer is in. -1 if the timer isn't in use
+		unsigned int generation; //Goes up every time the timer is reused, so old ids stop working
+	};
+
+	std::vector<Timer> timers; //Every timer, in use or not
+	std::vector<int> slotHeads; //The first timer in each slot. -1 if the slot is empty. The slots for every level are kept together, one level after the other
+	std::vector<int> dueTimers; //The timers that went off during the current advance(). Reused from frame to frame
+	int firstUnused; //The first timer that isn't being used. The unused timers are linked together with 'next'
+	unsigned int count; //How many timers are waiting
+	unsigned long long currentTick; //How many ticks have passed
+	float tickLength; //How long a tick is, in seconds
+	float leftoverTime; //Time that has passed that doesn't add up to a whole tick yet
+
+	//--- Utility Functions ---//
+	void insert(int index); //Put a timer in the slot for its due tick
+	void unlink(int index); //Take a timer out of its slot
+	void cascade(unsigned int level); //Empty the current slot of a level and spread its timers out into the levels below
+	void freeTimer(int index); //Give a timer back to the unused list
+};
+
+#endif
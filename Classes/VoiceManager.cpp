@@ -0,0 +1,306 @@
+#include "VoiceManager.h"
+#include "Profiler.h"
+
+//Core Libraries
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <sstream>
+
+//3rd Party Libraries
+#include "AudioEngine.h"
+
+//Namespaces
+using cocos2d::experimental::AudioEngine;
+
+//How much louder a merged play is for every doubling of the plays in it. Ex: 8 plays in one frame come out 75% louder than the loudest of them, up to full volume
+static const float COALESCE_BOOST = 0.25f;
+
+//--- Static Variables ---//
+VoiceManager* VoiceManager::inst = nullptr;
+
+
+
+//--- Constructor ---//
+VoiceManager::VoiceManager()
+{
+	//Init the private data
+	defaultMaxVoices = 4;
+	totalVoiceLimit = 16;
+	stealMode = VoiceSteal::Oldest;
+	currentTime = 0.0;
+	stats = VoiceStats();
+}
+
+
+
+//--- Setters ---//
+void VoiceManager::setMaxVoices(SoundId soundId, unsigned int maxVoices)
+{
+	Sound* sound = getSound(soundId);
+	if (!sound)
+		return;
+
+	sound->maxVoices = maxVoices;
+	sound->hasOwnCap = true;
+}
+
+void VoiceManager::setDefaultMaxVoices(unsigned int maxVoices)
+{
+	//Change every sound that hasn't been given its own cap too
+	defaultMaxVoices = maxVoices;
+	for (unsigned int i = 0; i < sounds.size(); i++)
+	{
+		if (!sounds[i].hasOwnCap)
+			sounds[i].maxVoices = maxVoices;
+	}
+}
+
+void VoiceManager::setTotalVoiceLimit(unsigned int maxVoices)
+{
+	totalVoiceLimit = maxVoices;
+}
+
+void VoiceManager::setStealMode(VoiceSteal mode)
+{
+	stealMode = mode;
+}
+
+
+
+//--- Getters ---//
+unsigned int VoiceManager::getVoiceCount() const
+{
+	return (unsigned int)voices.size();
+}
+
+unsigned int VoiceManager::getVoiceCount(SoundId sound) const
+{
+	return (sound < sounds.size()) ? sounds[sound].voiceCount : 0;
+}
+
+VoiceStats VoiceManager::getStats() const
+{
+	VoiceStats current = stats;
+	current.activeVoices = (unsigned int)voices.size();
+	return current;
+}
+
+std::string VoiceManager::getStatsText() const
+{
+	std::ostringstream text;
+	text << "Voices: " << voices.size() << " (peak " << stats.peakVoices << ") | Plays: " << stats.plays << "/" << stats.requests
+		<< " | Merged: " << stats.coalesced << " | Stolen: " << stats.stolen << " | Dropped: " << stats.dropped << " | Decoded: " << (int)stats.decodedSeconds << "s";
+	return text.str();
+}
+
+
+
+//--- Methods ---//
+void VoiceManager::play(SoundId soundId, float volume)
+{
+	stats.requests++;
+
+	//There is nothing to play for an id the sound cache never handed out
+	Sound* sound = getSound(soundId);
+	if (!sound)
+	{
+		stats.dropped++;
+		return;
+	}
+
+	//Just remember it for now. The first play of a sound in a frame puts it on the queue, the rest are merged into it
+	if (sound->queuedPlays == 0)
+	{
+		queuedSounds.push_back(soundId);
+		sound->queuedVolume = volume;
+	}
+	else
+	{
+		sound->queuedVolume = std::max(sound->queuedVolume, volume);
+		stats.coalesced++;
+	}
+	sound->queuedPlays++;
+}
+
+void VoiceManager::play(const std::string& path, float volume)
+{
+	play(SOUNDS->getId(path), volume);
+}
+
+void VoiceManager::update(float deltaTime)
+{
+	//Every voice that played through the frame decoded that much audio
+	currentTime += deltaTime;
+	stats.decodedSeconds += (double)voices.size() * (double)deltaTime;
+
+	removeFinishedVoices();
+	if (queuedSounds.empty())
+		return;
+
+	PROFILE_SCOPE("VoiceManager::update");
+
+	for (unsigned int i = 0; i < queuedSounds.size(); i++)
+	{
+		Sound& sound = sounds[queuedSounds[i]];
+
+		//Play the merged plays a bit louder than the loudest one, so a big burst still sounds bigger than a single bird
+		float volume = std::min(sound.queuedVolume * (1.0f + COALESCE_BOOST * log2f((float)sound.queuedPlays)), 1.0f);
+		sound.queuedPlays = 0;
+
+		//Never decode in the middle of a frame. If the sound isn't loaded, the cache starts loading it and this play is dropped
+		if (!SOUNDS->acquire(queuedSounds[i]))
+		{
+			stats.dropped++;
+			continue;
+		}
+
+		if (!makeRoom(queuedSounds[i], volume))
+		{
+			stats.dropped++;
+			continue;
+		}
+
+		//AudioEngine can still refuse if it is out of voices of its own (ex: something else is playing sounds without going through us)
+		int audioId = AudioEngine::play2d(SOUNDS->getPath(queuedSounds[i]), false, volume);
+		if (audioId == AudioEngine::INVALID_AUDIO_ID)
+		{
+			stats.dropped++;
+			continue;
+		}
+
+		Voice voice;
+		voice.audioId = audioId;
+		voice.sound = queuedSounds[i];
+		voice.volume = volume;
+		voice.startTime = currentTime;
+		voices.push_back(voice);
+		sound.voiceCount++;
+		stats.plays++;
+	}
+	queuedSounds.clear();
+
+	stats.peakVoices = std::max(stats.peakVoices, (unsigned int)voices.size());
+}
+
+void VoiceManager::stopAll()
+{
+	for (int i = (int)voices.size() - 1; i >= 0; i--)
+		stopVoice((unsigned int)i);
+
+	for (unsigned int i = 0; i < queuedSounds.size(); i++)
+		sounds[queuedSounds[i]].queuedPlays = 0;
+	queuedSounds.clear();
+}
+
+void VoiceManager::resetStats()
+{
+	stats = VoiceStats();
+	stats.peakVoices = (unsigned int)voices.size();
+}
+
+void VoiceManager::printStats() const
+{
+	//Output the counters to the console
+	std::cout << "Voice Manager -> " << getStatsText() << std::endl;
+}
+
+
+
+//--- Singleton Instance ---//
+VoiceManager* VoiceManager::getInstance()
+{
+	//Generate the singleton if it hasn't been created yet
+	if (!inst)
+		inst = new VoiceManager();
+
+	//Return the singleton
+	return inst;
+}
+
+
+
+//--- Utility Functions ---//
+VoiceManager::Sound* VoiceManager::getSound(SoundId soundId)
+{
+	//Only ids the sound cache knows about are added. Anything else (ex: INVALID_SOUND_ID) would grow the list by billions of entries
+	if (!SOUNDS->isValid(soundId))
+		return nullptr;
+
+	//First time seeing it, so it gets the default cap. The ids count up from 0, so there are never many gaps to fill
+	while (sounds.size() <= soundId)
+	{
+		Sound sound;
+		sound.maxVoices = defaultMaxVoices;
+		sound.hasOwnCap = false;
+		sound.voiceCount = 0;
+		sound.queuedPlays = 0;
+		sound.queuedVolume = 0.0f;
+		sounds.push_back(sound);
+	}
+
+	return &sounds[soundId];
+}
+
+void VoiceManager::removeFinishedVoices()
+{
+	//AudioEngine forgets a voice once it is done playing, so asking for its state gives back an error
+	unsigned int kept = 0;
+	for (unsigned int i = 0; i < voices.size(); i++)
+	{
+		if (AudioEngine::getState(voices[i].audioId) == AudioEngine::AudioState::ERROR)
+			sounds[voices[i].sound].voiceCount--;
+		else
+			voices[kept++] = voices[i];
+	}
+	voices.resize(kept);
+}
+
+bool VoiceManager::makeRoom(SoundId sound, float volume)
+{
+	if (sounds[sound].maxVoices == 0)
+		return false;
+
+	//Keep stealing until there is room under both caps. Normally this is only ever one voice, but the caps might have just been lowered
+	while (true)
+	{
+		//If the sound is at its own cap, one of its voices has to go. Otherwise, if everything is at the total cap, any voice can go
+		bool soundFull = sounds[sound].voiceCount >= sounds[sound].maxVoices;
+		bool totalFull = voices.size() >= totalVoiceLimit;
+		if (!soundFull && !totalFull)
+			return true;
+		if (stealMode == VoiceSteal::None || voices.empty())
+			return false;
+
+		//The voices are kept oldest first, so the first one that can go is the oldest. For the quietest, the oldest wins ties
+		int victim = -1;
+		for (unsigned int i = 0; i < voices.size(); i++)
+		{
+			if (soundFull && voices[i].sound != sound)
+				continue;
+
+			if (victim < 0)
+			{
+				victim = (int)i;
+				if (stealMode == VoiceSteal::Oldest)
+					break;
+			}
+			else if (voices[i].volume < voices[victim].volume)
+				victim = (int)i;
+		}
+
+		//Don't cut off a louder voice for a quieter one
+		if (victim < 0 || (stealMode == VoiceSteal::Quietest && volume < voices[victim].volume))
+			return false;
+
+		stopVoice((unsigned int)victim);
+		stats.stolen++;
+	}
+}
+
+void VoiceManager::stopVoice(unsigned int index)
+{
+	AudioEngine::stop(voices[index].audioId);
+	sounds[voices[index].sound].voiceCount--;
+	voices.erase(voices.begin() + index);
+}
@@ -0,0 +1,187 @@
+/*
+============================================================
+	Voice Manager:
+		- Sits between the game and Cocos2D's AudioEngine and decides which sounds actually get played. Each sound that is playing is called a 'voice'
+			> Every voice decodes its own copy of the MP3 while it plays. Holding the mouse down during a burst used to start dozens of the same sound on top of each other
+			> Past a handful of copies, more voices of the same sound don't sound any different. They just cost more decoding and get clipped when they are mixed together
+		- Each sound has a cap on how many voices of it can play at once, and there is a cap on the total as well
+			> When a cap is hit, an old voice is 'stolen' (stopped) to make room for the new one. Either the oldest one, or the quietest one
+		- Plays are queued up and only started in update(). Every play of the same sound in the same frame is merged into one, slightly louder play
+			> 50 birds spawned in one frame would otherwise start 50 voices at the exact same moment, which just sounds like one loud one anyway
+		- Keeps counters of how many plays were asked for, started, merged, stolen and dropped, and how much audio has been decoded
+		- Sounds are played by their id from the sound cache (SoundCache.h). A sound that isn't loaded yet is dropped rather than decoded in the middle of a frame
+
+	Usage:
+		- Get an id for the sound with SOUNDS->getId() once, then call play() with it instead of AudioEngine::play2d()
+		- Call update() once a frame. This is where the voices are actually started
+		- Use setMaxVoices() to change the cap for a sound. Sounds without their own cap use the default (4)
+
+	Note:
+		- This class uses the Singleton design pattern
+			> There is a macro "VOICES->" that provides a shortcut for getting the singleton instance
+		- Voices started with AudioEngine directly aren't counted or capped
+============================================================
+*/
+
+#ifndef VOICEMANAGER_H
+#define VOICEMANAGER_H
+
+//Core Libraries
+#include <string>
+#include <vector>
+
+//Wrapper Classes
+#include "SoundCache.h"
+
+/*
+	Voice Steal Enum
+	- Which voice is stopped to make room when a cap is hit
+
+	> Oldest -> The voice that has been playing the longest. It is the closest to being done anyway
+	> Quietest -> The voice with the lowest volume. If the new play is quieter than all of them, the new play is dropped instead
+	> None -> Nothing is stolen. The new play is dropped
+*/
+enum class VoiceSteal
+{
+	Oldest,
+	Quietest,
+	None
+};
+
+/*
+	Voice Stats Struct
+	- Counters for the voice manager. Everything but the voice counts adds up from the start, or since resetStats() was called
+*/
+struct VoiceStats
+{
+	unsigned int activeVoices; //How many voices are playing right now
+	unsigned int peakVoices; //The most voices that were ever playing at once
+	unsigned int requests; //How many times play() was called
+	unsigned int plays; //How many voices were actually started
+	unsigned int coalesced; //How many plays were merged into another play of the same sound in the same frame
+	unsigned int stolen; //How many voices were stopped early to make room
+	unsigned int dropped; //How many plays were thrown away because there was no room and nothing could be stolen, the sound wasn't loaded yet, or the id wasn't a real sound
+	double decodedSeconds; //How many seconds of audio have been decoded. Every voice decodes a second of audio every second it plays
+};
+
+
+
+/*
+	Voice Manager Class:
+	> Setters
+		- Set the voice cap for a sound, the default cap and the total cap
+		- Set how voices are stolen
+	> Getters
+		- Get the number of voices playing
+		- Get the counters
+	> Methods
+		- Queue a sound to play
+		- Start the queued sounds
+		- Stop every voice
+		- Reset and print the counters
+*/
+class VoiceManager
+{
+protected:
+	//--- Constructor ---//
+	VoiceManager(); //The constructor is protected so only one instance of this class can ever exist. This is called the singleton pattern.
+
+public:
+	//--- Setters ---//
+	/*
+		Set how many voices of a sound can play at once
+
+		@param Sound -> The id of the sound from the sound cache
+		@param MaxVoices -> The cap. 0 means the sound is never played
+	*/
+	void setMaxVoices(SoundId sound, unsigned int maxVoices);
+
+	void setDefaultMaxVoices(unsigned int maxVoices); //Set the cap for sounds that haven't been given their own. Default is 4
+	void setTotalVoiceLimit(unsigned int maxVoices); //Set how many voices can play at once across every sound. Default is 16. Cocos2D's own limit is 32
+	void setStealMode(VoiceSteal mode); //Set which voice is stopped when a cap is hit. Default is Oldest
+
+
+
+	//--- Getters ---//
+	unsigned int getVoiceCount() const; //Get how many voices are playing
+	unsigned int getVoiceCount(SoundId sound) const; //Get how many voices of a sound are playing
+	VoiceStats getStats() const; //Get the counters
+	std::string getStatsText() const; //Get the counters as a line of text. Used in the profiler overlay
+
+
+
+	//--- Methods ---//
+	/*
+		Queue a sound to be played in the next update(). Plays of the same sound in the same frame are merged into one louder play
+
+		@param Sound -> The id of the sound from the sound cache
+		@param Volume -> How loud to play it, from 0 to 1. Defaulted to 1
+	*/
+	void play(SoundId sound, float volume = 1.0f);
+
+	void play(const std::string& path, float volume = 1.0f); //Same as above, but looks the id up from the path first. Fine for one-off sounds, use the id for anything played often
+
+	/*
+		Start every sound queued since the last update, stealing voices where the caps are hit. Also forgets the voices that have finished
+
+		@param DeltaTime -> How much time has passed, in seconds. Only used for the decoding counter
+	*/
+	void update(float deltaTime);
+
+	void stopAll(); //Stop every voice and throw away the queued plays
+	void resetStats(); //Set every counter back to 0. The voice counts are kept
+	void printStats() const; //Output the counters to the console
+
+
+
+	//--- Singleton Instance ---//
+	/*
+		Get the instance of the singleton. You shouldn't ever need to call this directly since the macro (VOICES->) automatically calls it
+
+		@return Returns -> The singleton instance of this class. This is the ONLY instance of this class so intrefacing HAS to be done through this instance.
+	*/
+	static VoiceManager* getInstance();
+
+private:
+	//--- Private Data ---//
+	//A sound that has been played at least once, or been given a cap
+	struct Sound
+	{
+		unsigned int maxVoices; //The cap for this sound
+		bool hasOwnCap; //False if it is using the default cap
+		unsigned int voiceCount; //How many voices of it are playing
+		unsigned int queuedPlays; //How many plays were asked for this frame
+		float queuedVolume; //The loudest of those plays
+	};
+
+	//A voice that is playing
+	struct Voice
+	{
+		int audioId; //The id AudioEngine gave it
+		SoundId sound; //The id of its sound
+		float volume; //How loud it was started
+		double startTime; //When it was started, in seconds since the manager was made
+	};
+
+	std::vector<Sound> sounds; //Every sound seen so far, indexed by its id
+	std::vector<Voice> voices; //Every voice playing, oldest first
+	std::vector<SoundId> queuedSounds; //The sounds with plays waiting for update(), in the order they were first asked for
+	unsigned int defaultMaxVoices; //The cap for sounds without their own
+	unsigned int totalVoiceLimit; //The cap across every sound
+	VoiceSteal stealMode; //Which voice is stopped when a cap is hit
+	double currentTime; //Seconds since the manager was made. Added up in update()
+	VoiceStats stats; //The counters
+
+	//--- Utility Functions ---//
+	Sound* getSound(SoundId sound); //Get a sound, adding it (and every id before it) if it hasn't been seen before. nullptr if the sound cache never handed the id out (ex: INVALID_SOUND_ID)
+	void removeFinishedVoices(); //Forget every voice AudioEngine has finished playing
+	bool makeRoom(SoundId sound, float volume); //Steal a voice if a cap would be passed by playing the sound. Returns false if the play should be dropped
+	void stopVoice(unsigned int index); //Stop a voice and take it off the list
+
+	//--- Singleton Instance ---//
+	static VoiceManager* inst; //The singleton instance. Ie: The only instance of this class that can ever exist
+};
+
+#define VOICES VoiceManager::getInstance() //Macro to make using the voice manager easier. Automatically gets the singleton instance
+
+#endif
@@ -0,0 +1,303 @@
+//Core Libraries
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+//3rd Party Libraries
+#include "cocos2d.h"
+
+//Wrapper Classes
+#include "SpriteAtlas.h"
+
+USING_NS_CC;
+
+/*
+	Atlas Packer:
+		- Packs a list of images into a single atlas texture, and writes the index the game uses to find each image in it (see SpriteAtlas.h)
+		- Run by CMake every time one of the images changes, so the game always gets an up to date atlas without anyone running anything by hand
+		- The images are sorted tallest first and placed in rows ('shelves'). Every size from 256 up to the max is tried and the one with the least wasted space wins
+		- Every image gets a border around it that copies its outer edge. Without it, the filtering at the edge of a sprite would blend in a bit of the image next to it
+
+	Usage:
+		AtlasPacker --root DIR --out PATH [--padding N] [--max-size N] IMAGE IMAGE ...
+			--root -> The folder the image paths start in. Normally the Resources folder
+			--out -> Where to write the atlas, without the extension. PATH.png and PATH.frames are written
+			--padding -> How many pixels of border go around every image. Default 2
+			--max-size -> The biggest the atlas can be on either side. Default 2048
+			IMAGE -> The path of each image, starting in the root folder. This is the name the game looks it up by, so use the same path the game does. Ex: Demo/Birds/spr_BirdRed.png
+
+	Note:
+		- Only RGBA and RGB images are supported. RGB images are given a solid alpha
+		- The atlas is written with straight (not premultiplied) alpha, the same as the original images, so Cocos2D loads it the same way it loaded them
+*/
+
+//The options read from the command line
+struct PackerOptions
+{
+	std::string root;
+	std::string out;
+	unsigned int padding;
+	unsigned int maxSize;
+	std::vector<std::string> images;
+};
+
+//An image to pack, and where it ended up
+struct PackedImage
+{
+	std::string name;
+	unsigned int width, height;
+	std::vector<unsigned char> pixels; //RGBA, top row first
+	unsigned int x, y; //Where the image itself starts in the atlas, not counting its border
+};
+
+static bool parseOptions(int argc, char** argv, PackerOptions& options)
+{
+	options.padding = 2;
+	options.maxSize = 2048;
+	for (int i = 1; i < argc; i++)
+	{
+		bool hasValue = i + 1 < argc;
+		if (strcmp(argv[i], "--root") == 0 && hasValue)
+			options.root = argv[++i];
+		else if (strcmp(argv[i], "--out") == 0 && hasValue)
+			options.out = argv[++i];
+		else if (strcmp(argv[i], "--padding") == 0 && hasValue)
+			options.padding = (unsigned int)atoi(argv[++i]);
+		else if (strcmp(argv[i], "--max-size") == 0 && hasValue)
+			options.maxSize = (unsigned int)atoi(argv[++i]);
+		else if (argv[i][0] == '-')
+		{
+			std::cout << "ERROR: Unknown option '" << argv[i] << "'" << std::endl;
+			return false;
+		}
+		else
+			options.images.push_back(argv[i]);
+	}
+
+	if (options.out.empty() || options.images.empty())
+	{
+		std::cout << "Usage: AtlasPacker --root DIR --out PATH [--padding N] [--max-size N] IMAGE IMAGE ..." << std::endl;
+		return false;
+	}
+
+	return true;
+}
+
+//Read an image and turn it into RGBA
+static bool loadImage(const std::string& path, PackedImage& imageOut)
+{
+	Image* image = new Image();
+	if (!image->initWithImageFile(path))
+	{
+		std::cout << "ERROR: Could not read the image '" << path << "'" << std::endl;
+		image->release();
+		return false;
+	}
+
+	imageOut.width = (unsigned int)image->getWidth();
+	imageOut.height = (unsigned int)image->getHeight();
+	imageOut.pixels.resize(imageOut.width * imageOut.height * 4);
+
+	const unsigned char* data = image->getData();
+	unsigned int pixelCount = imageOut.width * imageOut.height;
+	bool loaded = true;
+	if (image->getRenderFormat() == Texture2D::PixelFormat::RGBA8888)
+		memcpy(imageOut.pixels.data(), data, pixelCount * 4);
+	else if (image->getRenderFormat() == Texture2D::PixelFormat::RGB888)
+	{
+		for (unsigned int i = 0; i < pixelCount; i++)
+		{
+			imageOut.pixels[i * 4 + 0] = data[i * 3 + 0];
+			imageOut.pixels[i * 4 + 1] = data[i * 3 + 1];
+			imageOut.pixels[i * 4 + 2] = data[i * 3 + 2];
+			imageOut.pixels[i * 4 + 3] = 255;
+		}
+	}
+	else
+	{
+		std::cout << "ERROR: '" << path << "' isn't an RGBA or RGB image" << std::endl;
+		loaded = false;
+	}
+
+	image->release();
+	return loaded;
+}
+
+/*
+	Place every image on shelves in an atlas of the given width. The images must already be sorted tallest first
+
+	@param Width -> The width of the atlas
+	@param Padding -> The border around every image
+	@param Images -> The images. Their positions are filled in
+	@return Returns -> How tall the atlas needs to be. 0 if an image is wider than the atlas
+*/
+static unsigned int placeImages(unsigned int width, unsigned int padding, std::vector<PackedImage>& images)
+{
+	unsigned int shelfX = 0, shelfY = 0, shelfHeight = 0;
+	for (unsigned int i = 0; i < images.size(); i++)
+	{
+		unsigned int paddedWidth = images[i].width + padding * 2;
+		unsigned int paddedHeight = images[i].height + padding * 2;
+		if (paddedWidth > width)
+			return 0;
+
+		//Start a new shelf once this one is full. The first image on a shelf is the tallest, so it sets the height
+		if (shelfX + paddedWidth > width)
+		{
+			shelfY += shelfHeight;
+			shelfX = 0;
+			shelfHeight = 0;
+		}
+
+		images[i].x = shelfX + padding;
+		images[i].y = shelfY + padding;
+		shelfX += paddedWidth;
+		shelfHeight = std::max(shelfHeight, paddedHeight);
+	}
+
+	return shelfY + shelfHeight;
+}
+
+//Copy an image into the atlas, and stretch its outer pixels out into its border
+static void copyImage(const PackedImage& image, unsigned int padding, unsigned int atlasWidth, std::vector<unsigned char>& atlas)
+{
+	for (int y = -(int)padding; y < (int)(image.height + padding); y++)
+	{
+		int sourceY = std::min(std::max(y, 0), (int)image.height - 1);
+		for (int x = -(int)padding; x < (int)(image.width + padding); x++)
+		{
+			int sourceX = std::min(std::max(x, 0), (int)image.width - 1);
+			const unsigned char* source = image.pixels.data() + (sourceY * image.width + sourceX) * 4;
+			unsigned char* destination = atlas.data() + ((image.y + y) * atlasWidth + (image.x + x)) * 4;
+			memcpy(destination, source, 4);
+		}
+	}
+}
+
+static unsigned int nextPowerOfTwo(unsigned int value)
+{
+	unsigned int power = 1;
+	while (power < value)
+		power *= 2;
+	return power;
+}
+
+int main(int argc, char** argv)
+{
+	PackerOptions options;
+	if (!parseOptions(argc, argv, options))
+		return 1;
+
+	//Cocos2D multiplies the alpha into PNGs when it loads them by default. The atlas has to be saved the same way as the originals, so that is turned off
+	Image::setPNGPremultipliedAlphaEnabled(false);
+
+	//Read every image
+	std::vector<PackedImage> images(options.images.size());
+	for (unsigned int i = 0; i < images.size(); i++)
+	{
+		images[i].name = options.images[i];
+		std::string path = (options.root.empty()) ? options.images[i] : options.root + "/" + options.images[i];
+		if (!loadImage(path, images[i]))
+			return 1;
+	}
+
+	//The tallest images go first so every shelf is about as tall as the images on it
+	//Ties are broken by name so the atlas comes out exactly the same every build
+	std::sort(images.begin(), images.end(), [](const PackedImage& a, const PackedImage& b)
+	{
+		if (a.height != b.height)
+			return a.height > b.height;
+		return a.name < b.name;
+	});
+
+	//Try every width and keep the one with the smallest atlas, or the squarest if two are the same size. Both sides are kept to powers of two so older GPUs can filter it properly
+	unsigned int bestWidth = 0, bestHeight = 0;
+	for (unsigned int width = 256; width <= options.maxSize; width *= 2)
+	{
+		unsigned int height = placeImages(width, options.padding, images);
+		if (height == 0)
+			continue;
+		height = nextPowerOfTwo(height);
+		if (height > options.maxSize)
+			continue;
+		bool smaller = width * height < bestWidth * bestHeight;
+		bool squarer = width * height == bestWidth * bestHeight && std::max(width, height) < std::max(bestWidth, bestHeight);
+		if (bestWidth == 0 || smaller || squarer)
+		{
+			bestWidth = width;
+			bestHeight = height;
+		}
+	}
+
+	if (bestWidth == 0)
+	{
+		std::cout << "ERROR: The images don't fit in a " << options.maxSize << "x" << options.maxSize << " atlas" << std::endl;
+		return 1;
+	}
+
+	//Place them for real at the winning size, and copy them in. Anything not covered by an image is left fully transparent
+	placeImages(bestWidth, options.padding, images);
+	std::vector<unsigned char> atlas(bestWidth * bestHeight * 4, 0);
+	for (unsigned int i = 0; i < images.size(); i++)
+		copyImage(images[i], options.padding, bestWidth, atlas);
+
+	//Save the atlas texture
+	Image* atlasImage = new Image();
+	atlasImage->initWithRawData(atlas.data(), (ssize_t)atlas.size(), (int)bestWidth, (int)bestHeight, 8, false);
+	bool saved = atlasImage->saveToFile(options.out + ".png", false);
+	atlasImage->release();
+	if (!saved)
+	{
+		std::cout << "ERROR: Could not write '" << options.out << ".png'" << std::endl;
+		return 1;
+	}
+
+	//Build the index. The frames are written in the order the images were given on the command line, not the packing order, so the ids stay the same when an image changes size
+	SpriteAtlasHeader header;
+	memcpy(header.magic, SPRITE_ATLAS_MAGIC, 4);
+	header.version = SPRITE_ATLAS_VERSION;
+	header.frameCount = (uint16_t)images.size();
+	header.width = (uint16_t)bestWidth;
+	header.height = (uint16_t)bestHeight;
+
+	std::vector<SpriteAtlasEntry> entries;
+	std::string names;
+	for (unsigned int i = 0; i < options.images.size(); i++)
+	{
+		const PackedImage& image = *std::find_if(images.begin(), images.end(), [&](const PackedImage& packed) { return packed.name == options.images[i]; });
+
+		SpriteAtlasEntry entry;
+		entry.x = (uint16_t)image.x;
+		entry.y = (uint16_t)image.y;
+		entry.width = (uint16_t)image.width;
+		entry.height = (uint16_t)image.height;
+		entry.nameOffset = (uint32_t)names.size();
+		entries.push_back(entry);
+
+		names += image.name;
+		names += '\0';
+	}
+	header.namesSize = (uint32_t)names.size();
+
+	std::ofstream file(options.out + ".frames", std::ios::binary | std::ios::trunc);
+	file.write((const char*)&header, sizeof(header));
+	file.write((const char*)entries.data(), entries.size() * sizeof(SpriteAtlasEntry));
+	file.write(names.data(), names.size());
+	if (!file)
+	{
+		std::cout << "ERROR: Could not write '" << options.out << ".frames'" << std::endl;
+		return 1;
+	}
+
+	//Report how well it packed
+	unsigned int usedPixels = 0;
+	for (unsigned int i = 0; i < images.size(); i++)
+		usedPixels += images[i].width * images[i].height;
+	std::cout << "Atlas Packer -> " << images.size() << " images in a " << bestWidth << "x" << bestHeight << " atlas (" << (usedPixels * 100 / (bestWidth * bestHeight)) << "% used), "
+		<< (sizeof(header) + entries.size() * sizeof(SpriteAtlasEntry) + names.size()) << " byte index" << std::endl;
+	return 0;
+}
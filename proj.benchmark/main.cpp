@@ -0,0 +1,695 @@
+//Core Libraries
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+//3rd Party Libraries
+#include "cocos2d.h"
+
+//Wrapper Classes
+#include "DisplayHandler.h"
+#include "InputHandler.h"
+#include "HeadlessRunner.h"
+#include "DemoScene.h"
+#include "CookedTexture.h"
+#include "JobSystem.h"
+
+USING_NS_CC;
+
+/*
+	Benchmark Driver:
+		- Runs DemoScene headless (no window, no GPU) with a fixed timestep and a scripted input stream
+		- Prints p50 / p95 / p99 timings for the scene update, the physics step and the actions
+		- The input can be recorded to a file and replayed later so two builds can be compared on exactly the same workload
+		- Once the frames are measured, the scene is reset with the birds still in it and the time it takes is reported as the restart latency
+		- With --piles, it instead drops piles of birds onto the ground and reports the physics step time for each physics tuning setup (see PhysicsTuning.h)
+		- With --particles, it instead runs the mouse particle emitter (see ParticleEmitter.h) at each particle count and reports the update time with and without SIMD
+			> Adding --particle-threads also spreads the same number of particles over a lot of emitters in a ParticleUpdater (see ParticleUpdater.h) and reports the time at each thread count
+		- With --textures, it instead loads the preloaded images over and over, both from the original files and from their cooked versions (see CookedTexture.h), and reports how long each takes
+		- With --jobs, it instead measures the job system (see JobSystem.h) at each thread count: how long a job takes to start and finish on its own and in a chain, and how much faster a big parallelFor() gets with more threads
+
+	Usage:
+		DemoBenchmark [--birds N] [--frames N] [--dt SECONDS] [--substeps N] [--restarts N] [--record FILE] [--replay FILE] [--piles N,N,...] [--settle N] [--bird-collisions 0|1] [--threaded-physics 0|1] [--simple-birds N] [--particles N,N,...] [--particle-threads N,N,...] [--textures N] [--jobs N,N,...]
+			--birds -> How many birds to spawn before measuring. Default 500
+			--frames -> How many frames to measure once the birds are spawned. Default 600
+			--dt -> The fixed frame time in seconds. Default 1/60. The physics still steps at its own fixed rate, so 1/30 means two physics steps per frame
+			--substeps -> How many pieces each physics step is split into. Default 1
+			--restarts -> How many times to fill the scene with birds and reset it to measure the restart latency. Default 5
+			--record -> Save the input for the whole run to a file
+			--replay -> Use the input from a recording instead of the built-in spawn script. Use the same --birds, --frames and --dt as the run that was recorded
+			--piles -> Run the pile benchmark instead, once for each number of birds in the list. Ex: --piles 1000,2500,5000,10000
+			--settle -> How many frames the pile gets to settle before it is measured. Default 600
+			--bird-collisions -> 0 turns off bird-vs-bird collisions so the birds only hit the ground. Default 1
+			--threaded-physics -> 1 steps the physics on its own thread (see PhysicsStepper.h). The physics time is then only the time to start the step, and waiting for it shows up in the update time. Sleeping birds are off. Default 0
+			--simple-birds -> How many simple birds (see BirdStore.h) to add on top of the normal ones before measuring. Their update shows up in the update time. Default 0
+			--particles -> Run the particle benchmark instead, once for each particle count in the list. Uses --frames and --dt. Ex: --particles 100,1000,10000,100000
+			--particle-threads -> The thread counts to run the particle updater with in the particle benchmark. Also checks that deterministic mode gives the same vertices at every count. Ex: --particle-threads 1,2,4,8
+			--textures -> Run the texture benchmark instead, loading each image this many times. Ex: --textures 20
+			--jobs -> Run the job system benchmark instead, once for each thread count in the list. Uses --frames. The speedup is against the first thread count, so start the list with 1. Ex: --jobs 1,2,4,8
+*/
+
+//The options read from the command line
+struct BenchmarkOptions
+{
+	unsigned int birds;
+	unsigned int frames;
+	float deltaTime;
+	unsigned int substeps;
+	unsigned int restarts;
+	std::string recordPath;
+	std::string replayPath;
+	std::vector<unsigned int> piles;
+	unsigned int settleFrames;
+	bool birdCollisions;
+	bool threadedPhysics;
+	unsigned int simpleBirds;
+	std::vector<unsigned int> particles;
+	std::vector<unsigned int> particleThreads;
+	unsigned int textureRuns;
+	std::vector<unsigned int> jobThreads;
+};
+
+//Read a comma separated list of numbers. Ex: "100,1000,10000"
+static void parseCountList(const char* list, std::vector<unsigned int>& countsOut)
+{
+	for (const char* count = list; *count; count++)
+	{
+		countsOut.push_back((unsigned int)atoi(count));
+		count = strchr(count, ',');
+		if (!count)
+			break;
+	}
+}
+
+//Read the command line into the options. Returns false if an option isn't recognised
+static bool parseOptions(int argc, char** argv, BenchmarkOptions& options)
+{
+	for (int i = 1; i < argc; i++)
+	{
+		//Every option needs a value after it
+		if (i + 1 >= argc)
+			return false;
+
+		if (strcmp(argv[i], "--birds") == 0)
+			options.birds = (unsigned int)atoi(argv[++i]);
+		else if (strcmp(argv[i], "--frames") == 0)
+			options.frames = (unsigned int)atoi(argv[++i]);
+		else if (strcmp(argv[i], "--dt") == 0)
+			options.deltaTime = (float)atof(argv[++i]);
+		else if (strcmp(argv[i], "--substeps") == 0)
+			options.substeps = (unsigned int)atoi(argv[++i]);
+		else if (strcmp(argv[i], "--restarts") == 0)
+			options.restarts = (unsigned int)atoi(argv[++i]);
+		else if (strcmp(argv[i], "--record") == 0)
+			options.recordPath = argv[++i];
+		else if (strcmp(argv[i], "--replay") == 0)
+			options.replayPath = argv[++i];
+		else if (strcmp(argv[i], "--piles") == 0)
+			parseCountList(argv[++i], options.piles);
+		else if (strcmp(argv[i], "--particles") == 0)
+			parseCountList(argv[++i], options.particles);
+		else if (strcmp(argv[i], "--particle-threads") == 0)
+			parseCountList(argv[++i], options.particleThreads);
+		else if (strcmp(argv[i], "--settle") == 0)
+			options.settleFrames = (unsigned int)atoi(argv[++i]);
+		else if (strcmp(argv[i], "--bird-collisions") == 0)
+			options.birdCollisions = atoi(argv[++i]) != 0;
+		else if (strcmp(argv[i], "--threaded-physics") == 0)
+			options.threadedPhysics = atoi(argv[++i]) != 0;
+		else if (strcmp(argv[i], "--simple-birds") == 0)
+			options.simpleBirds = (unsigned int)atoi(argv[++i]);
+		else if (strcmp(argv[i], "--textures") == 0)
+			options.textureRuns = (unsigned int)atoi(argv[++i]);
+		else if (strcmp(argv[i], "--jobs") == 0)
+			parseCountList(argv[++i], options.jobThreads);
+		else
+			return false;
+	}
+
+	return true;
+}
+
+//Build a script that clicks the mouse once every two frames, alternating between the left (yellow bird) and right (red bird) buttons
+//The cursor is moved around the top of the window in a fixed pattern so every run spawns the birds in exactly the same places
+static std::vector<ScriptedInput> buildSpawnScript(unsigned int numBirds, unsigned int startFrame = 0)
+{
+	std::vector<ScriptedInput> script;
+	script.reserve(numBirds * 3);
+
+	Size windowSize = DISPLAY->getWindowSize();
+	for (unsigned int i = 0; i < numBirds; i++)
+	{
+		//The button is released on the frame after it was pressed so every click takes the same number of frames
+		unsigned int frame = startFrame + i * 2;
+		int button = (i % 2 == 0) ? (int)MouseButton::BUTTON_LEFT : (int)MouseButton::BUTTON_RIGHT;
+		Vec2 position(40.0f + (float)((i * 37) % (unsigned int)(windowSize.width - 80.0f)), windowSize.height * 0.6f + (float)((i * 53) % 150));
+
+		ScriptedInput move = { frame, ScriptedInput::MouseMove, 0, position };
+		ScriptedInput down = { frame, ScriptedInput::MouseDown, button, Vec2::ZERO };
+		ScriptedInput up = { frame + 1, ScriptedInput::MouseUp, button, Vec2::ZERO };
+		script.push_back(move);
+		script.push_back(down);
+		script.push_back(up);
+	}
+
+	return script;
+}
+
+//A named set of physics tuning settings for the pile benchmark
+struct PileConfig
+{
+	const char* name;
+	PhysicsTuning tuning;
+};
+
+//Build the setups the pile benchmark compares. Each one changes a single thing from the one before it, apart from 'sleep' which is the defaults plus sleeping
+static std::vector<PileConfig> buildPileConfigs(unsigned int numBirds)
+{
+	std::vector<PileConfig> configs;
+
+	//What Chipmunk does out of the box
+	PileConfig config = { "default", PhysicsTuning::getDefault() };
+	configs.push_back(config);
+
+	//Fewer solver iterations, and a bit more overlap allowed so the pile doesn't jitter with them
+	config.name = "solver";
+	config.tuning.iterations = 5;
+	config.tuning.collisionSlop = 0.5f;
+	configs.push_back(config);
+
+	//A spatial hash instead of the bounding box tree. The cells are about as big as a red bird (the biggest one) and there is about one per bird
+	config.name = "hash";
+	config.tuning.spatialHashCellSize = 64.0f;
+	config.tuning.spatialHashCount = (int)numBirds;
+	configs.push_back(config);
+
+	//Birds that have settled go to sleep
+	config.name = "hash+sleep";
+	config.tuning.sleepTimeThreshold = 0.5f;
+	configs.push_back(config);
+
+	//Sleeping on its own, to see how much of the win is from the sleeping alone
+	config.name = "sleep";
+	config.tuning = PhysicsTuning::getDefault();
+	config.tuning.sleepTimeThreshold = 0.5f;
+	configs.push_back(config);
+
+	return configs;
+}
+
+//Drop piles of birds onto the ground and print how long the physics step takes for each physics tuning setup
+//Every setup gets a brand new scene, since a physics world can't go back from the spatial hash to the tree
+static int runPileBenchmark(const BenchmarkOptions& options)
+{
+	//The birds are dropped in columns 60 pixels apart. Make the window (and so the ground) wide enough that the biggest pile is about 20 birds high
+	unsigned int maxBirds = 0;
+	for (unsigned int i = 0; i < options.piles.size(); i++)
+		maxBirds = std::max(maxBirds, options.piles[i]);
+	const float columnSpacing = 60.0f;
+	unsigned int windowWidth = std::max(640u, (unsigned int)((maxBirds / 20 + 2) * columnSpacing));
+
+	DISPLAY->initHeadless(windowWidth, 480);
+	INPUTS->init();
+
+	//Start the job system like AppDelegate does, so the scene's particles and simple birds are spread over every core the same as in the game
+	JOBS->init(0);
+
+	std::cout << "DemoScene pile benchmark: " << options.settleFrames << " settle frames, " << options.frames << " measured frames, ground " << windowWidth << " pixels wide" << std::endl;
+	std::cout << std::left << std::setw(8) << "birds" << std::setw(12) << "config" << std::right
+		<< std::setw(10) << "p50 ms" << std::setw(10) << "p95 ms" << std::setw(10) << "mean ms" << std::setw(10) << "asleep" << std::endl;
+
+	for (unsigned int pile = 0; pile < options.piles.size(); pile++)
+	{
+		unsigned int numBirds = options.piles[pile];
+		std::vector<PileConfig> configs = buildPileConfigs(numBirds);
+		for (unsigned int c = 0; c < configs.size(); c++)
+		{
+			HeadlessRunner runner(options.deltaTime);
+			if (!runner.init())
+			{
+				std::cout << "ERROR: The headless runner failed to build the scene!" << std::endl;
+				JOBS->shutdown();
+				return 1;
+			}
+
+			DemoScene* demoScene = runner.getDemoScene();
+			demoScene->setBirdLifetime(1000000.0f);
+			demoScene->getPhysicsStepper().setSubsteps(options.substeps);
+			demoScene->setPhysicsTuning(configs[c].tuning);
+			demoScene->setBirdCollisions(options.birdCollisions);
+			demoScene->setThreadedPhysics(options.threadedPhysics);
+
+			//Drop the birds in a grid above the ground, alternating yellow and red. The rows are spaced out so they land on each other one at a time instead of all at once
+			unsigned int columns = std::max(1u, (windowWidth - (unsigned int)columnSpacing) / (unsigned int)columnSpacing);
+			std::vector<Vec2> positions[NumBirdTypes];
+			for (unsigned int i = 0; i < numBirds; i++)
+				positions[i % 2].push_back(Vec2(columnSpacing * (float)(i % columns + 1), 100.0f + 70.0f * (float)(i / columns)));
+			demoScene->spawnBirdBatch(BirdType::Yellow, positions[BirdType::Yellow]);
+			demoScene->spawnBirdBatch(BirdType::Red, positions[BirdType::Red]);
+
+			//Let the pile settle, then measure
+			runner.run(options.settleFrames);
+			runner.clearTimings();
+			runner.run(options.frames);
+
+			std::vector<double> physics;
+			physics.reserve(runner.getFrameTimings().size());
+			for (unsigned int i = 0; i < runner.getFrameTimings().size(); i++)
+				physics.push_back(runner.getFrameTimings()[i].physics);
+			TimingSummary summary = HeadlessRunner::summarize(physics);
+
+			std::cout << std::left << std::setw(8) << numBirds << std::setw(12) << configs[c].name << std::right << std::fixed << std::setprecision(3)
+				<< std::setw(10) << summary.p50 << std::setw(10) << summary.p95 << std::setw(10) << summary.mean
+				<< std::setw(10) << demoScene->getSleepingBirdCount() << std::endl;
+			std::cout.unsetf(std::ios_base::floatfield);
+
+			//Give the birds back to the pool before the scene goes away so the next setup can reuse them
+			demoScene->resetScene();
+		}
+	}
+
+	JOBS->shutdown();
+	return 0;
+}
+
+//How many emitters the particles are spread over in the thread benchmark. About what a screen full of birds with trails looks like
+static const unsigned int PARTICLE_BENCHMARK_EMITTERS = 64;
+
+//Fill a particle updater with emitters that share the given number of particles between them
+//Every emitter is seeded the same way, so two updaters built with this come out exactly the same
+static ParticleUpdater* buildParticleUpdater(unsigned int totalParticles, unsigned int threadCount, bool deterministic)
+{
+	ParticleUpdater* updater = ParticleUpdater::create();
+	updater->retain();
+	updater->setThreadCount(threadCount);
+	updater->setDeterministic(deterministic);
+
+	unsigned int perEmitter = std::max(totalParticles / PARTICLE_BENCHMARK_EMITTERS, 1u);
+	for (unsigned int i = 0; i < PARTICLE_BENCHMARK_EMITTERS; i++)
+	{
+		ParticleEmitter* emitter = ParticleEmitter::createMeteor(perEmitter);
+		emitter->setEndColorVar(Color4F(0.75f, 0.75f, 0.75f, 0.75f));
+		emitter->setPosition(40.0f + (float)(i % 8) * 80.0f, 40.0f + (float)(i / 8) * 60.0f);
+		updater->addEmitter(emitter);
+	}
+
+	//Let every emitter fill up. Meteor particles live for up to 3 seconds
+	for (float time = 0.0f; time < 3.0f; time += 1.0f / 60.0f)
+		updater->step(1.0f / 60.0f);
+
+	return updater;
+}
+
+//Hash a block of memory (64 bit FNV-1a). Any change to any byte changes the result
+static unsigned long long checksumBytes(const void* data, size_t size)
+{
+	const unsigned char* bytes = (const unsigned char*)data;
+	unsigned long long hash = 14695981039346656037ULL;
+	for (size_t i = 0; i < size; i++)
+	{
+		hash ^= bytes[i];
+		hash *= 1099511628211ULL;
+	}
+	return hash;
+}
+
+//Run a particle updater at each particle count and thread count and print how long its step takes, including building and merging the vertices
+//Then run it in deterministic mode at every thread count and check that the merged vertices match the first thread count in the list exactly. The speedup is against the first thread count too, so start the list with 1
+static void runParticleThreadBenchmark(const BenchmarkOptions& options)
+{
+	//The updater hands its chunks to the job system, so it needs at least as many threads as the most the list asks for
+	JOBS->init(*std::max_element(options.particleThreads.begin(), options.particleThreads.end()));
+
+	std::cout << std::endl << "Particle thread benchmark: " << PARTICLE_BENCHMARK_EMITTERS << " emitters, " << options.frames << " measured frames, " << std::thread::hardware_concurrency() << " hardware threads" << std::endl;
+	std::cout << std::left << std::setw(10) << "max" << std::setw(10) << "threads" << std::right
+		<< std::setw(10) << "alive" << std::setw(10) << "p50 ms" << std::setw(10) << "p95 ms" << std::setw(10) << "speedup" << std::setw(15) << "deterministic" << std::endl;
+
+	for (unsigned int run = 0; run < options.particles.size(); run++)
+	{
+		//Keep a checksum of every frame of the first deterministic run to compare the others against. Keeping the vertices themselves would take gigabytes
+		std::vector<unsigned long long> expectedFrames;
+		double singleThreadTime = 0.0;
+
+		for (unsigned int threads = 0; threads < options.particleThreads.size(); threads++)
+		{
+			unsigned int threadCount = options.particleThreads[threads];
+
+			//Measure with the chunks handed out as fast as possible
+			ParticleUpdater* updater = buildParticleUpdater(options.particles[run], threadCount, false);
+			std::vector<double> times;
+			times.reserve(options.frames);
+			for (unsigned int frame = 0; frame < options.frames; frame++)
+			{
+				std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+				updater->step(options.deltaTime);
+				std::chrono::high_resolution_clock::time_point end = std::chrono::high_resolution_clock::now();
+				times.push_back(std::chrono::duration<double, std::milli>(end - start).count());
+			}
+			TimingSummary summary = HeadlessRunner::summarize(times);
+			unsigned int alive = updater->getParticleCount();
+			updater->release();
+
+			//Then run the same frames in deterministic mode and compare the vertices with the first thread count in the list
+			updater = buildParticleUpdater(options.particles[run], threadCount, true);
+			bool matches = true;
+			for (unsigned int frame = 0; frame < options.frames; frame++)
+			{
+				updater->step(options.deltaTime);
+				const std::vector<V3F_C4B_T2F>& vertices = updater->getVertices();
+				unsigned long long checksum = checksumBytes(vertices.data(), vertices.size() * sizeof(V3F_C4B_T2F));
+				if (threads == 0)
+					expectedFrames.push_back(checksum);
+				else if (expectedFrames[frame] != checksum)
+					matches = false;
+			}
+			updater->release();
+
+			if (threads == 0)
+				singleThreadTime = summary.mean;
+			double speedup = (summary.mean > 0.0) ? singleThreadTime / summary.mean : 0.0;
+			std::cout << std::left << std::setw(10) << options.particles[run] << std::setw(10) << threadCount << std::right
+				<< std::setw(10) << alive << std::fixed << std::setprecision(3) << std::setw(10) << summary.p50 << std::setw(10) << summary.p95
+				<< std::setprecision(2) << std::setw(9) << speedup << "x" << std::setw(15) << ((threads == 0) ? "reference" : (matches ? "match" : "MISMATCH")) << std::endl;
+			std::cout.unsetf(std::ios_base::floatfield);
+		}
+	}
+
+	JOBS->shutdown();
+}
+
+//Run the mouse particle emitter at each particle count and print how long its update takes, with the SIMD kernels and with the plain loops
+//The emitter is run on its own, without a scene, so only the particle update is measured. Nothing is drawn since the display is headless
+static int runParticleBenchmark(const BenchmarkOptions& options)
+{
+	std::cout << "Particle benchmark: " << options.frames << " measured frames, SIMD kernels compiled with " << ParticleEmitter::getSimdName() << std::endl;
+	std::cout << std::left << std::setw(10) << "max" << std::setw(10) << "kernels" << std::right
+		<< std::setw(10) << "alive" << std::setw(10) << "p50 ms" << std::setw(10) << "p95 ms" << std::setw(12) << "ns/particle" << std::endl;
+
+	for (unsigned int run = 0; run < options.particles.size(); run++)
+	{
+		for (int simd = 1; simd >= 0; simd--)
+		{
+			//Use the same settings as the mouse particles, but with the particles living long enough to fill the emitter up
+			ParticleEmitter::setSimdEnabled(simd != 0);
+			ParticleEmitter* emitter = ParticleEmitter::createMeteor(options.particles[run]);
+			emitter->retain();
+			emitter->setEndColorVar(Color4F(0.75f, 0.75f, 0.75f, 0.75f));
+			emitter->setPosition(320.0f, 240.0f);
+
+			//Let it fill up. Meteor particles live for up to 3 seconds
+			for (unsigned int frame = 0; (float)frame * options.deltaTime < 3.0f; frame++)
+				emitter->simulate(options.deltaTime);
+
+			//Measure. The emitter is moved around in a circle like it is following the mouse
+			std::vector<double> times;
+			times.reserve(options.frames);
+			double particleFrames = 0.0;
+			for (unsigned int frame = 0; frame < options.frames; frame++)
+			{
+				float angle = (float)frame * 0.05f;
+				emitter->setPosition(320.0f + cosf(angle) * 100.0f, 240.0f + sinf(angle) * 100.0f);
+
+				std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+				emitter->simulate(options.deltaTime);
+				std::chrono::high_resolution_clock::time_point end = std::chrono::high_resolution_clock::now();
+				times.push_back(std::chrono::duration<double, std::milli>(end - start).count());
+				particleFrames += (double)emitter->getParticleCount();
+			}
+			TimingSummary summary = HeadlessRunner::summarize(times);
+
+			double nanosecondsPerParticle = (particleFrames > 0.0) ? summary.mean * 1000000.0 * (double)options.frames / particleFrames : 0.0;
+			std::cout << std::left << std::setw(10) << options.particles[run] << std::setw(10) << ((simd != 0) ? ParticleEmitter::getSimdName() : "Scalar") << std::right
+				<< std::setw(10) << emitter->getParticleCount() << std::fixed << std::setprecision(3) << std::setw(10) << summary.p50 << std::setw(10) << summary.p95
+				<< std::setw(12) << nanosecondsPerParticle << std::endl;
+			std::cout.unsetf(std::ios_base::floatfield);
+
+			emitter->release();
+		}
+	}
+
+	ParticleEmitter::setSimdEnabled(true);
+	if (!options.particleThreads.empty())
+		runParticleThreadBenchmark(options);
+	return 0;
+}
+
+//Load the images the preloader loads, from the original files and then from the cooked versions, and print how long each takes
+//Only the part the preloader's workers do is measured. The upload needs a GPU, and is about the same either way since it is the same pixels
+static int runTextureBenchmark(const BenchmarkOptions& options)
+{
+	const char* paths[] = { "Demo/Background/spr_Background.jpg", "Demo/Atlas/atlas_Demo.png" };
+	std::cout << "Texture benchmark: " << options.textureRuns << " loads of each image" << std::endl;
+	std::cout << std::left << std::setw(40) << "image" << std::setw(10) << "from" << std::right
+		<< std::setw(12) << "bytes" << std::setw(10) << "p50 ms" << std::setw(10) << "p95 ms" << std::endl;
+
+	for (unsigned int i = 0; i < sizeof(paths) / sizeof(paths[0]); i++)
+	{
+		std::string cookedPath = CookedTexture::getCookedPath(paths[i]);
+		if (!FileUtils::getInstance()->isFileExist(paths[i]) || !FileUtils::getInstance()->isFileExist(cookedPath))
+		{
+			std::cout << std::left << std::setw(40) << paths[i] << "skipped, it or its cooked version is missing. Build the TextureCooker target first" << std::right << std::endl;
+			continue;
+		}
+		std::string fullPaths[] = { FileUtils::getInstance()->fullPathForFilename(paths[i]), FileUtils::getInstance()->fullPathForFilename(cookedPath) };
+
+		for (int cooked = 0; cooked <= 1; cooked++)
+		{
+			std::vector<double> times;
+			times.reserve(options.textureRuns);
+			for (unsigned int run = 0; run < options.textureRuns; run++)
+			{
+				std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+				Image* image;
+				if (cooked)
+					image = CookedTexture::load(fullPaths[1]);
+				else
+				{
+					image = new Image();
+					if (!image->initWithImageFile(fullPaths[0]))
+					{
+						image->release();
+						image = nullptr;
+					}
+				}
+				std::chrono::high_resolution_clock::time_point end = std::chrono::high_resolution_clock::now();
+
+				if (!image)
+				{
+					std::cout << "ERROR: Could not load '" << fullPaths[cooked] << "'" << std::endl;
+					return 1;
+				}
+				image->release();
+				times.push_back(std::chrono::duration<double, std::milli>(end - start).count());
+			}
+			TimingSummary summary = HeadlessRunner::summarize(times);
+
+			std::cout << std::left << std::setw(40) << paths[i] << std::setw(10) << (cooked ? "cooked" : "source") << std::right
+				<< std::setw(12) << FileUtils::getInstance()->getFileSize(fullPaths[cooked]) << std::fixed << std::setprecision(3)
+				<< std::setw(10) << summary.p50 << std::setw(10) << summary.p95 << std::endl;
+			std::cout.unsetf(std::ios_base::floatfield);
+		}
+	}
+
+	return 0;
+}
+
+//How many jobs are started each frame of the job benchmark, and how many items the parallelFor() works through
+static const unsigned int JOB_BENCHMARK_JOBS = 1000;
+static const unsigned int JOB_BENCHMARK_ITEMS = 1 << 20;
+static const unsigned int JOB_BENCHMARK_GRAIN = 4096;
+
+//Start the job system at each thread count and print how long it takes to run lots of empty jobs, a long chain of empty jobs, and a parallelFor() over a big array
+//The empty jobs show what the job system itself costs per job. The parallelFor() shows how well real work spreads out over the cores
+static int runJobBenchmark(const BenchmarkOptions& options)
+{
+	std::cout << "Job benchmark: " << JOB_BENCHMARK_JOBS << " jobs and " << JOB_BENCHMARK_ITEMS << " parallelFor items per frame, " << options.frames << " measured frames, " << std::thread::hardware_concurrency() << " hardware threads" << std::endl;
+	std::cout << std::left << std::setw(10) << "threads" << std::right
+		<< std::setw(12) << "ns/job" << std::setw(12) << "ns/chained" << std::setw(10) << "p50 ms" << std::setw(10) << "p95 ms" << std::setw(10) << "speedup" << std::setw(10) << "stolen" << std::endl;
+
+	std::vector<float> values(JOB_BENCHMARK_ITEMS);
+	double singleThreadTime = 0.0;
+	for (unsigned int run = 0; run < options.jobThreads.size(); run++)
+	{
+		JOBS->init(options.jobThreads[run]);
+		unsigned int threadCount = JOBS->getThreadCount();
+
+		//Empty jobs, all started at once and then waited on
+		std::vector<JobHandle> jobs(JOB_BENCHMARK_JOBS);
+		std::vector<double> spreadTimes;
+		spreadTimes.reserve(options.frames);
+		for (unsigned int frame = 0; frame < options.frames; frame++)
+		{
+			std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+			for (unsigned int i = 0; i < JOB_BENCHMARK_JOBS; i++)
+				jobs[i] = JOBS->run([]() {});
+			JOBS->wait(jobs);
+			std::chrono::high_resolution_clock::time_point end = std::chrono::high_resolution_clock::now();
+			spreadTimes.push_back(std::chrono::duration<double, std::milli>(end - start).count());
+		}
+
+		//Empty jobs that each wait on the one before, so only one can ever run at a time
+		std::vector<double> chainTimes;
+		chainTimes.reserve(options.frames);
+		for (unsigned int frame = 0; frame < options.frames; frame++)
+		{
+			std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+			JobHandle last;
+			for (unsigned int i = 0; i < JOB_BENCHMARK_JOBS; i++)
+			{
+				JobHandle job = JOBS->create([]() {});
+				JOBS->addDependency(job, last);
+				JOBS->submit(job);
+				last = job;
+			}
+			JOBS->wait(last);
+			std::chrono::high_resolution_clock::time_point end = std::chrono::high_resolution_clock::now();
+			chainTimes.push_back(std::chrono::duration<double, std::milli>(end - start).count());
+		}
+
+		//A loop with a bit of real math in it, about what moving a particle costs
+		JOBS->resetStats();
+		std::vector<double> loopTimes;
+		loopTimes.reserve(options.frames);
+		for (unsigned int frame = 0; frame < options.frames; frame++)
+		{
+			std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+			JOBS->parallelFor(JOB_BENCHMARK_ITEMS, JOB_BENCHMARK_GRAIN, [&values, frame](unsigned int first, unsigned int last, unsigned int)
+			{
+				for (unsigned int i = first; i < last; i++)
+					values[i] = sqrtf((float)(i + frame)) * sinf((float)i * 0.001f);
+			});
+			std::chrono::high_resolution_clock::time_point end = std::chrono::high_resolution_clock::now();
+			loopTimes.push_back(std::chrono::duration<double, std::milli>(end - start).count());
+		}
+		uint64_t stolen = JOBS->getStats().jobsStolen;
+
+		TimingSummary spread = HeadlessRunner::summarize(spreadTimes);
+		TimingSummary chain = HeadlessRunner::summarize(chainTimes);
+		TimingSummary loop = HeadlessRunner::summarize(loopTimes);
+		if (run == 0)
+			singleThreadTime = loop.mean;
+		double speedup = (loop.mean > 0.0) ? singleThreadTime / loop.mean : 0.0;
+		std::cout << std::left << std::setw(10) << threadCount << std::right << std::fixed << std::setprecision(1)
+			<< std::setw(12) << spread.mean * 1000000.0 / JOB_BENCHMARK_JOBS << std::setw(12) << chain.mean * 1000000.0 / JOB_BENCHMARK_JOBS
+			<< std::setprecision(3) << std::setw(10) << loop.p50 << std::setw(10) << loop.p95 << std::setprecision(2) << std::setw(9) << speedup << "x" << std::setw(10) << stolen << std::endl;
+		std::cout.unsetf(std::ios_base::floatfield);
+	}
+
+	JOBS->shutdown();
+	return 0;
+}
+
+int main(int argc, char** argv)
+{
+	//Read the options
+	BenchmarkOptions options = { 500, 600, 1.0f / 60.0f, 1, 5, "", "", std::vector<unsigned int>(), 600, true, false, 0, std::vector<unsigned int>(), std::vector<unsigned int>(), 0, std::vector<unsigned int>() };
+	if (!parseOptions(argc, argv, options))
+	{
+		std::cout << "Usage: DemoBenchmark [--birds N] [--frames N] [--dt SECONDS] [--substeps N] [--restarts N] [--record FILE] [--replay FILE] [--piles N,N,...] [--settle N] [--bird-collisions 0|1] [--threaded-physics 0|1] [--simple-birds N] [--particles N,N,...] [--particle-threads N,N,...] [--textures N] [--jobs N,N,...]" << std::endl;
+		return 1;
+	}
+
+	//The pile and particle benchmarks are separate runs of their own
+	if (!options.piles.empty())
+		return runPileBenchmark(options);
+	if (!options.particles.empty())
+		return runParticleBenchmark(options);
+	if (options.textureRuns > 0)
+		return runTextureBenchmark(options);
+	if (!options.jobThreads.empty())
+		return runJobBenchmark(options);
+
+	//Start the job system like AppDelegate does, so the scene's particles and simple birds are spread over every core
+	JOBS->init(0);
+
+	//Start the display without a window and set up the input handler like AppDelegate does
+	DISPLAY->initHeadless(640, 480);
+	INPUTS->init();
+
+	//Build the scene
+	HeadlessRunner runner(options.deltaTime);
+	if (!runner.init())
+	{
+		std::cout << "ERROR: The headless runner failed to build the scene!" << std::endl;
+		return 1;
+	}
+
+	//Keep the birds around for the whole run so the count stays at what was asked for
+	runner.getDemoScene()->setBirdLifetime(1000000.0f);
+	runner.getDemoScene()->getPhysicsStepper().setSubsteps(options.substeps);
+	runner.getDemoScene()->setBirdCollisions(options.birdCollisions);
+	runner.getDemoScene()->setThreadedPhysics(options.threadedPhysics);
+
+	//Pick where the input comes from. Either a recording or the built-in spawn script
+	if (!options.replayPath.empty())
+	{
+		if (!INPUTS->startReplay(options.replayPath))
+			return 1;
+	}
+	else
+		runner.setScript(buildSpawnScript(options.birds));
+
+	//Save the input if asked to. Everything from here on is recorded, so replaying the file repeats this whole run
+	if (!options.recordPath.empty() && !INPUTS->startRecording(options.recordPath))
+		return 1;
+
+	//Spawn the birds. These frames aren't measured
+	//The simple birds are thrown out from the middle of the window all at once and given a second to land
+	runner.run(options.birds * 2);
+	if (options.simpleBirds > 0)
+	{
+		runner.getDemoScene()->spawnSimpleBirds(BirdType::Yellow, options.simpleBirds, Vec2(320.0f, 300.0f), 250.0f);
+		runner.run((unsigned int)(1.0f / options.deltaTime));
+	}
+	runner.clearTimings();
+
+	//Measure
+	std::cout << "DemoScene headless benchmark: " << options.birds << " birds";
+	if (options.simpleBirds > 0)
+		std::cout << " + " << runner.getDemoScene()->getBirdStore()->getCount() << " simple birds";
+	std::cout << std::endl;
+	runner.run(options.frames);
+	runner.printReport(std::cout);
+
+	//Finish the recording. The restart measurements below aren't part of it
+	if (INPUTS->isRecording())
+	{
+		INPUTS->stopRecording();
+		std::cout << "Input recorded to " << options.recordPath << std::endl;
+	}
+	INPUTS->stopReplay();
+
+	//Measure how long it takes to reset the scene with the birds in it. The first reset uses the birds from the measured run, the rest spawn a fresh pile first
+	std::vector<double> restartTimes;
+	for (unsigned int i = 0; i < options.restarts; i++)
+	{
+		if (i > 0)
+		{
+			runner.setScript(buildSpawnScript(options.birds, runner.getCurrentFrame()));
+			runner.run(options.birds * 2);
+		}
+
+		std::chrono::high_resolution_clock::time_point restartStart = std::chrono::high_resolution_clock::now();
+		runner.getDemoScene()->resetScene();
+		std::chrono::high_resolution_clock::time_point restartEnd = std::chrono::high_resolution_clock::now();
+		restartTimes.push_back(std::chrono::duration<double, std::milli>(restartEnd - restartStart).count());
+
+		//Run one frame so the physics world finishes removing the bodies, like the next frame after a restart would
+		runner.run(1);
+	}
+
+	if (!restartTimes.empty())
+	{
+		TimingSummary restart = HeadlessRunner::summarize(restartTimes);
+		std::cout << "Restart (" << restartTimes.size() << " resets with " << options.birds << " birds): p50 " << restart.p50 << " ms, max " << restart.max << " ms" << std::endl;
+	}
+
+	JOBS->shutdown();
+	return 0;
+}
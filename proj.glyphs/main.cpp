@@ -0,0 +1,421 @@
+//Core Libraries
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+//3rd Party Libraries
+#include "cocos2d.h"
+
+//Wrapper Classes
+#include "GlyphCache.h"
+
+USING_NS_CC;
+
+/*
+	Glyph Baker:
+		- Draws every letter of a font once and saves them all into a glyph cache the game can load without FreeType (see GlyphCache.h)
+		- Run by CMake every time the font changes, the same as the atlas packer. The Visual Studio project doesn't run it, so the game built from that draws its labels with FreeType
+		- Each letter is drawn by FreeType at 4 times the bake size, then turned into a signed distance field and shrunk down. Drawing it bigger first makes the edges a lot more accurate
+		- The distance is worked out exactly (not estimated) with the Felzenszwalb and Huttenlocher distance transform, one column then one row at a time
+
+	Usage:
+		GlyphBaker [--size N] [--spread N] [--chars TEXT] FONT OUT
+			--size -> The font size to bake the letters at. Every other size is scaled from this one. Default 48
+			--spread -> How many pixels out from the edge of each letter the distance goes, at the bake size. Default 6
+			--chars -> The letters to bake. Default every printable ASCII character, from the space to the '~'
+			FONT -> The '.ttf' file to bake
+			OUT -> Where to write the glyph cache. Normally the same path with the '.glyphs' extension (see GlyphCache::getCachePath())
+
+	Note:
+		- Only letters up to 0xFFFF can be baked, since the kerning pairs store the letters in 16 bits
+*/
+
+//How much bigger than the bake size the letters are drawn before they are shrunk down
+static const unsigned int OVERSAMPLE = 4;
+
+//How many empty pixels are left between the letters in the texture, so the filtering doesn't blend neighbours together
+static const unsigned int LETTER_GAP = 1;
+
+//Stands in for 'infinitely far away' in the distance transform
+static const float FAR_AWAY = 1e20f;
+
+//The options read from the command line
+struct BakerOptions
+{
+	unsigned int size;
+	unsigned int spread;
+	std::u32string chars;
+	std::string font;
+	std::string out;
+};
+
+//A baked letter, and where it ended up
+struct BakedGlyph
+{
+	GlyphCacheEntry entry;
+	std::vector<unsigned char> pixels; //The distance field, entry.width x entry.height
+};
+
+static bool parseOptions(int argc, char** argv, BakerOptions& options)
+{
+	options.size = 48;
+	options.spread = 6;
+	std::vector<std::string> paths;
+	for (int i = 1; i < argc; i++)
+	{
+		bool hasValue = i + 1 < argc;
+		if (strcmp(argv[i], "--size") == 0 && hasValue)
+			options.size = (unsigned int)atoi(argv[++i]);
+		else if (strcmp(argv[i], "--spread") == 0 && hasValue)
+			options.spread = (unsigned int)atoi(argv[++i]);
+		else if (strcmp(argv[i], "--chars") == 0 && hasValue)
+		{
+			if (!StringUtils::UTF8ToUTF32(argv[++i], options.chars))
+			{
+				std::cout << "ERROR: The letters given to --chars aren't valid UTF-8" << std::endl;
+				return false;
+			}
+		}
+		else if (argv[i][0] == '-')
+		{
+			std::cout << "ERROR: Unknown option '" << argv[i] << "'" << std::endl;
+			return false;
+		}
+		else
+			paths.push_back(argv[i]);
+	}
+
+	if (paths.size() != 2 || options.size == 0 || options.spread == 0)
+	{
+		std::cout << "Usage: GlyphBaker [--size N] [--spread N] [--chars TEXT] FONT OUT" << std::endl;
+		return false;
+	}
+
+	if (options.chars.empty())
+	{
+		for (char32_t letter = ' '; letter <= '~'; letter++)
+			options.chars += letter;
+	}
+
+	options.font = paths[0];
+	options.out = paths[1];
+	return true;
+}
+
+//Where the parabolas rooted at cells Q and V cross
+static float getIntersection(const std::vector<float>& values, int q, int v)
+{
+	return ((values[q] + (float)(q * q)) - (values[v] + (float)(v * v))) / (float)(2 * q - 2 * v);
+}
+
+//The 1D distance transform. Works out the squared distance from every cell to the nearest seed, where each cell starts with 0 if it is a seed and FAR_AWAY if it isn't
+//Vertices and boundaries are scratch space, at least count and count + 1 long
+static void transform1D(float* cells, unsigned int count, unsigned int stride, std::vector<float>& values, std::vector<int>& vertices, std::vector<float>& boundaries)
+{
+	for (unsigned int i = 0; i < count; i++)
+		values[i] = cells[i * stride];
+
+	//Build the lower envelope of the parabolas rooted at each cell. Boundaries[k] is where parabola k starts being the lowest
+	int k = 0;
+	vertices[0] = 0;
+	boundaries[0] = -FAR_AWAY;
+	boundaries[1] = FAR_AWAY;
+	for (int q = 1; q < (int)count; q++)
+	{
+		float s = getIntersection(values, q, vertices[k]);
+		while (s <= boundaries[k])
+		{
+			k--;
+			s = getIntersection(values, q, vertices[k]);
+		}
+		k++;
+		vertices[k] = q;
+		boundaries[k] = s;
+		boundaries[k + 1] = FAR_AWAY;
+	}
+
+	//Read the distances back off the envelope
+	k = 0;
+	for (int q = 0; q < (int)count; q++)
+	{
+		while (boundaries[k + 1] < (float)q)
+			k++;
+		int v = vertices[k];
+		cells[q * stride] = (float)((q - v) * (q - v)) + values[v];
+	}
+}
+
+//The 2D distance transform. Each column, then each row
+static void transform2D(std::vector<float>& grid, unsigned int width, unsigned int height)
+{
+	unsigned int longest = std::max(width, height);
+	std::vector<float> values(longest);
+	std::vector<int> vertices(longest);
+	std::vector<float> boundaries(longest + 1);
+
+	for (unsigned int x = 0; x < width; x++)
+		transform1D(grid.data() + x, height, width, values, vertices, boundaries);
+	for (unsigned int y = 0; y < height; y++)
+		transform1D(grid.data() + y * width, width, 1, values, vertices, boundaries);
+}
+
+/*
+	Draw one letter and turn it into a distance field
+
+	@param Font -> The font, loaded at the bake size times OVERSAMPLE
+	@param Letter -> The letter to draw
+	@param Ascender -> How far above the baseline the top of the line is, at the oversampled size
+	@param Options -> The bake size and spread
+	@param GlyphOut -> The baked letter. Its position in the texture isn't filled in
+	@return Returns -> False if the font doesn't have the letter
+*/
+static bool bakeGlyph(FontFreeType* font, char32_t letter, int ascender, const BakerOptions& options, BakedGlyph& glyphOut)
+{
+	long bitmapWidth = 0, bitmapHeight = 0;
+	Rect bounds;
+	int xAdvance = 0;
+	const unsigned char* bitmap = font->getGlyphBitmap(letter, bitmapWidth, bitmapHeight, bounds, xAdvance);
+
+	memset(&glyphOut.entry, 0, sizeof(glyphOut.entry));
+	glyphOut.entry.codepoint = (uint32_t)letter;
+	glyphOut.entry.xAdvance = (int16_t)((xAdvance + (int)OVERSAMPLE / 2) / (int)OVERSAMPLE);
+	glyphOut.pixels.clear();
+	if (!bitmap || bitmapWidth <= 0 || bitmapHeight <= 0)
+		return xAdvance > 0; //Letters like the space have nothing to draw, but still move the pen
+
+	//Put the letter in the middle of a grid with room for the spread around it. The grid is a whole number of bake size pixels across
+	unsigned int padding = options.spread * OVERSAMPLE;
+	unsigned int width = ((unsigned int)bitmapWidth + padding * 2 + OVERSAMPLE - 1) / OVERSAMPLE * OVERSAMPLE;
+	unsigned int height = ((unsigned int)bitmapHeight + padding * 2 + OVERSAMPLE - 1) / OVERSAMPLE * OVERSAMPLE;
+
+	//Work out the distance from every pixel outside the letter to the nearest pixel inside it, and the other way around
+	std::vector<float> outside(width * height, FAR_AWAY);
+	std::vector<float> inside(width * height, 0.0f);
+	for (unsigned int y = 0; y < (unsigned int)bitmapHeight; y++)
+	{
+		for (unsigned int x = 0; x < (unsigned int)bitmapWidth; x++)
+		{
+			if (bitmap[y * bitmapWidth + x] >= 128)
+			{
+				unsigned int cell = (y + padding) * width + (x + padding);
+				outside[cell] = 0.0f;
+				inside[cell] = FAR_AWAY;
+			}
+		}
+	}
+	transform2D(outside, width, height);
+	transform2D(inside, width, height);
+
+	//Shrink it down by averaging each block of pixels. The edge sits half way between the last pixel inside and the first pixel outside
+	//128 is the edge, and the value goes down to 0 (or up to 255) one spread away from it
+	glyphOut.entry.width = (uint16_t)(width / OVERSAMPLE);
+	glyphOut.entry.height = (uint16_t)(height / OVERSAMPLE);
+	glyphOut.pixels.resize(glyphOut.entry.width * glyphOut.entry.height);
+	float maxDistance = (float)padding;
+	for (unsigned int y = 0; y < glyphOut.entry.height; y++)
+	{
+		for (unsigned int x = 0; x < glyphOut.entry.width; x++)
+		{
+			float distance = 0.0f;
+			for (unsigned int sy = 0; sy < OVERSAMPLE; sy++)
+			{
+				for (unsigned int sx = 0; sx < OVERSAMPLE; sx++)
+				{
+					unsigned int cell = (y * OVERSAMPLE + sy) * width + (x * OVERSAMPLE + sx);
+					distance += (outside[cell] > 0.0f) ? sqrtf(outside[cell]) - 0.5f : 0.5f - sqrtf(inside[cell]);
+				}
+			}
+			distance /= (float)(OVERSAMPLE * OVERSAMPLE);
+
+			float value = 0.5f - distance / (maxDistance * 2.0f);
+			value = std::min(std::max(value, 0.0f), 1.0f);
+			glyphOut.pixels[y * glyphOut.entry.width + x] = (unsigned char)(value * 255.0f + 0.5f);
+		}
+	}
+
+	//The offsets are where the top left of the grid is, moved back to the bake size
+	glyphOut.entry.offsetX = (bounds.origin.x - (float)padding) / (float)OVERSAMPLE;
+	glyphOut.entry.offsetY = ((float)ascender + bounds.origin.y - (float)padding) / (float)OVERSAMPLE;
+	return true;
+}
+
+/*
+	Place every letter on shelves in a texture of the given width. The letters must already be sorted tallest first
+
+	@param Width -> The width of the texture
+	@param Glyphs -> The letters. Their positions are filled in
+	@return Returns -> How tall the texture needs to be. 0 if a letter is wider than the texture
+*/
+static unsigned int placeGlyphs(unsigned int width, std::vector<BakedGlyph*>& glyphs)
+{
+	unsigned int shelfX = 0, shelfY = 0, shelfHeight = 0;
+	for (unsigned int i = 0; i < glyphs.size(); i++)
+	{
+		GlyphCacheEntry& entry = glyphs[i]->entry;
+		unsigned int cellWidth = entry.width + LETTER_GAP;
+		unsigned int cellHeight = entry.height + LETTER_GAP;
+		if (cellWidth > width)
+			return 0;
+
+		if (shelfX + cellWidth > width)
+		{
+			shelfY += shelfHeight;
+			shelfX = 0;
+			shelfHeight = 0;
+		}
+
+		entry.x = (uint16_t)shelfX;
+		entry.y = (uint16_t)shelfY;
+		shelfX += cellWidth;
+		shelfHeight = std::max(shelfHeight, cellHeight);
+	}
+
+	return shelfY + shelfHeight;
+}
+
+static unsigned int nextPowerOfTwo(unsigned int value)
+{
+	unsigned int power = 1;
+	while (power < value)
+		power *= 2;
+	return power;
+}
+
+int main(int argc, char** argv)
+{
+	BakerOptions options;
+	if (!parseOptions(argc, argv, options))
+		return 1;
+
+	//Load the font bigger than the bake size so the edges come out accurate
+	FontFreeType* font = FontFreeType::create(options.font, (float)(options.size * OVERSAMPLE), GlyphCollection::DYNAMIC, nullptr);
+	if (!font)
+	{
+		std::cout << "ERROR: Could not read the font '" << options.font << "'" << std::endl;
+		return 1;
+	}
+	font->retain();
+
+	//Bake every letter. Letters the font doesn't have are skipped, and labels just leave them out
+	std::vector<BakedGlyph> glyphs;
+	glyphs.reserve(options.chars.size());
+	for (unsigned int i = 0; i < options.chars.size(); i++)
+	{
+		if (options.chars[i] > 0xFFFF)
+		{
+			std::cout << "WARNING: Letters past 0xFFFF can't be baked, skipping " << (unsigned int)options.chars[i] << std::endl;
+			continue;
+		}
+
+		BakedGlyph glyph;
+		if (bakeGlyph(font, options.chars[i], font->getFontAscender(), options, glyph))
+			glyphs.push_back(glyph);
+		else
+			std::cout << "WARNING: '" << options.font << "' doesn't have the letter " << (unsigned int)options.chars[i] << ", skipping it" << std::endl;
+	}
+
+	//Find the pairs of letters that need kerning. Asking about every pair is only a few thousand lookups for ASCII
+	std::vector<GlyphKerningPair> kerning;
+	for (unsigned int left = 0; left < glyphs.size(); left++)
+	{
+		for (unsigned int right = 0; right < glyphs.size(); right++)
+		{
+			std::u32string pair;
+			pair += (char32_t)glyphs[left].entry.codepoint;
+			pair += (char32_t)glyphs[right].entry.codepoint;
+			int count = 0;
+			int* amounts = font->getHorizontalKerningForTextUTF32(pair, count);
+			int amount = (amounts && count == 2) ? amounts[1] : 0;
+			delete[] amounts;
+
+			amount = (int)floorf((float)amount / (float)OVERSAMPLE + 0.5f);
+			if (amount != 0)
+			{
+				GlyphKerningPair kerningPair = { (uint16_t)glyphs[left].entry.codepoint, (uint16_t)glyphs[right].entry.codepoint, (int16_t)amount, 0 };
+				kerning.push_back(kerningPair);
+			}
+		}
+	}
+
+	GlyphCacheHeader header;
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, GLYPH_CACHE_MAGIC, 4);
+	header.version = GLYPH_CACHE_VERSION;
+	header.glyphCount = (uint16_t)glyphs.size();
+	header.bakeSize = (uint16_t)options.size;
+	header.spread = (uint16_t)options.spread;
+	header.lineHeight = (uint16_t)((font->getFontMaxHeight() + (int)OVERSAMPLE / 2) / (int)OVERSAMPLE);
+	header.kerningCount = (uint32_t)kerning.size();
+	font->release();
+
+	//Pack the letters tallest first, the same way the atlas packer does, and keep the smallest texture
+	std::vector<BakedGlyph*> sorted;
+	for (unsigned int i = 0; i < glyphs.size(); i++)
+		sorted.push_back(&glyphs[i]);
+	std::sort(sorted.begin(), sorted.end(), [](const BakedGlyph* a, const BakedGlyph* b)
+	{
+		if (a->entry.height != b->entry.height)
+			return a->entry.height > b->entry.height;
+		return a->entry.codepoint < b->entry.codepoint;
+	});
+
+	unsigned int bestWidth = 0, bestHeight = 0;
+	for (unsigned int width = 64; width <= 4096; width *= 2)
+	{
+		unsigned int height = placeGlyphs(width, sorted);
+		if (height == 0)
+			continue;
+		height = nextPowerOfTwo(height);
+		if (height > 4096)
+			continue;
+		bool smaller = width * height < bestWidth * bestHeight;
+		bool squarer = width * height == bestWidth * bestHeight && std::max(width, height) < std::max(bestWidth, bestHeight);
+		if (bestWidth == 0 || smaller || squarer)
+		{
+			bestWidth = width;
+			bestHeight = height;
+		}
+	}
+
+	if (bestWidth == 0)
+	{
+		std::cout << "ERROR: The letters don't fit in a 4096x4096 texture. Try a smaller --size" << std::endl;
+		return 1;
+	}
+
+	placeGlyphs(bestWidth, sorted);
+	header.width = (uint16_t)bestWidth;
+	header.height = (uint16_t)bestHeight;
+
+	//Copy every letter into the texture. Anything not covered by a letter is as far outside an edge as it gets
+	std::vector<unsigned char> texture(bestWidth * bestHeight, 0);
+	std::vector<GlyphCacheEntry> entries;
+	for (unsigned int i = 0; i < glyphs.size(); i++)
+	{
+		const BakedGlyph& glyph = glyphs[i];
+		for (unsigned int y = 0; y < glyph.entry.height; y++)
+			memcpy(texture.data() + (glyph.entry.y + y) * bestWidth + glyph.entry.x, glyph.pixels.data() + y * glyph.entry.width, glyph.entry.width);
+		entries.push_back(glyph.entry);
+	}
+
+	//Write it out
+	std::ofstream file(options.out, std::ios::binary | std::ios::trunc);
+	file.write((const char*)&header, sizeof(header));
+	file.write((const char*)entries.data(), entries.size() * sizeof(GlyphCacheEntry));
+	file.write((const char*)kerning.data(), kerning.size() * sizeof(GlyphKerningPair));
+	file.write((const char*)texture.data(), texture.size());
+	if (!file)
+	{
+		std::cout << "ERROR: Could not write '" << options.out << "'" << std::endl;
+		return 1;
+	}
+
+	std::cout << "Glyph Baker -> " << options.font << ": " << glyphs.size() << " letters at size " << options.size << " in a " << bestWidth << "x" << bestHeight << " texture, "
+		<< kerning.size() << " kerning pairs" << std::endl;
+	return 0;
+}
@@ -0,0 +1,269 @@
+//Core Libraries
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+//3rd Party Libraries
+#include "cocos2d.h"
+
+//Wrapper Classes
+#include "CookedTexture.h"
+#include "LZ4Block.h"
+
+USING_NS_CC;
+
+/*
+	Texture Cooker:
+		- Turns a PNG or JPG into a cooked texture the game can load without decoding anything (see CookedTexture.h)
+		- Run by CMake every time the image changes, the same as the atlas packer
+		- The alpha is multiplied into the colours here, the same thing Cocos2D does to PNGs when it loads them, so the texture looks exactly the same in game
+		- The mip chain is made by averaging each 2x2 block of pixels into one. This happens after the alpha is multiplied in, otherwise see-through pixels would bleed their colour into the edges
+
+	Usage:
+		TextureCooker [--mips] [--mip-levels N] [--lz4] IN OUT
+			--mips -> Make the full mip chain, all the way down to 1x1. Only works for images that are a power of two on both sides, older GPUs can't use mips on anything else
+			--mip-levels -> Make the mip chain, but stop once it has N images (counting the full size one). Use this for atlases, since the border around each sprite shrinks with every mip
+			--lz4 -> Compress the pixels with LZ4. If they don't get any smaller (ex: a photo), they are saved uncompressed instead
+			IN -> The image to cook
+			OUT -> Where to write the cooked texture. Normally the same path with the '.ctex' extension (see CookedTexture::getCookedPath())
+
+	Note:
+		- Images with an alpha channel are saved as RGBA8888. Images without one (ex: JPGs) are saved as RGB888, which is a quarter smaller
+*/
+
+//The PVR (version 3) header that starts the payload. Cocos2D reads this to know how to upload the pixels
+#pragma pack(push, 1)
+struct PVRv3Header
+{
+	uint32_t version;
+	uint32_t flags;
+	uint64_t pixelFormat;
+	uint32_t colorSpace;
+	uint32_t channelType;
+	uint32_t height;
+	uint32_t width;
+	uint32_t depth;
+	uint32_t numberOfSurfaces;
+	uint32_t numberOfFaces;
+	uint32_t numberOfMipmaps;
+	uint32_t metadataLength;
+};
+#pragma pack(pop)
+
+static_assert(sizeof(PVRv3Header) == 52, "The PVR header must be exactly 52 bytes!");
+
+//The values of the PVR header fields we use. They come from the PVR spec, and are the same ones Cocos2D checks for
+static const uint32_t PVR3_VERSION = 0x03525650; //'PVR' then 3
+static const uint32_t PVR3_FLAG_PREMULTIPLIED = 0x02;
+static const uint64_t PVR3_FORMAT_RGBA8888 = 0x0808080861626772ULL; //The channel names then the bits in each
+static const uint64_t PVR3_FORMAT_RGB888 = 0x0008080800626772ULL;
+
+//The options read from the command line
+struct CookerOptions
+{
+	unsigned int mipLevels; //0 means the full chain
+	bool mips;
+	bool lz4;
+	std::string in;
+	std::string out;
+};
+
+static bool parseOptions(int argc, char** argv, CookerOptions& options)
+{
+	options.mipLevels = 0;
+	options.mips = false;
+	options.lz4 = false;
+	std::vector<std::string> paths;
+	for (int i = 1; i < argc; i++)
+	{
+		if (strcmp(argv[i], "--mips") == 0)
+			options.mips = true;
+		else if (strcmp(argv[i], "--mip-levels") == 0 && i + 1 < argc)
+		{
+			options.mips = true;
+			options.mipLevels = (unsigned int)atoi(argv[++i]);
+		}
+		else if (strcmp(argv[i], "--lz4") == 0)
+			options.lz4 = true;
+		else if (argv[i][0] == '-')
+		{
+			std::cout << "ERROR: Unknown option '" << argv[i] << "'" << std::endl;
+			return false;
+		}
+		else
+			paths.push_back(argv[i]);
+	}
+
+	if (paths.size() != 2)
+	{
+		std::cout << "Usage: TextureCooker [--mips] [--mip-levels N] [--lz4] IN OUT" << std::endl;
+		return false;
+	}
+
+	options.in = paths[0];
+	options.out = paths[1];
+	return true;
+}
+
+static bool isPowerOfTwo(unsigned int value)
+{
+	return value > 0 && (value & (value - 1)) == 0;
+}
+
+//Make the next mip from the one before it. Each pixel is the average of a 2x2 block. When one side is already 1 pixel, only the other side is halved
+static void makeMip(const std::vector<unsigned char>& source, unsigned int width, unsigned int height, unsigned int channels, std::vector<unsigned char>& mipOut)
+{
+	unsigned int mipWidth = std::max(width / 2, 1u);
+	unsigned int mipHeight = std::max(height / 2, 1u);
+	unsigned int stepX = (width > 1) ? 1 : 0;
+	unsigned int stepY = (height > 1) ? 1 : 0;
+	mipOut.resize(mipWidth * mipHeight * channels);
+
+	for (unsigned int y = 0; y < mipHeight; y++)
+	{
+		const unsigned char* row0 = source.data() + (y * 2) * width * channels;
+		const unsigned char* row1 = source.data() + (y * 2 + stepY) * width * channels;
+		for (unsigned int x = 0; x < mipWidth; x++)
+		{
+			unsigned int left = x * 2 * channels;
+			unsigned int right = (x * 2 + stepX) * channels;
+			for (unsigned int c = 0; c < channels; c++)
+			{
+				unsigned int sum = row0[left + c] + row0[right + c] + row1[left + c] + row1[right + c];
+				mipOut[(y * mipWidth + x) * channels + c] = (unsigned char)((sum + 2) / 4);
+			}
+		}
+	}
+}
+
+int main(int argc, char** argv)
+{
+	CookerOptions options;
+	if (!parseOptions(argc, argv, options))
+		return 1;
+
+	//Read the image with straight alpha so the multiply below is the only one
+	Image::setPNGPremultipliedAlphaEnabled(false);
+	Image* image = new Image();
+	if (!image->initWithImageFile(options.in))
+	{
+		std::cout << "ERROR: Could not read the image '" << options.in << "'" << std::endl;
+		image->release();
+		return 1;
+	}
+
+	unsigned int width = (unsigned int)image->getWidth();
+	unsigned int height = (unsigned int)image->getHeight();
+	unsigned int channels;
+	if (image->getRenderFormat() == Texture2D::PixelFormat::RGBA8888)
+		channels = 4;
+	else if (image->getRenderFormat() == Texture2D::PixelFormat::RGB888)
+		channels = 3;
+	else
+	{
+		std::cout << "ERROR: '" << options.in << "' isn't an RGBA or RGB image" << std::endl;
+		image->release();
+		return 1;
+	}
+
+	std::vector<unsigned char> pixels(image->getData(), image->getData() + width * height * channels);
+	image->release();
+
+	//Multiply the alpha into the colours. Rounded the same way Cocos2D does it
+	if (channels == 4)
+	{
+		for (unsigned int i = 0; i < width * height; i++)
+		{
+			unsigned char* pixel = pixels.data() + i * 4;
+			for (unsigned int c = 0; c < 3; c++)
+				pixel[c] = (unsigned char)((pixel[c] * (pixel[3] + 1)) >> 8);
+		}
+	}
+
+	//Work out how many mips to make
+	unsigned int mipCount = 1;
+	if (options.mips && !(isPowerOfTwo(width) && isPowerOfTwo(height)))
+		std::cout << "WARNING: '" << options.in << "' is " << width << "x" << height << ", which isn't a power of two. It is cooked without mips" << std::endl;
+	else if (options.mips)
+	{
+		for (unsigned int size = std::max(width, height); size > 1; size /= 2)
+			mipCount++;
+		if (options.mipLevels > 0)
+			mipCount = std::min(mipCount, options.mipLevels);
+	}
+
+	//Build the PVR payload: the header, then every mip from biggest to smallest
+	PVRv3Header pvr;
+	memset(&pvr, 0, sizeof(pvr));
+	pvr.version = PVR3_VERSION;
+	pvr.flags = (channels == 4) ? PVR3_FLAG_PREMULTIPLIED : 0;
+	pvr.pixelFormat = (channels == 4) ? PVR3_FORMAT_RGBA8888 : PVR3_FORMAT_RGB888;
+	pvr.height = height;
+	pvr.width = width;
+	pvr.depth = 1;
+	pvr.numberOfSurfaces = 1;
+	pvr.numberOfFaces = 1;
+	pvr.numberOfMipmaps = mipCount;
+
+	std::vector<unsigned char> payload((const unsigned char*)&pvr, (const unsigned char*)&pvr + sizeof(pvr));
+	std::vector<unsigned char> mip = pixels, nextMip;
+	unsigned int mipWidth = width, mipHeight = height;
+	for (unsigned int i = 0; i < mipCount; i++)
+	{
+		payload.insert(payload.end(), mip.begin(), mip.end());
+		if (i + 1 < mipCount)
+		{
+			makeMip(mip, mipWidth, mipHeight, channels, nextMip);
+			mip.swap(nextMip);
+			mipWidth = std::max(mipWidth / 2, 1u);
+			mipHeight = std::max(mipHeight / 2, 1u);
+		}
+	}
+
+	//Compress it if that was asked for and it actually helps
+	CookedTextureHeader header;
+	memcpy(header.magic, COOKED_TEXTURE_MAGIC, 4);
+	header.version = COOKED_TEXTURE_VERSION;
+	header.flags = 0;
+	header.width = width;
+	header.height = height;
+	header.mipCount = mipCount;
+	header.payloadSize = (uint32_t)payload.size();
+	header.reserved = 0;
+
+	std::vector<unsigned char> stored;
+	if (options.lz4)
+	{
+		stored.resize(LZ4Block::getMaxCompressedSize(payload.size()));
+		size_t compressedSize = LZ4Block::compress(payload.data(), payload.size(), stored.data(), stored.size());
+		if (compressedSize > 0 && compressedSize < payload.size())
+		{
+			stored.resize(compressedSize);
+			header.flags |= COOKED_TEXTURE_FLAG_LZ4;
+		}
+		else
+			std::cout << "WARNING: '" << options.in << "' doesn't get any smaller with LZ4. It is cooked uncompressed" << std::endl;
+	}
+	if (!(header.flags & COOKED_TEXTURE_FLAG_LZ4))
+		stored.swap(payload);
+	header.storedSize = (uint32_t)stored.size();
+
+	//Write it out
+	std::ofstream file(options.out, std::ios::binary | std::ios::trunc);
+	file.write((const char*)&header, sizeof(header));
+	file.write((const char*)stored.data(), stored.size());
+	if (!file)
+	{
+		std::cout << "ERROR: Could not write '" << options.out << "'" << std::endl;
+		return 1;
+	}
+
+	std::cout << "Texture Cooker -> " << options.in << ": " << width << "x" << height << ((channels == 4) ? " RGBA" : " RGB") << ", " << mipCount << " mip(s), "
+		<< (sizeof(header) + stored.size()) << " bytes" << ((header.flags & COOKED_TEXTURE_FLAG_LZ4) ? " (LZ4, " + std::to_string(header.payloadSize) + " bytes raw)" : " (raw)") << std::endl;
+	return 0;
+}